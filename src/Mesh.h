@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cmath>
+#include <iostream>
 #include <glm/glm.hpp>
 #include <string>
 #include <vector>
@@ -21,59 +23,209 @@ struct Texture
   std::string path;
 };
 
+#define MATERIAL_MAX_TEXTURES (MaterialSamplerType_Count * MATERIAL_SAMPLERS_PER_TYPE)
+
+struct MaterialTextureBinding
+{
+  uint32 textureId;
+  uint32 unit;
+  UniformHandle sampler; // valid with any program, see materialSamplerHandle()
+};
+
+// NOTE: Everything a draw needs to bind a material, resolved at load time so binding does no string work or allocation
+struct MaterialBindingTable
+{
+  uint32 count;
+  MaterialTextureBinding bindings[MATERIAL_MAX_TEXTURES];
+};
+
+// textures are bound to units 0 through textures.size() - 1, the Nth texture of a type is "material.<type>N"
+inline MaterialBindingTable buildMaterialBindingTable(const std::vector<Texture>& textures)
+{
+  MaterialBindingTable table = {};
+  uint32 typeCounts[MaterialSamplerType_Count] = {};
+  for (uint32 i = 0; i < textures.size(); i++)
+  {
+    const Texture& texture = textures[i];
+    uint32 type = 0;
+    while (type < MaterialSamplerType_Count && texture.type != materialSamplerTypeNames[type]) { type++; }
+    if (type == MaterialSamplerType_Count || typeCounts[type] == MATERIAL_SAMPLERS_PER_TYPE)
+    {
+      std::cout << "ERROR::MESH::Material has no sampler left for texture: " << texture.path << " (" << texture.type << ")" << std::endl;
+      continue;
+    }
+    uint32 number = ++typeCounts[type];
+    table.bindings[table.count++] = { texture.id, i, materialSamplerHandle((MaterialSamplerType)type, number) };
+  }
+  return table;
+}
+
+inline void bindMaterial(const ShaderProgram& shader, const MaterialBindingTable& material)
+{
+  for (uint32 i = 0; i < material.count; i++)
+  {
+    const MaterialTextureBinding& binding = material.bindings[i];
+    glActiveTexture(GL_TEXTURE0 + binding.unit); // activate proper texture unit before binding
+    shader.setUniform(binding.sampler, binding.unit);
+    glBindTexture(GL_TEXTURE_2D, binding.textureId);
+  }
+  glActiveTexture(GL_TEXTURE0);
+}
+
+// vertex attributes of the currently bound VAO, sourced from the currently bound GL_ARRAY_BUFFER
+inline void setupVertexAttributes()
+{
+  // vertex positions
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+  glEnableVertexAttribArray(0);
+  // vertex normals
+  glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
+  glEnableVertexAttribArray(1);
+  // vertex texture coords
+  glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
+  glEnableVertexAttribArray(2);
+}
+
+// NOTE: One VAO, vertex buffer and index buffer that many meshes are packed into, sized up front. Meshes in an arena
+// NOTE: are addressed by their base vertex and first index, so they can all be drawn without binding another VAO.
+class MeshArena
+{
+public:
+  uint32 VAO;
+
+  MeshArena(uint32 vertexCapacity, uint32 indexCapacity)
+  {
+    this->vertexCapacity = vertexCapacity;
+    this->indexCapacity = indexCapacity;
+
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
+
+    glBindVertexArray(VAO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, vertexCapacity * sizeof(Vertex), NULL, GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCapacity * sizeof(uint32), NULL, GL_STATIC_DRAW);
+
+    setupVertexAttributes();
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+    // Must unbind EBO AFTER unbinding VAO, since VAO stores all glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _) calls
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  }
+
+  ~MeshArena() {
+    glDeleteBuffers(1, &EBO);
+    glDeleteBuffers(1, &VBO);
+    glDeleteVertexArrays(1, &VAO);
+  }
+
+  // Returns false if the arena doesn't have room left for the mesh
+  bool add(const Vertex* vertices, uint32 verticesCount, const uint32* indices, uint32 indicesCount,
+           uint32* baseVertex, uint32* firstIndex)
+  {
+    if(vertexCount + verticesCount > vertexCapacity || indexCount + indicesCount > indexCapacity)
+    {
+      std::cout << "ERROR::MESH_ARENA::Out of space for mesh with " << verticesCount << " vertices" << std::endl;
+      return false;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferSubData(GL_ARRAY_BUFFER, vertexCount * sizeof(Vertex), verticesCount * sizeof(Vertex), vertices);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // NOTE: the element buffer binding is VAO state, the arena's VAO must be bound to upload indices
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, indexCount * sizeof(uint32), indicesCount * sizeof(uint32), indices);
+    glBindVertexArray(0);
+
+    *baseVertex = vertexCount;
+    *firstIndex = indexCount;
+    vertexCount += verticesCount;
+    indexCount += indicesCount;
+    return true;
+  }
+
+private:
+  uint32 VBO, EBO;
+  uint32 vertexCapacity, indexCapacity;
+  uint32 vertexCount = 0;
+  uint32 indexCount = 0;
+};
+
 class Mesh
 {
 public:
   uint32 indicesCount;
   std::vector<Texture> textures;
+  MaterialBindingTable material;
   uint32 VAO;
+  uint32 baseVertex = 0; // added to every index
+  uint32 firstIndex = 0; // offset into the element buffer, in indices
+  float32 boundingRadius; // furthest vertex from the mesh's origin
+
+  Mesh(const std::vector<Vertex>& vertices, const std::vector<uint32>& indices, std::vector<Texture> textures)
+          : Mesh(vertices.data(), (uint32)vertices.size(), indices.data(), (uint32)indices.size(), textures) {}
 
-  Mesh(std::vector<Vertex> vertices, std::vector<uint32> indices, std::vector<Texture> textures)
+  // NOTE: vertices and indices only need to live until the constructor returns (ex: a memory mapped mesh cache)
+  // NOTE: When an arena is given the mesh is packed into it and shares its VAO, otherwise it owns its own buffers
+  Mesh(const Vertex* vertices, uint32 verticesCount, const uint32* indices, uint32 indicesCount, std::vector<Texture> textures,
+       MeshArena* arena = NULL)
   {
-    this->indicesCount = indices.size();
+    this->indicesCount = indicesCount;
     this->textures = textures;
+    material = buildMaterialBindingTable(textures);
+
+    float32 maxDistanceSquared = 0.0f;
+    for(uint32 i = 0; i < verticesCount; i++)
+    {
+      const glm::vec3& position = vertices[i].Position;
+      float32 distanceSquared = position.x * position.x + position.y * position.y + position.z * position.z;
+      if(distanceSquared > maxDistanceSquared) { maxDistanceSquared = distanceSquared; }
+    }
+    boundingRadius = sqrtf(maxDistanceSquared);
 
-    setupMesh(vertices, indices);
+    if(arena != NULL && arena->add(vertices, verticesCount, indices, indicesCount, &baseVertex, &firstIndex))
+    {
+      VAO = arena->VAO;
+      ownsBuffers = false;
+    } else
+    {
+      setupMesh(vertices, verticesCount, indices);
+    }
   }
 
   ~Mesh() {
+    if(!ownsBuffers) { return; }
     glDeleteBuffers(1, &EBO);
     glDeleteBuffers(1, &VBO);
     glDeleteVertexArrays(1, &VAO);
   }
 
-  void Draw(ShaderProgram shader)
+  // byte offset of the mesh's first index, as expected by the glDrawElements family
+  void* indexOffset() const { return (void*)(firstIndex * sizeof(uint32)); }
+
+  // NOTE: No heap allocations or string building, safe to call as often as needed per frame
+  void Draw(const ShaderProgram& shader)
   {
-    uint32 diffuseNr = 1;
-    uint32 specularNr = 1;
-    for (uint32 i = 0; i < textures.size(); i++)
-    {
-      Texture texture = textures[i];
-      glActiveTexture(GL_TEXTURE0 + i); // activate proper texture unit before binding
-      // retrieve texture number (the N in diffuse_textureN)
-      std::string number;
-      std::string name = texture.type;
-      if (name == "diffTexture")
-        number = std::to_string(diffuseNr++);
-      else if (name == "specTexture")
-        number = std::to_string(specularNr++);
-
-      const std::string uniformName = "material." + name + number; // ex: "material.diffTexture2", "material.specTexture6"
-      shader.setUniform(uniformName, i);
-      glBindTexture(GL_TEXTURE_2D, texture.id);
-    }
-    glActiveTexture(GL_TEXTURE0);
+    bindMaterial(shader, material);
 
     // draw mesh
     glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, indicesCount, GL_UNSIGNED_INT, 0);
+    glDrawElementsBaseVertex(GL_TRIANGLES, indicesCount, GL_UNSIGNED_INT, indexOffset(), baseVertex);
     glBindVertexArray(0);
   }
 
 private:
-  uint32 VBO, EBO;
+  uint32 VBO = 0, EBO = 0;
+  bool ownsBuffers = true;
 
-  void setupMesh(std::vector<Vertex> vertices, std::vector<uint32> indices)
+  void setupMesh(const Vertex* vertices, uint32 verticesCount, const uint32* indices)
   {
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
@@ -82,20 +234,12 @@ private:
     glBindVertexArray(VAO);
 
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, verticesCount * sizeof(Vertex), vertices, GL_STATIC_DRAW);
 
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indicesCount * sizeof(uint32), &indices[0], GL_STATIC_DRAW);
-
-    // vertex positions
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
-    glEnableVertexAttribArray(0);
-    // vertex normals
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
-    glEnableVertexAttribArray(1);
-    // vertex texture coords
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
-    glEnableVertexAttribArray(2);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indicesCount * sizeof(uint32), indices, GL_STATIC_DRAW);
+
+    setupVertexAttributes();
 
     // unbind VBO, VAO, & EBO
     glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -11,37 +11,109 @@
 #include <string>
 #include <vector>
 #include <iostream>
+#include <cstring>
+#include <algorithm>
 
 #include "Mesh.h"
 #include "LearnOpenGLPlatform.h"
 #include "common/OpenGLUtil.h"
+#include "common/MeshCache.h"
+#include "common/MeshSimplifier.h"
+#include "common/WorkerPool.h"
+#include "common/TextureCache.h"
+#include "common/RenderQueue.h"
+
+#define MODEL_MAX_LODS 4
+// NOTE: fraction of the full detail triangle count each level of detail is simplified down to
+const float32 modelLodTriangleRatios[MODEL_MAX_LODS] = { 1.0f, 0.35f, 0.12f, 0.04f };
+
+// NOTE: full detail meshes that share a material, drawn with a single glMultiDrawElementsBaseVertex
+struct ModelDrawBatch
+{
+  MaterialBindingTable material;
+  std::vector<GLsizei> indexCounts;
+  std::vector<const void*> indexOffsets;
+  std::vector<GLint> baseVertices;
+};
 
 class Model
 {
 public:
   std::vector<Mesh*> meshes;
+  // NOTE: lodMeshes[lod - 1][i] is meshes[i] simplified to modelLodTriangleRatios[lod], they share meshes[i]'s textures
+  std::vector<std::vector<Mesh*>> lodMeshes;
 
-  Model(const char* path)
+  // NOTE: levels of detail past the first are generated on import and stored in the mesh cache
+  Model(const char* path, uint32 lodCount = 1)
   {
-    loadModel(path);
+    if(lodCount < 1) { lodCount = 1; }
+    if(lodCount > MODEL_MAX_LODS) { lodCount = MODEL_MAX_LODS; }
+    loadModel(path, lodCount);
   }
 
   ~Model() {
     for(Mesh* mesh : meshes) { delete mesh; }
-    for(Texture texture : texturesLoaded) { glDeleteTextures(1, &texture.id); }
+    for(std::vector<Mesh*>& lod : lodMeshes) { for(Mesh* mesh : lod) { delete mesh; } }
+    delete arena; // NOTE: after the meshes that were packed into it
+    for(Texture texture : texturesLoaded) { releaseTexture(texture.id); }
+  }
+
+  uint32 lodCount() const { return (uint32)lodMeshes.size() + 1; }
+  const std::vector<Mesh*>& lodLevel(uint32 lod) const { return lod == 0 ? meshes : lodMeshes[lod - 1]; }
+
+  // NOTE: Every mesh of the model (levels of detail included) lives in one arena, so a draw is one VAO bind and one
+  // NOTE: multi-draw per material
+  void Draw(const ShaderProgram& shader)
+  {
+    if(arena == NULL) { return; }
+    glBindVertexArray(arena->VAO);
+    for (const ModelDrawBatch& batch : drawBatches)
+    {
+      bindMaterial(shader, batch.material);
+      glMultiDrawElementsBaseVertex(GL_TRIANGLES, batch.indexCounts.data(), GL_UNSIGNED_INT, batch.indexOffsets.data(),
+                                    (GLsizei)batch.indexCounts.size(), batch.baseVertices.data());
+    }
+    glBindVertexArray(0);
   }
 
-  void Draw(ShaderProgram shader)
+  // One packet per draw batch, packet supplies everything but the vertex array, material and draw arguments
+  void submit(RenderQueue& queue, RenderLayer layer, const glm::vec3& position, RenderPacket packet) const
   {
-    for (uint32 i = 0; i < meshes.size(); i++) meshes[i]->Draw(shader);
+    if(arena == NULL) { return; }
+    packet.vertexArray = arena->VAO;
+    for (const ModelDrawBatch& batch : drawBatches)
+    {
+      packet.material = &batch.material;
+      packet.multiDrawCount = (GLsizei)batch.indexCounts.size();
+      packet.indexCounts = batch.indexCounts.data();
+      packet.indexOffsets = batch.indexOffsets.data();
+      packet.baseVertices = batch.baseVertices.data();
+      queue.submit(layer, position, packet);
+    }
   }
 
+  uint32 drawBatchCount() const { return (uint32)drawBatches.size(); }
+
 private:
+  MeshArena* arena = NULL;
+  std::vector<ModelDrawBatch> drawBatches;
   std::vector<Texture> texturesLoaded;
   std::string directory;
 
-  void loadModel(std::string path)
+  struct PendingTexture
   {
+    std::string path; // relative to the model's directory, matches Texture::path
+    std::string type;
+    std::string fileLocation;
+    DecodedImage image;
+  };
+
+  void loadModel(std::string path, uint32 lodCount)
+  {
+    directory = path.substr(0, path.find_last_of('/'));
+
+    if(loadModelFromCache(path.c_str(), lodCount)) { return; }
+
     Assimp::Importer import;
     const aiScene* scene = import.ReadFile(path, aiProcess_Triangulate | aiProcess_FlipUVs);
 
@@ -50,31 +122,179 @@ private:
       std::cout << "ERROR::ASSIMP::" << import.GetErrorString() << std::endl;
       return;
     }
-    directory = path.substr(0, path.find_last_of('/'));
 
-    processNode(scene->mRootNode, scene);
+    std::vector<const aiMesh*> assimpMeshes;
+    processNode(scene->mRootNode, scene, assimpMeshes);
+
+    // NOTE: sized up front, worker threads write into these while the jobs are in flight
+    std::vector<MeshCacheSourceMesh> cacheMeshes(assimpMeshes.size());
+    for (uint32 i = 0; i < assimpMeshes.size(); i++)
+    {
+      processMaterial(assimpMeshes[i], scene, cacheMeshes[i].textures);
+    }
+
+    JobCounter jobs;
+    for (uint32 i = 0; i < assimpMeshes.size(); i++)
+    {
+      const aiMesh* assimpMesh = assimpMeshes[i];
+      MeshCacheSourceMesh* cacheMesh = &cacheMeshes[i];
+      addJob(&jobs, [assimpMesh, cacheMesh] { processMesh(assimpMesh, cacheMesh); });
+    }
+
+    std::vector<std::vector<Texture>*> textureLists;
+    for (MeshCacheSourceMesh& cacheMesh : cacheMeshes) { textureLists.push_back(&cacheMesh.textures); }
+    loadTextures(textureLists, &jobs);
+
+    // simplify every level of detail straight from the full detail mesh, so they can all run at once
+    uint32 sourceMeshCount = (uint32)cacheMeshes.size();
+    cacheMeshes.resize(sourceMeshCount * lodCount);
+    for (uint32 lod = 1; lod < lodCount; lod++)
+    {
+      for (uint32 i = 0; i < sourceMeshCount; i++)
+      {
+        const MeshCacheSourceMesh* sourceMesh = &cacheMeshes[i];
+        MeshCacheSourceMesh* lodMesh = &cacheMeshes[(lod * sourceMeshCount) + i];
+        lodMesh->textures = sourceMesh->textures;
+        lodMesh->lod = lod;
+        uint32 targetTriangleCount = (uint32)((sourceMesh->indices.size() / 3) * modelLodTriangleRatios[lod]);
+        addJob(&jobs, [sourceMesh, lodMesh, targetTriangleCount] {
+          simplifyMesh(sourceMesh->vertices.data(), (uint32)sourceMesh->vertices.size(),
+                       sourceMesh->indices.data(), (uint32)sourceMesh->indices.size(),
+                       targetTriangleCount, &lodMesh->vertices, &lodMesh->indices);
+        });
+      }
+    }
+    waitForJobs(&jobs);
+
+    uint64 totalVertexCount = 0;
+    uint64 totalIndexCount = 0;
+    for (const MeshCacheSourceMesh& cacheMesh : cacheMeshes)
+    {
+      totalVertexCount += cacheMesh.vertices.size();
+      totalIndexCount += cacheMesh.indices.size();
+    }
+
+    // GL uploads happen on this thread, after all workers are finished
+    addMeshes(cacheMeshes.size(), totalVertexCount, totalIndexCount, [&cacheMeshes](uint32 i, MeshArena* arena) -> Mesh* {
+      const MeshCacheSourceMesh& cacheMesh = cacheMeshes[i];
+      return new Mesh(cacheMesh.vertices.data(), (uint32)cacheMesh.vertices.size(),
+                      cacheMesh.indices.data(), (uint32)cacheMesh.indices.size(), cacheMesh.textures, arena);
+    }, [&cacheMeshes](uint32 i) { return cacheMeshes[i].lod; }, lodCount);
+
+    writeMeshCache(path.c_str(), cacheMeshes);
   }
 
-  void processNode(aiNode* node, const aiScene* scene)
+  // NOTE: Warm path, vertex and index data are uploaded straight from the memory mapped file
+  bool loadModelFromCache(const char* path, uint32 lodCount)
+  {
+    MeshCacheFile cacheFile;
+    if(!openMeshCache(path, &cacheFile)) { return false; }
+    if(cacheFile.header->lodCount != lodCount)
+    {
+      // NOTE: cold path rewrites the cache with the requested levels of detail
+      closeMeshCache(&cacheFile);
+      return false;
+    }
+
+    std::vector<std::vector<Texture>> meshTextures(cacheFile.header->meshCount);
+    std::vector<std::vector<Texture>*> textureLists;
+    for(uint32 i = 0; i < cacheFile.header->meshCount; i++)
+    {
+      const MeshCacheMesh& cacheMesh = cacheFile.meshes[i];
+      for(uint32 j = 0; j < cacheMesh.textureCount; j++)
+      {
+        const MeshCacheTexture& cacheTexture = cacheFile.textures[cacheMesh.firstTexture + j];
+        meshTextures[i].push_back({ 0, cacheTexture.type, cacheTexture.path });
+      }
+      textureLists.push_back(&meshTextures[i]);
+    }
+
+    JobCounter jobs;
+    loadTextures(textureLists, &jobs);
+
+    uint64 totalVertexCount = 0;
+    uint64 totalIndexCount = 0;
+    for(uint32 i = 0; i < cacheFile.header->meshCount; i++)
+    {
+      totalVertexCount += cacheFile.meshes[i].vertexCount;
+      totalIndexCount += cacheFile.meshes[i].indexCount;
+    }
+
+    addMeshes(cacheFile.header->meshCount, totalVertexCount, totalIndexCount, [&cacheFile, &meshTextures](uint32 i, MeshArena* arena) -> Mesh* {
+      const MeshCacheMesh& cacheMesh = cacheFile.meshes[i];
+      return new Mesh(meshCacheVertices(cacheFile, cacheMesh), cacheMesh.vertexCount,
+                      meshCacheIndices(cacheFile, cacheMesh), cacheMesh.indexCount,
+                      meshTextures[i], arena);
+    }, [&cacheFile](uint32 i) { return cacheFile.meshes[i].lod; }, lodCount);
+
+    closeMeshCache(&cacheFile);
+    return true;
+  }
+
+  template<typename CreateMesh, typename MeshLod>
+  void addMeshes(uint64 meshCount, uint64 totalVertexCount, uint64 totalIndexCount, CreateMesh createMesh, MeshLod meshLod,
+                 uint32 lodCount)
+  {
+    arena = new MeshArena((uint32)totalVertexCount, (uint32)totalIndexCount);
+    lodMeshes.resize(lodCount - 1);
+    for(uint32 i = 0; i < meshCount; i++)
+    {
+      uint32 lod = meshLod(i);
+      std::vector<Mesh*>& lodList = (lod == 0) ? meshes : lodMeshes[lod - 1];
+      lodList.push_back(createMesh(i, arena));
+    }
+    buildDrawBatches();
+  }
+
+  // full detail meshes sorted by material so each material's textures are bound once per draw
+  void buildDrawBatches()
+  {
+    std::vector<Mesh*> sortedMeshes = meshes;
+    auto textureIdsLess = [](const Mesh* a, const Mesh* b) {
+      uint64 sharedCount = a->textures.size() < b->textures.size() ? a->textures.size() : b->textures.size();
+      for(uint32 i = 0; i < sharedCount; i++)
+      {
+        if(a->textures[i].id != b->textures[i].id) { return a->textures[i].id < b->textures[i].id; }
+      }
+      return a->textures.size() < b->textures.size();
+    };
+    std::stable_sort(sortedMeshes.begin(), sortedMeshes.end(), textureIdsLess);
+
+    drawBatches.clear();
+    for(uint32 i = 0; i < sortedMeshes.size(); i++)
+    {
+      const Mesh* mesh = sortedMeshes[i];
+      // NOTE: equivalent materials are neighbors after sorting, neither sorts before the other
+      if(i == 0 || textureIdsLess(sortedMeshes[i - 1], mesh))
+      {
+        drawBatches.push_back({ mesh->material, {}, {}, {} });
+      }
+      ModelDrawBatch& batch = drawBatches.back();
+      batch.indexCounts.push_back((GLsizei)mesh->indicesCount);
+      batch.indexOffsets.push_back(mesh->indexOffset());
+      batch.baseVertices.push_back((GLint)mesh->baseVertex);
+    }
+  }
+
+  void processNode(aiNode* node, const aiScene* scene, std::vector<const aiMesh*>& assimpMeshes)
   {
     // process all the node's meshes (if any)
     for (uint32 i = 0; i < node->mNumMeshes; i++)
     {
-      aiMesh* assimpMesh = scene->mMeshes[node->mMeshes[i]];
-      Mesh* mesh;
-      processMesh(assimpMesh, scene, &mesh);
-      meshes.push_back(mesh);
+      assimpMeshes.push_back(scene->mMeshes[node->mMeshes[i]]);
     }
     // then do the same for each of its children
     for (uint32 i = 0; i < node->mNumChildren; i++)
     {
-      processNode(node->mChildren[i], scene);
+      processNode(node->mChildren[i], scene, assimpMeshes);
     }
   }
 
-  void processMesh(const aiMesh* assimpMesh, const aiScene* scene, Mesh** mesh)
+  // NOTE: Runs on worker threads, must not touch OpenGL or any Model state
+  static void processMesh(const aiMesh* assimpMesh, MeshCacheSourceMesh* cacheMesh)
   {
-    std::vector<Vertex> vertices;
+    std::vector<Vertex>& vertices = cacheMesh->vertices;
+    vertices.reserve(assimpMesh->mNumVertices);
     for (uint32 i = 0; i < assimpMesh->mNumVertices; i++)
     {
       Vertex vertex;
@@ -88,63 +308,95 @@ private:
     }
 
     // process indices
-    std::vector<uint32> indices;
+    std::vector<uint32>& indices = cacheMesh->indices;
+    indices.reserve(assimpMesh->mNumFaces * 3);
     for (uint32 i = 0; i < assimpMesh->mNumFaces; i++)
     {
       aiFace face = assimpMesh->mFaces[i];
       indices.insert(indices.end(), face.mIndices, face.mIndices + face.mNumIndices);
     }
+  }
 
-    // process material
-    std::vector<Texture> textures;
+  // Gathers texture types and paths, ids are filled in by loadTextures()
+  void processMaterial(const aiMesh* assimpMesh, const aiScene* scene, std::vector<Texture>& textures)
+  {
     if (assimpMesh->mMaterialIndex >= 0)
     {
       aiMaterial* material = scene->mMaterials[assimpMesh->mMaterialIndex];
-      std::vector<Texture> diffuseMaps = loadMaterialTextures(material, aiTextureType_DIFFUSE, "diffTexture");
+      std::vector<Texture> diffuseMaps = materialTextures(material, aiTextureType_DIFFUSE, "diffTexture");
       textures.insert(textures.end(), diffuseMaps.begin(), diffuseMaps.end());
-      std::vector<Texture> specularMaps = loadMaterialTextures(material, aiTextureType_SPECULAR, "specTexture");
+      std::vector<Texture> specularMaps = materialTextures(material, aiTextureType_SPECULAR, "specTexture");
       textures.insert(textures.end(), specularMaps.begin(), specularMaps.end());
     }
-
-    *mesh = new Mesh(vertices, indices, textures);
   }
 
-  std::vector<Texture> loadMaterialTextures(aiMaterial* mat, aiTextureType type, std::string typeName)
+  std::vector<Texture> materialTextures(aiMaterial* mat, aiTextureType type, std::string typeName)
   {
     std::vector<Texture> textures;
-
-    char filename[128]; // NOTE: Hard limit on file directory size
-    memcpy(filename, directory.c_str(), directory.length());
-    filename[directory.length()] = '/';
-
     for (uint32 i = 0; i < mat->GetTextureCount(type); i++)
     {
       aiString fileName;
       mat->GetTexture(type, i, &fileName);
-      bool skip = false;
-      for (uint32 j = 0; j < texturesLoaded.size(); j++)
+      textures.push_back({ 0, typeName, fileName.C_Str() });
+    }
+    return textures;
+  }
+
+  Texture* findLoadedTexture(const char* path)
+  {
+    for (uint32 i = 0; i < texturesLoaded.size(); i++)
+    {
+      if (std::strcmp(texturesLoaded[i].path.data(), path) == 0) { return &texturesLoaded[i]; }
+    }
+    return NULL;
+  }
+
+  // Decodes every texture that isn't already in the texture cache on the worker pool, then uploads them all on this thread
+  // NOTE: Also waits on any jobs already added to jobs, so that work overlaps with the image decoding
+  void loadTextures(std::vector<std::vector<Texture>*>& textureLists, JobCounter* jobs)
+  {
+    std::vector<PendingTexture> pendingTextures;
+    for (std::vector<Texture>* textures : textureLists)
+    {
+      for (Texture& texture : *textures)
       {
-        if (std::strcmp(texturesLoaded[j].path.data(), fileName.C_Str()) == 0)
+        if (findLoadedTexture(texture.path.c_str()) != NULL) { continue; }
+        bool alreadyPending = false;
+        for (PendingTexture& pendingTexture : pendingTextures) { alreadyPending |= pendingTexture.path == texture.path; }
+        if (alreadyPending) { continue; }
+
+        std::string fileLocation = directory + '/' + texture.path;
+        Texture cachedTexture = { 0, texture.type, texture.path };
+        if (acquireCached2DTexture(fileLocation.c_str(), cachedTexture.id))
         {
-          textures.push_back(texturesLoaded[j]);
-          skip = true;
-          break;
+          texturesLoaded.push_back(cachedTexture);
+          continue;
         }
-      }
-      if (!skip)
-      {   // if texture hasn't been loaded already, load it
-        uint32 fileNameSize = directory.length() + fileName.length + 2;
-        memcpy(filename + directory.length() + 1, fileName.C_Str(), fileName.length);
-        filename[fileNameSize-1] = '\0';
-
-        Texture texture;
-        load2DTexture(filename, texture.id, false, false);
-        texture.type = typeName;
-        texture.path = fileName.C_Str();
-        textures.push_back(texture);
-        texturesLoaded.push_back(texture); // add to loaded textures
+        pendingTextures.push_back({ texture.path, texture.type, fileLocation, {} });
       }
     }
-    return textures;
+
+    for (PendingTexture& pendingTexture : pendingTextures)
+    {
+      PendingTexture* pending = &pendingTexture;
+      addJob(jobs, [pending] { decode2DImage(pending->fileLocation.c_str(), false, &pending->image); });
+    }
+    waitForJobs(jobs);
+
+    for (PendingTexture& pendingTexture : pendingTextures)
+    {
+      Texture texture;
+      add2DTexture(pendingTexture.fileLocation.c_str(), pendingTexture.image, texture.id);
+      texture.type = pendingTexture.type;
+      texture.path = pendingTexture.path;
+      texturesLoaded.push_back(texture); // add to loaded textures
+      freeDecodedImage(&pendingTexture.image);
+    }
+
+    // NOTE: Duplicates share the first load's Texture, type included
+    for (std::vector<Texture>* textures : textureLists)
+    {
+      for (Texture& texture : *textures) { texture = *findLoadedTexture(texture.path.c_str()); }
+    }
   }
 };
\ No newline at end of file
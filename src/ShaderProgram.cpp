@@ -3,14 +3,32 @@
 #include "ShaderProgram.h"
 
 #include "common/WindowsFileHelper.h"
+#include "common/glExtensions.h"
 
 #include <fstream>
 #include <sstream>
 #include <iostream>
 #include <vector>
 #include <ctime>
+#include <cstring>
+#include <cstdio>
+#include <thread>
 
 #define NO_SHADER 0
+#define UNIFORM_NOT_FOUND UINT32_MAX
+#define UNIFORM_TABLE_INIT_SIZE 32
+#define SHADER_CACHE_RELATIVE_PATH "src/data/shaderCache/"
+#define SHADER_CACHE_FILE_IDENTIFIER 0x50485353 // "SSHP"
+#define SHADER_CACHE_FILE_VERSION 1
+
+struct ShaderCacheFileHeader
+{
+  uint32 identifier;
+  uint32 version;
+  uint64 sourceHash;
+  uint32 binaryFormat;
+  uint32 binaryLength;
+};
 
 bool ShaderProgram::updateShaderWhenOutdated(GLuint* shaderId, const char* shaderFileLocation, uint32* lastUpdated, GLenum shaderType) {
   uint32 lastWriteTime = getFileLastWriteTime(shaderFileLocation);
@@ -40,27 +58,22 @@ bool ShaderProgram::updateShadersWhenOutdated(ShaderTypeFlags shaderTypeFlag, Ti
 bool ShaderProgram::updateShadersWhenOutdated(ShaderTypeFlags shaderTypeFlag) {
   bool shaderFileWasOutdated =
           ((shaderTypeFlag & VertexShaderFlag) && updateShaderWhenOutdated(&vertexShader, vertexShaderPath, &vertexShaderFileTime, GL_VERTEX_SHADER)) ||
-          ((shaderTypeFlag & GeometryShaderFlag) && (geometryShader != NO_SHADER) && updateShaderWhenOutdated(&geometryShader, geometryShaderPath, &geometryShaderFileTime, GL_GEOMETRY_SHADER)) ||
+          ((shaderTypeFlag & GeometryShaderFlag) && (geometryShaderPath != NULL) && updateShaderWhenOutdated(&geometryShader, geometryShaderPath, &geometryShaderFileTime, GL_GEOMETRY_SHADER)) ||
           ((shaderTypeFlag & FragmentShaderFlag) && updateShaderWhenOutdated(&fragmentShader, fragmentShaderPath, &fragmentShaderFileTime, GL_FRAGMENT_SHADER));
 
   if(shaderFileWasOutdated) {
-    glAttachShader(this->ID, vertexShader);
-    glAttachShader(this->ID, fragmentShader);
-    if(geometryShader != NO_SHADER) glAttachShader(this->ID, geometryShader);
-    glLinkProgram(this->ID);
-
-    int32 linkSuccess;
-    glGetProgramiv(this->ID, GL_LINK_STATUS, &linkSuccess);
-    if (!linkSuccess)
-    {
-      char infoLog[512];
-      glGetProgramInfoLog(this->ID, 512, NULL, infoLog);
-      std::cout << "ERROR::PROGRAM::SHADER::LINK_FAILED\n" << infoLog << std::endl;
-    }
-
-    glDetachShader(this->ID, vertexShader);
-    glDetachShader(this->ID, fragmentShader);
-    if (geometryShader != NO_SHADER) glDetachShader(this->ID, geometryShader);
+    // NOTE: programs loaded from the binary cache never compiled their stages
+    if(vertexShader == NO_SHADER) { vertexShader = loadShader(vertexShaderPath, GL_VERTEX_SHADER); }
+    if(fragmentShader == NO_SHADER) { fragmentShader = loadShader(fragmentShaderPath, GL_FRAGMENT_SHADER); }
+    if(geometryShaderPath != NULL && geometryShader == NO_SHADER) { geometryShader = loadShader(geometryShaderPath, GL_GEOMETRY_SHADER); }
+    // NOTE: the relinked program is saved to the binary cache under the hash of the sources it was built from
+    std::string vertexShaderCode, fragmentShaderCode, geometryShaderCode;
+    readShaderCodeAsString(vertexShaderPath, &vertexShaderCode);
+    readShaderCodeAsString(fragmentShaderPath, &fragmentShaderCode);
+    if(geometryShaderPath != NULL) { readShaderCodeAsString(geometryShaderPath, &geometryShaderCode); }
+    sourceHash = hashShaderSources(vertexShaderCode, fragmentShaderCode, geometryShaderCode);
+    linkShaders();
+    finishLink();
   }
 
   return shaderFileWasOutdated;
@@ -70,28 +83,93 @@ bool ShaderProgram::updateShadersWhenOutdated(ShaderTypeFlags shaderTypeFlag) {
 ShaderProgram::ShaderProgram(const char* vertexPath, const char* fragmentPath, const char* geometryPath)
 {
   vertexShaderPath = vertexPath;
-  vertexShader = loadShader(vertexPath, GL_VERTEX_SHADER);
   vertexShaderFileTime = getFileLastWriteTime(vertexShaderPath);
-
   fragmentShaderPath = fragmentPath;
-  fragmentShader = loadShader(fragmentPath, GL_FRAGMENT_SHADER);
   fragmentShaderFileTime = getFileLastWriteTime(fragmentShaderPath);
-
   geometryShaderPath = geometryPath;
-  geometryShader = geometryPath != NULL ? loadShader(geometryPath, GL_GEOMETRY_SHADER) : NO_SHADER;
-  geometryShaderFileTime = geometryShader != NO_SHADER ? getFileLastWriteTime(geometryShaderPath) : 0;
+  geometryShaderFileTime = geometryPath != NULL ? getFileLastWriteTime(geometryShaderPath) : 0;
+
+  vertexShader = NO_SHADER;
+  fragmentShader = NO_SHADER;
+  geometryShader = NO_SHADER;
+
+  reserveMaterialSamplerHandles();
+
+  std::string vertexShaderCode, fragmentShaderCode, geometryShaderCode;
+  readShaderCodeAsString(vertexPath, &vertexShaderCode);
+  readShaderCodeAsString(fragmentPath, &fragmentShaderCode);
+  if(geometryPath != NULL) { readShaderCodeAsString(geometryPath, &geometryShaderCode); }
 
   // shader program
   this->ID = glCreateProgram(); // NOTE: returns 0 if error occurs when creating program
+
+  sourceHash = hashShaderSources(vertexShaderCode, fragmentShaderCode, geometryShaderCode);
+  linkPending = false;
+  if(loadProgramBinary()) {
+    cacheUniformLocations();
+    return;
+  }
+
+  // NOTE: Compile and link status are not queried until the program is first used, querying would force the driver
+  // NOTE: to finish compiling now instead of in the background while the scene continues loading other resources
+  vertexShader = compileShader(vertexShaderCode.c_str(), GL_VERTEX_SHADER);
+  fragmentShader = compileShader(fragmentShaderCode.c_str(), GL_FRAGMENT_SHADER);
+  if(geometryPath != NULL) { geometryShader = compileShader(geometryShaderCode.c_str(), GL_GEOMETRY_SHADER); }
+  linkShaders();
+}
+
+// Returns true if the program can be used without waiting on the driver
+bool ShaderProgram::isLinkComplete()
+{
+  if(!linkPending) { return true; }
+  if(!glExtensions.parallelShaderCompile) { return false; }
+
+  int32 completionStatus;
+  glGetProgramiv(this->ID, GL_COMPLETION_STATUS_KHR, &completionStatus);
+  return completionStatus == GL_TRUE;
+}
+
+void ShaderProgram::finishLinks(ShaderProgram* const* programs, uint32 count)
+{
+  uint32 pendingCount;
+  do
+  {
+    pendingCount = 0;
+    for(uint32 i = 0; i < count; ++i)
+    {
+      ShaderProgram* program = programs[i];
+      if(!program->linkPending) { continue; }
+      // NOTE: without KHR_parallel_shader_compile there's nothing to poll, finish them in order
+      if(!glExtensions.parallelShaderCompile || program->isLinkComplete()) { program->finishLink(); }
+      else { pendingCount++; }
+    }
+    if(pendingCount > 0) { std::this_thread::yield(); }
+  } while(pendingCount > 0);
+}
+
+void ShaderProgram::linkShaders()
+{
   glAttachShader(this->ID, vertexShader);
   glAttachShader(this->ID, fragmentShader);
-  if (geometryPath != NO_SHADER) glAttachShader(this->ID, geometryShader);
+  if (geometryShader != NO_SHADER) glAttachShader(this->ID, geometryShader);
+  if(glExtensions.programBinary) { glProgramParameteri(this->ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE); }
   glLinkProgram(this->ID);
+  linkPending = true;
+}
+
+// NOTE: Blocks until the driver has finished compiling and linking
+void ShaderProgram::finishLink()
+{
+  linkPending = false;
 
   int32 linkSuccess;
   glGetProgramiv(this->ID, GL_LINK_STATUS, &linkSuccess);
   if (!linkSuccess)
   {
+    checkCompileStatus(vertexShader, GL_VERTEX_SHADER);
+    checkCompileStatus(fragmentShader, GL_FRAGMENT_SHADER);
+    if (geometryShader != NO_SHADER) checkCompileStatus(geometryShader, GL_GEOMETRY_SHADER);
+
     char infoLog[512];
     glGetProgramInfoLog(this->ID, 512, NULL, infoLog);
     std::cout << "ERROR::PROGRAM::SHADER::LINK_FAILED\n" << infoLog << std::endl;
@@ -99,7 +177,238 @@ ShaderProgram::ShaderProgram(const char* vertexPath, const char* fragmentPath, c
 
   glDetachShader(this->ID, vertexShader);
   glDetachShader(this->ID, fragmentShader);
-  if (geometryPath != NO_SHADER) glDetachShader(this->ID, geometryShader);
+  if (geometryShader != NO_SHADER) glDetachShader(this->ID, geometryShader);
+
+  if(linkSuccess) { saveProgramBinary(); }
+  cacheUniformLocations();
+}
+
+// FNV-1a, 64 bit
+file_access uint64 hashBytes(uint64 hash, const char* bytes, size_t byteCount)
+{
+  for(size_t i = 0; i < byteCount; ++i)
+  {
+    hash ^= (uint8)bytes[i];
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+// NOTE: Binaries are only valid for the driver that produced them, so the driver strings are part of the hash
+uint64 ShaderProgram::hashShaderSources(const std::string& vertexShaderCode, const std::string& fragmentShaderCode, const std::string& geometryShaderCode)
+{
+  const char* driverStrings[] = {
+          (const char*)glGetString(GL_VENDOR),
+          (const char*)glGetString(GL_RENDERER),
+          (const char*)glGetString(GL_VERSION)
+  };
+
+  // NOTE: sizes are hashed along with the code so "ab" + "c" doesn't collide with "a" + "bc"
+  uint64 hash = 14695981039346656037ull;
+  const std::string* sources[] = { &vertexShaderCode, &fragmentShaderCode, &geometryShaderCode };
+  for(uint32 i = 0; i < ArrayCount(sources); ++i)
+  {
+    uint64 sourceSize = sources[i]->size();
+    hash = hashBytes(hash, (const char*)&sourceSize, sizeof(sourceSize));
+    hash = hashBytes(hash, sources[i]->c_str(), sources[i]->size());
+  }
+  for(uint32 i = 0; i < ArrayCount(driverStrings); ++i)
+  {
+    if(driverStrings[i] != NULL) { hash = hashBytes(hash, driverStrings[i], strlen(driverStrings[i]) + 1); }
+  }
+  return hash;
+}
+
+std::string ShaderProgram::programBinaryFileLocation() const
+{
+  char fileName[32];
+  snprintf(fileName, ArrayCount(fileName), "%016llx.bin", (unsigned long long)sourceHash);
+  return std::string(SHADER_CACHE_RELATIVE_PATH) + fileName;
+}
+
+bool ShaderProgram::loadProgramBinary()
+{
+  if(!glExtensions.programBinary) { return false; }
+
+  std::ifstream cacheFile(programBinaryFileLocation(), std::ios::binary);
+  if(!cacheFile) { return false; }
+
+  ShaderCacheFileHeader header;
+  cacheFile.read((char*)&header, sizeof(header));
+  if(!cacheFile ||
+     header.identifier != SHADER_CACHE_FILE_IDENTIFIER ||
+     header.version != SHADER_CACHE_FILE_VERSION ||
+     header.sourceHash != sourceHash) {
+    return false;
+  }
+
+  std::vector<char> binary(header.binaryLength);
+  cacheFile.read(binary.data(), header.binaryLength);
+  if(!cacheFile) { return false; }
+
+  // NOTE: Drivers may reject binaries even when the driver strings match (ex: driver updated in place)
+  glProgramBinary(this->ID, header.binaryFormat, binary.data(), header.binaryLength);
+  int32 linkSuccess;
+  glGetProgramiv(this->ID, GL_LINK_STATUS, &linkSuccess);
+  return linkSuccess == GL_TRUE;
+}
+
+void ShaderProgram::saveProgramBinary()
+{
+  if(!glExtensions.programBinary) { return; }
+
+  int32 binaryLength = 0;
+  glGetProgramiv(this->ID, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+  if(binaryLength <= 0) { return; }
+
+  std::vector<char> binary(binaryLength);
+  GLenum binaryFormat;
+  glGetProgramBinary(this->ID, binaryLength, &binaryLength, &binaryFormat, binary.data());
+  if(binaryLength <= 0) { return; }
+
+  ShaderCacheFileHeader header;
+  header.identifier = SHADER_CACHE_FILE_IDENTIFIER;
+  header.version = SHADER_CACHE_FILE_VERSION;
+  header.sourceHash = sourceHash;
+  header.binaryFormat = binaryFormat;
+  header.binaryLength = (uint32)binaryLength;
+
+  std::ofstream cacheFile(programBinaryFileLocation(), std::ios::binary | std::ios::trunc);
+  if(!cacheFile) {
+    std::cout << "ERROR::SHADER::CACHE::FILE_NOT_SUCCESFULLY_WRITTEN" << std::endl;
+    return;
+  }
+  cacheFile.write((const char*)&header, sizeof(header));
+  cacheFile.write(binary.data(), binaryLength);
+}
+
+// FNV-1a
+file_access uint32 hashUniformName(const char* name)
+{
+  uint32 hash = 2166136261u;
+  while(*name != '\0')
+  {
+    hash ^= (uint8)*name++;
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+uint32 ShaderProgram::findUniformHandleIndex(const char* name, uint32 nameHash) const
+{
+  if(uniformTable.empty()) { return UNIFORM_NOT_FOUND; }
+
+  uint32 tableMask = (uint32)uniformTable.size() - 1;
+  for(uint32 slot = nameHash & tableMask;; slot = (slot + 1) & tableMask)
+  {
+    const UniformTableEntry& entry = uniformTable[slot];
+    if(entry.handleIndex == UNIFORM_NOT_FOUND) { return UNIFORM_NOT_FOUND; }
+    if(entry.nameHash == nameHash && strcmp(uniformNames[entry.handleIndex].c_str(), name) == 0) { return entry.handleIndex; }
+  }
+}
+
+uint32 ShaderProgram::insertUniformName(const char* name, uint32 nameHash)
+{
+  uint32 handleIndex = (uint32)uniformNames.size();
+  uniformNames.push_back(name);
+  uniformLocations.push_back(-1);
+
+  // keep the table at most half full, handles index into uniformNames so they survive the rehash
+  if(uniformNames.size() * 2 > uniformTable.size())
+  {
+    uint32 newTableSize = uniformTable.empty() ? UNIFORM_TABLE_INIT_SIZE : (uint32)uniformTable.size() * 2;
+    uniformTable.assign(newTableSize, { 0, UNIFORM_NOT_FOUND });
+    for(uint32 i = 0; i < handleIndex; ++i)
+    {
+      uint32 hash = hashUniformName(uniformNames[i].c_str());
+      uint32 slot = hash & (newTableSize - 1);
+      while(uniformTable[slot].handleIndex != UNIFORM_NOT_FOUND) { slot = (slot + 1) & (newTableSize - 1); }
+      uniformTable[slot] = { hash, i };
+    }
+  }
+
+  uint32 tableMask = (uint32)uniformTable.size() - 1;
+  uint32 slot = nameHash & tableMask;
+  while(uniformTable[slot].handleIndex != UNIFORM_NOT_FOUND) { slot = (slot + 1) & tableMask; }
+  uniformTable[slot] = { nameHash, handleIndex };
+
+  return handleIndex;
+}
+
+// NOTE: Introspects all active uniforms so setters never need to ask the driver for a location
+void ShaderProgram::cacheUniformLocations()
+{
+  for(uint32 i = 0; i < uniformLocations.size(); ++i) { uniformLocations[i] = -1; }
+
+  int32 activeUniformCount;
+  glGetProgramiv(this->ID, GL_ACTIVE_UNIFORMS, &activeUniformCount);
+  char uniformName[256];
+  char elementName[256];
+  for(int32 uniformIndex = 0; uniformIndex < activeUniformCount; ++uniformIndex)
+  {
+    int32 arraySize;
+    GLenum uniformType;
+    GLsizei nameLength;
+    glGetActiveUniform(this->ID, uniformIndex, ArrayCount(uniformName), &nameLength, &arraySize, &uniformType, uniformName);
+
+    // arrays are reported as "name[0]", both "name" and every "name[i]" may be used to set them
+    bool isArray = nameLength > 3 && strcmp(uniformName + nameLength - 3, "[0]") == 0;
+    if(isArray) { uniformName[nameLength - 3] = '\0'; }
+
+    for(int32 element = -1; element < arraySize; ++element)
+    {
+      const char* name = uniformName;
+      if(element >= 0)
+      {
+        if(!isArray) { break; }
+        snprintf(elementName, ArrayCount(elementName), "%s[%d]", uniformName, element);
+        name = elementName;
+      }
+
+      uint32 nameHash = hashUniformName(name);
+      uint32 handleIndex = findUniformHandleIndex(name, nameHash);
+      if(handleIndex == UNIFORM_NOT_FOUND) { handleIndex = insertUniformName(name, nameHash); }
+      uniformLocations[handleIndex] = glGetUniformLocation(this->ID, name);
+    }
+  }
+}
+
+// NOTE: Must run before any other handle is handed out, see materialSamplerHandle()
+void ShaderProgram::reserveMaterialSamplerHandles()
+{
+  char samplerName[64];
+  for(uint32 type = 0; type < MaterialSamplerType_Count; ++type)
+  {
+    for(uint32 number = 1; number <= MATERIAL_SAMPLERS_PER_TYPE; ++number)
+    {
+      snprintf(samplerName, ArrayCount(samplerName), "material.%s%u", materialSamplerTypeNames[type], number);
+      getUniformHandle(samplerName);
+    }
+  }
+}
+
+int32 ShaderProgram::uniformLocation(const char* name) const
+{
+  if(linkPending)
+  {
+    // NOTE: locations are only cached once the link is finished, the value would be silently dropped
+    std::cout << "ERROR::SHADER::UNIFORM_SET_BEFORE_LINK_FINISHED " << name << std::endl;
+    Assert(!"uniform set before use() or finishLinks()");
+    return -1;
+  }
+  uint32 handleIndex = findUniformHandleIndex(name, hashUniformName(name));
+  return handleIndex != UNIFORM_NOT_FOUND ? uniformLocations[handleIndex] : -1;
+}
+
+UniformHandle ShaderProgram::getUniformHandle(const char* name)
+{
+  uint32 nameHash = hashUniformName(name);
+  uint32 handleIndex = findUniformHandleIndex(name, nameHash);
+  if(handleIndex == UNIFORM_NOT_FOUND) {
+    // NOTE: uniforms that are not active still receive a handle, they may become active when shaders are updated
+    handleIndex = insertUniformName(name, nameHash);
+  }
+  return { handleIndex };
 }
 
 void ShaderProgram::deleteShaderResources()
@@ -114,92 +423,174 @@ void ShaderProgram::deleteShaderResources()
 // use/activate the shader
 void ShaderProgram::use()
 {
+  if(linkPending) { finishLink(); }
   glUseProgram(this->ID);
 }
 
 // utility uniform functions
-void ShaderProgram::setUniform(const std::string& name, bool value) const
+void ShaderProgram::setUniform(const char* name, bool value) const
 {
-  glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+  glUniform1i(uniformLocation(name), (int)value);
 }
 
-void ShaderProgram::setUniform(const std::string& name, int32 value) const
+void ShaderProgram::setUniform(const char* name, int32 value) const
 {
-  glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+  glUniform1i(uniformLocation(name), value);
 }
 
-void ShaderProgram::setUniform(const std::string& name, uint32 value) const
+void ShaderProgram::setUniform(const char* name, uint32 value) const
 {
-  glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+  glUniform1i(uniformLocation(name), value);
 }
 
-void ShaderProgram::setUniform(const std::string& name, float32 value) const
+void ShaderProgram::setUniform(const char* name, float32 value) const
 {
-  glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+  glUniform1f(uniformLocation(name), value);
 }
 
-void ShaderProgram::setUniform(const std::string& name, float32 value1, float32 value2) const
+void ShaderProgram::setUniform(const char* name, float32 value1, float32 value2) const
 {
-  glUniform2f(glGetUniformLocation(ID, name.c_str()), value1, value2);
+  glUniform2f(uniformLocation(name), value1, value2);
 }
 
-void ShaderProgram::setUniform(const std::string& name, float32 value1, float32 value2, float32 value3) const
+void ShaderProgram::setUniform(const char* name, float32 value1, float32 value2, float32 value3) const
 {
-  glUniform3f(glGetUniformLocation(ID, name.c_str()), value1, value2, value3);
+  glUniform3f(uniformLocation(name), value1, value2, value3);
 }
 
-void ShaderProgram::setUniform(const std::string& name, float32 value1, float32 value2, float32 value3, float32 value4) const
+void ShaderProgram::setUniform(const char* name, float32 value1, float32 value2, float32 value3, float32 value4) const
 {
-  glUniform4f(glGetUniformLocation(ID, name.c_str()), value1, value2, value3, value4);
+  glUniform4f(uniformLocation(name), value1, value2, value3, value4);
 }
 
-void ShaderProgram::setUniform(const std::string& name, const glm::mat4& mat) const
+void ShaderProgram::setUniform(const char* name, const glm::mat4& mat) const
 {
-  glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()),
+  glUniformMatrix4fv(uniformLocation(name),
                      1, // count
                      GL_FALSE, // transpose: swap columns and rows (true or false)
                      glm::value_ptr(mat)); // pointer to float values
 }
 
-void ShaderProgram::setUniform(const std::string& name, const glm::mat4* matArray, const uint32 arraySize)
+void ShaderProgram::setUniform(const char* name, const glm::mat4* matArray, const uint32 arraySize)
 {
-  glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()),
+  glUniformMatrix4fv(uniformLocation(name),
                      arraySize, // count
                      GL_FALSE, // transpose: swap columns and rows (true or false)
                      glm::value_ptr(*matArray)); // pointer to float values
 }
 
-void ShaderProgram::setUniform(const std::string& name, const float* floatArray, const uint32 arraySize)
+void ShaderProgram::setUniform(const char* name, const float* floatArray, const uint32 arraySize)
 {
-  glUniform1fv(glGetUniformLocation(ID, name.c_str()), arraySize, floatArray);
+  glUniform1fv(uniformLocation(name), arraySize, floatArray);
 }
 
-void ShaderProgram::setUniform(const std::string& name, const glm::vec2& vector2)
+void ShaderProgram::setUniform(const char* name, const glm::vec2& vector2)
 {
   setUniform(name, vector2.x, vector2.y);
 }
 
-void ShaderProgram::setUniform(const std::string& name, const glm::vec3& vector3)
+void ShaderProgram::setUniform(const char* name, const glm::vec3& vector3)
 {
   setUniform(name, vector3.x, vector3.y, vector3.z);
 }
 
-void ShaderProgram::setUniform(const std::string& name, const glm::vec4& vector4)
+void ShaderProgram::setUniform(const char* name, const glm::vec4& vector4)
 {
   setUniform(name, vector4.x, vector4.y, vector4.z, vector4.w);
 }
 
-void ShaderProgram::bindBlockIndex(const std::string& name, uint32 index)
+void ShaderProgram::bindBlockIndex(const char* name, uint32 index)
 {
-  uint32 blockIndex = glGetUniformBlockIndex(ID, name.c_str());
+  if(linkPending) { finishLink(); }
+  uint32 blockIndex = glGetUniformBlockIndex(ID, name);
   glUniformBlockBinding(ID, blockIndex, index);
 }
 
+void ShaderProgram::setUniform(UniformHandle handle, bool value) const
+{
+  glUniform1i(uniformLocations[handle.index], (int)value);
+}
+
+void ShaderProgram::setUniform(UniformHandle handle, int32 value) const
+{
+  glUniform1i(uniformLocations[handle.index], value);
+}
+
+void ShaderProgram::setUniform(UniformHandle handle, uint32 value) const
+{
+  glUniform1i(uniformLocations[handle.index], value);
+}
+
+void ShaderProgram::setUniform(UniformHandle handle, float32 value) const
+{
+  glUniform1f(uniformLocations[handle.index], value);
+}
+
+void ShaderProgram::setUniform(UniformHandle handle, float32 value1, float32 value2) const
+{
+  glUniform2f(uniformLocations[handle.index], value1, value2);
+}
+
+void ShaderProgram::setUniform(UniformHandle handle, float32 value1, float32 value2, float32 value3) const
+{
+  glUniform3f(uniformLocations[handle.index], value1, value2, value3);
+}
+
+void ShaderProgram::setUniform(UniformHandle handle, float32 value1, float32 value2, float32 value3, float32 value4) const
+{
+  glUniform4f(uniformLocations[handle.index], value1, value2, value3, value4);
+}
+
+void ShaderProgram::setUniform(UniformHandle handle, const glm::mat4& mat) const
+{
+  glUniformMatrix4fv(uniformLocations[handle.index], 1, GL_FALSE, glm::value_ptr(mat));
+}
+
+void ShaderProgram::setUniform(UniformHandle handle, const glm::mat4* matArray, const uint32 arraySize) const
+{
+  glUniformMatrix4fv(uniformLocations[handle.index], arraySize, GL_FALSE, glm::value_ptr(*matArray));
+}
+
+void ShaderProgram::setUniform(UniformHandle handle, const float* floatArray, const uint32 arraySize) const
+{
+  glUniform1fv(uniformLocations[handle.index], arraySize, floatArray);
+}
+
+void ShaderProgram::setUniform(UniformHandle handle, const glm::vec2& vector2) const
+{
+  setUniform(handle, vector2.x, vector2.y);
+}
+
+void ShaderProgram::setUniform(UniformHandle handle, const glm::vec3& vector3) const
+{
+  setUniform(handle, vector3.x, vector3.y, vector3.z);
+}
+
+void ShaderProgram::setUniform(UniformHandle handle, const glm::vec4& vector4) const
+{
+  setUniform(handle, vector4.x, vector4.y, vector4.z, vector4.w);
+}
+
 /*
  * parameters:
  * shaderType can be GL_VERTEX_SHADER, GL_FRAGMENT_SHADER, or GL_GEOMETRY_SHADER
  */
 uint32 ShaderProgram::loadShader(const char* shaderPath, GLenum shaderType) {
+  std::string shaderCode;
+  readShaderCodeAsString(shaderPath, &shaderCode);
+  uint32 shader = compileShader(shaderCode.c_str(), shaderType);
+  checkCompileStatus(shader, shaderType);
+  return shader;
+}
+
+uint32 ShaderProgram::compileShader(const char* shaderCode, GLenum shaderType) {
+  uint32 shader = glCreateShader(shaderType);
+  glShaderSource(shader, 1, &shaderCode, NULL);
+  glCompileShader(shader);
+  return shader;
+}
+
+void ShaderProgram::checkCompileStatus(uint32 shader, GLenum shaderType) {
   std::string shaderTypeStr;
   if(shaderType == GL_VERTEX_SHADER) {
     shaderTypeStr = "VERTEX";
@@ -209,14 +600,6 @@ uint32 ShaderProgram::loadShader(const char* shaderPath, GLenum shaderType) {
     shaderTypeStr = "GEOMETRY";
   }
 
-  std::string shaderCode;
-  readShaderCodeAsString(shaderPath, &shaderCode);
-  const char* shaderCodeCStr = shaderCode.c_str();
-
-  uint32 shader = glCreateShader(shaderType);
-  glShaderSource(shader, 1, &shaderCodeCStr, NULL);
-  glCompileShader(shader);
-
   int32 shaderSuccess;
   glGetShaderiv(shader, GL_COMPILE_STATUS, &shaderSuccess);
   if (shaderSuccess != GL_TRUE)
@@ -225,8 +608,6 @@ uint32 ShaderProgram::loadShader(const char* shaderPath, GLenum shaderType) {
     glGetShaderInfoLog(shader, 512, NULL, infoLog);
     std::cout << "ERROR::SHADER::" << shaderTypeStr << "::COMPILATION_FAILED\n" << infoLog << std::endl;
   }
-
-  return shader;
 }
 
 void ShaderProgram::readShaderCodeAsString(const char* shaderPath, std::string* shaderCode)
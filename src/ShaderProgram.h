@@ -5,6 +5,7 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include <string>
+#include <vector>
 
 #include "LearnOpenGLPlatform.h"
 
@@ -22,6 +23,27 @@ struct Timer {
   uint32 lengthInSeconds = TIMER_LENGTH_IN_SECONDS_INIT_VALUE;
 };
 
+// NOTE: Index into the program's uniform table, remains valid when the program is relinked
+struct UniformHandle {
+  uint32 index;
+};
+
+// NOTE: Every program reserves its first uniform handles for the model material samplers ("material.diffTexture1"
+// NOTE: through "material.specTexture4"), so a material's sampler handles can be resolved once and used with any program
+#define MATERIAL_SAMPLERS_PER_TYPE 4
+enum MaterialSamplerType {
+  MaterialSamplerType_Diffuse = 0,
+  MaterialSamplerType_Specular,
+  MaterialSamplerType_Count
+};
+const char* const materialSamplerTypeNames[MaterialSamplerType_Count] = { "diffTexture", "specTexture" }; // matches Texture::type
+
+// number starts at 1, ex: MaterialSamplerType_Specular & 2 is "material.specTexture2"
+inline UniformHandle materialSamplerHandle(MaterialSamplerType type, uint32 number)
+{
+  return { ((uint32)type * MATERIAL_SAMPLERS_PER_TYPE) + (number - 1) };
+}
+
 // TODO: Convert to a simple structure?
 class ShaderProgram
 {
@@ -30,8 +52,16 @@ public:
   uint32 ID;
 
   // constructor reads and builds the shader
+  // NOTE: Building is not waited on, create all of a scene's programs first, load the scene's other resources while
+  // NOTE: the driver compiles them in the background, then resolve them together with finishLinks() before first use
   ShaderProgram(const char* vertexPath, const char* fragmentPath, const char* geometryPath = NULL);
 
+  // Returns true if the program is ready to be used without stalling
+  bool isLinkComplete();
+  // Waits for every program to link, finishing each (binary cache save, uniform locations) as the driver completes it.
+  // NOTE: use() finishes a program that was never resolved, but then the wait lands on that first use
+  static void finishLinks(ShaderProgram* const* programs, uint32 count);
+
   // This function takes in a bit flag of ShaderType enums
   // Returns true if shader was outdated
   // NOTE: This will require you to resupply any uniforms that aren't supplied in render loop
@@ -45,23 +75,52 @@ public:
   void deleteShaderResources();
 
   // utility uniform functions
-  void setUniform(const std::string& name, bool value) const;
-  void setUniform(const std::string& name, int32 value) const;
-  void setUniform(const std::string& name, uint32 value) const;
-  void setUniform(const std::string& name, float32 value) const;
-  void setUniform(const std::string& name, float32 value1, float32 value2) const;
-  void setUniform(const std::string& name, float32 value1, float32 value2, float32 value3) const;
-  void setUniform(const std::string& name, float32 value1, float32 value2, float32 value3, float32 value4) const;
-  void setUniform(const std::string& name, const glm::mat4& mat) const;
-  void setUniform(const std::string& name, const glm::mat4* matArray, uint32 arraySize);
-  void setUniform(const std::string& name, const float* floatArray, uint32 arraySize);
-  void setUniform(const std::string& name, const glm::vec2& vector2);
-  void setUniform(const std::string& name, const glm::vec3& vector3);
-  void setUniform(const std::string& name, const glm::vec4& vector4);
-  void bindBlockIndex(const std::string& name, uint32 index);
+  // NOTE: like glUniform*(), these apply to the program in use, so they may only be called after use() (which also
+  // NOTE: finishes a pending link)
+  void setUniform(const char* name, bool value) const;
+  void setUniform(const char* name, int32 value) const;
+  void setUniform(const char* name, uint32 value) const;
+  void setUniform(const char* name, float32 value) const;
+  void setUniform(const char* name, float32 value1, float32 value2) const;
+  void setUniform(const char* name, float32 value1, float32 value2, float32 value3) const;
+  void setUniform(const char* name, float32 value1, float32 value2, float32 value3, float32 value4) const;
+  void setUniform(const char* name, const glm::mat4& mat) const;
+  void setUniform(const char* name, const glm::mat4* matArray, uint32 arraySize);
+  void setUniform(const char* name, const float* floatArray, uint32 arraySize);
+  void setUniform(const char* name, const glm::vec2& vector2);
+  void setUniform(const char* name, const glm::vec3& vector3);
+  void setUniform(const char* name, const glm::vec4& vector4);
+  void bindBlockIndex(const char* name, uint32 index);
+
+  // handle based uniform functions, no name lookups so they are preferred in render loops
+  UniformHandle getUniformHandle(const char* name);
+  void setUniform(UniformHandle handle, bool value) const;
+  void setUniform(UniformHandle handle, int32 value) const;
+  void setUniform(UniformHandle handle, uint32 value) const;
+  void setUniform(UniformHandle handle, float32 value) const;
+  void setUniform(UniformHandle handle, float32 value1, float32 value2) const;
+  void setUniform(UniformHandle handle, float32 value1, float32 value2, float32 value3) const;
+  void setUniform(UniformHandle handle, float32 value1, float32 value2, float32 value3, float32 value4) const;
+  void setUniform(UniformHandle handle, const glm::mat4& mat) const;
+  void setUniform(UniformHandle handle, const glm::mat4* matArray, uint32 arraySize) const;
+  void setUniform(UniformHandle handle, const float* floatArray, uint32 arraySize) const;
+  void setUniform(UniformHandle handle, const glm::vec2& vector2) const;
+  void setUniform(UniformHandle handle, const glm::vec3& vector3) const;
+  void setUniform(UniformHandle handle, const glm::vec4& vector4) const;
 
 private:
 
+  struct UniformTableEntry {
+    uint32 nameHash;
+    uint32 handleIndex;
+  };
+
+  // open addressed hash table of uniform names, capacity is always a power of two
+  std::vector<UniformTableEntry> uniformTable;
+  // indexed by UniformHandle::index
+  std::vector<std::string> uniformNames;
+  std::vector<int32> uniformLocations; // -1 when the uniform is not active in the current link
+
   uint32 vertexShaderFileTime;
   GLuint vertexShader;
   const char* vertexShaderPath;
@@ -74,7 +133,23 @@ private:
   GLuint geometryShader;
   const char* geometryShaderPath;
 
+  uint64 sourceHash; // identifies the program in the binary cache
+  bool linkPending; // link status has not yet been checked
+
+  void linkShaders();
+  void finishLink();
+  bool loadProgramBinary();
+  void saveProgramBinary();
+  std::string programBinaryFileLocation() const;
+  uint64 hashShaderSources(const std::string& vertexShaderCode, const std::string& fragmentShaderCode, const std::string& geometryShaderCode);
+  void cacheUniformLocations();
+  void reserveMaterialSamplerHandles();
+  uint32 findUniformHandleIndex(const char* name, uint32 nameHash) const;
+  uint32 insertUniformName(const char* name, uint32 nameHash);
+  int32 uniformLocation(const char* name) const;
   uint32 loadShader(const char* shaderPath, GLenum shaderType);
+  uint32 compileShader(const char* shaderCode, GLenum shaderType);
+  void checkCompileStatus(uint32 shader, GLenum shaderType);
   bool updateShaderWhenOutdated(GLuint* shaderId, const char* shaderFileLocation, uint32* lastUpdated, GLenum shaderType);
   void readShaderCodeAsString(const char* shaderPath, std::string* shaderCode);
 };
\ No newline at end of file
@@ -7,6 +7,7 @@
 #include "LearnOpenGLPlatform.h"
 #include "ShaderProgram.h"
 #include "common/FileLocations.h"
+#include "common/GLState.h"
 
 #define STB_TRUETYPE_IMPLEMENTATION  // force following include to generate implementation
 #include "stb/stb_truetype.h"
@@ -109,23 +110,8 @@ void TextDebugShader::updateWindowDimens(Extent2D windowExtent)
 void TextDebugShader::renderText(std::string text, GLfloat x, GLfloat y, GLfloat scale, glm::vec3 color)
 {
   // store original values before rendering text
-  GLint originalSrcRGB, originalSrcAlpha, originalDstRGB, originalDstAlpha;
-  GLint originalProgramID, originalBoundVertexArray, originalActiveTexture, originalTexture0;
-  GLint originalArrayBuffer;
-  GLint originalViewport[4];
-  bool blendWasEnabled = glIsEnabled(GL_BLEND) == GL_TRUE;
-  bool depthTestWasEnabled = glIsEnabled(GL_DEPTH_TEST) == GL_TRUE;
-  glGetIntegerv(GL_VIEWPORT, originalViewport);
-  glGetIntegerv(GL_BLEND_SRC_RGB, &originalSrcRGB);
-  glGetIntegerv(GL_BLEND_SRC_ALPHA, &originalSrcAlpha);
-  glGetIntegerv(GL_BLEND_DST_RGB, &originalDstRGB);
-  glGetIntegerv(GL_BLEND_DST_ALPHA, &originalDstAlpha);
-  glGetIntegerv(GL_CURRENT_PROGRAM, &originalProgramID);
-  glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &originalBoundVertexArray);
-  glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &originalArrayBuffer);
-  glGetIntegerv(GL_ACTIVE_TEXTURE, &originalActiveTexture);
+  GLStateSnapshot original = glStateSnapshot();
   glActiveTexture(GL_TEXTURE0); // We will only be using GL_TEXTURE0 to render text
-  glGetIntegerv(GL_TEXTURE_BINDING_2D, &originalTexture0);
 
   // start rendering text
   glViewport(0, 0, windowExtent.width, windowExtent.height);
@@ -173,14 +159,5 @@ void TextDebugShader::renderText(std::string text, GLfloat x, GLfloat y, GLfloat
   }
 
   // return to values to state before rendering text
-  glBindBuffer(GL_ARRAY_BUFFER, originalArrayBuffer);
-  glBindTexture(GL_TEXTURE_2D, originalTexture0);
-  glBindVertexArray(originalBoundVertexArray);
-  glActiveTexture(originalActiveTexture);
-  glUseProgram(originalProgramID);
-  // return blend values to original state
-  if(!blendWasEnabled) { glDisable(GL_BLEND); }
-  if(depthTestWasEnabled) { glEnable(GL_DEPTH_TEST); }
-  glBlendFuncSeparate(originalSrcRGB, originalDstRGB, originalSrcAlpha, originalDstAlpha);
-  glViewport(originalViewport[0], originalViewport[1], originalViewport[2], originalViewport[3]);
+  glStateRestore(original);
 }
\ No newline at end of file
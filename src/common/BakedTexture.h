@@ -0,0 +1,67 @@
+#pragma once
+
+#include <string>
+
+#include "../LearnOpenGLPlatform.h"
+
+// NOTE: .btex files are written offline by tools/TextureBaker and live next to the image they were baked from.
+// NOTE: They hold every mip level, already block compressed, so loading is a read + glCompressedTexImage2D per level.
+// NOTE: layout: BakedTextureHeader | mip 0 | mip 1 | ... | mip n
+#define BAKED_TEXTURE_IDENTIFIER 0x58455442 // "BTEX"
+#define BAKED_TEXTURE_VERSION 1
+#define BAKED_TEXTURE_MAX_MIP_COUNT 16
+
+enum BakedTextureFormat {
+  BakedTextureFormat_R8 = 0,
+  BakedTextureFormat_RGB8,
+  BakedTextureFormat_RGBA8,
+  BakedTextureFormat_BC1, // RGB, 4 bits per pixel
+  BakedTextureFormat_BC3, // RGBA, 8 bits per pixel
+  BakedTextureFormat_BC5, // RG, 8 bits per pixel, used for tangent space normals
+  BakedTextureFormat_BC7, // RGBA, 8 bits per pixel
+};
+
+enum BakedTextureFlags {
+  BakedTexture_NoValue = 0,
+  BakedTexture_FlippedVertically = 1 << 0,
+  BakedTexture_NormalMap = 1 << 1, // z must be reconstructed in the shader when stored as BC5
+};
+
+struct BakedTextureMip
+{
+  uint32 width;
+  uint32 height;
+  uint32 offset; // from the end of the header
+  uint32 size;
+};
+
+struct BakedTextureHeader
+{
+  uint32 identifier;
+  uint32 version;
+  uint32 format;
+  uint32 flags;
+  uint32 mipCount;
+  uint32 dataSize;
+  BakedTextureMip mips[BAKED_TEXTURE_MAX_MIP_COUNT];
+};
+
+inline bool bakedTextureFormatCompressed(uint32 format)
+{
+  return format >= BakedTextureFormat_BC1;
+}
+
+// ex: "src/data/PBR/brick_normal.jpg" -> "src/data/PBR/brick_normal.btex"
+// ex: "src/data/flower.png" flipped -> "src/data/flower_flipped.btex"
+inline std::string bakedTextureLocation(const char* imgLocation, bool flipImageVert)
+{
+  std::string location = imgLocation;
+  size_t extensionStart = location.find_last_of('.');
+  size_t directoryEnd = location.find_last_of("/\\");
+  if(extensionStart != std::string::npos && (directoryEnd == std::string::npos || extensionStart > directoryEnd))
+  {
+    location.erase(extensionStart);
+  }
+  if(flipImageVert) { location += "_flipped"; }
+  return location + ".btex";
+}
@@ -73,12 +73,14 @@ const char* const InfiniteCapsulesFragmentShaderFileLoc = RAY_MARCHING_BASE"Infi
 #define MANDELBROT_BASE "src/scenes/Mandelbrot/"
 const char* const HexagonPlaygroundShaderFileLoc = MANDELBROT_BASE"HexagonPlaygroundFragmentShader.glsl";
 const char* const MandelbrotFragmentShaderFileLoc = MANDELBROT_BASE"MandelbrotFragmentShader.glsl";
+const char* const MandelbrotIterationsFragmentShaderFileLoc = MANDELBROT_BASE"MandelbrotIterationsFragmentShader.glsl";
 
 // Menger Sponge Shaders
 #define MENGER_SPONGE_BASE "src/scenes/MengerSponge/"
 const char* const MengerSpongeFragmentShaderFileLoc = MENGER_SPONGE_BASE"MengerSpongeFragmentShader.glsl";
 const char* const CubePosNormTexVertexShaderFileLoc = MENGER_SPONGE_BASE"CubePosNormTexVertexShader.glsl";
 const char* const CubeTextureFragmentShaderFileLoc = MENGER_SPONGE_BASE"CubeTextureFragmentShader.glsl";
+const char* const MengerSpongeTemporalFragmentShaderFileLoc = MENGER_SPONGE_BASE"MengerSpongeTemporalFragmentShader.glsl";
 
 // Ray Tracing Shaders
 #define RAY_TRACING_SPHERE_BASE "src/scenes/RayTracingSphere/"
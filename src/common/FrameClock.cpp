@@ -0,0 +1,168 @@
+#include "FrameClock.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <fstream>
+#include <iostream>
+
+#define FRAME_PACING_SPIN_NANOSECONDS 2000000 // sleep until this close to the target, then spin (sleep is coarse)
+
+enum FrameClockMode {
+  FrameClock_Variable,
+  FrameClock_Fixed,
+  FrameClock_Injected,
+};
+
+file_access FrameClockMode frameClockMode = FrameClock_Variable;
+file_access uint64 lastFrameStartNanoseconds = 0;
+file_access float64 frameTime = 0.0;
+file_access float32 frameDeltaTime = 0.0f;
+file_access float32 frameWallDeltaTime = 0.0f;
+file_access uint64 frameCount = 0;
+file_access float32 fixedTimestep = 0.0f;
+file_access float32 targetFrameRate = 0.0f;
+file_access bool recordingFrameTimes = false;
+file_access std::vector<float32> recordedFrameTimes;
+file_access std::vector<float32> injectedFrameTimes;
+file_access uint64 injectedFrameIndex = 0;
+
+uint64 monotonicNanoseconds()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void startFrameClock()
+{
+  lastFrameStartNanoseconds = monotonicNanoseconds();
+  frameTime = 0.0;
+  frameDeltaTime = 0.0f;
+  frameWallDeltaTime = 0.0f;
+  frameCount = 0;
+  injectedFrameIndex = 0;
+}
+
+file_access void paceFrame()
+{
+  if(targetFrameRate <= 0.0f) { return; }
+
+  uint64 frameDeadline = lastFrameStartNanoseconds + (uint64)(1000000000.0 / targetFrameRate);
+  uint64 now = monotonicNanoseconds();
+  if(now + FRAME_PACING_SPIN_NANOSECONDS < frameDeadline)
+  {
+    std::this_thread::sleep_for(std::chrono::nanoseconds(frameDeadline - now - FRAME_PACING_SPIN_NANOSECONDS));
+  }
+  while(monotonicNanoseconds() < frameDeadline) { std::this_thread::yield(); }
+}
+
+void advanceFrameClock()
+{
+  paceFrame();
+
+  uint64 frameStart = monotonicNanoseconds();
+  float32 measuredDelta = (float32)((frameStart - lastFrameStartNanoseconds) / 1000000000.0);
+  lastFrameStartNanoseconds = frameStart;
+  frameWallDeltaTime = measuredDelta;
+
+  switch(frameClockMode)
+  {
+    case FrameClock_Variable:
+      frameDeltaTime = measuredDelta < FRAME_CLOCK_MAX_DELTA_SECONDS ? measuredDelta : FRAME_CLOCK_MAX_DELTA_SECONDS;
+      break;
+    case FrameClock_Fixed:
+      frameDeltaTime = fixedTimestep;
+      break;
+    case FrameClock_Injected:
+      if(injectedFrameIndex < injectedFrameTimes.size()) { frameDeltaTime = injectedFrameTimes[injectedFrameIndex++]; }
+      break;
+  }
+
+  frameTime += frameDeltaTime;
+  frameCount++;
+  if(recordingFrameTimes) { recordedFrameTimes.push_back(frameDeltaTime); }
+}
+
+float32 getTime()
+{
+  return (float32)frameTime;
+}
+
+float32 getDeltaTime()
+{
+  return frameDeltaTime;
+}
+
+float32 getWallDeltaTime()
+{
+  return frameWallDeltaTime;
+}
+
+uint64 getFrameCount()
+{
+  return frameCount;
+}
+
+void setFixedTimestep(float32 timestepInSeconds)
+{
+  fixedTimestep = timestepInSeconds;
+  frameClockMode = timestepInSeconds > 0.0f ? FrameClock_Fixed : FrameClock_Variable;
+}
+
+float32 getFixedTimestep()
+{
+  return frameClockMode == FrameClock_Fixed ? fixedTimestep : 0.0f;
+}
+
+void setTargetFrameRate(float32 framesPerSecond)
+{
+  targetFrameRate = framesPerSecond;
+}
+
+float32 getTargetFrameRate()
+{
+  return targetFrameRate;
+}
+
+void startRecordingFrameTimes()
+{
+  recordedFrameTimes.clear();
+  recordingFrameTimes = true;
+}
+
+// NOTE: plain text, one delta in seconds per line
+bool saveRecordedFrameTimes(const char* fileLoc)
+{
+  recordingFrameTimes = false;
+  std::ofstream file(fileLoc);
+  if(!file.is_open())
+  {
+    std::cout << "ERROR::FRAME_CLOCK::FAILED_TO_SAVE_FRAME_TIMES " << fileLoc << std::endl;
+    return false;
+  }
+  file.precision(9);
+  for(float32 frameTimeDelta : recordedFrameTimes) { file << frameTimeDelta << '\n'; }
+  return true;
+}
+
+bool injectFrameTimes(const char* fileLoc)
+{
+  std::ifstream file(fileLoc);
+  if(!file.is_open())
+  {
+    std::cout << "ERROR::FRAME_CLOCK::FAILED_TO_LOAD_FRAME_TIMES " << fileLoc << std::endl;
+    return false;
+  }
+
+  injectedFrameTimes.clear();
+  float32 frameTimeDelta;
+  while(file >> frameTimeDelta) { injectedFrameTimes.push_back(frameTimeDelta); }
+  if(injectedFrameTimes.empty())
+  {
+    std::cout << "ERROR::FRAME_CLOCK::NO_FRAME_TIMES " << fileLoc << std::endl;
+    return false;
+  }
+
+  injectedFrameIndex = 0;
+  frameClockMode = FrameClock_Injected;
+  return true;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "../LearnOpenGLPlatform.h"
+
+// NOTE: Every scene reads its time from here. Time only moves when advanceFrameClock() is called, so it is constant
+// NOTE: for the whole frame and every scene drawn during that frame sees the same values.
+//  - variable timestep: deltas are measured with a monotonic clock (large gaps are clamped)
+//  - fixed timestep: every frame advances by the same amount, regardless of how long it took
+//  - injected: deltas are read from a file recorded with startRecordingFrameTimes(), for deterministic replays
+#define FRAME_CLOCK_MAX_DELTA_SECONDS 0.25f
+
+void startFrameClock(); // resets time to zero
+void advanceFrameClock(); // call once at the start of every frame, sleeps first when a target frame rate is set
+
+float32 getTime(); // seconds since startFrameClock()
+float32 getDeltaTime(); // seconds between the last two calls to advanceFrameClock()
+float32 getWallDeltaTime(); // measured seconds between the last two frames, unaffected by the timestep mode (ex: FPS)
+uint64 getFrameCount();
+uint64 monotonicNanoseconds(); // wall clock, for measuring rather than animating
+
+void setFixedTimestep(float32 timestepInSeconds); // zero returns to a variable timestep
+float32 getFixedTimestep(); // zero when using a variable timestep
+void setTargetFrameRate(float32 framesPerSecond); // zero for uncapped
+float32 getTargetFrameRate();
+
+void startRecordingFrameTimes();
+bool saveRecordedFrameTimes(const char* fileLoc);
+// NOTE: Once the injected deltas run out the last one is repeated
+bool injectFrameTimes(const char* fileLoc);
@@ -0,0 +1,485 @@
+#include "GLState.h"
+
+#include <imgui/imgui.h>
+#include <iostream>
+
+file_access const GLenum textureTargets[GL_STATE_TEXTURE_TARGET_COUNT] = { GL_TEXTURE_2D, GL_TEXTURE_CUBE_MAP, GL_TEXTURE_2D_ARRAY };
+file_access const GLenum textureTargetBindings[GL_STATE_TEXTURE_TARGET_COUNT] = { GL_TEXTURE_BINDING_2D, GL_TEXTURE_BINDING_CUBE_MAP, GL_TEXTURE_BINDING_2D_ARRAY };
+file_access const GLenum capabilities[GL_STATE_CAPABILITY_COUNT] = { GL_BLEND, GL_DEPTH_TEST, GL_CULL_FACE, GL_STENCIL_TEST, GL_SCISSOR_TEST, GL_MULTISAMPLE };
+file_access const char* const callNames[GLStateCall_Count] = {
+  "glUseProgram", "glBindVertexArray", "glBindFramebuffer", "glBindBuffer", "glActiveTexture", "glBindTexture",
+  "glEnable/glDisable", "glBlendFunc", "glDepthFunc/Mask", "glCullFace/FrontFace", "glStencilFunc/Op/Mask", "glViewport"
+};
+
+file_access GLStateSnapshot state;
+file_access GLStateCallCounts frameCounts;
+file_access GLStateCallCounts lastFrameCounts;
+
+// driver entry points, glad's pointers are replaced by the filtering versions below
+file_access PFNGLUSEPROGRAMPROC driverUseProgram;
+file_access PFNGLBINDVERTEXARRAYPROC driverBindVertexArray;
+file_access PFNGLDELETEVERTEXARRAYSPROC driverDeleteVertexArrays;
+file_access PFNGLBINDFRAMEBUFFERPROC driverBindFramebuffer;
+file_access PFNGLDELETEFRAMEBUFFERSPROC driverDeleteFramebuffers;
+file_access PFNGLBINDBUFFERPROC driverBindBuffer;
+file_access PFNGLDELETEBUFFERSPROC driverDeleteBuffers;
+file_access PFNGLACTIVETEXTUREPROC driverActiveTexture;
+file_access PFNGLBINDTEXTUREPROC driverBindTexture;
+file_access PFNGLDELETETEXTURESPROC driverDeleteTextures;
+file_access PFNGLENABLEPROC driverEnable;
+file_access PFNGLDISABLEPROC driverDisable;
+file_access PFNGLBLENDFUNCSEPARATEPROC driverBlendFuncSeparate;
+file_access PFNGLDEPTHFUNCPROC driverDepthFunc;
+file_access PFNGLDEPTHMASKPROC driverDepthMask;
+file_access PFNGLCULLFACEPROC driverCullFace;
+file_access PFNGLFRONTFACEPROC driverFrontFace;
+file_access PFNGLSTENCILFUNCPROC driverStencilFunc;
+file_access PFNGLSTENCILOPPROC driverStencilOp;
+file_access PFNGLSTENCILMASKPROC driverStencilMask;
+file_access PFNGLVIEWPORTPROC driverViewport;
+
+// Returns true if the call has to reach the driver
+file_access bool countCall(GLStateCall call, bool changesState)
+{
+  frameCounts.calls[call]++;
+  if(!changesState) { frameCounts.redundant[call]++; }
+  return changesState;
+}
+
+file_access int32 textureTargetIndex(GLenum target)
+{
+  for(int32 i = 0; i < GL_STATE_TEXTURE_TARGET_COUNT; ++i)
+  {
+    if(textureTargets[i] == target) { return i; }
+  }
+  return -1;
+}
+
+file_access int32 capabilityIndex(GLenum capability)
+{
+  for(int32 i = 0; i < GL_STATE_CAPABILITY_COUNT; ++i)
+  {
+    if(capabilities[i] == capability) { return i; }
+  }
+  return -1;
+}
+
+file_access void APIENTRY cachedUseProgram(GLuint program)
+{
+  if(!countCall(GLStateCall_UseProgram, state.program != program)) { return; }
+  state.program = program;
+  driverUseProgram(program);
+}
+
+file_access void APIENTRY cachedBindVertexArray(GLuint vertexArray)
+{
+  if(!countCall(GLStateCall_BindVertexArray, state.vertexArray != vertexArray)) { return; }
+  state.vertexArray = vertexArray;
+  driverBindVertexArray(vertexArray);
+}
+
+// NOTE: Deleting a bound object reverts its binding to 0 and its name may be handed out again, the shadow state must
+// NOTE: follow or a later bind of the recycled name would be filtered out
+file_access void APIENTRY cachedDeleteVertexArrays(GLsizei count, const GLuint* vertexArrays)
+{
+  for(GLsizei i = 0; i < count; ++i)
+  {
+    if(vertexArrays[i] == state.vertexArray) { state.vertexArray = 0; }
+  }
+  driverDeleteVertexArrays(count, vertexArrays);
+}
+
+file_access void APIENTRY cachedBindFramebuffer(GLenum target, GLuint framebuffer)
+{
+  bool draw = target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER;
+  bool read = target == GL_FRAMEBUFFER || target == GL_READ_FRAMEBUFFER;
+  bool changesState = (draw && state.drawFramebuffer != framebuffer) || (read && state.readFramebuffer != framebuffer);
+  if(!countCall(GLStateCall_BindFramebuffer, changesState)) { return; }
+  if(draw) { state.drawFramebuffer = framebuffer; }
+  if(read) { state.readFramebuffer = framebuffer; }
+  driverBindFramebuffer(target, framebuffer);
+}
+
+file_access void APIENTRY cachedDeleteFramebuffers(GLsizei count, const GLuint* framebuffers)
+{
+  for(GLsizei i = 0; i < count; ++i)
+  {
+    if(framebuffers[i] == state.drawFramebuffer) { state.drawFramebuffer = 0; }
+    if(framebuffers[i] == state.readFramebuffer) { state.readFramebuffer = 0; }
+  }
+  driverDeleteFramebuffers(count, framebuffers);
+}
+
+// NOTE: Only GL_ARRAY_BUFFER is tracked, GL_ELEMENT_ARRAY_BUFFER is vertex array state
+file_access void APIENTRY cachedBindBuffer(GLenum target, GLuint buffer)
+{
+  if(target != GL_ARRAY_BUFFER)
+  {
+    driverBindBuffer(target, buffer);
+    return;
+  }
+  if(!countCall(GLStateCall_BindBuffer, state.arrayBuffer != buffer)) { return; }
+  state.arrayBuffer = buffer;
+  driverBindBuffer(target, buffer);
+}
+
+file_access void APIENTRY cachedDeleteBuffers(GLsizei count, const GLuint* buffers)
+{
+  for(GLsizei i = 0; i < count; ++i)
+  {
+    if(buffers[i] == state.arrayBuffer) { state.arrayBuffer = 0; }
+  }
+  driverDeleteBuffers(count, buffers);
+}
+
+file_access void APIENTRY cachedActiveTexture(GLenum texture)
+{
+  uint32 unit = texture - GL_TEXTURE0;
+  if(!countCall(GLStateCall_ActiveTexture, state.activeTexture != unit)) { return; }
+  state.activeTexture = unit;
+  driverActiveTexture(texture);
+}
+
+file_access void APIENTRY cachedBindTexture(GLenum target, GLuint texture)
+{
+  int32 targetIndex = textureTargetIndex(target);
+  if(targetIndex < 0 || state.activeTexture >= GL_STATE_MAX_TEXTURE_UNITS)
+  {
+    driverBindTexture(target, texture);
+    return;
+  }
+  uint32& binding = state.textures[state.activeTexture][targetIndex];
+  if(!countCall(GLStateCall_BindTexture, binding != texture)) { return; }
+  binding = texture;
+  driverBindTexture(target, texture);
+}
+
+file_access void APIENTRY cachedDeleteTextures(GLsizei count, const GLuint* textures)
+{
+  for(GLsizei i = 0; i < count; ++i)
+  {
+    for(uint32 unit = 0; unit < GL_STATE_MAX_TEXTURE_UNITS; ++unit)
+    {
+      for(uint32 target = 0; target < GL_STATE_TEXTURE_TARGET_COUNT; ++target)
+      {
+        if(state.textures[unit][target] == textures[i]) { state.textures[unit][target] = 0; }
+      }
+    }
+  }
+  driverDeleteTextures(count, textures);
+}
+
+file_access void APIENTRY cachedEnable(GLenum capability)
+{
+  int32 index = capabilityIndex(capability);
+  if(index < 0)
+  {
+    driverEnable(capability);
+    return;
+  }
+  if(!countCall(GLStateCall_EnableDisable, !state.capabilities[index])) { return; }
+  state.capabilities[index] = true;
+  driverEnable(capability);
+}
+
+file_access void APIENTRY cachedDisable(GLenum capability)
+{
+  int32 index = capabilityIndex(capability);
+  if(index < 0)
+  {
+    driverDisable(capability);
+    return;
+  }
+  if(!countCall(GLStateCall_EnableDisable, state.capabilities[index])) { return; }
+  state.capabilities[index] = false;
+  driverDisable(capability);
+}
+
+file_access void APIENTRY cachedBlendFuncSeparate(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha)
+{
+  bool changesState = state.blendSrcRGB != srcRGB || state.blendDstRGB != dstRGB ||
+                      state.blendSrcAlpha != srcAlpha || state.blendDstAlpha != dstAlpha;
+  if(!countCall(GLStateCall_Blend, changesState)) { return; }
+  state.blendSrcRGB = srcRGB;
+  state.blendDstRGB = dstRGB;
+  state.blendSrcAlpha = srcAlpha;
+  state.blendDstAlpha = dstAlpha;
+  driverBlendFuncSeparate(srcRGB, dstRGB, srcAlpha, dstAlpha);
+}
+
+file_access void APIENTRY cachedBlendFunc(GLenum src, GLenum dst)
+{
+  cachedBlendFuncSeparate(src, dst, src, dst);
+}
+
+file_access void APIENTRY cachedDepthFunc(GLenum func)
+{
+  if(!countCall(GLStateCall_Depth, state.depthFunc != func)) { return; }
+  state.depthFunc = func;
+  driverDepthFunc(func);
+}
+
+file_access void APIENTRY cachedDepthMask(GLboolean flag)
+{
+  bool mask = flag == GL_TRUE;
+  if(!countCall(GLStateCall_Depth, state.depthMask != mask)) { return; }
+  state.depthMask = mask;
+  driverDepthMask(flag);
+}
+
+file_access void APIENTRY cachedCullFace(GLenum mode)
+{
+  if(!countCall(GLStateCall_Cull, state.cullFace != mode)) { return; }
+  state.cullFace = mode;
+  driverCullFace(mode);
+}
+
+file_access void APIENTRY cachedFrontFace(GLenum mode)
+{
+  if(!countCall(GLStateCall_Cull, state.frontFace != mode)) { return; }
+  state.frontFace = mode;
+  driverFrontFace(mode);
+}
+
+file_access void APIENTRY cachedStencilFunc(GLenum func, GLint ref, GLuint mask)
+{
+  bool changesState = state.stencilFunc != func || state.stencilRef != ref || state.stencilFuncMask != mask;
+  if(!countCall(GLStateCall_Stencil, changesState)) { return; }
+  state.stencilFunc = func;
+  state.stencilRef = ref;
+  state.stencilFuncMask = mask;
+  driverStencilFunc(func, ref, mask);
+}
+
+file_access void APIENTRY cachedStencilOp(GLenum fail, GLenum depthFail, GLenum depthPass)
+{
+  bool changesState = state.stencilFail != fail || state.stencilDepthFail != depthFail || state.stencilDepthPass != depthPass;
+  if(!countCall(GLStateCall_Stencil, changesState)) { return; }
+  state.stencilFail = fail;
+  state.stencilDepthFail = depthFail;
+  state.stencilDepthPass = depthPass;
+  driverStencilOp(fail, depthFail, depthPass);
+}
+
+file_access void APIENTRY cachedStencilMask(GLuint mask)
+{
+  if(!countCall(GLStateCall_Stencil, state.stencilWriteMask != mask)) { return; }
+  state.stencilWriteMask = mask;
+  driverStencilMask(mask);
+}
+
+file_access void APIENTRY cachedViewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+  bool changesState = state.viewport[0] != x || state.viewport[1] != y || state.viewport[2] != width || state.viewport[3] != height;
+  if(!countCall(GLStateCall_Viewport, changesState)) { return; }
+  state.viewport[0] = x;
+  state.viewport[1] = y;
+  state.viewport[2] = width;
+  state.viewport[3] = height;
+  driverViewport(x, y, width, height);
+}
+
+// NOTE: The only time the state is read back from the driver
+file_access void queryDriverState()
+{
+  GLint value;
+  glGetIntegerv(GL_CURRENT_PROGRAM, &value); state.program = value;
+  glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &value); state.vertexArray = value;
+  glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &value); state.drawFramebuffer = value;
+  glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &value); state.readFramebuffer = value;
+  glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &value); state.arrayBuffer = value;
+  glGetIntegerv(GL_ACTIVE_TEXTURE, &value); state.activeTexture = value - GL_TEXTURE0;
+
+  GLint unitCount;
+  glGetIntegerv(GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, &unitCount);
+  for(uint32 unit = 0; unit < GL_STATE_MAX_TEXTURE_UNITS && unit < (uint32)unitCount; ++unit)
+  {
+    driverActiveTexture(GL_TEXTURE0 + unit);
+    for(uint32 target = 0; target < GL_STATE_TEXTURE_TARGET_COUNT; ++target)
+    {
+      glGetIntegerv(textureTargetBindings[target], &value); state.textures[unit][target] = value;
+    }
+  }
+  driverActiveTexture(GL_TEXTURE0 + state.activeTexture);
+
+  for(uint32 i = 0; i < GL_STATE_CAPABILITY_COUNT; ++i) { state.capabilities[i] = glIsEnabled(capabilities[i]) == GL_TRUE; }
+
+  glGetIntegerv(GL_BLEND_SRC_RGB, &value); state.blendSrcRGB = value;
+  glGetIntegerv(GL_BLEND_DST_RGB, &value); state.blendDstRGB = value;
+  glGetIntegerv(GL_BLEND_SRC_ALPHA, &value); state.blendSrcAlpha = value;
+  glGetIntegerv(GL_BLEND_DST_ALPHA, &value); state.blendDstAlpha = value;
+  glGetIntegerv(GL_DEPTH_FUNC, &value); state.depthFunc = value;
+  GLboolean depthMask;
+  glGetBooleanv(GL_DEPTH_WRITEMASK, &depthMask); state.depthMask = depthMask == GL_TRUE;
+  glGetIntegerv(GL_CULL_FACE_MODE, &value); state.cullFace = value;
+  glGetIntegerv(GL_FRONT_FACE, &value); state.frontFace = value;
+  glGetIntegerv(GL_STENCIL_FUNC, &value); state.stencilFunc = value;
+  glGetIntegerv(GL_STENCIL_REF, &value); state.stencilRef = value;
+  glGetIntegerv(GL_STENCIL_VALUE_MASK, &value); state.stencilFuncMask = value;
+  glGetIntegerv(GL_STENCIL_FAIL, &value); state.stencilFail = value;
+  glGetIntegerv(GL_STENCIL_PASS_DEPTH_FAIL, &value); state.stencilDepthFail = value;
+  glGetIntegerv(GL_STENCIL_PASS_DEPTH_PASS, &value); state.stencilDepthPass = value;
+  glGetIntegerv(GL_STENCIL_WRITEMASK, &value); state.stencilWriteMask = value;
+  glGetIntegerv(GL_VIEWPORT, state.viewport);
+}
+
+void initGLState()
+{
+  driverUseProgram = glad_glUseProgram;
+  driverBindVertexArray = glad_glBindVertexArray;
+  driverDeleteVertexArrays = glad_glDeleteVertexArrays;
+  driverBindFramebuffer = glad_glBindFramebuffer;
+  driverDeleteFramebuffers = glad_glDeleteFramebuffers;
+  driverBindBuffer = glad_glBindBuffer;
+  driverDeleteBuffers = glad_glDeleteBuffers;
+  driverActiveTexture = glad_glActiveTexture;
+  driverBindTexture = glad_glBindTexture;
+  driverDeleteTextures = glad_glDeleteTextures;
+  driverEnable = glad_glEnable;
+  driverDisable = glad_glDisable;
+  driverBlendFuncSeparate = glad_glBlendFuncSeparate;
+  driverDepthFunc = glad_glDepthFunc;
+  driverDepthMask = glad_glDepthMask;
+  driverCullFace = glad_glCullFace;
+  driverFrontFace = glad_glFrontFace;
+  driverStencilFunc = glad_glStencilFunc;
+  driverStencilOp = glad_glStencilOp;
+  driverStencilMask = glad_glStencilMask;
+  driverViewport = glad_glViewport;
+
+  queryDriverState();
+
+  glad_glUseProgram = cachedUseProgram;
+  glad_glBindVertexArray = cachedBindVertexArray;
+  glad_glDeleteVertexArrays = cachedDeleteVertexArrays;
+  glad_glBindFramebuffer = cachedBindFramebuffer;
+  glad_glDeleteFramebuffers = cachedDeleteFramebuffers;
+  glad_glBindBuffer = cachedBindBuffer;
+  glad_glDeleteBuffers = cachedDeleteBuffers;
+  glad_glActiveTexture = cachedActiveTexture;
+  glad_glBindTexture = cachedBindTexture;
+  glad_glDeleteTextures = cachedDeleteTextures;
+  glad_glEnable = cachedEnable;
+  glad_glDisable = cachedDisable;
+  glad_glBlendFunc = cachedBlendFunc;
+  glad_glBlendFuncSeparate = cachedBlendFuncSeparate;
+  glad_glDepthFunc = cachedDepthFunc;
+  glad_glDepthMask = cachedDepthMask;
+  glad_glCullFace = cachedCullFace;
+  glad_glFrontFace = cachedFrontFace;
+  glad_glStencilFunc = cachedStencilFunc;
+  glad_glStencilOp = cachedStencilOp;
+  glad_glStencilMask = cachedStencilMask;
+  glad_glViewport = cachedViewport;
+
+  frameCounts = {};
+  lastFrameCounts = {};
+}
+
+void glStateBeginFrame()
+{
+  lastFrameCounts = frameCounts;
+  frameCounts = {};
+}
+
+const GLStateCallCounts& glStateLastFrameCounts()
+{
+  return lastFrameCounts;
+}
+
+GLStateSnapshot glStateSnapshot()
+{
+  return state;
+}
+
+void glStateRestore(const GLStateSnapshot& snapshot)
+{
+  glUseProgram(snapshot.program);
+  glBindVertexArray(snapshot.vertexArray);
+  if(snapshot.drawFramebuffer == snapshot.readFramebuffer)
+  {
+    glBindFramebuffer(GL_FRAMEBUFFER, snapshot.drawFramebuffer);
+  } else
+  {
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, snapshot.drawFramebuffer);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, snapshot.readFramebuffer);
+  }
+  glBindBuffer(GL_ARRAY_BUFFER, snapshot.arrayBuffer);
+
+  for(uint32 unit = 0; unit < GL_STATE_MAX_TEXTURE_UNITS; ++unit)
+  {
+    for(uint32 target = 0; target < GL_STATE_TEXTURE_TARGET_COUNT; ++target)
+    {
+      if(state.textures[unit][target] == snapshot.textures[unit][target]) { continue; }
+      glActiveTexture(GL_TEXTURE0 + unit);
+      glBindTexture(textureTargets[target], snapshot.textures[unit][target]);
+    }
+  }
+  glActiveTexture(GL_TEXTURE0 + snapshot.activeTexture);
+
+  for(uint32 i = 0; i < GL_STATE_CAPABILITY_COUNT; ++i)
+  {
+    if(snapshot.capabilities[i]) { glEnable(capabilities[i]); }
+    else { glDisable(capabilities[i]); }
+  }
+  glBlendFuncSeparate(snapshot.blendSrcRGB, snapshot.blendDstRGB, snapshot.blendSrcAlpha, snapshot.blendDstAlpha);
+  glDepthFunc(snapshot.depthFunc);
+  glDepthMask(snapshot.depthMask ? GL_TRUE : GL_FALSE);
+  glCullFace(snapshot.cullFace);
+  glFrontFace(snapshot.frontFace);
+  glStencilFunc(snapshot.stencilFunc, snapshot.stencilRef, snapshot.stencilFuncMask);
+  glStencilOp(snapshot.stencilFail, snapshot.stencilDepthFail, snapshot.stencilDepthPass);
+  glStencilMask(snapshot.stencilWriteMask);
+  glViewport(snapshot.viewport[0], snapshot.viewport[1], snapshot.viewport[2], snapshot.viewport[3]);
+}
+
+uint32 glStateBoundTexture(GLenum target)
+{
+  int32 targetIndex = textureTargetIndex(target);
+  if(targetIndex >= 0 && state.activeTexture < GL_STATE_MAX_TEXTURE_UNITS)
+  {
+    return state.textures[state.activeTexture][targetIndex];
+  }
+
+  // NOTE: untracked, fall back to asking the driver
+  GLenum binding = targetIndex >= 0 ? textureTargetBindings[targetIndex] : GL_NONE;
+  if(target == GL_TEXTURE_3D) { binding = GL_TEXTURE_BINDING_3D; }
+  if(binding == GL_NONE)
+  {
+    std::cout << "ERROR::GL_STATE::No binding query for texture target: " << target << std::endl;
+    return 0;
+  }
+  GLint texture;
+  glGetIntegerv(binding, &texture);
+  return texture;
+}
+
+uint32 glStateActiveTexture()
+{
+  return GL_TEXTURE0 + state.activeTexture;
+}
+
+uint32 glStateBoundFramebuffer(GLenum target)
+{
+  return target == GL_READ_FRAMEBUFFER ? state.readFramebuffer : state.drawFramebuffer;
+}
+
+void drawGLStateGui()
+{
+  ImGui::SetNextWindowSize(ImVec2(360, 0), ImGuiCond_FirstUseEver);
+  if(ImGui::Begin("GL State"))
+  {
+    uint32 totalCalls = 0;
+    uint32 totalRedundant = 0;
+    ImGui::Text("%-24s %8s %10s", "last frame", "calls", "redundant");
+    for(uint32 i = 0; i < GLStateCall_Count; ++i)
+    {
+      ImGui::Text("%-24s %8u %10u", callNames[i], lastFrameCounts.calls[i], lastFrameCounts.redundant[i]);
+      totalCalls += lastFrameCounts.calls[i];
+      totalRedundant += lastFrameCounts.redundant[i];
+    }
+    ImGui::Separator();
+    ImGui::Text("%-24s %8u %10u", "total", totalCalls, totalRedundant);
+  }
+  ImGui::End();
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include "../LearnOpenGLPlatform.h"
+
+// NOTE: Shadow copy of the OpenGL state that scenes set every frame. initGLState() swaps glad's function pointers for
+// NOTE: filtering versions, so every glEnable, glBindTexture, glUseProgram, ... in the program only reaches the driver
+// NOTE: when it changes something. Code outside of glad (ex: the ImGui backend) must leave the state as it found it.
+// NOTE: Tracked: program, vertex array, draw & read framebuffers, GL_ARRAY_BUFFER, active texture, 2D/cube map/2D array
+// NOTE: bindings of the first GL_STATE_MAX_TEXTURE_UNITS units, blend, depth, cull, stencil & viewport. Untracked
+// NOTE: targets and units pass straight through. The glStencil*Separate() calls aren't tracked and must not be used.
+#define GL_STATE_MAX_TEXTURE_UNITS 32
+#define GL_STATE_TEXTURE_TARGET_COUNT 3 // GL_TEXTURE_2D, GL_TEXTURE_CUBE_MAP, GL_TEXTURE_2D_ARRAY
+#define GL_STATE_CAPABILITY_COUNT 6 // GL_BLEND, GL_DEPTH_TEST, GL_CULL_FACE, GL_STENCIL_TEST, GL_SCISSOR_TEST, GL_MULTISAMPLE
+
+enum GLStateCall {
+  GLStateCall_UseProgram = 0,
+  GLStateCall_BindVertexArray,
+  GLStateCall_BindFramebuffer,
+  GLStateCall_BindBuffer,
+  GLStateCall_ActiveTexture,
+  GLStateCall_BindTexture,
+  GLStateCall_EnableDisable,
+  GLStateCall_Blend,
+  GLStateCall_Depth,
+  GLStateCall_Cull,
+  GLStateCall_Stencil,
+  GLStateCall_Viewport,
+  GLStateCall_Count
+};
+
+struct GLStateCallCounts
+{
+  uint32 calls[GLStateCall_Count];
+  uint32 redundant[GLStateCall_Count]; // filtered out before reaching the driver
+};
+
+struct GLStateSnapshot
+{
+  uint32 program;
+  uint32 vertexArray;
+  uint32 drawFramebuffer;
+  uint32 readFramebuffer;
+  uint32 arrayBuffer;
+  uint32 activeTexture; // unit index, not GL_TEXTUREi
+  uint32 textures[GL_STATE_MAX_TEXTURE_UNITS][GL_STATE_TEXTURE_TARGET_COUNT];
+  bool capabilities[GL_STATE_CAPABILITY_COUNT];
+  GLenum blendSrcRGB, blendDstRGB, blendSrcAlpha, blendDstAlpha;
+  GLenum depthFunc;
+  bool depthMask;
+  GLenum cullFace;
+  GLenum frontFace;
+  GLenum stencilFunc;
+  int32 stencilRef;
+  uint32 stencilFuncMask;
+  GLenum stencilFail, stencilDepthFail, stencilDepthPass;
+  uint32 stencilWriteMask;
+  int32 viewport[4];
+};
+
+// NOTE: must be called after glad is loaded (and after loadGLExtensions()) with the context current
+void initGLState();
+// Resets the per frame counters
+void glStateBeginFrame();
+const GLStateCallCounts& glStateLastFrameCounts();
+void drawGLStateGui();
+
+// NOTE: Replaces the glGet*() save/restore pattern, neither stalls on the driver
+GLStateSnapshot glStateSnapshot();
+void glStateRestore(const GLStateSnapshot& snapshot); // only issues the calls for state that differs
+uint32 glStateBoundTexture(GLenum target); // on the active unit
+uint32 glStateActiveTexture(); // as GL_TEXTUREi
+uint32 glStateBoundFramebuffer(GLenum target); // GL_DRAW_FRAMEBUFFER or GL_READ_FRAMEBUFFER
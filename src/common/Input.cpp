@@ -407,12 +407,14 @@ void glfw_framebuffer_size_callback(GLFWwindow* window, int32 width, int32 heigh
 
 void enableCursor(GLFWwindow* window, bool enable)
 {
+  if(window == NULL) { return; } // NOTE: headless mode has no window
   glfwSetInputMode(window, GLFW_CURSOR, enable ? GLFW_CURSOR_NORMAL : GLFW_CURSOR_DISABLED);
   windowModeChangeTossNextInput.set();
 }
 
 bool isCursorEnabled(GLFWwindow* window)
 {
+  if(window == NULL) { return false; }
   return glfwGetInputMode(window, GLFW_CURSOR) == GLFW_CURSOR_NORMAL;
 }
 
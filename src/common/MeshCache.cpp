@@ -0,0 +1,192 @@
+#include "MeshCache.h"
+
+#include <windows.h>
+#include <sys/stat.h>
+#include <fstream>
+#include <iostream>
+#include <cstring>
+#include <cstdio>
+
+#define MESH_CACHE_RELATIVE_PATH "src/data/meshCache/"
+#define MESH_CACHE_FILE_IDENTIFIER 0x4843534D // "MSCH"
+#define MESH_CACHE_FILE_VERSION 2
+#define MESH_CACHE_FILE_PATH_SIZE 64
+
+file_access uint64 alignTo8(uint64 value)
+{
+  return (value + 7) & ~(uint64)7;
+}
+
+// cache files are named after a hash of the model path, FNV-1a
+file_access void meshCacheFileLocation(const char* modelPath, char* fileLocation)
+{
+  uint64 hash = 14695981039346656037ull;
+  for(const char* c = modelPath; *c != '\0'; ++c)
+  {
+    hash ^= (uint8)*c;
+    hash *= 1099511628211ull;
+  }
+  snprintf(fileLocation, MESH_CACHE_FILE_PATH_SIZE, MESH_CACHE_RELATIVE_PATH"%016llx.mesh", (unsigned long long)hash);
+}
+
+file_access bool modelFileStats(const char* modelPath, uint64* fileSize, uint64* modifiedTime)
+{
+  struct stat fileStats;
+  if(stat(modelPath, &fileStats) != 0) { return false; }
+  *fileSize = (uint64)fileStats.st_size;
+  *modifiedTime = (uint64)fileStats.st_mtime;
+  return true;
+}
+
+bool openMeshCache(const char* modelPath, MeshCacheFile* cacheFile)
+{
+  *cacheFile = {};
+
+  // NOTE: Only the model file is checked, edits to .mtl files or textures alone won't invalidate the cache
+  uint64 sourceFileSize, sourceFileModifiedTime;
+  if(!modelFileStats(modelPath, &sourceFileSize, &sourceFileModifiedTime)) { return false; }
+
+  char fileLocation[MESH_CACHE_FILE_PATH_SIZE];
+  meshCacheFileLocation(modelPath, fileLocation);
+
+  HANDLE fileHandle = CreateFileA(fileLocation, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if(fileHandle == INVALID_HANDLE_VALUE) { return false; }
+
+  LARGE_INTEGER fileSize;
+  if(!GetFileSizeEx(fileHandle, &fileSize) || (uint64)fileSize.QuadPart < sizeof(MeshCacheHeader))
+  {
+    CloseHandle(fileHandle);
+    return false;
+  }
+
+  HANDLE mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+  if(mappingHandle == NULL)
+  {
+    CloseHandle(fileHandle);
+    return false;
+  }
+
+  const uint8* data = (const uint8*)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+  if(data == NULL)
+  {
+    CloseHandle(mappingHandle);
+    CloseHandle(fileHandle);
+    return false;
+  }
+
+  cacheFile->fileHandle = fileHandle;
+  cacheFile->mappingHandle = mappingHandle;
+  cacheFile->data = data;
+  cacheFile->size = (uint64)fileSize.QuadPart;
+  cacheFile->header = (const MeshCacheHeader*)data;
+
+  const MeshCacheHeader* header = cacheFile->header;
+  bool headerValid = header->identifier == MESH_CACHE_FILE_IDENTIFIER &&
+                     header->version == MESH_CACHE_FILE_VERSION &&
+                     header->vertexSize == sizeof(Vertex) &&
+                     header->sourceFileSize == sourceFileSize &&
+                     header->sourceFileModifiedTime == sourceFileModifiedTime;
+  uint64 tablesEnd = sizeof(MeshCacheHeader) + (header->meshCount * sizeof(MeshCacheMesh)) + (header->textureCount * sizeof(MeshCacheTexture));
+  if(!headerValid || tablesEnd > cacheFile->size)
+  {
+    closeMeshCache(cacheFile);
+    return false;
+  }
+
+  cacheFile->meshes = (const MeshCacheMesh*)(data + sizeof(MeshCacheHeader));
+  cacheFile->textures = (const MeshCacheTexture*)(cacheFile->meshes + header->meshCount);
+
+  // guard against truncated files before anyone reads through the offsets
+  for(uint32 i = 0; i < header->meshCount; ++i)
+  {
+    const MeshCacheMesh& mesh = cacheFile->meshes[i];
+    bool meshValid = mesh.vertexOffset + ((uint64)mesh.vertexCount * sizeof(Vertex)) <= cacheFile->size &&
+                     mesh.indexOffset + ((uint64)mesh.indexCount * sizeof(uint32)) <= cacheFile->size &&
+                     mesh.firstTexture + mesh.textureCount <= header->textureCount &&
+                     mesh.lod < header->lodCount;
+    if(!meshValid)
+    {
+      closeMeshCache(cacheFile);
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void closeMeshCache(MeshCacheFile* cacheFile)
+{
+  if(cacheFile->data != NULL) { UnmapViewOfFile(cacheFile->data); }
+  if(cacheFile->mappingHandle != NULL) { CloseHandle(cacheFile->mappingHandle); }
+  if(cacheFile->fileHandle != NULL) { CloseHandle(cacheFile->fileHandle); }
+  *cacheFile = {};
+}
+
+void writeMeshCache(const char* modelPath, const std::vector<MeshCacheSourceMesh>& meshes)
+{
+  MeshCacheHeader header = {};
+  header.identifier = MESH_CACHE_FILE_IDENTIFIER;
+  header.version = MESH_CACHE_FILE_VERSION;
+  header.vertexSize = sizeof(Vertex);
+  header.meshCount = (uint32)meshes.size();
+  header.lodCount = 1;
+  if(!modelFileStats(modelPath, &header.sourceFileSize, &header.sourceFileModifiedTime)) { return; }
+
+  std::vector<MeshCacheMesh> meshTable(meshes.size());
+  std::vector<MeshCacheTexture> textureTable;
+  for(uint32 i = 0; i < meshes.size(); ++i)
+  {
+    meshTable[i].firstTexture = (uint32)textureTable.size();
+    meshTable[i].textureCount = (uint32)meshes[i].textures.size();
+    meshTable[i].lod = meshes[i].lod;
+    if(meshes[i].lod >= header.lodCount) { header.lodCount = meshes[i].lod + 1; }
+    for(const Texture& texture : meshes[i].textures)
+    {
+      MeshCacheTexture cacheTexture = {};
+      if(texture.type.length() >= MESH_CACHE_TEXTURE_TYPE_SIZE || texture.path.length() >= MESH_CACHE_TEXTURE_PATH_SIZE)
+      {
+        std::cout << "ERROR::MESH_CACHE::TEXTURE_PATH_TOO_LONG " << texture.path << std::endl;
+        return;
+      }
+      strcpy(cacheTexture.type, texture.type.c_str());
+      strcpy(cacheTexture.path, texture.path.c_str());
+      textureTable.push_back(cacheTexture);
+    }
+  }
+  header.textureCount = (uint32)textureTable.size();
+
+  uint64 offset = alignTo8(sizeof(MeshCacheHeader) + (meshTable.size() * sizeof(MeshCacheMesh)) + (textureTable.size() * sizeof(MeshCacheTexture)));
+  for(uint32 i = 0; i < meshes.size(); ++i)
+  {
+    meshTable[i].vertexOffset = offset;
+    meshTable[i].vertexCount = (uint32)meshes[i].vertices.size();
+    offset = alignTo8(offset + (meshes[i].vertices.size() * sizeof(Vertex)));
+  }
+  for(uint32 i = 0; i < meshes.size(); ++i)
+  {
+    meshTable[i].indexOffset = offset;
+    meshTable[i].indexCount = (uint32)meshes[i].indices.size();
+    offset = alignTo8(offset + (meshes[i].indices.size() * sizeof(uint32)));
+  }
+
+  char fileLocation[MESH_CACHE_FILE_PATH_SIZE];
+  meshCacheFileLocation(modelPath, fileLocation);
+  std::ofstream file(fileLocation, std::ios::binary | std::ios::trunc);
+  if(!file)
+  {
+    std::cout << "ERROR::MESH_CACHE::FILE_NOT_SUCCESFULLY_WRITTEN " << fileLocation << std::endl;
+    return;
+  }
+
+  const char padding[8] = {};
+  auto writePadded = [&](const void* bytes, uint64 byteCount) {
+    file.write((const char*)bytes, byteCount);
+    file.write(padding, alignTo8(byteCount) - byteCount);
+  };
+
+  file.write((const char*)&header, sizeof(header));
+  file.write((const char*)meshTable.data(), meshTable.size() * sizeof(MeshCacheMesh));
+  writePadded(textureTable.data(), textureTable.size() * sizeof(MeshCacheTexture));
+  for(const MeshCacheSourceMesh& mesh : meshes) { writePadded(mesh.vertices.data(), mesh.vertices.size() * sizeof(Vertex)); }
+  for(const MeshCacheSourceMesh& mesh : meshes) { writePadded(mesh.indices.data(), mesh.indices.size() * sizeof(uint32)); }
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <vector>
+
+#include "../LearnOpenGLPlatform.h"
+#include "../Mesh.h"
+
+#define MESH_CACHE_TEXTURE_TYPE_SIZE 16
+#define MESH_CACHE_TEXTURE_PATH_SIZE 128 // NOTE: Matches the hard limit in Model::loadMaterialTextures
+
+// NOTE: File layout: [MeshCacheHeader][MeshCacheMesh * meshCount][MeshCacheTexture * textureCount][Vertex data][uint32 index data]
+// NOTE: Every section is 8 byte aligned so the mapped file can be read in place
+struct MeshCacheHeader
+{
+  uint32 identifier;
+  uint32 version;
+  uint32 vertexSize; // sizeof(Vertex) when written, guards against layout changes
+  uint32 meshCount;
+  uint32 textureCount;
+  uint32 lodCount; // simplified levels of detail stored alongside the full detail meshes, 1 if none
+  uint64 sourceFileSize;
+  uint64 sourceFileModifiedTime;
+};
+
+struct MeshCacheMesh
+{
+  uint64 vertexOffset; // bytes from start of file
+  uint64 indexOffset; // bytes from start of file
+  uint32 vertexCount;
+  uint32 indexCount;
+  uint32 firstTexture; // index into the texture table
+  uint32 textureCount;
+  uint32 lod; // 0 for the model's own meshes
+  uint32 padding;
+};
+
+struct MeshCacheTexture
+{
+  char type[MESH_CACHE_TEXTURE_TYPE_SIZE];
+  char path[MESH_CACHE_TEXTURE_PATH_SIZE]; // relative to the model's directory
+};
+
+// memory mapped, read only view of a cache file
+struct MeshCacheFile
+{
+  void* fileHandle;
+  void* mappingHandle;
+  const uint8* data;
+  uint64 size;
+  const MeshCacheHeader* header;
+  const MeshCacheMesh* meshes;
+  const MeshCacheTexture* textures;
+};
+
+// data gathered during an Assimp import that is needed to write the cache
+struct MeshCacheSourceMesh
+{
+  std::vector<Vertex> vertices;
+  std::vector<uint32> indices;
+  std::vector<Texture> textures;
+  uint32 lod = 0;
+};
+
+// Returns false if there is no cache for the model or if the cache is outdated
+bool openMeshCache(const char* modelPath, MeshCacheFile* cacheFile);
+void closeMeshCache(MeshCacheFile* cacheFile);
+void writeMeshCache(const char* modelPath, const std::vector<MeshCacheSourceMesh>& meshes);
+
+inline const Vertex* meshCacheVertices(const MeshCacheFile& cacheFile, const MeshCacheMesh& mesh)
+{
+  return (const Vertex*)(cacheFile.data + mesh.vertexOffset);
+}
+
+inline const uint32* meshCacheIndices(const MeshCacheFile& cacheFile, const MeshCacheMesh& mesh)
+{
+  return (const uint32*)(cacheFile.data + mesh.indexOffset);
+}
@@ -0,0 +1,457 @@
+#include <cmath>
+#include <cstring>
+#include <queue>
+#include <unordered_map>
+
+#include "MeshSimplifier.h"
+
+#define SIMPLIFY_MIN_NORMAL_DOT 0.2 // collapses that turn any triangle further than this are rejected
+#define SIMPLIFY_BOUNDARY_WEIGHT 1000.0 // keeps open edges in place, they have no opposing faces to hold them
+
+// symmetric 4x4 error quadric, upper triangle
+struct Quadric
+{
+  float64 a2, ab, ac, ad;
+  float64     b2, bc, bd;
+  float64         c2, cd;
+  float64             d2;
+};
+
+struct CollapseCandidate
+{
+  float64 cost;
+  uint32 keep;
+  uint32 remove;
+  uint32 keepVersion;
+  uint32 removeVersion;
+  float64 target[3];
+
+  bool operator>(const CollapseCandidate& other) const { return cost > other.cost; }
+};
+
+struct SimplifyState
+{
+  std::vector<float64> positions; // 3 per welded position
+  std::vector<Quadric> quadrics;
+  std::vector<uint32> versions; // bumped whenever a position moves so queued candidates can be recognized as stale
+  std::vector<bool> removed;
+  std::vector<std::vector<uint32>> triangles; // triangles touching each welded position, may hold removed/stale entries
+  std::vector<uint32> cornerPositions; // 3 per triangle, welded position of each corner
+  std::vector<bool> triangleRemoved;
+};
+
+file_access void addPlane(Quadric* q, float64 a, float64 b, float64 c, float64 d, float64 weight)
+{
+  q->a2 += weight * a * a; q->ab += weight * a * b; q->ac += weight * a * c; q->ad += weight * a * d;
+  q->b2 += weight * b * b; q->bc += weight * b * c; q->bd += weight * b * d;
+  q->c2 += weight * c * c; q->cd += weight * c * d;
+  q->d2 += weight * d * d;
+}
+
+file_access Quadric addQuadrics(const Quadric& q1, const Quadric& q2)
+{
+  return { q1.a2 + q2.a2, q1.ab + q2.ab, q1.ac + q2.ac, q1.ad + q2.ad,
+                          q1.b2 + q2.b2, q1.bc + q2.bc, q1.bd + q2.bd,
+                                         q1.c2 + q2.c2, q1.cd + q2.cd,
+                                                        q1.d2 + q2.d2 };
+}
+
+file_access float64 quadricError(const Quadric& q, const float64* v)
+{
+  float64 x = v[0], y = v[1], z = v[2];
+  return q.a2 * x * x + 2.0 * q.ab * x * y + 2.0 * q.ac * x * z + 2.0 * q.ad * x
+         + q.b2 * y * y + 2.0 * q.bc * y * z + 2.0 * q.bd * y
+         + q.c2 * z * z + 2.0 * q.cd * z
+         + q.d2;
+}
+
+file_access void cross(const float64* u, const float64* v, float64* result)
+{
+  result[0] = u[1] * v[2] - u[2] * v[1];
+  result[1] = u[2] * v[0] - u[0] * v[2];
+  result[2] = u[0] * v[1] - u[1] * v[0];
+}
+
+// unnormalized, length is twice the triangle's area
+file_access void triangleNormal(const float64* p0, const float64* p1, const float64* p2, float64* normal)
+{
+  float64 e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+  float64 e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+  cross(e1, e2, normal);
+}
+
+file_access float64 determinant3(float64 m00, float64 m01, float64 m02,
+                                 float64 m10, float64 m11, float64 m12,
+                                 float64 m20, float64 m21, float64 m22)
+{
+  return m00 * (m11 * m22 - m12 * m21) - m01 * (m10 * m22 - m12 * m20) + m02 * (m10 * m21 - m11 * m20);
+}
+
+// Picks the position minimizing the combined quadric, falling back to the best of the endpoints and midpoint when singular
+file_access CollapseCandidate collapseCandidate(const SimplifyState& state, uint32 keep, uint32 remove)
+{
+  CollapseCandidate candidate;
+  candidate.keep = keep;
+  candidate.remove = remove;
+  candidate.keepVersion = state.versions[keep];
+  candidate.removeVersion = state.versions[remove];
+
+  Quadric q = addQuadrics(state.quadrics[keep], state.quadrics[remove]);
+  float64 det = determinant3(q.a2, q.ab, q.ac,
+                             q.ab, q.b2, q.bc,
+                             q.ac, q.bc, q.c2);
+  if(fabs(det) > 1e-12)
+  {
+    // Cramer's rule on A * v = -b
+    float64 invDet = -1.0 / det;
+    candidate.target[0] = invDet * determinant3(q.ad, q.ab, q.ac,
+                                                q.bd, q.b2, q.bc,
+                                                q.cd, q.bc, q.c2);
+    candidate.target[1] = invDet * determinant3(q.a2, q.ad, q.ac,
+                                                q.ab, q.bd, q.bc,
+                                                q.ac, q.cd, q.c2);
+    candidate.target[2] = invDet * determinant3(q.a2, q.ab, q.ad,
+                                                q.ab, q.b2, q.bd,
+                                                q.ac, q.bc, q.cd);
+    candidate.cost = quadricError(q, candidate.target);
+    return candidate;
+  }
+
+  const float64* keepPosition = &state.positions[keep * 3];
+  const float64* removePosition = &state.positions[remove * 3];
+  float64 options[3][3];
+  for(uint32 i = 0; i < 3; i++)
+  {
+    options[0][i] = keepPosition[i];
+    options[1][i] = removePosition[i];
+    options[2][i] = (keepPosition[i] + removePosition[i]) * 0.5;
+  }
+  candidate.cost = INFINITY;
+  for(uint32 option = 0; option < 3; option++)
+  {
+    float64 error = quadricError(q, options[option]);
+    if(error < candidate.cost)
+    {
+      candidate.cost = error;
+      for(uint32 i = 0; i < 3; i++) { candidate.target[i] = options[option][i]; }
+    }
+  }
+  return candidate;
+}
+
+// Returns false if moving position to target turns any of its remaining triangles too far (or degenerates them)
+file_access bool collapseKeepsOrientation(const SimplifyState& state, uint32 position, uint32 other, const float64* target)
+{
+  for(uint32 triangle : state.triangles[position])
+  {
+    if(state.triangleRemoved[triangle]) { continue; }
+    const uint32* corners = &state.cornerPositions[triangle * 3];
+    if(corners[0] == other || corners[1] == other || corners[2] == other) { continue; } // removed by the collapse
+
+    const float64* p[3];
+    const float64* moved[3];
+    for(uint32 i = 0; i < 3; i++)
+    {
+      p[i] = &state.positions[corners[i] * 3];
+      moved[i] = (corners[i] == position) ? target : p[i];
+    }
+    float64 before[3], after[3];
+    triangleNormal(p[0], p[1], p[2], before);
+    triangleNormal(moved[0], moved[1], moved[2], after);
+    float64 beforeLength = sqrt(before[0] * before[0] + before[1] * before[1] + before[2] * before[2]);
+    float64 afterLength = sqrt(after[0] * after[0] + after[1] * after[1] + after[2] * after[2]);
+    if(afterLength <= 0.0) { return false; }
+    if(beforeLength <= 0.0) { continue; } // already degenerate, nothing to preserve
+    float64 dot = (before[0] * after[0] + before[1] * after[1] + before[2] * after[2]) / (beforeLength * afterLength);
+    if(dot < SIMPLIFY_MIN_NORMAL_DOT) { return false; }
+  }
+  return true;
+}
+
+file_access void gatherNeighbors(const SimplifyState& state, uint32 position, std::vector<uint32>* neighbors)
+{
+  neighbors->clear();
+  for(uint32 triangle : state.triangles[position])
+  {
+    if(state.triangleRemoved[triangle]) { continue; }
+    const uint32* corners = &state.cornerPositions[triangle * 3];
+    for(uint32 i = 0; i < 3; i++)
+    {
+      if(corners[i] == position) { continue; }
+      bool known = false;
+      for(uint32 neighbor : *neighbors) { known |= neighbor == corners[i]; }
+      if(!known) { neighbors->push_back(corners[i]); }
+    }
+  }
+}
+
+// Collapsing an edge whose endpoints share more neighbors than the triangles on the edge pinches the surface into
+// non-manifold edges (the "link condition")
+file_access bool collapseKeepsManifold(const SimplifyState& state, uint32 keep, uint32 remove,
+                                       std::vector<uint32>* keepNeighbors, std::vector<uint32>* removeNeighbors)
+{
+  gatherNeighbors(state, keep, keepNeighbors);
+  gatherNeighbors(state, remove, removeNeighbors);
+  uint32 sharedNeighbors = 0;
+  for(uint32 keepNeighbor : *keepNeighbors)
+  {
+    for(uint32 removeNeighbor : *removeNeighbors) { sharedNeighbors += keepNeighbor == removeNeighbor ? 1 : 0; }
+  }
+  uint32 edgeTriangles = 0;
+  for(uint32 triangle : state.triangles[keep])
+  {
+    if(state.triangleRemoved[triangle]) { continue; }
+    const uint32* corners = &state.cornerPositions[triangle * 3];
+    edgeTriangles += (corners[0] == remove || corners[1] == remove || corners[2] == remove) ? 1 : 0;
+  }
+  return sharedNeighbors <= edgeTriangles;
+}
+
+// The vertex at keep whose normal and texture coordinates are closest to vertex's, so corners moving onto keep join
+// its side of any seam instead of adding a vertex
+file_access uint32 closestAttributeVertex(const Vertex* vertices, const std::vector<uint32>& candidates, uint32 vertex)
+{
+  const Vertex& target = vertices[vertex];
+  uint32 closest = vertex;
+  float32 closestDistance = INFINITY;
+  for(uint32 candidate : candidates)
+  {
+    const Vertex& other = vertices[candidate];
+    float32 du = other.TexCoords.x - target.TexCoords.x;
+    float32 dv = other.TexCoords.y - target.TexCoords.y;
+    float32 normalDot = other.Normal.x * target.Normal.x + other.Normal.y * target.Normal.y + other.Normal.z * target.Normal.z;
+    float32 distance = du * du + dv * dv + (1.0f - normalDot);
+    if(distance < closestDistance)
+    {
+      closestDistance = distance;
+      closest = candidate;
+    }
+  }
+  return closest;
+}
+
+void simplifyMesh(const Vertex* vertices, uint32 vertexCount, const uint32* indices, uint32 indexCount,
+                  uint32 targetTriangleCount, std::vector<Vertex>* simplifiedVertices, std::vector<uint32>* simplifiedIndices)
+{
+  SimplifyState state;
+  uint32 triangleCount = indexCount / 3;
+
+  // weld vertices by exact position
+  struct PositionKey
+  {
+    float32 x, y, z;
+    bool operator==(const PositionKey& other) const { return x == other.x && y == other.y && z == other.z; }
+  };
+  struct PositionKeyHash
+  {
+    size_t operator()(const PositionKey& key) const
+    {
+      uint32 bits[3];
+      memcpy(bits, &key, sizeof(bits));
+      return (size_t)(bits[0] * 73856093u ^ bits[1] * 19349663u ^ bits[2] * 83492791u);
+    }
+  };
+  std::unordered_map<PositionKey, uint32, PositionKeyHash> positionIds;
+  std::vector<uint32> vertexPositions(vertexCount);
+  for(uint32 i = 0; i < vertexCount; i++)
+  {
+    PositionKey key = { vertices[i].Position.x, vertices[i].Position.y, vertices[i].Position.z };
+    auto inserted = positionIds.insert({ key, (uint32)(state.positions.size() / 3) });
+    if(inserted.second)
+    {
+      state.positions.push_back(key.x);
+      state.positions.push_back(key.y);
+      state.positions.push_back(key.z);
+    }
+    vertexPositions[i] = inserted.first->second;
+  }
+  uint32 positionCount = (uint32)(state.positions.size() / 3);
+
+  state.quadrics.assign(positionCount, Quadric{});
+  state.versions.assign(positionCount, 0);
+  state.removed.assign(positionCount, false);
+  state.triangles.resize(positionCount);
+  state.cornerPositions.resize(triangleCount * 3);
+  state.triangleRemoved.assign(triangleCount, false);
+
+  // corners keep their original vertex for attributes, only their position is shared
+  std::vector<uint32> cornerVertices(indices, indices + triangleCount * 3);
+
+  // face quadrics, area weighted
+  std::unordered_map<uint64, uint32> edgeUseCounts;
+  auto edgeKey = [](uint32 a, uint32 b) -> uint64 { return a < b ? ((uint64)a << 32) | b : ((uint64)b << 32) | a; };
+  uint32 liveTriangleCount = 0;
+  for(uint32 triangle = 0; triangle < triangleCount; triangle++)
+  {
+    uint32* corners = &state.cornerPositions[triangle * 3];
+    for(uint32 i = 0; i < 3; i++) { corners[i] = vertexPositions[cornerVertices[triangle * 3 + i]]; }
+    if(corners[0] == corners[1] || corners[1] == corners[2] || corners[2] == corners[0])
+    {
+      state.triangleRemoved[triangle] = true;
+      continue;
+    }
+    liveTriangleCount++;
+
+    float64 normal[3];
+    triangleNormal(&state.positions[corners[0] * 3], &state.positions[corners[1] * 3], &state.positions[corners[2] * 3], normal);
+    float64 doubleArea = sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+    if(doubleArea > 0.0)
+    {
+      float64 a = normal[0] / doubleArea, b = normal[1] / doubleArea, c = normal[2] / doubleArea;
+      const float64* p0 = &state.positions[corners[0] * 3];
+      float64 d = -(a * p0[0] + b * p0[1] + c * p0[2]);
+      for(uint32 i = 0; i < 3; i++) { addPlane(&state.quadrics[corners[i]], a, b, c, d, doubleArea * 0.5); }
+    }
+
+    for(uint32 i = 0; i < 3; i++)
+    {
+      state.triangles[corners[i]].push_back(triangle);
+      edgeUseCounts[edgeKey(corners[i], corners[(i + 1) % 3])]++;
+    }
+  }
+
+  // boundary edges get a plane perpendicular to their face so they resist moving inward
+  for(uint32 triangle = 0; triangle < triangleCount; triangle++)
+  {
+    if(state.triangleRemoved[triangle]) { continue; }
+    const uint32* corners = &state.cornerPositions[triangle * 3];
+    float64 normal[3];
+    triangleNormal(&state.positions[corners[0] * 3], &state.positions[corners[1] * 3], &state.positions[corners[2] * 3], normal);
+    for(uint32 i = 0; i < 3; i++)
+    {
+      uint32 p0 = corners[i], p1 = corners[(i + 1) % 3];
+      if(edgeUseCounts[edgeKey(p0, p1)] != 1) { continue; }
+      const float64* v0 = &state.positions[p0 * 3];
+      const float64* v1 = &state.positions[p1 * 3];
+      float64 edge[3] = { v1[0] - v0[0], v1[1] - v0[1], v1[2] - v0[2] };
+      float64 perpendicular[3];
+      cross(edge, normal, perpendicular);
+      float64 length = sqrt(perpendicular[0] * perpendicular[0] + perpendicular[1] * perpendicular[1] + perpendicular[2] * perpendicular[2]);
+      if(length <= 0.0) { continue; }
+      float64 a = perpendicular[0] / length, b = perpendicular[1] / length, c = perpendicular[2] / length;
+      float64 d = -(a * v0[0] + b * v0[1] + c * v0[2]);
+      addPlane(&state.quadrics[p0], a, b, c, d, SIMPLIFY_BOUNDARY_WEIGHT);
+      addPlane(&state.quadrics[p1], a, b, c, d, SIMPLIFY_BOUNDARY_WEIGHT);
+    }
+  }
+
+  std::priority_queue<CollapseCandidate, std::vector<CollapseCandidate>, std::greater<CollapseCandidate>> candidates;
+  for(const auto& edgeUseCount : edgeUseCounts)
+  {
+    uint32 a = (uint32)(edgeUseCount.first >> 32);
+    uint32 b = (uint32)(edgeUseCount.first & 0xFFFFFFFF);
+    candidates.push(collapseCandidate(state, a, b));
+  }
+
+  std::vector<uint32> neighbors;
+  std::vector<uint32> removeNeighbors;
+  std::vector<uint32> keepVertices;
+  while(liveTriangleCount > targetTriangleCount && !candidates.empty())
+  {
+    CollapseCandidate candidate = candidates.top();
+    candidates.pop();
+    uint32 keep = candidate.keep;
+    uint32 remove = candidate.remove;
+    if(state.removed[keep] || state.removed[remove] ||
+       state.versions[keep] != candidate.keepVersion || state.versions[remove] != candidate.removeVersion) { continue; }
+
+    if(!collapseKeepsOrientation(state, keep, remove, candidate.target) ||
+       !collapseKeepsOrientation(state, remove, keep, candidate.target) ||
+       !collapseKeepsManifold(state, keep, remove, &neighbors, &removeNeighbors)) { continue; }
+
+    keepVertices.clear();
+    for(uint32 triangle : state.triangles[keep])
+    {
+      if(state.triangleRemoved[triangle]) { continue; }
+      for(uint32 i = 0; i < 3; i++)
+      {
+        if(state.cornerPositions[triangle * 3 + i] == keep) { keepVertices.push_back(cornerVertices[triangle * 3 + i]); }
+      }
+    }
+
+    // collapse remove into keep
+    for(uint32 i = 0; i < 3; i++) { state.positions[keep * 3 + i] = candidate.target[i]; }
+    state.quadrics[keep] = addQuadrics(state.quadrics[keep], state.quadrics[remove]);
+    state.removed[remove] = true;
+    state.versions[keep]++;
+
+    for(uint32 triangle : state.triangles[remove])
+    {
+      if(state.triangleRemoved[triangle]) { continue; }
+      uint32* corners = &state.cornerPositions[triangle * 3];
+      bool touchesKeep = corners[0] == keep || corners[1] == keep || corners[2] == keep;
+      if(touchesKeep)
+      {
+        state.triangleRemoved[triangle] = true;
+        liveTriangleCount--;
+        continue;
+      }
+      for(uint32 i = 0; i < 3; i++)
+      {
+        if(corners[i] != remove) { continue; }
+        corners[i] = keep;
+        cornerVertices[triangle * 3 + i] = closestAttributeVertex(vertices, keepVertices, cornerVertices[triangle * 3 + i]);
+      }
+      state.triangles[keep].push_back(triangle);
+    }
+    state.triangles[remove].clear();
+
+    // compact keep's triangle list, then queue new costs for every edge around keep
+    // NOTE: remove's triangles that didn't touch keep can't already be in keep's list, so there are no duplicates
+    std::vector<uint32>& keepTriangles = state.triangles[keep];
+    uint32 liveCount = 0;
+    for(uint32 triangle : keepTriangles)
+    {
+      if(!state.triangleRemoved[triangle]) { keepTriangles[liveCount++] = triangle; }
+    }
+    keepTriangles.resize(liveCount);
+
+    gatherNeighbors(state, keep, &neighbors);
+    for(uint32 neighbor : neighbors) { candidates.push(collapseCandidate(state, keep, neighbor)); }
+  }
+
+  // corners that share a welded position, normal and texture coordinates share an output vertex
+  // NOTE: Assimp doesn't join identical vertices for us, so every face may come in with its own copies
+  struct OutputVertexKey
+  {
+    uint32 position;
+    float32 attributes[5];
+    bool operator==(const OutputVertexKey& other) const { return memcmp(this, &other, sizeof(OutputVertexKey)) == 0; }
+  };
+  struct OutputVertexKeyHash
+  {
+    size_t operator()(const OutputVertexKey& key) const
+    {
+      uint32 words[6];
+      memcpy(words, &key, sizeof(words));
+      uint64 hash = 14695981039346656037ull;
+      for(uint32 word : words) { hash = (hash ^ word) * 1099511628211ull; }
+      return (size_t)hash;
+    }
+  };
+  simplifiedVertices->clear();
+  simplifiedIndices->clear();
+  simplifiedIndices->reserve(liveTriangleCount * 3);
+  std::unordered_map<OutputVertexKey, uint32, OutputVertexKeyHash> outputVertices;
+  for(uint32 triangle = 0; triangle < triangleCount; triangle++)
+  {
+    if(state.triangleRemoved[triangle]) { continue; }
+    for(uint32 i = 0; i < 3; i++)
+    {
+      uint32 position = state.cornerPositions[triangle * 3 + i];
+      uint32 vertex = cornerVertices[triangle * 3 + i];
+      const Vertex& source = vertices[vertex];
+      OutputVertexKey key = { position, { source.Normal.x, source.Normal.y, source.Normal.z, source.TexCoords.x, source.TexCoords.y } };
+      auto inserted = outputVertices.insert({ key, (uint32)simplifiedVertices->size() });
+      if(inserted.second)
+      {
+        Vertex simplifiedVertex = vertices[vertex];
+        simplifiedVertex.Position = glm::vec3((float32)state.positions[position * 3],
+                                              (float32)state.positions[position * 3 + 1],
+                                              (float32)state.positions[position * 3 + 2]);
+        simplifiedVertices->push_back(simplifiedVertex);
+      }
+      simplifiedIndices->push_back(inserted.first->second);
+    }
+  }
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <vector>
+
+#include "../LearnOpenGLPlatform.h"
+#include "../Mesh.h"
+
+// NOTE: Quadric error metric edge collapse (Garland & Heckbert). Vertices that share a position are welded for the
+// NOTE: collapse so that normal and UV seams don't tear open, each surviving corner keeps its original vertex's
+// NOTE: normal and texture coordinates at its new position. Collapses that would flip a triangle are rejected.
+// NOTE: Safe to call from worker threads.
+void simplifyMesh(const Vertex* vertices, uint32 vertexCount, const uint32* indices, uint32 indexCount,
+                  uint32 targetTriangleCount, std::vector<Vertex>* simplifiedVertices, std::vector<uint32>* simplifiedIndices);
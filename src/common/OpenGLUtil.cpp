@@ -4,6 +4,12 @@
 #include <iostream>
 #include <windows.h>
 #include <time.h>
+#include <cstring>
+#include <fstream>
+
+#include "glExtensions.h"
+#include "WindowsFileHelper.h"
+#include "GLState.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb/stb_image.h>
@@ -44,8 +50,7 @@ void snapshot(Framebuffer* framebuffer)
   bitmapInfoHeader.biClrUsed = 0;
   bitmapInfoHeader.biClrImportant = 0;
 
-  GLint originalReadFramebuffer;
-  glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &originalReadFramebuffer);
+  uint32 originalReadFramebuffer = glStateBoundFramebuffer(GL_READ_FRAMEBUFFER);
   glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer->id);
   glReadPixels((GLint)0, (GLint)0,
                (GLint)framebuffer->extent.width, (GLint)framebuffer->extent.height,
@@ -60,86 +65,288 @@ void snapshot(Framebuffer* framebuffer)
   free(bmpBuffer);
 }
 
-void load2DTexture(const char* imgLocation, uint32& textureId, bool flipImageVert, bool inputSRGB, uint32* width, uint32* height)
+bool load2DTexture(const char* imgLocation, uint32& textureId, bool flipImageVert, bool inputSRGB, uint32* width, uint32* height)
 {
-  glGenTextures(1, &textureId);
-  glBindTexture(GL_TEXTURE_2D, textureId);
+  BakedTexture bakedTexture;
+  if(readBakedTexture(imgLocation, flipImageVert, inputSRGB, &bakedTexture))
+  {
+    glGenTextures(1, &textureId);
+    fillBaked2DTexture(textureId, bakedTexture.header, bakedTexture.data, inputSRGB);
+    if (width != NULL) *width = bakedTexture.header.mips[0].width;
+    if (height != NULL) *height = bakedTexture.header.mips[0].height;
+    freeBakedTexture(&bakedTexture);
+    return true;
+  }
 
-  // load image data
-  int w, h, numChannels;
-  stbi_set_flip_vertically_on_load(flipImageVert);
-  unsigned char* data = stbi_load(imgLocation, &w, &h, &numChannels, 0 /*desired channels*/);
-  if (data && numChannels <= 4)
+  DecodedImage image;
+  if(!decode2DImage(imgLocation, flipImageVert, &image))
   {
-    uint32 dataColorSpace;
-    uint32 dataComponentComposition;
-    if (numChannels == 3)
-    {
-      dataColorSpace = inputSRGB ? GL_SRGB : GL_RGB;
-      dataComponentComposition = GL_RGB;
-    } else if(numChannels == 4)
+    textureId = 0;
+    return false;
+  }
+  upload2DTexture(image, textureId, inputSRGB);
+  if (width != NULL) *width = image.width;
+  if (height != NULL) *height = image.height;
+  freeDecodedImage(&image);
+  return true;
+}
+
+// NOTE: stb_image's flip setting is global, it is always left off and images are flipped here instead so that
+// NOTE: decoding is safe from worker threads
+bool decode2DImage(const char* imgLocation, bool flipImageVert, DecodedImage* image)
+{
+  int w = 0, h = 0, numChannels = 0; // NOTE: stbi_load() leaves these untouched when it fails
+  image->data = stbi_load(imgLocation, &w, &h, &numChannels, 0 /*desired channels*/);
+  if (image->data == NULL)
+  {
+    image->width = image->height = image->channelCount = 0;
+    std::cout << "ERROR::TEXTURE::DECODE_FAILED: " << imgLocation << " (" << stbi_failure_reason() << ")" << std::endl;
+    return false;
+  }
+  image->width = w;
+  image->height = h;
+  image->channelCount = numChannels;
+
+  if (flipImageVert)
+  {
+    uint32 rowSize = image->width * image->channelCount;
+    uint8* rowSwap = new uint8[rowSize];
+    for (uint32 row = 0; row < image->height / 2; row++)
     {
-      dataColorSpace = inputSRGB ? GL_SRGB_ALPHA : GL_RGBA;
-      dataComponentComposition = GL_RGBA;
-    } else if(numChannels == 1) {
-      dataColorSpace = dataComponentComposition = GL_RED;
-    } else if(numChannels == 2) {
-      dataColorSpace = dataComponentComposition = GL_RG;
+      uint8* topRow = image->data + (row * rowSize);
+      uint8* bottomRow = image->data + ((image->height - 1 - row) * rowSize);
+      memcpy(rowSwap, topRow, rowSize);
+      memcpy(topRow, bottomRow, rowSize);
+      memcpy(bottomRow, rowSwap, rowSize);
     }
+    delete[] rowSwap;
+  }
+  return true;
+}
 
-    glTexImage2D(GL_TEXTURE_2D, // target
-                 0, // level of detail (level n is the nth mipmap reduction image)
-                 dataColorSpace, // What is the color space of the data
-                 w, // width of texture
-                 h, // height of texture
-                 0, // border (legacy stuff, MUST BE 0)
-                 dataComponentComposition, // How are the components of the data composed
-                 GL_UNSIGNED_BYTE, // specifies data type of pixel data
-                 data); // pointer to the image data
-    glGenerateMipmap(GL_TEXTURE_2D);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-
-    // set texture options
-    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST); // disables bilinear filtering (creates sharp edges when magnifying texture)
-
-    if (width != NULL) *width = w;
-    if (height != NULL) *height = h;
+void freeDecodedImage(DecodedImage* image)
+{
+  stbi_image_free(image->data); // free texture image memory
+  image->data = NULL;
+}
+
+void upload2DTexture(const DecodedImage& image, uint32& textureId, bool inputSRGB)
+{
+  glGenTextures(1, &textureId);
+
+  if (image.data && image.channelCount <= 4)
+  {
+    fill2DTexture(textureId, image.width, image.height, image.channelCount, image.data, inputSRGB);
   } else
   {
+    glBindTexture(GL_TEXTURE_2D, textureId);
     std::cout << "Failed to load texture" << std::endl;
   }
-  stbi_image_free(data); // free texture image memory
 }
 
-void loadCubeMapTexture(const char* const imgLocations[6], uint32& textureId, bool flipImageVert)
+// NOTE: pixels is an offset into the buffer when a GL_PIXEL_UNPACK_BUFFER is bound
+void fill2DTexture(uint32 textureId, uint32 width, uint32 height, uint32 numChannels, const void* pixels, bool inputSRGB)
+{
+  glBindTexture(GL_TEXTURE_2D, textureId);
+
+  uint32 dataColorSpace;
+  uint32 dataComponentComposition;
+  if (numChannels == 3)
+  {
+    dataColorSpace = inputSRGB ? GL_SRGB8 : GL_RGB;
+    dataComponentComposition = GL_RGB;
+  } else if(numChannels == 4)
+  {
+    dataColorSpace = inputSRGB ? GL_SRGB8_ALPHA8 : GL_RGBA;
+    dataComponentComposition = GL_RGBA;
+  } else if(numChannels == 1) {
+    dataColorSpace = dataComponentComposition = GL_RED;
+  } else if(numChannels == 2) {
+    dataColorSpace = dataComponentComposition = GL_RG;
+  }
+
+  glTexImage2D(GL_TEXTURE_2D, // target
+               0, // level of detail (level n is the nth mipmap reduction image)
+               dataColorSpace, // What is the color space of the data
+               width, // width of texture
+               height, // height of texture
+               0, // border (legacy stuff, MUST BE 0)
+               dataComponentComposition, // How are the components of the data composed
+               GL_UNSIGNED_BYTE, // specifies data type of pixel data
+               pixels); // pointer to the image data
+  glGenerateMipmap(GL_TEXTURE_2D);
+
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+
+  // set texture options
+  glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST); // disables bilinear filtering (creates sharp edges when magnifying texture)
+}
+
+uint64 texture2DGpuBytes(uint32 width, uint32 height, uint32 channelCount)
+{
+  uint64 baseLevelBytes = (uint64)width * height * channelCount;
+  return baseLevelBytes + (baseLevelBytes / 3);
+}
+
+file_access bool bakedTextureFormatSupported(uint32 format, bool inputSRGB)
+{
+  switch(format)
+  {
+    case BakedTextureFormat_BC1:
+    case BakedTextureFormat_BC3:
+      return inputSRGB ? glExtensions.textureCompressionS3TCSRGB : glExtensions.textureCompressionS3TC;
+    case BakedTextureFormat_BC7:
+      return glExtensions.textureCompressionBPTC;
+    default:
+      return format <= BakedTextureFormat_BC5;
+  }
+}
+
+bool readBakedTexture(const char* imgLocation, bool flipImageVert, bool inputSRGB, BakedTexture* bakedTexture)
+{
+  bakedTexture->data = NULL;
+
+  std::string bakedLocation = bakedTextureLocation(imgLocation, flipImageVert);
+  std::ifstream bakedFile(bakedLocation, std::ios::binary);
+  if(!bakedFile.is_open()) { return false; }
+  // NOTE: an image edited since it was baked is decoded until it is baked again
+  if(getFileLastWriteTimestamp(bakedLocation.c_str()) < getFileLastWriteTimestamp(imgLocation))
+  {
+    std::cout << "ERROR::BAKED_TEXTURE::STALE_FILE for " << imgLocation << std::endl;
+    return false;
+  }
+
+  BakedTextureHeader& header = bakedTexture->header;
+  bakedFile.read((char*)&header, sizeof(header));
+  if(!bakedFile || header.identifier != BAKED_TEXTURE_IDENTIFIER || header.version != BAKED_TEXTURE_VERSION ||
+     header.mipCount == 0 || header.mipCount > BAKED_TEXTURE_MAX_MIP_COUNT)
+  {
+    std::cout << "ERROR::BAKED_TEXTURE::INVALID_FILE for " << imgLocation << std::endl;
+    return false;
+  }
+  // NOTE: a stale or truncated file must never have its mips read past the end of the data
+  bool mipsInBounds = true;
+  for(uint32 i = 0; i < header.mipCount; ++i)
+  {
+    const BakedTextureMip& mip = header.mips[i];
+    if((uint64)mip.offset + mip.size > header.dataSize) { mipsInBounds = false; }
+  }
+  std::streamoff dataStart = bakedFile.tellg();
+  bakedFile.seekg(0, std::ios::end);
+  std::streamoff fileSize = bakedFile.tellg();
+  bakedFile.seekg(dataStart);
+  if(!mipsInBounds || !bakedFile || fileSize - dataStart < (std::streamoff)header.dataSize)
+  {
+    std::cout << "ERROR::BAKED_TEXTURE::TRUNCATED_FILE for " << imgLocation << std::endl;
+    return false;
+  }
+  if(!bakedTextureFormatSupported(header.format, inputSRGB)) { return false; }
+
+  bakedTexture->data = new uint8[header.dataSize];
+  bakedFile.read((char*)bakedTexture->data, header.dataSize);
+  if(!bakedFile)
+  {
+    std::cout << "ERROR::BAKED_TEXTURE::TRUNCATED_FILE for " << imgLocation << std::endl;
+    freeBakedTexture(bakedTexture);
+    return false;
+  }
+  return true;
+}
+
+void freeBakedTexture(BakedTexture* bakedTexture)
+{
+  delete[] bakedTexture->data;
+  bakedTexture->data = NULL;
+}
+
+void fillBaked2DTexture(uint32 textureId, const BakedTextureHeader& header, const uint8* mipData, bool inputSRGB)
+{
+  glBindTexture(GL_TEXTURE_2D, textureId);
+
+  uint32 internalFormat;
+  uint32 dataComponentComposition = GL_RED;
+  switch(header.format)
+  {
+    case BakedTextureFormat_R8:
+      internalFormat = GL_R8;
+      break;
+    case BakedTextureFormat_RGB8:
+      internalFormat = inputSRGB ? GL_SRGB8 : GL_RGB8;
+      dataComponentComposition = GL_RGB;
+      break;
+    case BakedTextureFormat_RGBA8:
+      internalFormat = inputSRGB ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+      dataComponentComposition = GL_RGBA;
+      break;
+    case BakedTextureFormat_BC1:
+      internalFormat = inputSRGB ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+      break;
+    case BakedTextureFormat_BC3:
+      internalFormat = inputSRGB ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+      break;
+    case BakedTextureFormat_BC5:
+      internalFormat = GL_COMPRESSED_RG_RGTC2;
+      break;
+    case BakedTextureFormat_BC7:
+      internalFormat = inputSRGB ? GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM : GL_COMPRESSED_RGBA_BPTC_UNORM;
+      break;
+    default:
+      std::cout << "ERROR::BAKED_TEXTURE::UNKNOWN_FORMAT " << header.format << std::endl;
+      return;
+  }
+
+  // NOTE: uncompressed mips are tightly packed, the default unpack alignment of 4 breaks odd sized RGB levels
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  for(uint32 level = 0; level < header.mipCount; ++level)
+  {
+    const BakedTextureMip& mip = header.mips[level];
+    if(bakedTextureFormatCompressed(header.format))
+    {
+      glCompressedTexImage2D(GL_TEXTURE_2D, level, internalFormat, mip.width, mip.height, 0, mip.size, mipData + mip.offset);
+    } else
+    {
+      glTexImage2D(GL_TEXTURE_2D, level, internalFormat, mip.width, mip.height, 0, dataComponentComposition, GL_UNSIGNED_BYTE, mipData + mip.offset);
+    }
+  }
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, header.mipCount - 1);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+  glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+}
+
+bool loadCubeMapTexture(const char* const imgLocations[6], uint32& textureId, bool flipImageVert)
 {
   glGenTextures(1, &textureId);
   glBindTexture(GL_TEXTURE_CUBE_MAP, textureId);
 
-  int width, height, nrChannels;
-  stbi_set_flip_vertically_on_load(flipImageVert);
   for (uint32 i = 0; i < 6; i++)
   {
-    unsigned char* data = stbi_load(imgLocations[i], &width, &height, &nrChannels, 0);
-    if (data)
+    DecodedImage image;
+    if (decode2DImage(imgLocations[i], flipImageVert, &image)) // NOTE: flips without stb_image's global flag
     {
       glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,
-                   0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data
+                   0, GL_RGB, image.width, image.height, 0, GL_RGB, GL_UNSIGNED_BYTE, image.data
       );
       glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
       glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
       glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
       glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
       glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+      freeDecodedImage(&image);
     } else
     {
       std::cout << "Cubemap texture failed to load at path: " << imgLocations[i] << std::endl;
+      glDeleteTextures(1, &textureId);
+      textureId = 0;
+      return false;
     }
-    stbi_image_free(data);
   }
+  return true;
 }
 
 Framebuffer initializeFramebuffer(Extent2D framebufferExtent, FramebufferCreationFlags flags)
@@ -147,10 +354,9 @@ Framebuffer initializeFramebuffer(Extent2D framebufferExtent, FramebufferCreatio
   Framebuffer resultBuffer;
   resultBuffer.extent = framebufferExtent;
 
-  GLint originalDrawFramebuffer, originalReadFramebuffer, originalActiveTexture, originalTexture0;
-  glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &originalDrawFramebuffer);
-  glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &originalReadFramebuffer);
-  glGetIntegerv(GL_ACTIVE_TEXTURE, &originalActiveTexture);
+  uint32 originalDrawFramebuffer = glStateBoundFramebuffer(GL_DRAW_FRAMEBUFFER);
+  uint32 originalReadFramebuffer = glStateBoundFramebuffer(GL_READ_FRAMEBUFFER);
+  uint32 originalActiveTexture = glStateActiveTexture();
 
   // creating frame buffer
   glGenFramebuffers(1, &resultBuffer.id);
@@ -162,10 +368,22 @@ Framebuffer initializeFramebuffer(Extent2D framebufferExtent, FramebufferCreatio
   // NOTE: gl operations on the GL_TEXTURE_2D target will affect our texture
   // NOTE: while it is remains bound to that target
   glActiveTexture(GL_TEXTURE0);
-  glGetIntegerv(GL_TEXTURE_BINDING_2D, &originalTexture0);
+  uint32 originalTexture0 = glStateBoundTexture(GL_TEXTURE_2D);
   glBindTexture(GL_TEXTURE_2D, resultBuffer.colorAttachment);
-  GLint internalFormat = (flags & FramebufferCreate_color_sRGB) ? GL_SRGB : GL_RGB;
-  glTexImage2D(GL_TEXTURE_2D, 0/*LoD*/, internalFormat, framebufferExtent.width, framebufferExtent.height, 0/*border*/, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+  if(flags & FramebufferCreate_color_RGBA16F)
+  {
+    glTexImage2D(GL_TEXTURE_2D, 0/*LoD*/, GL_RGBA16F, framebufferExtent.width, framebufferExtent.height, 0/*border*/, GL_RGBA, GL_FLOAT, NULL);
+  } else if(flags & FramebufferCreate_color_RGBA32F)
+  {
+    glTexImage2D(GL_TEXTURE_2D, 0/*LoD*/, GL_RGBA32F, framebufferExtent.width, framebufferExtent.height, 0/*border*/, GL_RGBA, GL_FLOAT, NULL);
+  } else if(flags & FramebufferCreate_color_RG32F)
+  {
+    glTexImage2D(GL_TEXTURE_2D, 0/*LoD*/, GL_RG32F, framebufferExtent.width, framebufferExtent.height, 0/*border*/, GL_RG, GL_FLOAT, NULL);
+  } else
+  {
+    GLint internalFormat = (flags & FramebufferCreate_color_sRGB) ? GL_SRGB : GL_RGB;
+    glTexImage2D(GL_TEXTURE_2D, 0/*LoD*/, internalFormat, framebufferExtent.width, framebufferExtent.height, 0/*border*/, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+  }
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
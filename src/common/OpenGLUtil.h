@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../LearnOpenGLPlatform.h"
+#include "BakedTexture.h"
 
 #define NO_FRAMEBUFFER_ATTACHMENT 0
 
@@ -15,10 +16,41 @@ enum FramebufferCreationFlags {
   FramebufferCreate_NoValue = 0,
   FramebufferCreate_NoDepthStencil = 1 << 0,
   FramebufferCreate_color_sRGB = 1 << 1,
+  FramebufferCreate_color_RGBA16F = 1 << 2, // ex: color + a value to carry along in alpha
+  FramebufferCreate_color_RG32F = 1 << 3, // ex: full precision distances that can't afford half float rounding
+  FramebufferCreate_color_RGBA32F = 1 << 4, // ex: color + a full precision value (such as window space depth) in alpha
 };
 
-void load2DTexture(const char* imgLocation, uint32& textureId, bool flipImageVert = false, bool inputSRGB = false, uint32* width = NULL, uint32* height = NULL);
-void loadCubeMapTexture(const char* const imgLocations[6], uint32& textureId, bool flipImageVert = false);
+struct DecodedImage {
+  uint8* data;
+  uint32 width;
+  uint32 height;
+  uint32 channelCount;
+};
+
+// Returns false and sets textureId to 0 when the image can't be read
+bool load2DTexture(const char* imgLocation, uint32& textureId, bool flipImageVert = false, bool inputSRGB = false, uint32* width = NULL, uint32* height = NULL);
+// load2DTexture() split in two, decode2DImage() may be called from worker threads, it returns false (and a zeroed
+// image) when the image can't be read
+bool decode2DImage(const char* imgLocation, bool flipImageVert, DecodedImage* image);
+void upload2DTexture(const DecodedImage& image, uint32& textureId, bool inputSRGB = false);
+void freeDecodedImage(DecodedImage* image);
+void fill2DTexture(uint32 textureId, uint32 width, uint32 height, uint32 numChannels, const void* pixels, bool inputSRGB = false);
+// Textures baked by tools/TextureBaker, load2DTexture() prefers them over the source image when present
+struct BakedTexture {
+  BakedTextureHeader header;
+  uint8* data; // every mip level, see BakedTextureHeader::mips
+};
+// Returns false if there is no baked file, it is older than the image or the driver can't sample its format (in sRGB
+// when inputSRGB), may be called from worker threads
+bool readBakedTexture(const char* imgLocation, bool flipImageVert, bool inputSRGB, BakedTexture* bakedTexture);
+// NOTE: mipData is an offset into the buffer when a GL_PIXEL_UNPACK_BUFFER is bound
+void fillBaked2DTexture(uint32 textureId, const BakedTextureHeader& header, const uint8* mipData, bool inputSRGB = false);
+void freeBakedTexture(BakedTexture* bakedTexture);
+// NOTE: Assumes 8 bits per channel, a full mip chain adds a third on top of the base level
+uint64 texture2DGpuBytes(uint32 width, uint32 height, uint32 channelCount);
+// Returns false (and texture 0) if any face fails to load
+bool loadCubeMapTexture(const char* const imgLocations[6], uint32& textureId, bool flipImageVert = false);
 Framebuffer initializeFramebuffer(Extent2D framebufferExtent, FramebufferCreationFlags flags = FramebufferCreate_NoValue);
 void deleteFramebuffer(Framebuffer* framebuffer);
 void deleteFramebuffers(uint32 count, Framebuffer** framebuffer);
@@ -0,0 +1,233 @@
+#include "Profiler.h"
+
+#include <glad/glad.h>
+#include <imgui/imgui.h>
+#include <chrono>
+#include <string>
+#include <cstring>
+
+#define PROFILER_SMOOTHING 0.9 // weight given to the previous result when the zones match frame to frame
+
+struct ProfileZone
+{
+  const char* name;
+  uint32 depth;
+  uint64 cpuBeginNs;
+  uint64 cpuEndNs;
+};
+
+struct ProfileFrame
+{
+  ProfileZone zones[PROFILER_MAX_ZONES];
+  uint32 zoneCount;
+  bool pending; // timestamps issued but not yet read back
+};
+
+file_access ProfileFrame profileFrames[PROFILER_FRAME_LATENCY];
+file_access uint32 timestampQueries[PROFILER_FRAME_LATENCY][PROFILER_MAX_ZONES * 2]; // begin & end per zone
+file_access bool queriesGenerated = false;
+file_access uint32 frameIndex = 0;
+file_access bool frameActive = false;
+file_access uint32 openZones[PROFILER_MAX_ZONES];
+file_access uint32 openZoneCount = 0;
+file_access ProfileZoneResult results[PROFILER_MAX_ZONES];
+file_access uint32 resultCount = 0;
+file_access uint64 droppedFrameCount = 0;
+
+file_access uint64 cpuNanoseconds()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+file_access float64 smooth(float64 previous, float64 latest, bool matches)
+{
+  return matches ? (previous * PROFILER_SMOOTHING) + (latest * (1.0 - PROFILER_SMOOTHING)) : latest;
+}
+
+file_access void collectFrame(ProfileFrame& frame, const uint32* queries)
+{
+  if(!frame.pending) { return; }
+  frame.pending = false;
+
+  // NOTE: The frame zone's end timestamp is the last one issued and queries complete in order
+  GLint available = 0;
+  glGetQueryObjectiv(queries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+  if(!available)
+  {
+    droppedFrameCount++;
+    return;
+  }
+
+  bool matchesResults = frame.zoneCount == resultCount;
+  GLuint64 frameGpuBeginNs;
+  glGetQueryObjectui64v(queries[0], GL_QUERY_RESULT, &frameGpuBeginNs);
+  uint64 frameCpuBeginNs = frame.zones[0].cpuBeginNs;
+  for(uint32 i = 0; i < frame.zoneCount; ++i)
+  {
+    const ProfileZone& zone = frame.zones[i];
+    GLuint64 gpuBeginNs, gpuEndNs;
+    glGetQueryObjectui64v(queries[i * 2], GL_QUERY_RESULT, &gpuBeginNs);
+    glGetQueryObjectui64v(queries[i * 2 + 1], GL_QUERY_RESULT, &gpuEndNs);
+
+    ProfileZoneResult& result = results[i];
+    bool matches = matchesResults && result.depth == zone.depth && strcmp(result.name, zone.name) == 0;
+    result.name = zone.name;
+    result.depth = zone.depth;
+    result.cpuBeginMs = smooth(result.cpuBeginMs, (zone.cpuBeginNs - frameCpuBeginNs) / 1000000.0, matches);
+    result.cpuMs = smooth(result.cpuMs, (zone.cpuEndNs - zone.cpuBeginNs) / 1000000.0, matches);
+    result.gpuBeginMs = smooth(result.gpuBeginMs, (gpuBeginNs - frameGpuBeginNs) / 1000000.0, matches);
+    result.gpuMs = smooth(result.gpuMs, (gpuEndNs - gpuBeginNs) / 1000000.0, matches);
+  }
+  resultCount = frame.zoneCount;
+}
+
+void profilerBeginFrame()
+{
+  if(!queriesGenerated)
+  {
+    glGenQueries(PROFILER_FRAME_LATENCY * PROFILER_MAX_ZONES * 2, &timestampQueries[0][0]);
+    queriesGenerated = true;
+  }
+
+  frameIndex++;
+  uint32 frameSlot = frameIndex % PROFILER_FRAME_LATENCY;
+  collectFrame(profileFrames[frameSlot], timestampQueries[frameSlot]);
+
+  profileFrames[frameSlot].zoneCount = 0;
+  openZoneCount = 0;
+  frameActive = true;
+  profilerBeginZone("Frame");
+}
+
+void profilerEndFrame()
+{
+  if(!frameActive) { return; }
+
+  // NOTE: closes the frame zone along with anything left open
+  profilerEndZone(0);
+  profileFrames[frameIndex % PROFILER_FRAME_LATENCY].pending = true;
+  frameActive = false;
+}
+
+uint32 profilerBeginZone(const char* name)
+{
+  if(!frameActive) { return PROFILER_INVALID_ZONE; }
+
+  uint32 frameSlot = frameIndex % PROFILER_FRAME_LATENCY;
+  ProfileFrame& frame = profileFrames[frameSlot];
+  if(frame.zoneCount == PROFILER_MAX_ZONES) { return PROFILER_INVALID_ZONE; }
+
+  uint32 zoneIndex = frame.zoneCount++;
+  ProfileZone& zone = frame.zones[zoneIndex];
+  zone.name = name;
+  zone.depth = openZoneCount;
+  zone.cpuBeginNs = cpuNanoseconds();
+  zone.cpuEndNs = zone.cpuBeginNs;
+  glQueryCounter(timestampQueries[frameSlot][zoneIndex * 2], GL_TIMESTAMP);
+  openZones[openZoneCount++] = zoneIndex;
+  return zoneIndex;
+}
+
+void profilerEndZone(uint32 zone)
+{
+  if(!frameActive || zone == PROFILER_INVALID_ZONE) { return; }
+
+  // NOTE: Zones must be ended in reverse order, any inner zone left open is ended here as well
+  uint32 frameSlot = frameIndex % PROFILER_FRAME_LATENCY;
+  while(openZoneCount > 0)
+  {
+    uint32 zoneIndex = openZones[--openZoneCount];
+    profileFrames[frameSlot].zones[zoneIndex].cpuEndNs = cpuNanoseconds();
+    glQueryCounter(timestampQueries[frameSlot][zoneIndex * 2 + 1], GL_TIMESTAMP);
+    if(zoneIndex == zone) { break; }
+  }
+}
+
+void profilerReset()
+{
+  for(uint32 i = 0; i < PROFILER_FRAME_LATENCY; ++i) { profileFrames[i].pending = false; }
+  resultCount = 0;
+  droppedFrameCount = 0;
+}
+
+void deinitProfiler()
+{
+  profilerReset();
+  frameActive = false;
+  if(queriesGenerated)
+  {
+    glDeleteQueries(PROFILER_FRAME_LATENCY * PROFILER_MAX_ZONES * 2, &timestampQueries[0][0]);
+    queriesGenerated = false;
+  }
+}
+
+uint32 profilerResults(const ProfileZoneResult** zoneResults)
+{
+  *zoneResults = results;
+  return resultCount;
+}
+
+file_access void drawFlameChart(const char* label, bool gpu)
+{
+  const float32 rowHeight = ImGui::GetTextLineHeight() + 4.0f;
+  float64 frameMs = gpu ? results[0].gpuMs : results[0].cpuMs;
+  uint32 maxDepth = 0;
+  for(uint32 i = 0; i < resultCount; ++i) { if(results[i].depth > maxDepth) { maxDepth = results[i].depth; } }
+
+  ImGui::Text("%s %.3f ms", label, frameMs);
+  ImVec2 origin = ImGui::GetCursorScreenPos();
+  float32 width = ImGui::GetContentRegionAvail().x;
+  ImGui::Dummy(ImVec2(width, (maxDepth + 1) * rowHeight));
+  if(frameMs <= 0.0) { return; }
+
+  ImDrawList* drawList = ImGui::GetWindowDrawList();
+  for(uint32 i = 0; i < resultCount; ++i)
+  {
+    const ProfileZoneResult& result = results[i];
+    float64 beginMs = gpu ? result.gpuBeginMs : result.cpuBeginMs;
+    float64 durationMs = gpu ? result.gpuMs : result.cpuMs;
+    ImVec2 zoneMin = ImVec2(origin.x + (float32)(beginMs / frameMs) * width, origin.y + result.depth * rowHeight);
+    ImVec2 zoneMax = ImVec2(zoneMin.x + (float32)(durationMs / frameMs) * width, zoneMin.y + rowHeight - 1.0f);
+    if(zoneMax.x - zoneMin.x < 1.0f) { zoneMax.x = zoneMin.x + 1.0f; }
+
+    drawList->AddRectFilled(zoneMin, zoneMax, ImColor::HSV(i * 0.13f, 0.55f, 0.75f));
+    drawList->PushClipRect(zoneMin, zoneMax, true);
+    drawList->AddText(ImVec2(zoneMin.x + 2.0f, zoneMin.y + 2.0f), IM_COL32(0, 0, 0, 255), result.name);
+    drawList->PopClipRect();
+
+    if(ImGui::IsMouseHoveringRect(zoneMin, zoneMax))
+    {
+      ImGui::SetTooltip("%s\nCPU %.3f ms\nGPU %.3f ms", result.name, result.cpuMs, result.gpuMs);
+    }
+  }
+}
+
+void drawProfilerGui(const char* title)
+{
+  std::string windowTitle = std::string("Profiler - ") + title;
+  ImGui::SetNextWindowSize(ImVec2(480, 0), ImGuiCond_FirstUseEver);
+  if(ImGui::Begin(windowTitle.c_str()))
+  {
+    if(resultCount == 0)
+    {
+      ImGui::Text("Waiting on GPU results...");
+    } else
+    {
+      drawFlameChart("GPU", true);
+      drawFlameChart("CPU", false);
+
+      ImGui::Separator();
+      ImGui::Text("%-32s %10s %10s", "zone", "CPU ms", "GPU ms");
+      for(uint32 i = 0; i < resultCount; ++i)
+      {
+        const ProfileZoneResult& result = results[i];
+        ImGui::Text("%*s%-*s %10.3f %10.3f", result.depth * 2, "", 32 - (int32)(result.depth * 2), result.name, result.cpuMs, result.gpuMs);
+      }
+    }
+    if(droppedFrameCount > 0)
+    {
+      ImGui::Text("%llu frames skipped, GPU results weren't ready in time", (unsigned long long)droppedFrameCount);
+    }
+  }
+  ImGui::End();
+}
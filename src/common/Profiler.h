@@ -0,0 +1,45 @@
+#pragma once
+
+#include "../LearnOpenGLPlatform.h"
+
+// NOTE: Nested CPU + GPU timing zones. GPU times come from GL_TIMESTAMP queries since GL_TIME_ELAPSED queries can't
+// NOTE: be nested. Query results are read PROFILER_FRAME_LATENCY frames later and only if they are already
+// NOTE: available, a frame whose results aren't ready yet is dropped rather than waited on.
+// NOTE: Zones opened outside of profilerBeginFrame()/profilerEndFrame() are ignored.
+#define PROFILER_FRAME_LATENCY 3
+#define PROFILER_MAX_ZONES 64
+#define PROFILER_INVALID_ZONE UINT32_MAX
+
+struct ProfileZoneResult
+{
+  const char* name;
+  uint32 depth;
+  float64 cpuBeginMs; // relative to the start of the frame
+  float64 cpuMs;
+  float64 gpuBeginMs; // relative to the start of the frame
+  float64 gpuMs;
+};
+
+void profilerBeginFrame();
+void profilerEndFrame();
+// NOTE: name must outlive the frame (string literals, Scene::title())
+uint32 profilerBeginZone(const char* name);
+void profilerEndZone(uint32 zone);
+// Forget results, ex: when switching scenes
+void profilerReset();
+void deinitProfiler();
+
+// Most recent frame with GPU results, smoothed over a few frames
+uint32 profilerResults(const ProfileZoneResult** results);
+void drawProfilerGui(const char* title);
+
+struct ProfileScope
+{
+  uint32 zone;
+  ProfileScope(const char* name) { zone = profilerBeginZone(name); }
+  ~ProfileScope() { profilerEndZone(zone); }
+};
+
+#define PROFILE_SCOPE_NAME_(line) profileScope##line
+#define PROFILE_SCOPE_NAME(line) PROFILE_SCOPE_NAME_(line)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_SCOPE_NAME(__LINE__)(name)
@@ -0,0 +1,142 @@
+#include "RenderQueue.h"
+
+#define RENDER_KEY_DEPTH_MAX 0xFFFFFF // 24 bits
+
+// program, vertex array & textures packed into 36 bits. GL names are small integers handed out in order, so the low
+// bits of each keep packets using the same objects together. Collisions only cost a state change, never correctness.
+file_access uint64 stateKey(const RenderPacket& packet)
+{
+  uint32 textureHash = 0;
+  for(uint32 i = 0; i < packet.textureCount; ++i)
+  {
+    textureHash = (textureHash * 31) + packet.textures[i].id;
+  }
+  if(packet.material != NULL)
+  {
+    for(uint32 i = 0; i < packet.material->count; ++i)
+    {
+      textureHash = (textureHash * 31) + packet.material->bindings[i].textureId;
+    }
+  }
+  textureHash = (textureHash ^ (textureHash >> 16)) & 0xFFFF;
+
+  uint64 program = packet.shader->ID & 0x3FF;
+  uint64 vertexArray = packet.vertexArray & 0x3FF;
+  return (program << 26) | (vertexArray << 16) | (uint64)textureHash;
+}
+
+file_access void drawPacket(const RenderPacket& packet)
+{
+  if(packet.multiDrawCount == 0)
+  {
+    glDrawElementsBaseVertex(GL_TRIANGLES, packet.indexCount, GL_UNSIGNED_INT, packet.indexOffset, packet.baseVertex);
+  } else
+  {
+    glMultiDrawElementsBaseVertex(GL_TRIANGLES, packet.indexCounts, GL_UNSIGNED_INT, packet.indexOffsets,
+                                  packet.multiDrawCount, packet.baseVertices);
+  }
+}
+
+void RenderQueue::begin(const glm::vec3& cameraPosition, float32 farPlane)
+{
+  this->cameraPosition = cameraPosition;
+  depthScale = (float32)RENDER_KEY_DEPTH_MAX / farPlane;
+  packets.clear();
+  sortItems.clear();
+}
+
+void RenderQueue::submit(RenderLayer layer, const glm::vec3& position, const RenderPacket& packet)
+{
+  float32 distance = glm::length(position - cameraPosition) * depthScale;
+  uint64 depth = distance < (float32)RENDER_KEY_DEPTH_MAX ? (uint64)distance : RENDER_KEY_DEPTH_MAX;
+
+  uint64 key = (uint64)layer << 62;
+  if(layer == RenderLayer_Transparent)
+  {
+    key |= (RENDER_KEY_DEPTH_MAX - depth) << 38;
+    key |= stateKey(packet) << 2;
+  } else
+  {
+    key |= stateKey(packet) << 26;
+    key |= depth << 2;
+  }
+
+  sortItems.push_back({ key, (uint32)packets.size() });
+  packets.push_back(packet);
+}
+
+// LSD radix sort on 8 bit digits, stable so packets with equal keys keep their submission order. Digits that every key
+// shares (ex: the unused low bits, the layer bits of a single layer frame) are skipped.
+void RenderQueue::sort()
+{
+  uint32 count = (uint32)sortItems.size();
+  sortScratch.resize(count);
+  SortItem* source = sortItems.data();
+  SortItem* destination = sortScratch.data();
+
+  for(uint32 shift = 0; shift < 64; shift += 8)
+  {
+    uint32 offsets[256] = {};
+    for(uint32 i = 0; i < count; ++i)
+    {
+      offsets[(source[i].key >> shift) & 0xFF]++;
+    }
+    if(offsets[(source[0].key >> shift) & 0xFF] == count) { continue; }
+
+    uint32 offset = 0;
+    for(uint32 digit = 0; digit < 256; ++digit)
+    {
+      uint32 digitCount = offsets[digit];
+      offsets[digit] = offset;
+      offset += digitCount;
+    }
+    for(uint32 i = 0; i < count; ++i)
+    {
+      destination[offsets[(source[i].key >> shift) & 0xFF]++] = source[i];
+    }
+
+    SortItem* swap = source;
+    source = destination;
+    destination = swap;
+  }
+
+  if(source != sortItems.data()) { sortItems.swap(sortScratch); }
+}
+
+void RenderQueue::execute()
+{
+  programSwitches = 0;
+  if(sortItems.empty()) { return; }
+  sort();
+
+  ShaderProgram* currentShader = NULL;
+  for(const SortItem& item : sortItems)
+  {
+    const RenderPacket& packet = packets[item.packet];
+    if(packet.shader != currentShader)
+    {
+      packet.shader->use();
+      currentShader = packet.shader;
+      programSwitches++;
+    }
+
+    // NOTE: redundant binds are filtered by the GL state cache
+    glBindVertexArray(packet.vertexArray);
+    for(uint32 i = 0; i < packet.textureCount; ++i)
+    {
+      glActiveTexture(GL_TEXTURE0 + packet.textures[i].unit);
+      glBindTexture(packet.textures[i].target, packet.textures[i].id);
+    }
+    if(packet.material != NULL) { bindMaterial(*packet.shader, *packet.material); }
+    if(packet.flags & RenderPacketFlag_ModelMatrix) { packet.shader->setUniform(packet.modelUniform, packet.model); }
+    glStencilMask((packet.flags & RenderPacketFlag_WriteStencil) ? 0xFF : 0x00);
+
+    if(packet.flags & RenderPacketFlag_BackFacesFirst)
+    {
+      glCullFace(GL_FRONT);
+      drawPacket(packet);
+      glCullFace(GL_BACK);
+    }
+    drawPacket(packet);
+  }
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "../Mesh.h"
+#include "../ShaderProgram.h"
+#include "../LearnOpenGLPlatform.h"
+
+// NOTE: Scenes submit draw packets during drawFrame() instead of issuing the draws, execute() then radix sorts the
+// NOTE: packets by a 64 bit state key and issues them all in one pass. The key orders by layer first, opaque packets
+// NOTE: are then grouped by program, vertex array and textures and drawn front to back within a group, transparent
+// NOTE: packets are drawn back to front. Packets with equal keys keep their submission order.
+// NOTE: Key, high to low bits:
+// NOTE:   opaque/background/overlay: layer (2) | program (10) | vertex array (10) | textures (16) | depth (24) | unused (2)
+// NOTE:   transparent:       layer (2) | inverted depth (24) | program (10) | vertex array (10) | textures (16) | unused (2)
+// NOTE: State that isn't in a packet (blend, depth test, framebuffer, uniforms shared by every draw of a program) is
+// NOTE: set by the scene before execute(). Program uniforms are only written while the program is in use, so set the
+// NOTE: per frame uniforms of every submitted program before calling execute().
+#define RENDER_PACKET_MAX_TEXTURES 4
+
+enum RenderLayer {
+  RenderLayer_Opaque = 0, // front to back
+  RenderLayer_Background, // ex: skybox, after the opaque packets so the depth test rejects most of it
+  RenderLayer_Transparent, // back to front
+  RenderLayer_Overlay, // ordered like opaque, for packets that must be depth tested against the transparent packets
+  RenderLayer_Count
+};
+
+enum RenderPacketFlags {
+  RenderPacketFlag_ModelMatrix = 1 << 0, // sets modelUniform to model
+  RenderPacketFlag_BackFacesFirst = 1 << 1, // draws with GL_FRONT culled then with GL_BACK culled (closed transparent meshes)
+  RenderPacketFlag_WriteStencil = 1 << 2 // glStencilMask(0xFF) for the draw, packets otherwise draw with glStencilMask(0x00)
+};
+
+struct RenderTexture
+{
+  GLenum target;
+  uint32 id;
+  uint32 unit;
+};
+
+struct RenderPacket
+{
+  ShaderProgram* shader;
+  uint32 vertexArray;
+  uint32 flags;
+
+  uint32 textureCount;
+  RenderTexture textures[RENDER_PACKET_MAX_TEXTURES];
+  const MaterialBindingTable* material; // optional, bound after textures
+
+  UniformHandle modelUniform;
+  glm::mat4 model;
+
+  // a single glDrawElementsBaseVertex() of the packet's indices when multiDrawCount is 0, otherwise a
+  // glMultiDrawElementsBaseVertex() of the arrays (owned by the submitter, must outlive execute())
+  GLsizei indexCount;
+  const void* indexOffset;
+  GLint baseVertex;
+  GLsizei multiDrawCount;
+  const GLsizei* indexCounts;
+  const void* const* indexOffsets;
+  const GLint* baseVertices;
+};
+
+class RenderQueue
+{
+public:
+  // Clears the previous frame's packets. Depth is the distance from cameraPosition, quantized over [0, farPlane]
+  void begin(const glm::vec3& cameraPosition, float32 farPlane);
+  // position is the world space point the packet is depth sorted by (ex: the center of the mesh)
+  void submit(RenderLayer layer, const glm::vec3& position, const RenderPacket& packet);
+  void execute();
+  uint32 packetCount() const { return (uint32)packets.size(); }
+  uint32 lastProgramSwitches() const { return programSwitches; }
+
+private:
+  struct SortItem
+  {
+    uint64 key;
+    uint32 packet;
+  };
+
+  glm::vec3 cameraPosition = glm::vec3(0.0f);
+  float32 depthScale = 0.0f;
+  uint32 programSwitches = 0;
+
+  std::vector<RenderPacket> packets;
+  std::vector<SortItem> sortItems;
+  std::vector<SortItem> sortScratch;
+
+  void sort();
+};
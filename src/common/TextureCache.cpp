@@ -0,0 +1,258 @@
+#include "TextureCache.h"
+
+#include <glad/glad.h>
+#include <unordered_map>
+#include <list>
+#include <string>
+#include <iostream>
+
+#include "TextureStreamer.h"
+
+enum TextureCacheKeyFlags {
+  TextureCacheKey_NoValue = 0,
+  TextureCacheKey_FlipVertical = 1 << 0,
+  TextureCacheKey_sRGB = 1 << 1,
+  TextureCacheKey_CubeMap = 1 << 2,
+};
+
+struct TextureCacheEntry
+{
+  uint32 id;
+  uint32 width;
+  uint32 height;
+  uint64 gpuBytes;
+  uint32 referenceCount;
+  bool failed; // streamed image failed to load, deleted as soon as it is no longer referenced
+  std::list<std::string>::iterator unreferencedPosition; // only valid when referenceCount == 0
+};
+
+file_access std::unordered_map<std::string, TextureCacheEntry> textureCache;
+file_access std::unordered_map<uint32, std::string> textureCacheKeysById;
+file_access std::list<std::string> unreferencedKeys; // most recently released at the front
+file_access uint64 residentBytes = 0;
+file_access uint64 budgetBytes = TEXTURE_CACHE_DEFAULT_BUDGET_BYTES;
+
+// ex: "2|src/data/flower.png" for an sRGB 2D texture
+file_access std::string textureCacheKey(const char* const* imgLocations, uint32 imgCount, uint32 flags)
+{
+  std::string key = std::to_string(flags);
+  for(uint32 i = 0; i < imgCount; ++i)
+  {
+    key += '|';
+    key += imgLocations[i];
+  }
+  return key;
+}
+
+file_access uint32 textureCacheKeyFlags(bool flipImageVert, bool inputSRGB)
+{
+  return (flipImageVert ? TextureCacheKey_FlipVertical : 0) | (inputSRGB ? TextureCacheKey_sRGB : 0);
+}
+
+// NOTE: the entry must already be out of unreferencedKeys
+file_access void deleteTexture(std::unordered_map<std::string, TextureCacheEntry>::iterator cached)
+{
+  cancelTextureStream(cached->second.id);
+  glDeleteTextures(1, &cached->second.id);
+  residentBytes -= cached->second.gpuBytes;
+  textureCacheKeysById.erase(cached->second.id);
+  textureCache.erase(cached);
+}
+
+file_access void evictUnreferencedTextures()
+{
+  while(residentBytes > budgetBytes && !unreferencedKeys.empty())
+  {
+    std::unordered_map<std::string, TextureCacheEntry>::iterator leastRecentlyUsed = textureCache.find(unreferencedKeys.back());
+    unreferencedKeys.pop_back();
+    deleteTexture(leastRecentlyUsed);
+  }
+}
+
+file_access bool acquireCachedTexture(const std::string& key, uint32& textureId, uint32* width, uint32* height)
+{
+  std::unordered_map<std::string, TextureCacheEntry>::iterator cached = textureCache.find(key);
+  if(cached == textureCache.end()) { return false; }
+
+  TextureCacheEntry& entry = cached->second;
+  if(entry.referenceCount == 0) { unreferencedKeys.erase(entry.unreferencedPosition); }
+  entry.referenceCount++;
+
+  textureId = entry.id;
+  if(width != NULL) { *width = entry.width; }
+  if(height != NULL) { *height = entry.height; }
+  return true;
+}
+
+file_access void addTexture(const std::string& key, uint32 textureId, uint32 width, uint32 height, uint64 gpuBytes)
+{
+  TextureCacheEntry entry = {};
+  entry.id = textureId;
+  entry.width = width;
+  entry.height = height;
+  entry.gpuBytes = gpuBytes;
+  entry.referenceCount = 1;
+  textureCache[key] = entry;
+  textureCacheKeysById[textureId] = key;
+  residentBytes += gpuBytes;
+
+  // NOTE: Referenced textures are never evicted, but adding one may push the unreferenced ones out
+  evictUnreferencedTextures();
+}
+
+void acquire2DTexture(const char* imgLocation, uint32& textureId, bool flipImageVert, bool inputSRGB, uint32* width, uint32* height)
+{
+  std::string key = textureCacheKey(&imgLocation, 1, textureCacheKeyFlags(flipImageVert, inputSRGB));
+  if(acquireCachedTexture(key, textureId, width, height)) { return; }
+
+  BakedTexture bakedTexture;
+  if(readBakedTexture(imgLocation, flipImageVert, inputSRGB, &bakedTexture))
+  {
+    const BakedTextureMip& baseLevel = bakedTexture.header.mips[0];
+    glGenTextures(1, &textureId);
+    fillBaked2DTexture(textureId, bakedTexture.header, bakedTexture.data, inputSRGB);
+    addTexture(key, textureId, baseLevel.width, baseLevel.height, bakedTexture.header.dataSize);
+    if(width != NULL) { *width = baseLevel.width; }
+    if(height != NULL) { *height = baseLevel.height; }
+    freeBakedTexture(&bakedTexture);
+    return;
+  }
+
+  DecodedImage image;
+  if(!decode2DImage(imgLocation, flipImageVert, &image))
+  {
+    // NOTE: failures are not cached, they hand out texture 0 and are retried by the next acquire
+    std::cout << "ERROR::TEXTURE_CACHE::LOAD_FAILED " << imgLocation << std::endl;
+    textureId = 0;
+    if(width != NULL) { *width = 0; }
+    if(height != NULL) { *height = 0; }
+    return;
+  }
+  upload2DTexture(image, textureId, inputSRGB);
+  addTexture(key, textureId, image.width, image.height, texture2DGpuBytes(image.width, image.height, image.channelCount));
+  if(width != NULL) { *width = image.width; }
+  if(height != NULL) { *height = image.height; }
+  freeDecodedImage(&image);
+}
+
+void acquireCubeMapTexture(const char* const imgLocations[6], uint32& textureId, bool flipImageVert)
+{
+  std::string key = textureCacheKey(imgLocations, 6, textureCacheKeyFlags(flipImageVert, false) | TextureCacheKey_CubeMap);
+  if(acquireCachedTexture(key, textureId, NULL, NULL)) { return; }
+
+  if(!loadCubeMapTexture(imgLocations, textureId, flipImageVert))
+  {
+    // NOTE: a cube map missing faces is never cached, the next acquire retries
+    std::cout << "ERROR::TEXTURE_CACHE::LOAD_FAILED " << imgLocations[0] << " (cube map)" << std::endl;
+    return;
+  }
+  int32 width, height;
+  glGetTexLevelParameteriv(GL_TEXTURE_CUBE_MAP_POSITIVE_X, 0, GL_TEXTURE_WIDTH, &width);
+  glGetTexLevelParameteriv(GL_TEXTURE_CUBE_MAP_POSITIVE_X, 0, GL_TEXTURE_HEIGHT, &height);
+  const uint32 bytesPerPixel = 3; // NOTE: loadCubeMapTexture() always uploads GL_RGB without mips
+  addTexture(key, textureId, width, height, 6ull * width * height * bytesPerPixel);
+}
+
+bool acquireCached2DTexture(const char* imgLocation, uint32& textureId, bool flipImageVert, bool inputSRGB)
+{
+  std::string key = textureCacheKey(&imgLocation, 1, textureCacheKeyFlags(flipImageVert, inputSRGB));
+  return acquireCachedTexture(key, textureId, NULL, NULL);
+}
+
+void add2DTexture(const char* imgLocation, const DecodedImage& image, uint32& textureId, bool flipImageVert, bool inputSRGB)
+{
+  if(image.data == NULL)
+  {
+    std::cout << "ERROR::TEXTURE_CACHE::LOAD_FAILED " << imgLocation << std::endl;
+    textureId = 0;
+    return;
+  }
+  std::string key = textureCacheKey(&imgLocation, 1, textureCacheKeyFlags(flipImageVert, inputSRGB));
+  upload2DTexture(image, textureId, inputSRGB);
+  addTexture(key, textureId, image.width, image.height, texture2DGpuBytes(image.width, image.height, image.channelCount));
+}
+
+// NOTE: Streamed entries are sized as their placeholder until the image lands
+file_access void onTextureStreamed(uint32 textureId, uint32 width, uint32 height, uint64 gpuBytes)
+{
+  std::unordered_map<uint32, std::string>::iterator keyById = textureCacheKeysById.find(textureId);
+  if(keyById == textureCacheKeysById.end()) { return; }
+
+  if(width == 0)
+  {
+    // NOTE: The placeholder stays alive for its holders under a key no acquire matches, so the next acquire retries
+    std::cout << "ERROR::TEXTURE_CACHE::LOAD_FAILED " << keyById->second << std::endl;
+    std::unordered_map<std::string, TextureCacheEntry>::iterator cached = textureCache.find(keyById->second);
+    TextureCacheEntry entry = cached->second;
+    textureCache.erase(cached);
+    entry.failed = true;
+    std::string failedKey = "failed|" + std::to_string(textureId);
+    keyById->second = failedKey;
+    cached = textureCache.insert({ failedKey, entry }).first;
+    if(entry.referenceCount == 0)
+    {
+      unreferencedKeys.erase(entry.unreferencedPosition);
+      deleteTexture(cached);
+    }
+    return;
+  }
+
+  TextureCacheEntry& entry = textureCache[keyById->second];
+  residentBytes = residentBytes - entry.gpuBytes + gpuBytes;
+  entry.width = width;
+  entry.height = height;
+  entry.gpuBytes = gpuBytes;
+  evictUnreferencedTextures();
+}
+
+void acquire2DTextureAsync(const char* imgLocation, uint32& textureId, bool flipImageVert, bool inputSRGB)
+{
+  std::string key = textureCacheKey(&imgLocation, 1, textureCacheKeyFlags(flipImageVert, inputSRGB));
+  if(acquireCachedTexture(key, textureId, NULL, NULL)) { return; }
+
+  setTextureStreamedCallback(onTextureStreamed);
+  stream2DTexture(imgLocation, textureId, flipImageVert, inputSRGB);
+  addTexture(key, textureId, 1, 1, texture2DGpuBytes(1, 1, 4));
+}
+
+void releaseTexture(uint32 textureId)
+{
+  if(textureId == 0) { return; } // failed loads
+  std::unordered_map<uint32, std::string>::iterator keyById = textureCacheKeysById.find(textureId);
+  if(keyById == textureCacheKeysById.end())
+  {
+    std::cout << "ERROR::TEXTURE_CACHE::RELEASED_UNKNOWN_TEXTURE " << textureId << std::endl;
+    return;
+  }
+
+  TextureCacheEntry& entry = textureCache[keyById->second];
+  Assert(entry.referenceCount > 0);
+  entry.referenceCount--;
+  if(entry.referenceCount == 0)
+  {
+    if(entry.failed)
+    {
+      deleteTexture(textureCache.find(keyById->second));
+      return;
+    }
+    unreferencedKeys.push_front(keyById->second);
+    entry.unreferencedPosition = unreferencedKeys.begin();
+    evictUnreferencedTextures();
+  }
+}
+
+void releaseTextures(uint32 count, const uint32* textureIds)
+{
+  for(uint32 i = 0; i < count; ++i) { releaseTexture(textureIds[i]); }
+}
+
+void setTextureCacheBudget(uint64 budgetInBytes)
+{
+  budgetBytes = budgetInBytes;
+  evictUnreferencedTextures();
+}
+
+uint64 textureCacheResidentBytes()
+{
+  return residentBytes;
+}
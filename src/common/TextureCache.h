@@ -0,0 +1,32 @@
+#pragma once
+
+#include "../LearnOpenGLPlatform.h"
+#include "OpenGLUtil.h"
+
+// NOTE: Process wide, reference counted texture cache keyed by image path(s) + load flags.
+// NOTE: Textures acquired here are owned by the cache, release them with releaseTextures() instead of glDeleteTextures().
+// NOTE: Textures that are no longer referenced stay resident until the cache grows past its GPU byte budget, at which
+// NOTE: point the least recently released are deleted first.
+// NOTE: Images that fail to load are not cached, they hand out texture 0 (which is safe to release). Streamed images that
+// NOTE: fail keep their placeholder for whoever acquired them, but later acquires load them again.
+#define TEXTURE_CACHE_DEFAULT_BUDGET_BYTES (512ull * 1024 * 1024)
+
+// drop-in replacements for load2DTexture() & loadCubeMapTexture()
+void acquire2DTexture(const char* imgLocation, uint32& textureId, bool flipImageVert = false, bool inputSRGB = false, uint32* width = NULL, uint32* height = NULL);
+void acquireCubeMapTexture(const char* const imgLocations[6], uint32& textureId, bool flipImageVert = false);
+// Returns immediately with a placeholder texture, the image is decoded and uploaded in the background
+// NOTE: Requires updateTextureStreaming() to be called every frame
+void acquire2DTextureAsync(const char* imgLocation, uint32& textureId, bool flipImageVert = false, bool inputSRGB = false);
+
+// For callers that decode images themselves (ex: on worker threads)
+// Returns false if the texture is not in the cache
+bool acquireCached2DTexture(const char* imgLocation, uint32& textureId, bool flipImageVert = false, bool inputSRGB = false);
+// Uploads the image and adds it to the cache with a reference count of one
+void add2DTexture(const char* imgLocation, const DecodedImage& image, uint32& textureId, bool flipImageVert = false, bool inputSRGB = false);
+
+void releaseTextures(uint32 count, const uint32* textureIds);
+void releaseTexture(uint32 textureId);
+
+// A budget of zero deletes textures as soon as they are no longer referenced
+void setTextureCacheBudget(uint64 budgetInBytes);
+uint64 textureCacheResidentBytes();
@@ -0,0 +1,267 @@
+#include "TextureStreamer.h"
+
+#include <glad/glad.h>
+#include <mutex>
+#include <deque>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <iostream>
+
+#include "OpenGLUtil.h"
+#include "WorkerPool.h"
+#include "glExtensions.h"
+#include "GLState.h"
+
+struct TextureStreamRequest
+{
+  std::string imgLocation;
+  uint32 textureId;
+  bool flipImageVert;
+  bool inputSRGB;
+  bool cancelled; // only touched on the context thread
+  BakedTexture bakedTexture; // bakedTexture.data is NULL when the image was decoded instead
+  DecodedImage image;
+};
+
+struct PixelBufferSlot
+{
+  uint32 bufferId;
+  uint8* persistentMapping; // NULL when ARB_buffer_storage is unavailable
+  GLsync uploadFence;
+};
+
+file_access bool textureStreamingInitialized = false;
+file_access PixelBufferSlot pixelBufferSlots[TEXTURE_STREAMING_PBO_COUNT];
+file_access uint32 nextPixelBufferSlot = 0;
+file_access JobCounter decodeJobs;
+file_access std::mutex decodedRequestsMutex;
+file_access std::vector<TextureStreamRequest*> decodedRequests; // filled by worker threads
+file_access std::deque<TextureStreamRequest*> uploadQueue; // decoded and waiting on a free pixel buffer
+file_access std::vector<TextureStreamRequest*> inFlightRequests; // every request that hasn't been uploaded yet
+file_access TextureStreamedCallback textureStreamedCallback = NULL;
+
+file_access void initTextureStreaming()
+{
+  for(uint32 i = 0; i < TEXTURE_STREAMING_PBO_COUNT; ++i)
+  {
+    PixelBufferSlot& slot = pixelBufferSlots[i];
+    glGenBuffers(1, &slot.bufferId);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.bufferId);
+    if(glExtensions.bufferStorage)
+    {
+      GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+      glBufferStorage(GL_PIXEL_UNPACK_BUFFER, TEXTURE_STREAMING_PBO_SIZE, NULL, flags);
+      slot.persistentMapping = (uint8*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, TEXTURE_STREAMING_PBO_SIZE, flags);
+      if(slot.persistentMapping == NULL)
+      {
+        // NOTE: the storage is immutable, recreate the buffer so the glBufferData() path below can be used
+        std::cout << "ERROR::TEXTURE_STREAMER::PERSISTENT_MAPPING_FAILED" << std::endl;
+        glDeleteBuffers(1, &slot.bufferId);
+        glGenBuffers(1, &slot.bufferId);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.bufferId);
+      }
+    } else
+    {
+      slot.persistentMapping = NULL;
+    }
+    if(slot.persistentMapping == NULL)
+    {
+      glBufferData(GL_PIXEL_UNPACK_BUFFER, TEXTURE_STREAMING_PBO_SIZE, NULL, GL_STREAM_DRAW);
+    }
+    slot.uploadFence = NULL;
+  }
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  textureStreamingInitialized = true;
+}
+
+void stream2DTexture(const char* imgLocation, uint32& textureId, bool flipImageVert, bool inputSRGB)
+{
+  if(!textureStreamingInitialized) { initTextureStreaming(); }
+
+  const uint8 placeholderPixel[] = { 128, 128, 128, 255 };
+  glGenTextures(1, &textureId);
+  fill2DTexture(textureId, 1, 1, 4, placeholderPixel, false);
+
+  TextureStreamRequest* request = new TextureStreamRequest();
+  request->imgLocation = imgLocation;
+  request->textureId = textureId;
+  request->flipImageVert = flipImageVert;
+  request->inputSRGB = inputSRGB;
+  request->cancelled = false;
+  request->bakedTexture = {};
+  request->image = {};
+  inFlightRequests.push_back(request);
+
+  addJob(&decodeJobs, [request] {
+    if(!readBakedTexture(request->imgLocation.c_str(), request->flipImageVert, request->inputSRGB, &request->bakedTexture))
+    {
+      decode2DImage(request->imgLocation.c_str(), request->flipImageVert, &request->image);
+    }
+    std::lock_guard<std::mutex> lock(decodedRequestsMutex);
+    decodedRequests.push_back(request);
+  });
+}
+
+void cancelTextureStream(uint32 textureId)
+{
+  for(TextureStreamRequest* request : inFlightRequests)
+  {
+    if(request->textureId == textureId) { request->cancelled = true; }
+  }
+}
+
+file_access void finishRequest(TextureStreamRequest* request)
+{
+  freeBakedTexture(&request->bakedTexture);
+  freeDecodedImage(&request->image);
+  for(uint32 i = 0; i < inFlightRequests.size(); ++i)
+  {
+    if(inFlightRequests[i] == request)
+    {
+      inFlightRequests[i] = inFlightRequests.back();
+      inFlightRequests.pop_back();
+      break;
+    }
+  }
+  delete request;
+}
+
+// NOTE: pixels is an offset into the bound GL_PIXEL_UNPACK_BUFFER when uploading from the ring
+file_access void fillStreamedTexture(const TextureStreamRequest* request, const uint8* pixels)
+{
+  if(request->bakedTexture.data != NULL)
+  {
+    fillBaked2DTexture(request->textureId, request->bakedTexture.header, pixels, request->inputSRGB);
+  } else
+  {
+    const DecodedImage& image = request->image;
+    fill2DTexture(request->textureId, image.width, image.height, image.channelCount, pixels, request->inputSRGB);
+  }
+
+  if(textureStreamedCallback != NULL)
+  {
+    if(request->bakedTexture.data != NULL)
+    {
+      const BakedTextureHeader& header = request->bakedTexture.header;
+      textureStreamedCallback(request->textureId, header.mips[0].width, header.mips[0].height, header.dataSize);
+    } else
+    {
+      const DecodedImage& image = request->image;
+      textureStreamedCallback(request->textureId, image.width, image.height, texture2DGpuBytes(image.width, image.height, image.channelCount));
+    }
+  }
+}
+
+void updateTextureStreaming()
+{
+  if(!textureStreamingInitialized) { return; }
+
+  {
+    std::lock_guard<std::mutex> lock(decodedRequestsMutex);
+    uploadQueue.insert(uploadQueue.end(), decodedRequests.begin(), decodedRequests.end());
+    decodedRequests.clear();
+  }
+
+  uint32 originalTexture = glStateBoundTexture(GL_TEXTURE_2D);
+
+  while(!uploadQueue.empty())
+  {
+    TextureStreamRequest* request = uploadQueue.front();
+    const DecodedImage& image = request->image;
+    bool baked = request->bakedTexture.data != NULL;
+    const uint8* pixels = baked ? request->bakedTexture.data : image.data;
+    uint64 imageSize = baked ? request->bakedTexture.header.dataSize : (uint64)image.width * image.height * image.channelCount;
+
+    if(request->cancelled || pixels == NULL || (!baked && image.channelCount > 4))
+    {
+      // NOTE: failed decodes keep the placeholder
+      if(!request->cancelled && textureStreamedCallback != NULL) { textureStreamedCallback(request->textureId, 0, 0, 0); }
+      uploadQueue.pop_front();
+      finishRequest(request);
+      continue;
+    }
+
+    if(imageSize > TEXTURE_STREAMING_PBO_SIZE)
+    {
+      fillStreamedTexture(request, pixels);
+      uploadQueue.pop_front();
+      finishRequest(request);
+      continue;
+    }
+
+    // NOTE: Never wait on the GPU, if the next pixel buffer is still being read the rest waits for a later frame
+    PixelBufferSlot& slot = pixelBufferSlots[nextPixelBufferSlot];
+    if(slot.uploadFence != NULL)
+    {
+      GLenum fenceStatus = glClientWaitSync(slot.uploadFence, 0, 0);
+      if(fenceStatus == GL_TIMEOUT_EXPIRED) { break; }
+      glDeleteSync(slot.uploadFence);
+      slot.uploadFence = NULL;
+    }
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.bufferId);
+    if(slot.persistentMapping != NULL)
+    {
+      memcpy(slot.persistentMapping, pixels, imageSize);
+    } else
+    {
+      void* mapping = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, imageSize, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+      if(mapping == NULL)
+      {
+        // NOTE: upload straight from client memory instead
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        fillStreamedTexture(request, pixels);
+        uploadQueue.pop_front();
+        finishRequest(request);
+        continue;
+      }
+      memcpy(mapping, pixels, imageSize);
+      glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    }
+    fillStreamedTexture(request, (const uint8*)0);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0); // NOTE: direct uploads read client pointers, not buffer offsets
+    slot.uploadFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glFlush(); // NOTE: the fence is only polled, it has to reach the GPU to ever signal
+    nextPixelBufferSlot = (nextPixelBufferSlot + 1) % TEXTURE_STREAMING_PBO_COUNT;
+
+    uploadQueue.pop_front();
+    finishRequest(request);
+  }
+
+  glBindTexture(GL_TEXTURE_2D, originalTexture);
+}
+
+bool textureStreamingIdle()
+{
+  return inFlightRequests.empty();
+}
+
+void setTextureStreamedCallback(TextureStreamedCallback callback)
+{
+  textureStreamedCallback = callback;
+}
+
+void deinitTextureStreaming()
+{
+  if(!textureStreamingInitialized) { return; }
+
+  waitForJobs(&decodeJobs);
+  while(!inFlightRequests.empty()) { finishRequest(inFlightRequests.back()); }
+  decodedRequests.clear();
+  uploadQueue.clear();
+
+  for(uint32 i = 0; i < TEXTURE_STREAMING_PBO_COUNT; ++i)
+  {
+    PixelBufferSlot& slot = pixelBufferSlots[i];
+    if(slot.uploadFence != NULL) { glDeleteSync(slot.uploadFence); }
+    if(slot.persistentMapping != NULL)
+    {
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.bufferId);
+      glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    }
+    glDeleteBuffers(1, &slot.bufferId);
+  }
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  textureStreamingInitialized = false;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "../LearnOpenGLPlatform.h"
+
+// NOTE: Textures returned here hold a 1x1 placeholder until their image has been decoded on a worker thread and
+// NOTE: uploaded through the pixel buffer ring. The texture id never changes, so it can be bound right away.
+// NOTE: Baked textures (see BakedTexture.h) are read from disk instead of decoded.
+#define TEXTURE_STREAMING_PBO_COUNT 3
+#define TEXTURE_STREAMING_PBO_SIZE (32 * 1024 * 1024) // images larger than this skip the ring and upload directly
+
+// NOTE: a width and height of 0 means the image failed to load, the texture keeps its placeholder
+typedef void (*TextureStreamedCallback)(uint32 textureId, uint32 width, uint32 height, uint64 gpuBytes);
+
+void stream2DTexture(const char* imgLocation, uint32& textureId, bool flipImageVert = false, bool inputSRGB = false);
+// Textures deleted before their upload lands must be cancelled first, the id may be reused by OpenGL
+void cancelTextureStream(uint32 textureId);
+// Called once per frame on the context thread, uploads at most one image per free pixel buffer
+void updateTextureStreaming();
+bool textureStreamingIdle();
+void setTextureStreamedCallback(TextureStreamedCallback callback);
+void deinitTextureStreaming();
@@ -0,0 +1,134 @@
+#include "UniformRing.h"
+
+#include <glad/glad.h>
+#include <iostream>
+#include <cstring>
+
+#include "glExtensions.h"
+
+#define UNIFORM_RING_SIZE (UNIFORM_RING_FRAME_COUNT * UNIFORM_RING_FRAME_SIZE)
+
+file_access bool uniformRingInitialized = false;
+file_access uint32 ringBuffer = 0;
+file_access uint8* persistentMapping = NULL; // NULL when ARB_buffer_storage is unavailable
+file_access GLsync frameFences[UNIFORM_RING_FRAME_COUNT];
+file_access uint32 offsetAlignment = 256;
+file_access uint32 frameIndex = UNIFORM_RING_FRAME_COUNT - 1; // the first frame wraps around to region 0
+file_access uint32 frameOffset = 0; // next free byte of the frame's region
+
+file_access void initUniformRing()
+{
+  GLint alignment;
+  glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+  if(alignment > 0) { offsetAlignment = (uint32)alignment; }
+
+  glGenBuffers(1, &ringBuffer);
+  glBindBuffer(GL_UNIFORM_BUFFER, ringBuffer);
+  if(glExtensions.bufferStorage)
+  {
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glBufferStorage(GL_UNIFORM_BUFFER, UNIFORM_RING_SIZE, NULL, flags);
+    persistentMapping = (uint8*)glMapBufferRange(GL_UNIFORM_BUFFER, 0, UNIFORM_RING_SIZE, flags);
+    if(persistentMapping == NULL)
+    {
+      // NOTE: the storage is immutable, recreate the buffer so the glBufferData() path below can be used
+      std::cout << "ERROR::UNIFORM_RING::PERSISTENT_MAPPING_FAILED" << std::endl;
+      glDeleteBuffers(1, &ringBuffer);
+      glGenBuffers(1, &ringBuffer);
+      glBindBuffer(GL_UNIFORM_BUFFER, ringBuffer);
+    }
+  } else
+  {
+    persistentMapping = NULL;
+  }
+  if(persistentMapping == NULL)
+  {
+    glBufferData(GL_UNIFORM_BUFFER, UNIFORM_RING_SIZE, NULL, GL_STREAM_DRAW);
+  }
+  for(uint32 i = 0; i < UNIFORM_RING_FRAME_COUNT; ++i) { frameFences[i] = NULL; }
+  uniformRingInitialized = true;
+}
+
+void uniformRingBeginFrame()
+{
+  if(!uniformRingInitialized) { initUniformRing(); }
+
+  frameIndex = (frameIndex + 1) % UNIFORM_RING_FRAME_COUNT;
+  frameOffset = 0;
+  if(persistentMapping != NULL)
+  {
+    // NOTE: only waits when the GPU is UNIFORM_RING_FRAME_COUNT frames behind
+    GLsync& fence = frameFences[frameIndex];
+    if(fence != NULL)
+    {
+      GLbitfield waitFlags = GL_SYNC_FLUSH_COMMANDS_BIT;
+      while(glClientWaitSync(fence, waitFlags, 1000000000) == GL_TIMEOUT_EXPIRED) { waitFlags = 0; }
+      glDeleteSync(fence);
+      fence = NULL;
+    }
+  } else if(frameIndex == 0)
+  {
+    // NOTE: orphan the storage, the driver hands us new memory while the GPU finishes with the old
+    glBindBuffer(GL_UNIFORM_BUFFER, ringBuffer);
+    glBufferData(GL_UNIFORM_BUFFER, UNIFORM_RING_SIZE, NULL, GL_STREAM_DRAW);
+  }
+}
+
+void uniformRingEndFrame()
+{
+  if(persistentMapping == NULL) { return; }
+  frameFences[frameIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+UniformBlock pushUniformBlock(const void* data, uint32 size)
+{
+  uint32 alignedOffset = (frameOffset + offsetAlignment - 1) & ~(offsetAlignment - 1);
+  if(!uniformRingInitialized || alignedOffset + size > UNIFORM_RING_FRAME_SIZE)
+  {
+    std::cout << "ERROR::UNIFORM_RING::FRAME_REGION_FULL_OR_NO_FRAME_BEGUN pushing " << size << " bytes" << std::endl;
+    Assert(!"uniform ring frame region full or no frame begun");
+    return { 0, 0, 0 };
+  }
+  frameOffset = alignedOffset + size;
+
+  uint32 offset = (frameIndex * UNIFORM_RING_FRAME_SIZE) + alignedOffset;
+  if(persistentMapping != NULL)
+  {
+    memcpy(persistentMapping + offset, data, size);
+  } else
+  {
+    glBindBuffer(GL_UNIFORM_BUFFER, ringBuffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data);
+  }
+  return { ringBuffer, offset, size };
+}
+
+void bindUniformBlock(uint32 bindIndex, const UniformBlock& block)
+{
+  if(block.buffer == 0)
+  {
+    // NOTE: never leave a previous frame's range bound, the ring may be rewriting it
+    glBindBufferBase(GL_UNIFORM_BUFFER, bindIndex, 0);
+    return;
+  }
+  glBindBufferRange(GL_UNIFORM_BUFFER, bindIndex, block.buffer, block.offset, block.size);
+}
+
+void deinitUniformRing()
+{
+  if(!uniformRingInitialized) { return; }
+
+  for(uint32 i = 0; i < UNIFORM_RING_FRAME_COUNT; ++i)
+  {
+    if(frameFences[i] != NULL) { glDeleteSync(frameFences[i]); }
+    frameFences[i] = NULL;
+  }
+  glBindBuffer(GL_UNIFORM_BUFFER, ringBuffer);
+  if(persistentMapping != NULL) { glUnmapBuffer(GL_UNIFORM_BUFFER); }
+  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+  glDeleteBuffers(1, &ringBuffer);
+  persistentMapping = NULL;
+  ringBuffer = 0;
+  frameIndex = UNIFORM_RING_FRAME_COUNT - 1;
+  uniformRingInitialized = false;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "../LearnOpenGLPlatform.h"
+
+// NOTE: Per frame uniform buffer data (ex: the projection & view matrices of a globalBlockVS) is written to one shared
+// NOTE: buffer split into UNIFORM_RING_FRAME_COUNT regions, a frame only writes to its own region and blocks are bound
+// NOTE: with glBindBufferRange(). With ARB_buffer_storage the buffer is persistently mapped and a region is fenced at
+// NOTE: the end of its frame, it is only written again once that fence has signaled. Without it, blocks are uploaded
+// NOTE: with glBufferSubData() and the whole buffer is orphaned every time the ring wraps back to the first region.
+// NOTE: Blocks are only valid for the frame they were pushed in.
+#define UNIFORM_RING_FRAME_COUNT 3
+#define UNIFORM_RING_FRAME_SIZE (64 * 1024)
+
+struct UniformBlock
+{
+  uint32 buffer; // 0 when the frame's region is full, binding it leaves the binding point empty
+  uint32 offset;
+  uint32 size;
+};
+
+// Called once per frame before any block is pushed, may wait on the GPU if it is UNIFORM_RING_FRAME_COUNT frames behind
+void uniformRingBeginFrame();
+// Called once per frame after the frame's last draw
+void uniformRingEndFrame();
+// Copies size bytes of data (laid out as std140) into the frame's region, aligned to GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+UniformBlock pushUniformBlock(const void* data, uint32 size);
+void bindUniformBlock(uint32 bindIndex, const UniformBlock& block);
+void deinitUniformRing();
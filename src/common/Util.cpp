@@ -1,7 +1,5 @@
 #include "Util.h"
 
-#include <time.h>
-
 void swap(float32* a, float32* b)
 {
   float32 tmp = *a;
@@ -18,11 +16,6 @@ glm::mat4& reverseZ(glm::mat4& mat)
   return mat;
 }
 
-float32 getTime() {
-  clock_t time = clock();
-  return (float32)time / CLOCKS_PER_SEC;
-}
-
 //template <typename T>
 //class Consumable {
 //  T value;
@@ -5,7 +5,6 @@
 
 void swap(float32* a, float32* b);
 glm::mat4& reverseZ(glm::mat4& mat);
-float32 getTime();
 bool consume(bool& val);
 
 class Consumabool {
@@ -7,7 +7,7 @@
 #include "../LearnOpenGLPlatform.h"
 #include <iostream>
 
-uint32 getFileLastWriteTime(const char* filePath) {
+inline uint32 getFileLastWriteTime(const char* filePath) {
   WIN32_FIND_DATA FindFileData = {};
   HANDLE hFind;
 
@@ -22,4 +22,11 @@ uint32 getFileLastWriteTime(const char* filePath) {
   }
 
   return FindFileData.ftLastWriteTime.dwLowDateTime;
-}
\ No newline at end of file
+}
+
+// Full resolution last write time (100ns intervals) for ordering files, 0 if the file can't be found
+inline uint64 getFileLastWriteTimestamp(const char* filePath) {
+  WIN32_FILE_ATTRIBUTE_DATA fileAttributes = {};
+  if (!GetFileAttributesEx(filePath, GetFileExInfoStandard, &fileAttributes)) { return 0; }
+  return ((uint64)fileAttributes.ftLastWriteTime.dwHighDateTime << 32) | fileAttributes.ftLastWriteTime.dwLowDateTime;
+}
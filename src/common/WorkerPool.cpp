@@ -0,0 +1,110 @@
+#include "WorkerPool.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+
+struct Job
+{
+  JobCounter* counter;
+  std::function<void()> work;
+};
+
+class WorkerPool
+{
+public:
+  std::mutex mutex;
+  std::condition_variable jobAdded;
+  std::condition_variable jobFinished;
+  std::deque<Job> jobs;
+  std::vector<std::thread> workers;
+  bool shuttingDown = false;
+
+  WorkerPool()
+  {
+    uint32 hardwareThreadCount = std::thread::hardware_concurrency();
+    uint32 workerCount = hardwareThreadCount > 1 ? hardwareThreadCount - 1 : 1; // leave the main thread its own core
+    for(uint32 i = 0; i < workerCount; ++i) { workers.emplace_back(&WorkerPool::workerLoop, this); }
+  }
+
+  ~WorkerPool()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      shuttingDown = true;
+    }
+    jobAdded.notify_all();
+    for(std::thread& worker : workers) { worker.join(); }
+  }
+
+  void runJob(Job& job)
+  {
+    job.work();
+    // NOTE: lock so a waiter can't check the counter and go to sleep between the decrement and the notify
+    std::lock_guard<std::mutex> lock(mutex);
+    job.counter->remaining--;
+    jobFinished.notify_all();
+  }
+
+  void workerLoop()
+  {
+    while(true)
+    {
+      Job job;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        jobAdded.wait(lock, [this] { return shuttingDown || !jobs.empty(); });
+        if(jobs.empty()) { return; } // shutting down
+        job = std::move(jobs.front());
+        jobs.pop_front();
+      }
+      runJob(job);
+    }
+  }
+};
+
+file_access WorkerPool& workerPool()
+{
+  local_access WorkerPool pool;
+  return pool;
+}
+
+void addJob(JobCounter* counter, std::function<void()> job)
+{
+  WorkerPool& pool = workerPool();
+  counter->remaining++;
+  {
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    pool.jobs.push_back({ counter, std::move(job) });
+  }
+  pool.jobAdded.notify_one();
+}
+
+void waitForJobs(JobCounter* counter)
+{
+  WorkerPool& pool = workerPool();
+  while(true)
+  {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(pool.mutex);
+      if(counter->remaining == 0) { return; }
+      if(pool.jobs.empty())
+      {
+        // everything left is already running on workers
+        pool.jobFinished.wait(lock, [&] { return counter->remaining == 0 || !pool.jobs.empty(); });
+        continue;
+      }
+      job = std::move(pool.jobs.front());
+      pool.jobs.pop_front();
+    }
+    pool.runJob(job);
+  }
+}
+
+uint32 workerThreadCount()
+{
+  return (uint32)workerPool().workers.size();
+}
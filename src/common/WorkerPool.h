@@ -0,0 +1,19 @@
+#pragma once
+
+#include <functional>
+#include <atomic>
+
+#include "../LearnOpenGLPlatform.h"
+
+// NOTE: Tracks a group of jobs so a caller can wait on its own work without waiting on everyone else's
+struct JobCounter
+{
+  std::atomic<uint32> remaining{0};
+};
+
+// NOTE: Jobs run on a process wide pool of worker threads (hardware threads - 1) that is started on first use.
+// NOTE: Jobs must not make OpenGL calls, the context is only current on the main thread.
+void addJob(JobCounter* counter, std::function<void()> job);
+// NOTE: The calling thread helps run queued jobs while it waits
+void waitForJobs(JobCounter* counter);
+uint32 workerThreadCount();
@@ -0,0 +1,99 @@
+#include "glExtensions.h"
+
+#include <cstring>
+
+GLExtensions glExtensions = {};
+
+GL_GET_PROGRAM_BINARY(glGetProgramBinaryStub)
+{
+  if(length != NULL) { *length = 0; }
+}
+gl_get_program_binary* glGetProgramBinary_ = glGetProgramBinaryStub;
+
+GL_PROGRAM_BINARY(glProgramBinaryStub) {}
+gl_program_binary* glProgramBinary_ = glProgramBinaryStub;
+
+GL_PROGRAM_PARAMETERI(glProgramParameteriStub) {}
+gl_program_parameteri* glProgramParameteri_ = glProgramParameteriStub;
+
+GL_MAX_SHADER_COMPILER_THREADS(glMaxShaderCompilerThreadsStub) {}
+gl_max_shader_compiler_threads* glMaxShaderCompilerThreadsKHR_ = glMaxShaderCompilerThreadsStub;
+
+GL_BUFFER_STORAGE(glBufferStorageStub) {}
+gl_buffer_storage* glBufferStorage_ = glBufferStorageStub;
+
+bool glExtensionSupported(const char* extensionName)
+{
+  int32 extensionCount;
+  glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+  for(int32 i = 0; i < extensionCount; ++i)
+  {
+    if(strcmp((const char*)glGetStringi(GL_EXTENSIONS, i), extensionName) == 0) { return true; }
+  }
+  return false;
+}
+
+file_access bool glVersionAtLeast(int32 major, int32 minor)
+{
+  int32 contextMajor, contextMinor;
+  glGetIntegerv(GL_MAJOR_VERSION, &contextMajor);
+  glGetIntegerv(GL_MINOR_VERSION, &contextMinor);
+  return contextMajor > major || (contextMajor == major && contextMinor >= minor);
+}
+
+void loadGLExtensions(GLADloadproc load)
+{
+  glExtensions = {};
+
+  if(glVersionAtLeast(4, 1) || glExtensionSupported("GL_ARB_get_program_binary"))
+  {
+    gl_get_program_binary* getProgramBinary = (gl_get_program_binary*)load("glGetProgramBinary");
+    gl_program_binary* programBinary = (gl_program_binary*)load("glProgramBinary");
+    gl_program_parameteri* programParameteri = (gl_program_parameteri*)load("glProgramParameteri");
+
+    // NOTE: A driver may support the extension while offering zero binary formats, which makes it useless to us
+    int32 binaryFormatCount = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &binaryFormatCount);
+
+    if(getProgramBinary && programBinary && programParameteri && binaryFormatCount > 0)
+    {
+      glGetProgramBinary = getProgramBinary;
+      glProgramBinary = programBinary;
+      glProgramParameteri = programParameteri;
+      glExtensions.programBinary = true;
+    }
+  }
+
+  // NOTE: The ARB version is identical apart from the suffix
+  gl_max_shader_compiler_threads* maxShaderCompilerThreads = NULL;
+  if(glExtensionSupported("GL_KHR_parallel_shader_compile"))
+  {
+    maxShaderCompilerThreads = (gl_max_shader_compiler_threads*)load("glMaxShaderCompilerThreadsKHR");
+  } else if(glExtensionSupported("GL_ARB_parallel_shader_compile"))
+  {
+    maxShaderCompilerThreads = (gl_max_shader_compiler_threads*)load("glMaxShaderCompilerThreadsARB");
+  }
+  if(maxShaderCompilerThreads)
+  {
+    glMaxShaderCompilerThreadsKHR = maxShaderCompilerThreads;
+    glMaxShaderCompilerThreadsKHR(0xFFFFFFFF); // let the driver pick the number of threads
+    glExtensions.parallelShaderCompile = true;
+  }
+
+  if(glVersionAtLeast(4, 4) || glExtensionSupported("GL_ARB_buffer_storage"))
+  {
+    gl_buffer_storage* bufferStorage = (gl_buffer_storage*)load("glBufferStorage");
+    if(bufferStorage)
+    {
+      glBufferStorage = bufferStorage;
+      glExtensions.bufferStorage = true;
+    }
+  }
+
+  // NOTE: No entry points, only the internal formats accepted by glCompressedTexImage2D()
+  glExtensions.textureCompressionS3TC = glExtensionSupported("GL_EXT_texture_compression_s3tc");
+  // NOTE: the sRGB S3TC formats come from EXT_texture_sRGB, or EXT_texture_compression_s3tc_srgb on newer drivers
+  glExtensions.textureCompressionS3TCSRGB = glExtensions.textureCompressionS3TC &&
+          (glExtensionSupported("GL_EXT_texture_sRGB") || glExtensionSupported("GL_EXT_texture_compression_s3tc_srgb"));
+  glExtensions.textureCompressionBPTC = glVersionAtLeast(4, 2) || glExtensionSupported("GL_ARB_texture_compression_bptc");
+}
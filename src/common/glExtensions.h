@@ -0,0 +1,72 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include "../LearnOpenGLPlatform.h"
+
+// NOTE: glad is generated for the OpenGL 3.3 core profile. Functionality from newer OpenGL versions or extensions
+// NOTE: is loaded here. Function pointers point to stubs when unavailable, check glExtensions before use.
+
+// ===== ARB_get_program_binary (core in 4.1) =====
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+
+#define GL_GET_PROGRAM_BINARY(name) void APIENTRY name(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary)
+typedef GL_GET_PROGRAM_BINARY(gl_get_program_binary);
+extern gl_get_program_binary* glGetProgramBinary_;
+#define glGetProgramBinary glGetProgramBinary_
+
+#define GL_PROGRAM_BINARY(name) void APIENTRY name(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length)
+typedef GL_PROGRAM_BINARY(gl_program_binary);
+extern gl_program_binary* glProgramBinary_;
+#define glProgramBinary glProgramBinary_
+
+#define GL_PROGRAM_PARAMETERI(name) void APIENTRY name(GLuint program, GLenum pname, GLint value)
+typedef GL_PROGRAM_PARAMETERI(gl_program_parameteri);
+extern gl_program_parameteri* glProgramParameteri_;
+#define glProgramParameteri glProgramParameteri_
+
+// ===== KHR_parallel_shader_compile / ARB_parallel_shader_compile =====
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+
+#define GL_MAX_SHADER_COMPILER_THREADS(name) void APIENTRY name(GLuint count)
+typedef GL_MAX_SHADER_COMPILER_THREADS(gl_max_shader_compiler_threads);
+extern gl_max_shader_compiler_threads* glMaxShaderCompilerThreadsKHR_;
+#define glMaxShaderCompilerThreadsKHR glMaxShaderCompilerThreadsKHR_
+
+// ===== ARB_buffer_storage (core in 4.4) =====
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#define GL_MAP_COHERENT_BIT 0x0080
+
+#define GL_BUFFER_STORAGE(name) void APIENTRY name(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags)
+typedef GL_BUFFER_STORAGE(gl_buffer_storage);
+extern gl_buffer_storage* glBufferStorage_;
+#define glBufferStorage glBufferStorage_
+
+// ===== EXT_texture_compression_s3tc (+ EXT_texture_sRGB) =====
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT 0x8C4C
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+
+// ===== ARB_texture_compression_bptc (core in 4.2) =====
+#define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#define GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM 0x8E8D
+
+struct GLExtensions
+{
+  bool programBinary;
+  bool parallelShaderCompile;
+  bool bufferStorage;
+  bool textureCompressionS3TC; // BC1 & BC3, BC5 (RGTC) is core in 3.0
+  bool textureCompressionS3TCSRGB; // sRGB BC1 & BC3
+  bool textureCompressionBPTC; // BC7
+};
+
+extern GLExtensions glExtensions;
+
+// NOTE: must be called after the OpenGL context is current and glad has been initialized
+void loadGLExtensions(GLADloadproc load);
+bool glExtensionSupported(const char* extensionName);
@@ -0,0 +1,77 @@
+#include "headlessUtil.h"
+
+#include <glad/glad.h>
+#include <iostream>
+
+#if HEADLESS_OSMESA
+
+// NOTE: glad already provides the OpenGL declarations, osmesa.h only needs its calling convention
+#ifndef GLAPIENTRY
+#define GLAPIENTRY APIENTRY
+#endif
+#include <GL/osmesa.h>
+
+file_access OSMesaContext headlessContext = NULL;
+file_access uint8* headlessColorBuffer = NULL;
+
+bool createHeadlessContext(Extent2D extent)
+{
+  const int32 contextAttributes[] = {
+          OSMESA_FORMAT, OSMESA_RGBA,
+          OSMESA_DEPTH_BITS, 24,
+          OSMESA_STENCIL_BITS, 8,
+          OSMESA_PROFILE, OSMESA_CORE_PROFILE,
+          OSMESA_CONTEXT_MAJOR_VERSION, 3, // OpenGL version x._
+          OSMESA_CONTEXT_MINOR_VERSION, 3, // OpenGL version _.x
+          0
+  };
+
+  headlessContext = OSMesaCreateContextAttribs(contextAttributes, NULL);
+  if(headlessContext == NULL)
+  {
+    std::cout << "Failed to create OSMesa context" << std::endl;
+    return false;
+  }
+
+  // NOTE: Scenes draw to their own framebuffers, this buffer only backs the default framebuffer
+  const uint32 bytesPerPixel = 4;
+  headlessColorBuffer = new uint8[extent.width * extent.height * bytesPerPixel];
+  if(!OSMesaMakeCurrent(headlessContext, headlessColorBuffer, GL_UNSIGNED_BYTE, extent.width, extent.height))
+  {
+    std::cout << "Failed to make OSMesa context current" << std::endl;
+    destroyHeadlessContext();
+    return false;
+  }
+
+  return true;
+}
+
+void destroyHeadlessContext()
+{
+  if(headlessContext != NULL) { OSMesaDestroyContext(headlessContext); }
+  delete[] headlessColorBuffer;
+  headlessContext = NULL;
+  headlessColorBuffer = NULL;
+}
+
+void* headlessGetProcAddress(const char* name)
+{
+  return (void*)OSMesaGetProcAddress(name);
+}
+
+#else
+
+bool createHeadlessContext(Extent2D extent)
+{
+  std::cout << "Headless context unavailable, compile with HEADLESS_OSMESA" << std::endl;
+  return false;
+}
+
+void destroyHeadlessContext() {}
+
+void* headlessGetProcAddress(const char* name)
+{
+  return NULL;
+}
+
+#endif
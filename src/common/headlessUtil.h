@@ -0,0 +1,9 @@
+#pragma once
+
+#include "../LearnOpenGLPlatform.h"
+
+// NOTE: A headless context is a software rendered OpenGL 3.3 core context (OSMesa) with no window or display
+// NOTE: Only available when compiled with HEADLESS_OSMESA, otherwise createHeadlessContext() always fails
+bool createHeadlessContext(Extent2D extent);
+void destroyHeadlessContext();
+void* headlessGetProcAddress(const char* name);
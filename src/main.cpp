@@ -5,23 +5,108 @@
 #include "imgui/backends/imgui_impl_opengl3.h"
 
 #include <iostream>
+#include <cstring>
 #include <GLFW/glfw3.h>
 #include <glad/glad.h>
 
 #include "main.h"
 #include "common/Input.h"
+#include "common/headlessUtil.h"
+#include "common/glExtensions.h"
+#include "common/GLState.h"
+#include "common/FrameClock.h"
 #include "scenes/SceneManager.h"
 
-int main()
+int main(int argc, char** argv)
 {
+  BenchmarkSettings benchmarkSettings;
+  if(parseBenchmarkArgs(argc, argv, &benchmarkSettings))
+  {
+    return runBenchmark(benchmarkSettings);
+  }
+
+  // NOTE: recorded frame times can be replayed with --benchmark <scene> --frame-times <file>
+  const char* recordFrameTimesFileLoc = NULL;
+  for(int i = 1; i < argc - 1; ++i)
+  {
+    if(strcmp(argv[i], "--record-frame-times") == 0) { recordFrameTimesFileLoc = argv[i + 1]; }
+  }
+
   loadGLFW();
   GLFWwindow* window = createWindow();
   initializeGLAD();
   initImgui(window);
+  if(recordFrameTimesFileLoc != NULL) { startRecordingFrameTimes(); }
   runScenes(window);
+  if(recordFrameTimesFileLoc != NULL) { saveRecordedFrameTimes(recordFrameTimesFileLoc); }
   return 0;
 }
 
+// usage: LearnOpenGL --benchmark <scene title|scene index> [--frames N] [--warmup N] [--width W] [--height H] [--timestep seconds] [--frame-times recorded.txt] [--out results.json]
+bool parseBenchmarkArgs(int argc, char** argv, BenchmarkSettings* settings)
+{
+  *settings = { NULL, 300, 30, { VIEWPORT_INIT_WIDTH, VIEWPORT_INIT_HEIGHT }, 1.0f / 60.0f, NULL, NULL };
+  for(int i = 1; i < argc; i += 2)
+  {
+    const char* arg = argv[i];
+    if(i + 1 == argc)
+    {
+      std::cout << "Missing value for argument: " << arg << std::endl;
+      std::cout << "usage: LearnOpenGL --benchmark <scene title|scene index> [--frames N] [--warmup N] [--width W] [--height H] [--timestep seconds] [--frame-times recorded.txt] [--out results.json]" << std::endl;
+      exit(-1);
+    }
+    const char* value = argv[i + 1];
+    if(strcmp(arg, "--benchmark") == 0) { settings->scene = value; }
+    else if(strcmp(arg, "--frames") == 0) { settings->frameCount = strtoul(value, NULL, 10); }
+    else if(strcmp(arg, "--warmup") == 0) { settings->warmupFrameCount = strtoul(value, NULL, 10); }
+    else if(strcmp(arg, "--width") == 0) { settings->extent.width = strtoul(value, NULL, 10); }
+    else if(strcmp(arg, "--height") == 0) { settings->extent.height = strtoul(value, NULL, 10); }
+    else if(strcmp(arg, "--timestep") == 0) { settings->timestep = (float32)atof(value); }
+    else if(strcmp(arg, "--frame-times") == 0) { settings->frameTimesFileLoc = value; }
+    else if(strcmp(arg, "--out") == 0) { settings->outputFileLoc = value; }
+    else if(strcmp(arg, "--record-frame-times") == 0) {} // handled in main()
+    else { std::cout << "Unknown argument: " << arg << std::endl; }
+  }
+
+  if(settings->scene == NULL) { return false; }
+  if(settings->frameCount == 0 || settings->extent.width == 0 || settings->extent.height == 0)
+  {
+    std::cout << "Benchmark requires a non-zero frame count and extent" << std::endl;
+    exit(-1);
+  }
+  return true;
+}
+
+int runBenchmark(BenchmarkSettings settings)
+{
+  bool benchmarkSucceeded;
+#if HEADLESS_OSMESA
+  if(!createHeadlessContext(settings.extent))
+  {
+    std::cout << "Failed to create headless context" << std::endl;
+    exit(-1);
+  }
+  if(!gladLoadGLLoader((GLADloadproc)headlessGetProcAddress))
+  {
+    std::cout << "Failed to initialize GLAD" << std::endl;
+    exit(-1);
+  }
+  loadGLExtensions((GLADloadproc)headlessGetProcAddress);
+  initGLState();
+  benchmarkSucceeded = runSceneBenchmark(NULL, settings);
+  destroyHeadlessContext();
+#else
+  // NOTE: Without OSMesa we still need a context, an invisible window is the next best thing
+  loadGLFW();
+  glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+  GLFWwindow* window = createWindow();
+  initializeGLAD();
+  benchmarkSucceeded = runSceneBenchmark(window, settings);
+  glfwTerminate();
+#endif
+  return benchmarkSucceeded ? 0 : -1;
+}
+
 void initImgui(GLFWwindow* window)
 {
   // Setup Dear ImGui context
@@ -57,6 +142,8 @@ void initializeGLAD()
     std::cout << "Failed to initialize GLAD" << std::endl;
     exit(-1);
   }
+  loadGLExtensions((GLADloadproc)glfwGetProcAddress);
+  initGLState();
 }
 
 GLFWwindow* createWindow()
@@ -1,8 +1,11 @@
 #pragma once
 
 #include "LearnOpenGLPlatform.h"
+#include "scenes/SceneManager.h"
 
-int main();
+int main(int argc, char** argv);
+bool parseBenchmarkArgs(int argc, char** argv, BenchmarkSettings* settings);
+int runBenchmark(BenchmarkSettings settings);
 void loadGLFW();
 GLFWwindow* createWindow();
 void initializeGLAD();
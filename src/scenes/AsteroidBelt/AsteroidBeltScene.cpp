@@ -1,12 +1,55 @@
+#include <imgui/imgui.h>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/packing.hpp>
+
 #include "AsteroidBeltScene.h"
 #include "../../common/FileLocations.h"
 #include "../../Model.h"
 #include "../../common/Util.h"
+#include "../../common/FrameClock.h"
 #include "../../common/ObjectData.h"
+#include "../../common/TextureCache.h"
+#include "../../common/Input.h"
 
 const uint32 skyboxTextureIndex = 0;
 const uint32 skybox2TextureIndex = skyboxTextureIndex + 1;
 
+const uint32 asteroidCounts[] = { 5000, 50000, 500000 }; // selected with keys 1, 2 & 3
+#define ASTEROID_LOD_COUNT 4
+// NOTE: projected radius in pixels below which an asteroid drops to the next level of detail
+const float32 asteroidLodPixelRadii[ASTEROID_LOD_COUNT - 1] = { 40.0f, 16.0f, 6.0f };
+
+const uint32 asteroidInstanceSizes[AsteroidInstanceFormat_Count] = { sizeof(glm::mat4), 2 * sizeof(glm::vec4), 8 * sizeof(uint16) };
+const char* const asteroidInstanceFormatNames[AsteroidInstanceFormat_Count] = { "mat4", "compact", "compact half float" };
+
+// NOTE: GL 3.3 has no base instance, so each level's instanced draw re-points the instance attributes at its first instance
+file_access void pointInstanceAttributes(AsteroidInstanceFormat format, uint32 firstInstance)
+{
+  uint32 stride = asteroidInstanceSizes[format];
+  uint64 offset = firstInstance * stride;
+  switch(format)
+  {
+    case AsteroidInstanceFormat_Matrix:
+      // A single vec4 is the largest attribute pointer available with a single call
+      // So we must individually assign the 4 vec4 attribute pointers to receiver a mat4x4 in the shader
+      glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, stride, (void*)(offset));
+      glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, stride, (void*)(offset + sizeof(glm::vec4)));
+      glVertexAttribPointer(5, 4, GL_FLOAT, GL_FALSE, stride, (void*)(offset + 2 * sizeof(glm::vec4)));
+      glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, stride, (void*)(offset + 3 * sizeof(glm::vec4)));
+      break;
+    case AsteroidInstanceFormat_Compact:
+      glVertexAttribPointer(7, 4, GL_FLOAT, GL_FALSE, stride, (void*)(offset));
+      glVertexAttribPointer(8, 4, GL_FLOAT, GL_FALSE, stride, (void*)(offset + sizeof(glm::vec4)));
+      break;
+    case AsteroidInstanceFormat_CompactHalf:
+      glVertexAttribPointer(7, 4, GL_HALF_FLOAT, GL_FALSE, stride, (void*)(offset));
+      glVertexAttribPointer(8, 4, GL_HALF_FLOAT, GL_FALSE, stride, (void*)(offset + 4 * sizeof(uint16)));
+      break;
+    default:
+      std::cout << "ERROR::ASTEROID_BELT::Unknown instance format: " << format << std::endl;
+  }
+}
+
 AsteroidBeltScene::AsteroidBeltScene() : FirstPersonScene()
 {
   camera.Position = glm::vec3(0.0f, 0.0f, 50.0f);
@@ -29,32 +72,111 @@ void AsteroidBeltScene::init(Extent2D windowExtent)
   reflectModelInstanceShader = new ShaderProgram(AsteroidVertexShaderFileLoc, skyboxReflectionFragmentShaderFileLoc);
   skyboxShader = new ShaderProgram(skyboxVertexShaderFileLoc, skyboxFragmentShaderFileLoc);
 
-  loadCubeMapTexture(skyboxInterstellarFaceLocations, skyboxTextureId);
-  loadCubeMapTexture(skyboxSpaceLightBlueFaceLocations, skybox2TextureId);
+  acquireCubeMapTexture(skyboxInterstellarFaceLocations, skyboxTextureId);
+  acquireCubeMapTexture(skyboxSpaceLightBlueFaceLocations, skybox2TextureId);
 
   planetModel = new Model(planetModelLoc);
-  asteroidModel = new Model(asteroidModelLoc);
+  asteroidModel = new Model(asteroidModelLoc, ASTEROID_LOD_COUNT);
 
   const float32 aspectRatio = (float32)windowExtent.width / (float32)windowExtent.height;
-  const glm::mat4 projectionMat = glm::perspective(glm::radians(camera.Zoom), aspectRatio, 0.1f, 100.0f);
+  projectionMat = glm::perspective(glm::radians(camera.Zoom), aspectRatio, 0.1f, 100.0f);
+
+  ShaderProgram* shaders[] = { modelShader, reflectModelInstanceShader, skyboxShader };
+  ShaderProgram::finishLinks(shaders, ArrayCount(shaders));
 
   modelShader->use();
   modelShader->setUniform("projection", projectionMat);
   modelShader->setUniform("skybox", 1);
+  modelViewUniform = modelShader->getUniformHandle("view");
+  modelCameraPosUniform = modelShader->getUniformHandle("cameraPos");
+  modelModelUniform = modelShader->getUniformHandle("model");
 
   skyboxShader->use();
   skyboxShader->setUniform("projection", projectionMat);
   skyboxShader->setUniform("skybox", 0);
+  skyboxViewUniform = skyboxShader->getUniformHandle("view");
 
   reflectModelInstanceShader->use();
   reflectModelInstanceShader->setUniform("projection", projectionMat);
   reflectModelInstanceShader->setUniform("skybox", 0);
+  instanceViewUniform = reflectModelInstanceShader->getUniformHandle("view");
+  instanceCameraPosUniform = reflectModelInstanceShader->getUniformHandle("cameraPos");
+  instanceOrbitUniform = reflectModelInstanceShader->getUniformHandle("orbit");
+  instanceCompactInstancesUniform = reflectModelInstanceShader->getUniformHandle("compactInstances");
+
+  // vertex buffer object to store the instance data for the asteroids
+  glGenBuffers(1, &asteroidInstanceBuffer);
+
+  for (uint32 lod = 0; lod < asteroidModel->lodCount(); lod++)
+  {
+    for (Mesh* mesh : asteroidModel->lodLevel(lod))
+    {
+      glBindVertexArray(mesh->VAO);
+
+      // For glVertexAttribDivisor, the default value is 0 which means that the attribute is updated once per
+      // iteration of the vertex shader. Setting it to 1 means that the attribute is updated once per instance.
+      glVertexAttribDivisor(0, 0); // vec3 position
+      glVertexAttribDivisor(1, 0); // vec3 normal
+      glVertexAttribDivisor(2, 0); // vec2 texture coordinate
+      glVertexAttribDivisor(3, 1); //  \.
+      glVertexAttribDivisor(4, 1); //   \ mat4
+      glVertexAttribDivisor(5, 1); //   / model matrix
+      glVertexAttribDivisor(6, 1); //  /'
+      glVertexAttribDivisor(7, 1); // vec4 position & scale
+      glVertexAttribDivisor(8, 1); // vec4 rotation quaternion
+
+      glBindVertexArray(0);
+    }
+  }
+
+  setInstanceFormat(instanceFormat);
+  initAsteroids(asteroidCounts[0]);
+  updateLods();
+}
+
+// every level of detail's meshes read their instances from the same buffer
+void AsteroidBeltScene::setInstanceFormat(AsteroidInstanceFormat format)
+{
+  instanceFormat = format;
+  bool matrixInstances = instanceFormat == AsteroidInstanceFormat_Matrix;
+
+  glBindBuffer(GL_ARRAY_BUFFER, asteroidInstanceBuffer);
+  for (uint32 lod = 0; lod < asteroidModel->lodCount(); lod++)
+  {
+    for (Mesh* mesh : asteroidModel->lodLevel(lod))
+    {
+      glBindVertexArray(mesh->VAO);
+      for (uint32 attribute = 3; attribute <= 6; attribute++)
+      {
+        if(matrixInstances) { glEnableVertexAttribArray(attribute); }
+        else { glDisableVertexAttribArray(attribute); }
+      }
+      for (uint32 attribute = 7; attribute <= 8; attribute++)
+      {
+        if(matrixInstances) { glDisableVertexAttribArray(attribute); }
+        else { glEnableVertexAttribArray(attribute); }
+      }
+      pointInstanceAttributes(instanceFormat, 0);
+    }
+  }
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void AsteroidBeltScene::updateLods()
+{
+  asteroidCuller.setLods(lodEnabled ? asteroidModel->lodCount() : 1, asteroidLodPixelRadii);
+}
+
+void AsteroidBeltScene::initAsteroids(uint32 count)
+{
+  numAsteroids = count;
+  asteroidPositionScales.resize(numAsteroids);
+  asteroidRotations.resize(numAsteroids);
 
-  glm::mat4* asteroidModelMatrices = new glm::mat4[numAsteroids];
   srand((uint32)getTime()); // initialize random seed
   float32 radius = 30.0;
   auto randDisplacement = []() -> float32 { return ((rand() % 2000) / 100.0f) - 10.0f; };
-  glm::mat4 identityMat = glm::mat4(1.0);
   for (uint32 i = 0; i < numAsteroids; i++)
   {
     // Displace along circle with 'radius' in range [-offset, offset]
@@ -65,51 +187,78 @@ void AsteroidBeltScene::init(Extent2D windowExtent)
     float32 y = displacement * 0.2f; // keep height of field smaller compared to width of x and z
     displacement = randDisplacement();
     float32 z = cos(angle) * radius + displacement;
-    asteroidModelMatrices[i] = glm::translate(identityMat, glm::vec3(x, y, z));
 
     // scale
     float32 scale = ((rand() % 200) / 1000.0f) + 0.05f;
-    asteroidModelMatrices[i] = glm::scale(asteroidModelMatrices[i], glm::vec3(scale));
+    asteroidPositionScales[i] = glm::vec4(x, y, z, scale);
 
     // rotate
     float32 rotAngle = (float32)(rand() % 360);
-    asteroidModelMatrices[i] = glm::rotate(asteroidModelMatrices[i], rotAngle, glm::vec3(0.4f, 0.6f, 0.8f));
+    glm::quat rotation = glm::angleAxis(rotAngle, glm::normalize(glm::vec3(0.4f, 0.6f, 0.8f)));
+    asteroidRotations[i] = glm::vec4(rotation.x, rotation.y, rotation.z, rotation.w);
+  }
+
+  uploadAsteroidInstances();
+}
+
+void AsteroidBeltScene::uploadAsteroidInstances()
+{
+  asteroidCuller.deinit();
+
+  // NOTE: the culler derives bounding spheres from the model matrices in every format
+  std::vector<glm::mat4> asteroidModelMatrices(numAsteroids);
+  glm::mat4 identityMat = glm::mat4(1.0);
+  for (uint32 i = 0; i < numAsteroids; i++)
+  {
+    const glm::vec4& positionScale = asteroidPositionScales[i];
+    const glm::vec4& rotation = asteroidRotations[i];
+    asteroidModelMatrices[i] = glm::translate(identityMat, glm::vec3(positionScale));
+    asteroidModelMatrices[i] = glm::scale(asteroidModelMatrices[i], glm::vec3(positionScale.w));
+    asteroidModelMatrices[i] = asteroidModelMatrices[i] * glm::mat4_cast(glm::quat(rotation.w, rotation.x, rotation.y, rotation.z));
   }
 
-  // vertex buffer object to store all model matrices for the asteroids
-  glGenBuffers(1, &asteroidModelMatrixBuffer);
-  glBindBuffer(GL_ARRAY_BUFFER, asteroidModelMatrixBuffer);
-  glBufferData(GL_ARRAY_BUFFER, numAsteroids * sizeof(glm::mat4), asteroidModelMatrices, GL_STATIC_DRAW);
+  uint32 instanceSize = asteroidInstanceSizes[instanceFormat];
+  std::vector<uint8> instances(numAsteroids * instanceSize);
+  for (uint32 i = 0; i < numAsteroids; i++)
+  {
+    uint8* instance = &instances[i * instanceSize];
+    switch(instanceFormat)
+    {
+      case AsteroidInstanceFormat_Matrix:
+        memcpy(instance, &asteroidModelMatrices[i], sizeof(glm::mat4));
+        break;
+      case AsteroidInstanceFormat_Compact:
+        memcpy(instance, &asteroidPositionScales[i], sizeof(glm::vec4));
+        memcpy(instance + sizeof(glm::vec4), &asteroidRotations[i], sizeof(glm::vec4));
+        break;
+      case AsteroidInstanceFormat_CompactHalf:
+      {
+        uint16* halves = (uint16*)instance;
+        for (uint32 component = 0; component < 4; component++)
+        {
+          halves[component] = glm::packHalf1x16(asteroidPositionScales[i][component]);
+          halves[4 + component] = glm::packHalf1x16(asteroidRotations[i][component]);
+        }
+        break;
+      }
+      default:
+        break;
+    }
+  }
 
-  for (uint32 i = 0; i < asteroidModel->meshes.size(); i++)
+  // NOTE: the mesh origin is used as the sphere center, every asteroid's translation is its bounding sphere's center
+  float32 meshRadius = 0.0f;
+  for (Mesh* mesh : asteroidModel->meshes)
   {
-    glBindVertexArray(asteroidModel->meshes[i]->VAO);
-
-    // A single vec4 is the largest attribute pointer available with a single call
-    // So we must individually assign the 4 vec4 attribute pointers to receiver a mat4x4 in the shader
-    glEnableVertexAttribArray(3);
-    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(glm::vec4), (void*)0);
-    glEnableVertexAttribArray(4);
-    glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(glm::vec4), (void*)(sizeof(glm::vec4)));
-    glEnableVertexAttribArray(5);
-    glVertexAttribPointer(5, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(glm::vec4), (void*)(2 * sizeof(glm::vec4)));
-    glEnableVertexAttribArray(6);
-    glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(glm::vec4), (void*)(3 * sizeof(glm::vec4)));
-
-    // For glVertexAttribDivisor, the default value is 0 which means that the attribute is updated once per
-    // iteration of the vertex shader. Setting it to 1 means that the attribute is updated once per instance.
-    glVertexAttribDivisor(0, 0); // vec3 position
-    glVertexAttribDivisor(1, 0); // vec3 normal
-    glVertexAttribDivisor(2, 0); // vec2 texture coordinate
-    glVertexAttribDivisor(3, 1); //  \.
-    glVertexAttribDivisor(4, 1); //   \ mat4
-    glVertexAttribDivisor(5, 1); //   / model matrix
-    glVertexAttribDivisor(6, 1); //  /'
-
-    glBindVertexArray(0);
+    if(mesh->boundingRadius > meshRadius) { meshRadius = mesh->boundingRadius; }
   }
+  asteroidCuller.init(asteroidModelMatrices.data(), instances.data(), instanceSize, numAsteroids, meshRadius);
 
-  delete[] asteroidModelMatrices;
+  // NOTE: the VAOs reference the buffer object, reallocating its storage doesn't require respecifying the attributes
+  glBindBuffer(GL_ARRAY_BUFFER, asteroidInstanceBuffer);
+  glBufferData(GL_ARRAY_BUFFER, instances.size(), instances.data(), GL_STREAM_DRAW);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  numVisibleAsteroids = numAsteroids;
 }
 
 void AsteroidBeltScene::deinit()
@@ -128,12 +277,13 @@ void AsteroidBeltScene::deinit()
   delete skyboxShader;
 
   uint32 deleteTextures[] = { skyboxTextureId, skybox2TextureId };
-  glDeleteTextures(ArrayCount(deleteTextures), deleteTextures);
+  releaseTextures(ArrayCount(deleteTextures), deleteTextures);
 
   delete planetModel;
   delete asteroidModel;
 
-  glDeleteBuffers(1, &asteroidModelMatrixBuffer);
+  asteroidCuller.deinit();
+  glDeleteBuffers(1, &asteroidInstanceBuffer);
 }
 
 Framebuffer AsteroidBeltScene::drawFrame()
@@ -160,39 +310,55 @@ Framebuffer AsteroidBeltScene::drawFrame()
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);           // OpenGL state-using function
 
   float32 t = getTime();
-  deltaTime = t - lastFrame;
-  lastFrame = t;
+  float32 deltaTime = getDeltaTime();
 
   glm::mat4 viewMat = camera.UpdateViewMatrix(deltaTime, cameraMovementSpeed);
 
   modelShader->use();
-  modelShader->setUniform("view", viewMat);
-  modelShader->setUniform("cameraPos", camera.Position);
+  modelShader->setUniform(modelViewUniform, viewMat);
+  modelShader->setUniform(modelCameraPosUniform, camera.Position);
 
   // draw Planet
   glm::mat4 model(1.0f);
   model = glm::translate(model, glm::vec3(0.0f, -3.0f, 0.0f));
   model = glm::rotate(model, t * glm::radians(planetRotationSpeed), glm::vec3(0.0f, 1.0f, 0.0f));
   model = glm::scale(model, glm::vec3(4.0f, 4.0f, 4.0f));
-  modelShader->setUniform("model", model);
+  modelShader->setUniform(modelModelUniform, model);
   planetModel->Draw(*modelShader);
 
   // draw meteorites
+  glm::mat4 orbit = glm::rotate(glm::mat4(1.0f), t * glm::radians(-planetRotationSpeed), glm::vec3(0.0f, 1.0f, 0.0f));
+  glm::vec3 orbitCameraPosition = glm::vec3(glm::inverse(orbit) * glm::vec4(camera.Position, 1.0f));
+  float32 pixelsPerRadian = windowExtent.height / (2.0f * tanf(glm::radians(camera.Zoom) * 0.5f));
+  numVisibleAsteroids = asteroidCuller.cull(projectionMat * viewMat * orbit, orbitCameraPosition, pixelsPerRadian,
+                                            cullingEnabled, asteroidInstanceBuffer);
+
   reflectModelInstanceShader->use();
-  reflectModelInstanceShader->setUniform("view", viewMat);
-  reflectModelInstanceShader->setUniform("cameraPos", camera.Position);
-  reflectModelInstanceShader->setUniform("orbit", glm::rotate(glm::mat4(1.0f), t * glm::radians(-planetRotationSpeed), glm::vec3(0.0f, 1.0f, 0.0f)));
-  for (uint32 i = 0; i < asteroidModel->meshes.size(); i++)
+  reflectModelInstanceShader->setUniform(instanceViewUniform, viewMat);
+  reflectModelInstanceShader->setUniform(instanceCameraPosUniform, camera.Position);
+  reflectModelInstanceShader->setUniform(instanceOrbitUniform, orbit);
+  reflectModelInstanceShader->setUniform(instanceCompactInstancesUniform, instanceFormat != AsteroidInstanceFormat_Matrix);
+  glBindBuffer(GL_ARRAY_BUFFER, asteroidInstanceBuffer);
+  for (uint32 lod = 0; lod < asteroidCuller.lodCount(); lod++)
   {
-    glBindVertexArray(asteroidModel->meshes[i]->VAO);
-    glDrawElementsInstanced(GL_TRIANGLES, asteroidModel->meshes[i]->indicesCount, GL_UNSIGNED_INT, 0, numAsteroids);
+    uint32 lodInstanceCount = asteroidCuller.lodInstanceCount(lod);
+    if(lodInstanceCount == 0) { continue; }
+    const std::vector<Mesh*>& lodMeshes = asteroidModel->lodLevel(lod);
+    for (uint32 i = 0; i < lodMeshes.size(); i++)
+    {
+      glBindVertexArray(lodMeshes[i]->VAO);
+      pointInstanceAttributes(instanceFormat, asteroidCuller.lodFirstInstance(lod));
+      glDrawElementsInstancedBaseVertex(GL_TRIANGLES, lodMeshes[i]->indicesCount, GL_UNSIGNED_INT, lodMeshes[i]->indexOffset(),
+                                        lodInstanceCount, lodMeshes[i]->baseVertex);
+    }
   }
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
 
   // draw skybox
   glBindVertexArray(skyboxVertexAtt.arrayObject);
   skyboxShader->use();
   glm::mat4 viewMinusTranslation = glm::mat4(glm::mat3(viewMat));
-  skyboxShader->setUniform("view", viewMinusTranslation);
+  skyboxShader->setUniform(skyboxViewUniform, viewMinusTranslation);
   glDrawElements(GL_TRIANGLES, // drawing mode
                  36, // number of elements to draw (3 vertices per triangle * 2 triangles per face * 6 faces)
                  GL_UNSIGNED_INT, // type of the indices
@@ -201,6 +367,61 @@ Framebuffer AsteroidBeltScene::drawFrame()
   return drawFramebuffer;
 }
 
+void AsteroidBeltScene::drawGui()
+{
+  FirstPersonScene::drawGui();
+
+  ImGui::Begin("Asteroid Belt");
+  ImGui::Text("Asteroids: %u (1/2/3 to change)", numAsteroids);
+  ImGui::Text("Frustum culling: %s (F to toggle)", cullingEnabled ? "on" : "off");
+  ImGui::Text("Drawn: %u, culled: %u", numVisibleAsteroids, numAsteroids - numVisibleAsteroids);
+  ImGui::Text("Cull + compact: %.3f ms on %u threads", asteroidCuller.lastCullMilliseconds(), workerThreadCount() + 1);
+  ImGui::Text("Levels of detail: %s (L to toggle)", lodEnabled ? "on" : "off");
+  ImGui::Text("Instance format: %s, %u bytes (K to change)", asteroidInstanceFormatNames[instanceFormat],
+              asteroidInstanceSizes[instanceFormat]);
+  uint64 trianglesDrawn = 0;
+  for(uint32 lod = 0; lod < asteroidCuller.lodCount(); lod++)
+  {
+    uint64 lodTriangles = 0;
+    for(Mesh* mesh : asteroidModel->lodLevel(lod)) { lodTriangles += mesh->indicesCount / 3; }
+    ImGui::Text("  LOD %u: %u asteroids, %llu triangles each", lod, asteroidCuller.lodInstanceCount(lod), (unsigned long long)lodTriangles);
+    trianglesDrawn += lodTriangles * asteroidCuller.lodInstanceCount(lod);
+  }
+  ImGui::Text("Asteroid triangles drawn: %llu", (unsigned long long)trianglesDrawn);
+  ImGui::End();
+}
+
+void AsteroidBeltScene::inputStatesUpdated()
+{
+  FirstPersonScene::inputStatesUpdated();
+
+  if(hotPress(KeyboardInput_F))
+  {
+    cullingEnabled = !cullingEnabled;
+  }
+
+  if(hotPress(KeyboardInput_K))
+  {
+    setInstanceFormat((AsteroidInstanceFormat)((instanceFormat + 1) % AsteroidInstanceFormat_Count));
+    uploadAsteroidInstances();
+  }
+
+  if(hotPress(KeyboardInput_L))
+  {
+    lodEnabled = !lodEnabled;
+    updateLods();
+  }
+
+  InputType countKeys[] = { KeyboardInput_1, KeyboardInput_2, KeyboardInput_3 };
+  for(uint32 i = 0; i < ArrayCount(countKeys); i++)
+  {
+    if(hotPress(countKeys[i]) && asteroidCounts[i] != numAsteroids)
+    {
+      initAsteroids(asteroidCounts[i]);
+    }
+  }
+}
+
 void AsteroidBeltScene::framebufferSizeChangeRequest(Extent2D windowExtent)
 {
   Scene::framebufferSizeChangeRequest(windowExtent);
@@ -3,6 +3,14 @@
 #include "../FirstPersonScene.h"
 #include "../../common/ObjectData.h"
 #include "../../Model.h"
+#include "AsteroidCuller.h"
+
+enum AsteroidInstanceFormat {
+  AsteroidInstanceFormat_Matrix = 0, // 64 bytes, mat4 model matrix
+  AsteroidInstanceFormat_Compact, // 32 bytes, float position, uniform scale & rotation quaternion
+  AsteroidInstanceFormat_CompactHalf, // 16 bytes, half float position, uniform scale & rotation quaternion (lossy, opt-in)
+  AsteroidInstanceFormat_Count
+};
 
 class AsteroidBeltScene : public FirstPersonScene
 {
@@ -11,15 +19,30 @@ public:
   void init(Extent2D windowExtent);
   Framebuffer drawFrame();
   void deinit();
+  void drawGui();
+  void inputStatesUpdated();
   virtual void framebufferSizeChangeRequest(Extent2D windowExtent);
   const char* title();
 
 private:
+  void initAsteroids(uint32 count);
+  void uploadAsteroidInstances();
+  void setInstanceFormat(AsteroidInstanceFormat format);
+  void updateLods();
 
   ShaderProgram* modelShader;
   ShaderProgram* reflectModelInstanceShader;
   ShaderProgram* skyboxShader;
 
+  UniformHandle modelViewUniform;
+  UniformHandle modelCameraPosUniform;
+  UniformHandle modelModelUniform;
+  UniformHandle instanceViewUniform;
+  UniformHandle instanceCameraPosUniform;
+  UniformHandle instanceOrbitUniform;
+  UniformHandle instanceCompactInstancesUniform;
+  UniformHandle skyboxViewUniform;
+
   Model* planetModel = NULL;
   Model* asteroidModel = NULL;
 
@@ -27,14 +50,23 @@ private:
 
   VertexAtt skyboxVertexAtt = {};
 
-  uint32 asteroidModelMatrixBuffer;
+  uint32 asteroidInstanceBuffer; // NOTE: visible asteroids are compacted to the front every frame
+  // NOTE: half floats only keep 11 significant bits, positions out in the belt would visibly snap
+  AsteroidInstanceFormat instanceFormat = AsteroidInstanceFormat_Compact;
+  // NOTE: kept so the instance format can change without generating a new belt
+  std::vector<glm::vec4> asteroidPositionScales;
+  std::vector<glm::vec4> asteroidRotations;
+  AsteroidCuller asteroidCuller;
+  bool cullingEnabled = true;
+  bool lodEnabled = true;
+  uint32 numAsteroids = 0;
+  uint32 numVisibleAsteroids = 0;
+
+  glm::mat4 projectionMat;
 
   uint32 skyboxTextureId;
   uint32 skybox2TextureId;
 
   const float32 planetRotationSpeed = 5.0f;
-  const uint32 numAsteroids = 5000;
 
-  float32 deltaTime = 0.0f;  // Time between current frame and last frame
-  float32 lastFrame = 0.0f; // Time of last frame
 };
\ No newline at end of file
@@ -0,0 +1,287 @@
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#include "AsteroidCuller.h"
+
+#include <glad/glad.h>
+
+#include "../../common/FrameClock.h"
+
+// NOTE: The widest instruction set the compiler is allowed to use is picked at compile time
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ASTEROID_CULL_SIMD_LANES 4
+#else
+#define ASTEROID_CULL_SIMD_LANES 1
+#endif
+
+#define FRUSTUM_PLANE_COUNT 6
+
+// Gribb/Hartmann plane extraction, planes face inward and are normalized so plane distances are true distances
+file_access void extractFrustumPlanes(const glm::mat4& clip, glm::vec4* planes)
+{
+  // NOTE: glm is column major, clip[column][row]
+  glm::vec4 row0 = glm::vec4(clip[0][0], clip[1][0], clip[2][0], clip[3][0]);
+  glm::vec4 row1 = glm::vec4(clip[0][1], clip[1][1], clip[2][1], clip[3][1]);
+  glm::vec4 row2 = glm::vec4(clip[0][2], clip[1][2], clip[2][2], clip[3][2]);
+  glm::vec4 row3 = glm::vec4(clip[0][3], clip[1][3], clip[2][3], clip[3][3]);
+  planes[0] = row3 + row0; // left
+  planes[1] = row3 - row0; // right
+  planes[2] = row3 + row1; // bottom
+  planes[3] = row3 - row1; // top
+  planes[4] = row3 + row2; // near
+  planes[5] = row3 - row2; // far
+  for(uint32 i = 0; i < FRUSTUM_PLANE_COUNT; i++)
+  {
+    float32 normalLength = sqrtf(planes[i].x * planes[i].x + planes[i].y * planes[i].y + planes[i].z * planes[i].z);
+    planes[i] = planes[i] / normalLength;
+  }
+}
+
+void AsteroidCuller::init(const glm::mat4* modelMatrices, const void* instances, uint32 instanceSize, uint32 count,
+                          float32 meshRadius)
+{
+  this->count = count;
+  this->instanceSize = instanceSize;
+  chunkCount = (count + ASTEROID_CULL_CHUNK_SIZE - 1) / ASTEROID_CULL_CHUNK_SIZE;
+  uint32 paddedCount = chunkCount * ASTEROID_CULL_CHUNK_SIZE;
+
+  this->instances.assign((const uint8*)instances, (const uint8*)instances + (count * instanceSize));
+  centerX.assign(paddedCount, 0.0f);
+  centerY.assign(paddedCount, 0.0f);
+  centerZ.assign(paddedCount, 0.0f);
+  radius.assign(paddedCount, -INFINITY); // NOTE: a sphere of negative infinite radius is outside every plane
+  for(uint32 i = 0; i < count; i++)
+  {
+    const glm::mat4& model = modelMatrices[i];
+    centerX[i] = model[3][0];
+    centerY[i] = model[3][1];
+    centerZ[i] = model[3][2];
+
+    // the largest axis scale bounds the mesh under any rotation and non-uniform scale
+    float32 maxScaleSquared = 0.0f;
+    for(uint32 axis = 0; axis < 3; axis++)
+    {
+      float32 scaleSquared = model[axis][0] * model[axis][0] + model[axis][1] * model[axis][1] + model[axis][2] * model[axis][2];
+      if(scaleSquared > maxScaleSquared) { maxScaleSquared = scaleSquared; }
+    }
+    radius[i] = meshRadius * sqrtf(maxScaleSquared);
+  }
+
+  visibleIndices.assign(paddedCount, 0);
+  visibleLods.assign(paddedCount, 0);
+  chunkVisibleCounts.assign(chunkCount, 0);
+  chunkLodCounts.assign(chunkCount * ASTEROID_CULL_MAX_LODS, 0);
+  chunkLodFirstInstances.assign(chunkCount * ASTEROID_CULL_MAX_LODS, 0);
+  visible = 0;
+}
+
+void AsteroidCuller::deinit()
+{
+  waitForJobs(&jobs);
+  count = 0;
+  chunkCount = 0;
+  visible = 0;
+  instanceSize = 0;
+  instances.clear();
+  centerX.clear();
+  centerY.clear();
+  centerZ.clear();
+  radius.clear();
+  visibleIndices.clear();
+  visibleLods.clear();
+  chunkVisibleCounts.clear();
+  chunkLodCounts.clear();
+  chunkLodFirstInstances.clear();
+}
+
+void AsteroidCuller::setLods(uint32 lodCount, const float32* lodPixelRadii)
+{
+  if(lodCount < 1) { lodCount = 1; }
+  if(lodCount > ASTEROID_CULL_MAX_LODS) { lodCount = ASTEROID_CULL_MAX_LODS; }
+  lods = lodCount;
+  for(uint32 i = 0; i < lods - 1; i++) { this->lodPixelRadii[i] = lodPixelRadii[i]; }
+}
+
+uint32 AsteroidCuller::cull(const glm::mat4& localToClip, const glm::vec3& cameraPosition, float32 pixelsPerRadian,
+                            bool frustumCull, uint32 instanceBuffer)
+{
+  uint64 startNanoseconds = monotonicNanoseconds();
+
+  glm::vec4 planes[FRUSTUM_PLANE_COUNT];
+  if(frustumCull)
+  {
+    extractFrustumPlanes(localToClip, planes);
+  } else
+  {
+    // NOTE: every real sphere is infinitely in front of these, only the padding (negative infinite radius) is culled
+    for(uint32 i = 0; i < FRUSTUM_PLANE_COUNT; i++) { planes[i] = glm::vec4(0.0f, 0.0f, 0.0f, INFINITY); }
+  }
+
+  for(uint32 chunk = 0; chunk < chunkCount; chunk++)
+  {
+    addJob(&jobs, [this, chunk, &planes, &cameraPosition, pixelsPerRadian] {
+      cullChunk(chunk, planes, cameraPosition, pixelsPerRadian);
+    });
+  }
+  waitForJobs(&jobs);
+
+  // each level of detail is contiguous, chunks keep their order within a level
+  visible = 0;
+  for(uint32 lod = 0; lod < ASTEROID_CULL_MAX_LODS; lod++)
+  {
+    lodFirstInstances[lod] = visible;
+    for(uint32 chunk = 0; chunk < chunkCount; chunk++)
+    {
+      chunkLodFirstInstances[chunk * ASTEROID_CULL_MAX_LODS + lod] = visible;
+      visible += chunkLodCounts[chunk * ASTEROID_CULL_MAX_LODS + lod];
+    }
+    lodInstanceCounts[lod] = visible - lodFirstInstances[lod];
+  }
+
+  if(visible > 0)
+  {
+    // NOTE: invalidating lets the driver hand back fresh memory instead of waiting on last frame's draws
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    uint8* mappedInstances = (uint8*)glMapBufferRange(GL_ARRAY_BUFFER, 0, visible * instanceSize,
+                                                      GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if(mappedInstances != NULL)
+    {
+      // workers only write to the mapped memory, the map and unmap stay on the main thread
+      for(uint32 chunk = 0; chunk < chunkCount; chunk++)
+      {
+        if(chunkVisibleCounts[chunk] == 0) { continue; }
+        addJob(&jobs, [this, chunk, mappedInstances] { copyChunk(chunk, mappedInstances); });
+      }
+      waitForJobs(&jobs);
+      glUnmapBuffer(GL_ARRAY_BUFFER);
+    } else
+    {
+      std::cout << "ERROR::ASTEROID_CULLER::MAP_INSTANCE_BUFFER_FAILED" << std::endl;
+      visible = 0;
+      for(uint32 lod = 0; lod < ASTEROID_CULL_MAX_LODS; lod++) { lodInstanceCounts[lod] = 0; }
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+  }
+
+  cullMilliseconds = (monotonicNanoseconds() - startNanoseconds) / 1000000.0;
+  return visible;
+}
+
+// NOTE: Runs on worker threads
+// NOTE: An asteroid drops a level of detail for every threshold its projected radius, radius * pixelsPerRadian / distance,
+// NOTE: falls below. Compared squared as (radius * pixelsPerRadian)^2 < (threshold * distance)^2 to avoid the sqrt and divide.
+void AsteroidCuller::cullChunk(uint32 chunk, const glm::vec4* planes, const glm::vec3& cameraPosition, float32 pixelsPerRadian)
+{
+  uint32 first = chunk * ASTEROID_CULL_CHUNK_SIZE;
+  uint32* chunkIndices = &visibleIndices[first];
+  uint8* chunkLods = &visibleLods[first];
+  uint32 chunkVisible = 0;
+  uint32 lodThresholdCount = lods - 1;
+
+#if ASTEROID_CULL_SIMD_LANES == 4
+  __m128 planeX[FRUSTUM_PLANE_COUNT], planeY[FRUSTUM_PLANE_COUNT], planeZ[FRUSTUM_PLANE_COUNT], planeW[FRUSTUM_PLANE_COUNT];
+  for(uint32 i = 0; i < FRUSTUM_PLANE_COUNT; i++)
+  {
+    planeX[i] = _mm_set1_ps(planes[i].x);
+    planeY[i] = _mm_set1_ps(planes[i].y);
+    planeZ[i] = _mm_set1_ps(planes[i].z);
+    planeW[i] = _mm_set1_ps(planes[i].w);
+  }
+  __m128 lodThresholdsSquared[ASTEROID_CULL_MAX_LODS - 1];
+  for(uint32 i = 0; i < lodThresholdCount; i++) { lodThresholdsSquared[i] = _mm_set1_ps(lodPixelRadii[i] * lodPixelRadii[i]); }
+  const __m128 cameraX = _mm_set1_ps(cameraPosition.x);
+  const __m128 cameraY = _mm_set1_ps(cameraPosition.y);
+  const __m128 cameraZ = _mm_set1_ps(cameraPosition.z);
+  const __m128 pixelsPerRadianSquared = _mm_set1_ps(pixelsPerRadian * pixelsPerRadian);
+  const __m128 negativeZero = _mm_set1_ps(-0.0f);
+  alignas(16) uint32 lanes[4];
+
+  for(uint32 i = first; i < first + ASTEROID_CULL_CHUNK_SIZE; i += 4)
+  {
+    __m128 x = _mm_loadu_ps(&centerX[i]);
+    __m128 y = _mm_loadu_ps(&centerY[i]);
+    __m128 z = _mm_loadu_ps(&centerZ[i]);
+    __m128 r = _mm_loadu_ps(&radius[i]);
+    __m128 negativeRadius = _mm_xor_ps(r, negativeZero);
+    __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    for(uint32 p = 0; p < FRUSTUM_PLANE_COUNT; p++)
+    {
+      __m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planeX[p], x), _mm_mul_ps(planeY[p], y)),
+                               _mm_add_ps(_mm_mul_ps(planeZ[p], z), planeW[p]));
+      inside = _mm_and_ps(inside, _mm_cmpgt_ps(dist, negativeRadius));
+    }
+
+    __m128 toCameraX = _mm_sub_ps(x, cameraX);
+    __m128 toCameraY = _mm_sub_ps(y, cameraY);
+    __m128 toCameraZ = _mm_sub_ps(z, cameraZ);
+    __m128 distSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(toCameraX, toCameraX), _mm_mul_ps(toCameraY, toCameraY)),
+                                    _mm_mul_ps(toCameraZ, toCameraZ));
+    __m128 projectedRadiusSquared = _mm_mul_ps(_mm_mul_ps(r, r), pixelsPerRadianSquared);
+    // compare masks are all ones (-1) per lane, subtracting them counts the thresholds each lane is under
+    __m128i lod = _mm_setzero_si128();
+    for(uint32 t = 0; t < lodThresholdCount; t++)
+    {
+      __m128 under = _mm_cmplt_ps(projectedRadiusSquared, _mm_mul_ps(lodThresholdsSquared[t], distSquared));
+      lod = _mm_sub_epi32(lod, _mm_castps_si128(under));
+    }
+    _mm_store_si128((__m128i*)lanes, lod);
+
+    // branchless compaction, every lane's index is written but only visible lanes advance the count
+    uint32 mask = (uint32)_mm_movemask_ps(inside);
+    for(uint32 lane = 0; lane < 4; lane++)
+    {
+      chunkIndices[chunkVisible] = i + lane;
+      chunkLods[chunkVisible] = (uint8)lanes[lane];
+      chunkVisible += (mask >> lane) & 1;
+    }
+  }
+#else
+  for(uint32 i = first; i < first + ASTEROID_CULL_CHUNK_SIZE; i++)
+  {
+    bool inside = true;
+    for(uint32 p = 0; p < FRUSTUM_PLANE_COUNT; p++)
+    {
+      float32 dist = planes[p].x * centerX[i] + planes[p].y * centerY[i] + planes[p].z * centerZ[i] + planes[p].w;
+      inside = inside && (dist > -radius[i]);
+    }
+
+    float32 toCameraX = centerX[i] - cameraPosition.x;
+    float32 toCameraY = centerY[i] - cameraPosition.y;
+    float32 toCameraZ = centerZ[i] - cameraPosition.z;
+    float32 distSquared = toCameraX * toCameraX + toCameraY * toCameraY + toCameraZ * toCameraZ;
+    float32 projectedRadiusSquared = radius[i] * radius[i] * pixelsPerRadian * pixelsPerRadian;
+    uint32 lod = 0;
+    for(uint32 t = 0; t < lodThresholdCount; t++)
+    {
+      lod += (projectedRadiusSquared < lodPixelRadii[t] * lodPixelRadii[t] * distSquared) ? 1 : 0;
+    }
+
+    chunkIndices[chunkVisible] = i;
+    chunkLods[chunkVisible] = (uint8)lod;
+    chunkVisible += inside ? 1 : 0;
+  }
+#endif
+
+  uint32* lodCounts = &chunkLodCounts[chunk * ASTEROID_CULL_MAX_LODS];
+  for(uint32 lod = 0; lod < ASTEROID_CULL_MAX_LODS; lod++) { lodCounts[lod] = 0; }
+  for(uint32 i = 0; i < chunkVisible; i++) { lodCounts[chunkLods[i]]++; }
+  chunkVisibleCounts[chunk] = chunkVisible;
+}
+
+// NOTE: Runs on worker threads
+void AsteroidCuller::copyChunk(uint32 chunk, uint8* mappedInstances)
+{
+  const uint32* chunkIndices = &visibleIndices[chunk * ASTEROID_CULL_CHUNK_SIZE];
+  const uint8* chunkLods = &visibleLods[chunk * ASTEROID_CULL_CHUNK_SIZE];
+  uint32 lodCursors[ASTEROID_CULL_MAX_LODS];
+  for(uint32 lod = 0; lod < ASTEROID_CULL_MAX_LODS; lod++)
+  {
+    lodCursors[lod] = chunkLodFirstInstances[chunk * ASTEROID_CULL_MAX_LODS + lod];
+  }
+  for(uint32 i = 0; i < chunkVisibleCounts[chunk]; i++)
+  {
+    memcpy(mappedInstances + (lodCursors[chunkLods[i]]++ * instanceSize), &instances[chunkIndices[i] * instanceSize], instanceSize);
+  }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "../../common/WorkerPool.h"
+#include "../../LearnOpenGLPlatform.h"
+
+// NOTE: Frustum culls asteroid bounding spheres on the worker pool and compacts the instance data of the visible
+// NOTE: asteroids to the front of the instance buffer, so the instanced draw only covers what can be seen.
+// NOTE: Instance data is copied as opaque records, any per asteroid format the vertex shader understands works.
+// NOTE: Spheres are tested in the asteroids' own space (before the orbit rotation the vertex shader applies) by
+// NOTE: extracting the frustum planes from projection * view * orbit, the spheres themselves never move.
+// NOTE: Visible asteroids are also bucketed by level of detail on their projected radius in pixels, each level's
+// NOTE: matrices are contiguous in the instance buffer so every level is drawn with a single instanced draw.
+#define ASTEROID_CULL_CHUNK_SIZE 16384 // asteroids per job, must be a multiple of the SIMD lane count
+#define ASTEROID_CULL_MAX_LODS 4
+
+class AsteroidCuller
+{
+public:
+  // modelMatrices place the bounding spheres, instances holds the count records of instanceSize bytes that are uploaded
+  // for the visible asteroids. meshRadius is the asteroid mesh's bounding radius around its origin
+  void init(const glm::mat4* modelMatrices, const void* instances, uint32 instanceSize, uint32 count, float32 meshRadius);
+  void deinit();
+  // lodPixelRadii holds lodCount - 1 descending projected radii (in pixels), an asteroid smaller than lodPixelRadii[i]
+  // on screen is drawn with level of detail i + 1 or coarser. A lodCount of 1 puts everything in the first level.
+  void setLods(uint32 lodCount, const float32* lodPixelRadii);
+  // Culls against the planes of localToClip (when frustumCull is set) and writes the visible instance records to
+  // instanceBuffer (GL_ARRAY_BUFFER of at least count records), grouped by level of detail. cameraPosition is in the
+  // asteroids' space and pixelsPerRadian is the viewport height / (2 * tan(fovY / 2)). Returns the number of
+  // instances written. Must be called on the main thread.
+  uint32 cull(const glm::mat4& localToClip, const glm::vec3& cameraPosition, float32 pixelsPerRadian, bool frustumCull,
+              uint32 instanceBuffer);
+  uint32 asteroidCount() const { return count; }
+  uint32 visibleCount() const { return visible; }
+  uint32 lodCount() const { return lods; }
+  uint32 lodFirstInstance(uint32 lod) const { return lodFirstInstances[lod]; }
+  uint32 lodInstanceCount(uint32 lod) const { return lodInstanceCounts[lod]; }
+  float64 lastCullMilliseconds() const { return cullMilliseconds; }
+
+private:
+  void cullChunk(uint32 chunk, const glm::vec4* planes, const glm::vec3& cameraPosition, float32 pixelsPerRadian);
+  void copyChunk(uint32 chunk, uint8* mappedInstances);
+
+  uint32 count = 0;
+  uint32 instanceSize = 0;
+  uint32 chunkCount = 0;
+  uint32 visible = 0;
+  uint32 lods = 1;
+  float32 lodPixelRadii[ASTEROID_CULL_MAX_LODS - 1] = {};
+  uint32 lodFirstInstances[ASTEROID_CULL_MAX_LODS] = {};
+  uint32 lodInstanceCounts[ASTEROID_CULL_MAX_LODS] = {};
+  float64 cullMilliseconds = 0.0;
+
+  std::vector<uint8> instances;
+  // bounding spheres as structure of arrays, padded to a whole chunk with spheres that are never visible
+  std::vector<float32> centerX;
+  std::vector<float32> centerY;
+  std::vector<float32> centerZ;
+  std::vector<float32> radius;
+
+  // each chunk compacts the indices (and levels of detail) of its visible asteroids to the front of its own
+  // ASTEROID_CULL_CHUNK_SIZE region
+  std::vector<uint32> visibleIndices;
+  std::vector<uint8> visibleLods;
+  std::vector<uint32> chunkVisibleCounts;
+  // [chunk * ASTEROID_CULL_MAX_LODS + lod]
+  std::vector<uint32> chunkLodCounts;
+  std::vector<uint32> chunkLodFirstInstances;
+  JobCounter jobs;
+};
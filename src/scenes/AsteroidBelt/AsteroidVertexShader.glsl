@@ -2,6 +2,9 @@
 layout(location = 0) in vec3 aPosition;
 layout(location = 1) in vec3 aNormal;
 layout(location = 3) in mat4 aModel;
+// compact instances, 32 bytes as floats or 16 bytes as half floats
+layout(location = 7) in vec4 aPositionScale; // xyz: position, w: uniform scale
+layout(location = 8) in vec4 aRotation; // unit quaternion, xyz: imaginary, w: real
 
 out VS_OUT{
   vec3 Normal;
@@ -11,12 +14,30 @@ out VS_OUT{
 uniform mat4 projection;
 uniform mat4 view;
 uniform mat4 orbit;
+uniform bool compactInstances;
+
+vec3 rotate(vec4 q, vec3 v)
+{
+  return v + 2.0 * cross(q.xyz, cross(q.xyz, v) + q.w * v);
+}
 
 void main()
 {
-  mat4 model = orbit * aModel;
-  mat3 normalMat = mat3(transpose(inverse(model)));
-  vs_out.Normal = normalize(normalMat * aNormal);
-  vs_out.Position = vec3(model * vec4(aPosition, 1.0));
-  gl_Position = projection * view * model * vec4(aPosition, 1.0);
-}
\ No newline at end of file
+  vec3 worldPosition;
+  if(compactInstances)
+  {
+    // NOTE: the scale is uniform and orbit is a pure rotation, normals only need the rotations
+    vec4 rotation = normalize(aRotation); // half floats drift off unit length
+    vec3 localPosition = aPositionScale.xyz + aPositionScale.w * rotate(rotation, aPosition);
+    worldPosition = vec3(orbit * vec4(localPosition, 1.0));
+    vs_out.Normal = normalize(mat3(orbit) * rotate(rotation, aNormal));
+  } else
+  {
+    mat4 model = orbit * aModel;
+    mat3 normalMat = mat3(transpose(inverse(model)));
+    vs_out.Normal = normalize(normalMat * aNormal);
+    worldPosition = vec3(model * vec4(aPosition, 1.0));
+  }
+  vs_out.Position = worldPosition;
+  gl_Position = projection * view * vec4(worldPosition, 1.0);
+}
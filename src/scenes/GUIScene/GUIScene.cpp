@@ -6,6 +6,7 @@
 #include "../../common/FileLocations.h"
 #include "../../common/ObjectData.h"
 #include "../../common/Util.h"
+#include "../../common/FrameClock.h"
 #include "../../common/Input.h"
 
 const glm::vec3 startingBoundingBoxMin = glm::vec3(-1.0f, -1.0f, -1.0f);
@@ -86,9 +87,8 @@ Framebuffer GUIScene::drawFrame()
   glBindVertexArray(cubeVertexAtt.arrayObject);
   glViewport(0, 0, windowExtent.width, windowExtent.height);
 
-  float32 t = (float32) getTime() - startTime;
-  deltaTime = t - lastFrame;
-  lastFrame = t;
+  float32 t = getTime() - startTime;
+  float32 deltaTime = getDeltaTime();
 
   glBindFramebuffer(GL_FRAMEBUFFER, drawFramebuffer.id);
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -43,8 +43,6 @@ private:
   Framebuffer drawFramebuffer;
 
   float32 startTime = 0;
-  float32 deltaTime = 0;
-  float32 lastFrame = 0;
 
   std::string text;
   glm::mat4 projectionMat;
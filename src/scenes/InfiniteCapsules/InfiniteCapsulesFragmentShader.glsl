@@ -7,7 +7,8 @@ out vec4 FragColor;
 #define HIT_DIST 0.01
 
 float distPosToScene(vec3 pos);
-float distanceRayToScene(vec3 rayOrigin, vec3 rayDir);
+float distanceRayToScene(vec3 rayOrigin, vec3 rayDir, float startDist);
+vec4 coneMarchTile();
 float distToInfiniteSpheres(vec3 pos);
 float distToInfiniteCapsules(vec3 rayPos);
 float distToXZAlignedPlane(vec3 rayPos, float planeValue);
@@ -25,12 +26,20 @@ uniform float elapsedTime;
 uniform mat4 viewRotationMat;
 uniform vec3 lightPos;
 uniform vec3 lightColor;
+uniform bool conePrePass; // when true, each fragment cone marches a tile of the ray march instead
+uniform int coneTileSize;
+uniform sampler2D coneDistances; // start distance per tile, written by the cone pre-pass
 
 float sinElapsedTime;
 float cosElapsedTime;
 
 void main()
 {
+  if(conePrePass) {
+    FragColor = coneMarchTile();
+    return;
+  }
+
   vec2 uv = (gl_FragCoord.xy-0.5*viewPortResolution.xy)/viewPortResolution.y;
 
   vec3 rayDir = vec3(uv.x, uv.y, 1.0); // NOTE: Expected to be normalized!
@@ -40,7 +49,8 @@ void main()
   //sinElapsedTime = sin(elapsedTime / 4.0);
   //cosElapsedTime = cos(elapsedTime / 4.0);
 
-  float dist = distanceRayToScene(rayOrigin, rayDir);
+  float startDist = texelFetch(coneDistances, ivec2(gl_FragCoord.xy) / coneTileSize, 0).x;
+  float dist = distanceRayToScene(rayOrigin, rayDir, startDist);
   //vec3 worldColor = vec3((sinElapsedTime + 1.0) / 2.0, cos(elapsedTime/7), (cosElapsedTime + 1.0) / 2.0);
   //vec3 worldColor = vec3(1.0, 1.0, 0.4);
 
@@ -86,9 +96,10 @@ float getLight(vec3 surfacePos) {
 }
 
 // NOTE: ray dir is assumed to be normalized
-float distanceRayToScene(vec3 rayOrigin, vec3 rayDir) {
+// NOTE: startDist must be known to be free of the scene along the ray (ex: from coneMarchTile())
+float distanceRayToScene(vec3 rayOrigin, vec3 rayDir, float startDist) {
 
-  float dist = 0.0;
+  float dist = startDist;
 
   for(int i = 0; i < MAX_STEPS; i++) {
 
@@ -102,6 +113,35 @@ float distanceRayToScene(vec3 rayOrigin, vec3 rayDir) {
   return -1.0f;
 }
 
+// Marches a single cone enclosing every ray shot for a coneTileSize x coneTileSize tile of pixels.
+// Every ray of the tile is within coneRadius of the cone's center. The cone keeps widening as it advances, so a step s is only
+// safe while s + (dist + s) * coneRadiusPerDist <= posToScene, giving s = (posToScene - coneRadius) / (1 + coneRadiusPerDist).
+// returns vec4(distance every ray in the tile can start at, steps taken, 0, 0)
+vec4 coneMarchTile() {
+  // NOTE: gl_FragCoord is at the center of the pre-pass pixel, which is the center of the tile in ray march pixels
+  vec2 uv = (gl_FragCoord.xy * coneTileSize - 0.5*viewPortResolution.xy)/viewPortResolution.y;
+
+  vec3 rayDir = vec3(uv.x, uv.y, 1.0);
+  rayDir = vec3(vec4(rayDir, 0.0) * viewRotationMat);
+  rayDir = normalize(rayDir);
+
+  // NOTE: tile's half diagonal padded by a pixel, the image plane is 1.0 away so its distances bound the angle between rays
+  float coneRadiusPerDist = (0.5 * coneTileSize + 1.0) * sqrt(2.0) / viewPortResolution.y;
+
+  float dist = 0.0;
+  int i = 0;
+  for(; i < MAX_STEPS; i++) {
+    vec3 pos = rayOrigin + (dist * rayDir);
+    float posToScene = distPosToScene(pos);
+    float safeDist = (posToScene - (dist * coneRadiusPerDist)) / (1.0 + coneRadiusPerDist);
+    if(safeDist < HIT_DIST) break; // cone touches the scene, rays must continue on their own
+    dist += safeDist;
+    if(posToScene > MISS_DIST) break;
+  }
+
+  return vec4(dist, i, 0.0, 0.0);
+}
+
 float distPosToScene(vec3 rayPos) {
   return distToInfiniteCapsules(rayPos);
 }
@@ -5,8 +5,11 @@
 #include "InfiniteCapsulesScene.h"
 #include "../../common/FileLocations.h"
 #include "../../common/Util.h"
+#include "../../common/FrameClock.h"
 #include "../../common/Input.h"
 
+const uint32 coneTextureIndex = 0;
+
 InfiniteCapsulesScene::InfiniteCapsulesScene(): FirstPersonScene()
 {
   camera.Position = glm::vec3(0.0f, 1.0f, 0.0f);
@@ -26,14 +29,16 @@ void InfiniteCapsulesScene::init(Extent2D windowExtent)
   quadVertexAtt = initializeFramebufferQuadVertexAttBuffers();
 
   drawFramebuffer = initializeFramebuffer(windowExtent, FramebufferCreate_NoDepthStencil);
+  initConeFramebuffer();
 
   rayMarchingShader->use();
   rayMarchingShader->setUniform("viewPortResolution", glm::vec2(windowExtent.width, windowExtent.height));
   rayMarchingShader->setUniform("lightColor", glm::vec3(0.5f, 0.5f, 0.5f));
   rayMarchingShader->setUniform("lightPos", lightPosition);
+  rayMarchingShader->setUniform("coneTileSize", CONE_MARCH_TILE_SIZE);
+  rayMarchingShader->setUniform("coneDistances", (int32)coneTextureIndex);
 
-  lastFrame = getTime();
-  startTime = lastFrame;
+  startTime = getTime();
 }
 
 void InfiniteCapsulesScene::deinit() {
@@ -44,20 +49,26 @@ void InfiniteCapsulesScene::deinit() {
 
   deleteVertexAtt(quadVertexAtt);
 
-  deleteFramebuffer(&drawFramebuffer);
+  Framebuffer* sceneFramebuffers[] = { &drawFramebuffer, &coneFramebuffer };
+  deleteFramebuffers(ArrayCount(sceneFramebuffers), sceneFramebuffers);
+}
+
+void InfiniteCapsulesScene::initConeFramebuffer()
+{
+  Extent2D coneExtent = {
+          (windowExtent.width + CONE_MARCH_TILE_SIZE - 1) / CONE_MARCH_TILE_SIZE,
+          (windowExtent.height + CONE_MARCH_TILE_SIZE - 1) / CONE_MARCH_TILE_SIZE
+  };
+  coneFramebuffer = initializeFramebuffer(coneExtent, (FramebufferCreationFlags)(FramebufferCreate_NoDepthStencil | FramebufferCreate_color_RG32F));
 }
 
 Framebuffer InfiniteCapsulesScene::drawFrame() {
   glDisable(GL_DEPTH_TEST);
   glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
-  glViewport(0, 0, windowExtent.width, windowExtent.height);
   glBindVertexArray(quadVertexAtt.arrayObject);
-  glBindFramebuffer(GL_FRAMEBUFFER, drawFramebuffer.id);
-  glClear(GL_COLOR_BUFFER_BIT);
 
   float32 t = getTime() - startTime;
-  deltaTime = t - lastFrame;
-  lastFrame = t;
+  float32 deltaTime = getDeltaTime();
 
   glm::mat4 cameraRotationMatrix = camera.UpdateViewMatrix(deltaTime, cameraMovementSpeed * 4.0f, false);
   rayMarchingShader->use();
@@ -71,10 +82,25 @@ Framebuffer InfiniteCapsulesScene::drawFrame() {
     lightDistanceTraveled += glm::length(lightDelta);
     if(lightDistanceTraveled > 100.0) lightAlive = false;
   }
+
+  // cone march pre-pass, one fragment per tile
+  glBindFramebuffer(GL_FRAMEBUFFER, coneFramebuffer.id);
+  glViewport(0, 0, coneFramebuffer.extent.width, coneFramebuffer.extent.height);
+  rayMarchingShader->setUniform("conePrePass", true);
+  glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+  rayMarchingShader->setUniform("conePrePass", false);
+
+  // NOTE: bound only between the pre-pass and the ray march so the texture is never bound while being rendered to
+  glActiveTexture(GL_TEXTURE0 + coneTextureIndex);
+  glBindTexture(GL_TEXTURE_2D, coneFramebuffer.colorAttachment);
+  glBindFramebuffer(GL_FRAMEBUFFER, drawFramebuffer.id);
+  glViewport(0, 0, windowExtent.width, windowExtent.height);
+  glClear(GL_COLOR_BUFFER_BIT);
   glDrawElements(GL_TRIANGLES, // drawing mode
                  6, // number of elements to draw (3 vertices per triangle * 2 triangles per quad)
                  GL_UNSIGNED_INT, // type of the indices
                  0); // offset in the EBO
+  glBindTexture(GL_TEXTURE_2D, 0);
 
    return drawFramebuffer;
 }
@@ -94,8 +120,10 @@ void InfiniteCapsulesScene::framebufferSizeChangeRequest(Extent2D windowExtent)
 {
   Scene::framebufferSizeChangeRequest(windowExtent);
 
-  deleteFramebuffer(&drawFramebuffer);
+  Framebuffer* sceneFramebuffers[] = { &drawFramebuffer, &coneFramebuffer };
+  deleteFramebuffers(ArrayCount(sceneFramebuffers), sceneFramebuffers);
   drawFramebuffer = initializeFramebuffer(windowExtent, FramebufferCreate_NoDepthStencil);
+  initConeFramebuffer();
 
   rayMarchingShader->use();
   rayMarchingShader->setUniform("viewPortResolution", glm::vec2(windowExtent.width, windowExtent.height));
@@ -8,6 +8,10 @@
 #include "../../common/ObjectData.h"
 #include "../../ShaderProgram.h"
 
+// NOTE: The cone pre-pass marches one cone per tile of pixels to find how far all of the tile's rays
+// NOTE: can travel before any may hit, letting the full resolution pass skip the empty space in front of the capsules.
+#define CONE_MARCH_TILE_SIZE 8
+
 class InfiniteCapsulesScene final : public FirstPersonScene {
 public:
   InfiniteCapsulesScene();
@@ -19,15 +23,16 @@ public:
   const char* title();
 
 private:
+  void initConeFramebuffer();
+
   ShaderProgram* rayMarchingShader = NULL;
 
   float32 startTime = 0;
-  float32 deltaTime = 0;
-  float32 lastFrame = 0;
 
   VertexAtt quadVertexAtt;
 
   Framebuffer drawFramebuffer;
+  Framebuffer coneFramebuffer; // NOTE: one texel per CONE_MARCH_TILE_SIZE tile of drawFramebuffer, start distance + steps taken
 
   glm::vec3 lightPosition = { 0.0f, 0.0f, 0.0f };
   bool lightAlive = false;
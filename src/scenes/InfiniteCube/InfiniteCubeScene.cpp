@@ -3,6 +3,9 @@
 #include "../../common/FileLocations.h"
 #include "../../common/ObjectData.h"
 #include "../../common/Util.h"
+#include "../../common/FrameClock.h"
+#include "../../common/TextureCache.h"
+#include "../../common/UniformRing.h"
 
 const uint32 colorAttachmentTextureIndex = 0;
 const uint32 outlineTextureIndex = 1;
@@ -22,7 +25,7 @@ void InfiniteCubeScene::init(Extent2D windowExtent)
 
   cubeVertexAtt = initializeCubePosNormTexVertexAttBuffers();
 
-  load2DTexture(outlineTextureLoc, outlineTexture);
+  acquire2DTexture(outlineTextureLoc, outlineTexture);
 
   drawFramebuffer = initializeFramebuffer(windowExtent);
   uint32 framebufferDimen = windowExtent.width < windowExtent.height ? windowExtent.width : windowExtent.height;
@@ -31,14 +34,8 @@ void InfiniteCubeScene::init(Extent2D windowExtent)
   const float32 aspectRatio = (float32)windowExtent.width / (float32)windowExtent.height;
   projectionMat = glm::perspective(glm::radians(camera.Zoom), aspectRatio, 0.1f, 100.0f);
 
-  {
-    glGenBuffers(1, &globalVSUniformBufferID);
-
-    glBindBuffer(GL_UNIFORM_BUFFER, globalVSUniformBufferID);
-    glBufferData(GL_UNIFORM_BUFFER, 2 * sizeof(glm::mat4), NULL, GL_STATIC_DRAW);
-
-    cubeShader->bindBlockIndex("globalBlockVS", globalVSBufferBindIndex);
-  }
+  ShaderProgram::finishLinks(&cubeShader, 1);
+  cubeShader->bindBlockIndex("globalBlockVS", globalVSBufferBindIndex);
 }
 
 void InfiniteCubeScene::deinit()
@@ -50,12 +47,10 @@ void InfiniteCubeScene::deinit()
 
   deleteVertexAtt(cubeVertexAtt);
 
-  glDeleteTextures(1, &outlineTexture);
+  releaseTexture(outlineTexture);
 
   Framebuffer* framebuffers[] = { &drawFramebuffer, &infiniteCubeTextureFramebuffer };
   deleteFramebuffers(ArrayCount(framebuffers), framebuffers);
-
-  glDeleteBuffers(1, &globalVSUniformBufferID);
 }
 
 Framebuffer InfiniteCubeScene::drawFrame()
@@ -75,8 +70,7 @@ Framebuffer InfiniteCubeScene::drawFrame()
   glDepthFunc(GL_LESS);
 
   float32 t = getTime();
-  deltaTime = t - lastFrame;
-  lastFrame = t;
+  float32 deltaTime = getDeltaTime();
 
 #if 0
   // control when we "change frames" for the cube
@@ -105,16 +99,9 @@ Framebuffer InfiniteCubeScene::drawFrame()
 
   glm::mat4 viewMat = camera.UpdateViewMatrix(deltaTime, cameraMovementSpeed);
 
-  glBindBuffer(GL_UNIFORM_BUFFER, globalVSUniformBufferID);
   // update global view matrix uniform
-  glBindBufferRange(GL_UNIFORM_BUFFER,    // target
-                    globalVSBufferBindIndex,  // index of binding point
-                    globalVSUniformBufferID,  // buffer id
-                    0,            // starting offset into buffer object
-                    4 * 16);        // size: 4 vec3's, 16 bits alignments
-  glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(glm::mat4), glm::value_ptr(projectionMat));
-  glBufferSubData(GL_UNIFORM_BUFFER, globalVSBufferViewMatOffset, sizeof(glm::mat4), glm::value_ptr(viewMat));
-  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+  struct { glm::mat4 projection; glm::mat4 view; } globalVS = { projectionMat, viewMat }; // globalBlockVS (std140)
+  bindUniformBlock(globalVSBufferBindIndex, pushUniformBlock(&globalVS, sizeof(globalVS)));
 
   // set texture uniforms
   glBindVertexArray(cubeVertexAtt.arrayObject);
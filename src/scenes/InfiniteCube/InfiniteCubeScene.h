@@ -54,15 +54,9 @@ private:
   glm::mat4 projectionMat;
 
   uint32 outlineTexture;
-  uint32 globalVSUniformBufferID;
   uint32 globalVSBufferBindIndex = 0;
-  uint32 globalVSBufferViewMatOffset = sizeof(glm::mat4);
   const float32 cubeRotationAngle = 2.5f;
 
-  // frame rate
-  float32 deltaTime = 0.0f;  // Time between current frame and last frame
-  float32 lastFrame = 0.0f; // Time of last frame
-
   Framebuffer drawFramebuffer;
   Framebuffer infiniteCubeTextureFramebuffer;
   uint32 colorIndex = 0;
@@ -5,9 +5,12 @@
 
 #include "../../common/FileLocations.h"
 #include "../../common/Util.h"
+#include "../../common/FrameClock.h"
 
 #include "KernelScene.h"
 #include "../../common/Input.h"
+#include "../../common/TextureCache.h"
+#include "../../common/UniformRing.h"
 
 const uint32 skyboxTextureIndex = 0;
 const uint32 nessCubeDiffuseTextureIndex = 1;
@@ -55,7 +58,7 @@ void KernelScene::init(Extent2D windowExtent)
   FirstPersonScene::init(windowExtent);
 
   const float32 aspectRatio = (float32)windowExtent.width / (float32)windowExtent.height;
-  projectionMat = glm::perspective(glm::radians(camera.Zoom), aspectRatio, 0.1f, 100.0f);
+  projectionMat = glm::perspective(glm::radians(camera.Zoom), aspectRatio, 0.1f, projectionFar);
 
   cubeShader = new ShaderProgram(posNormTexVertexShaderFileLoc, nessCubeFragmentShaderFileLoc);
   lightShader = new ShaderProgram(posGlobalBlockVertexShaderFileLoc, SingleColorFragmentShaderFileLoc);
@@ -76,6 +79,9 @@ void KernelScene::init(Extent2D windowExtent)
 
   nanoSuitModel = new Model(nanoSuitModelLoc);
 
+  ShaderProgram* shaders[] = { cubeShader, lightShader, modelShader, stencilShader, framebufferShader, skyboxShader };
+  ShaderProgram::finishLinks(shaders, ArrayCount(shaders));
+
   auto setConstantLightUniforms = [&](ShaderProgram* shader)
   {
     // positional light constants
@@ -91,19 +97,26 @@ void KernelScene::init(Extent2D windowExtent)
     shader->setUniform("spotLight.attenuation.quadratic", 0.032f);
   };
 
-  glGenBuffers(1, &globalVSUniformBuffer);
-  glBindBuffer(GL_UNIFORM_BUFFER, globalVSUniformBuffer);
-  glBufferData(GL_UNIFORM_BUFFER, 2 * sizeof(glm::mat4), NULL, GL_STATIC_DRAW);
+  auto getDynamicLightUniforms = [&](ShaderProgram* shader)
+  {
+    DynamicLightUniforms uniforms;
+    uniforms.positionalLightPosition = shader->getUniformHandle("positionalLight.position");
+    uniforms.positionalLightAmbient = shader->getUniformHandle("positionalLight.color.ambient");
+    uniforms.positionalLightDiffuse = shader->getUniformHandle("positionalLight.color.diffuse");
+    uniforms.positionalLightSpecular = shader->getUniformHandle("positionalLight.color.specular");
+    uniforms.spotLightPosition = shader->getUniformHandle("spotLight.position");
+    uniforms.spotLightDirection = shader->getUniformHandle("spotLight.direction");
+    uniforms.spotLightAmbient = shader->getUniformHandle("spotLight.color.ambient");
+    uniforms.spotLightDiffuse = shader->getUniformHandle("spotLight.color.diffuse");
+    uniforms.spotLightSpecular = shader->getUniformHandle("spotLight.color.specular");
+    return uniforms;
+  };
 
   cubeShader->bindBlockIndex("globalBlockVS", globalVSBufferBindIndex);
   modelShader->bindBlockIndex("globalBlockVS", globalVSBufferBindIndex);
   lightShader->bindBlockIndex("globalBlockVS", globalVSBufferBindIndex);
   stencilShader->bindBlockIndex("globalBlockVS", globalVSBufferBindIndex);
 
-  glGenBuffers(1, &globalFSUniformBuffer);
-  glBindBuffer(GL_UNIFORM_BUFFER, globalFSUniformBuffer);
-  glBufferData(GL_UNIFORM_BUFFER, 64, NULL, GL_STATIC_DRAW);
-
   cubeShader->bindBlockIndex("globalBlockFS", globalFSBufferBindIndex);
   modelShader->bindBlockIndex("globalBlockFS", globalFSBufferBindIndex);
 
@@ -115,27 +128,43 @@ void KernelScene::init(Extent2D windowExtent)
   cubeShader->setUniform("material.shininess", 32.0f);
   cubeShader->setUniform("material.diffTexture1", nessCubeDiffuseTextureIndex);
   cubeShader->setUniform("material.specTexture1", nessCubeSpecularTextureIndex);
+  cubeModelUniform = cubeShader->getUniformHandle("model");
+  cubeAnimSwitchUniform = cubeShader->getUniformHandle("animSwitch");
+  cubeViewPosUniform = cubeShader->getUniformHandle("viewPos");
+  cubeViewUniform = cubeShader->getUniformHandle("view");
+  cubeLightUniforms = getDynamicLightUniforms(cubeShader);
+  lightModelUniform = lightShader->getUniformHandle("model");
+  lightColorUniform = lightShader->getUniformHandle("color");
 
   modelShader->use();
   setConstantLightUniforms(modelShader);
   modelShader->setUniform("material.shininess", 32.0f);
   modelShader->setUniform("model", nanoSuitModelMatrix);
+  modelViewPosUniform = modelShader->getUniformHandle("viewPos");
+  modelViewUniform = modelShader->getUniformHandle("view");
+  modelLightUniforms = getDynamicLightUniforms(modelShader);
+
+  stencilColorUniform = stencilShader->getUniformHandle("color");
+  stencilViewUniform = stencilShader->getUniformHandle("view");
+  stencilModelUniform = stencilShader->getUniformHandle("model");
 
   skyboxShader->use();
   skyboxShader->setUniform("projection", projectionMat);
   skyboxShader->setUniform("skybox", skyboxTextureIndex);
+  skyboxViewUniform = skyboxShader->getUniformHandle("view");
 
   framebufferShader->use();
   framebufferShader->setUniform("textureWidth", (float32)windowExtent.width);
   framebufferShader->setUniform("textureHeight", (float32)windowExtent.height);
   framebufferShader->setUniform("tex", colorAttachmentTextureIndex);
+  framebufferKernelUniform = framebufferShader->getUniformHandle("kernel");
 }
 
 void KernelScene::initializeTextures(uint32& diffTextureId, uint32& specTextureId, uint32& skyboxTextureId)
 {
-  load2DTexture(diffuseTextureLoc, diffTextureId, true, true);
-  load2DTexture(specularTextureLoc, specTextureId, true, false);
-  loadCubeMapTexture(skyboxWaterFaceLocations, skyboxTextureId);
+  acquire2DTexture(diffuseTextureLoc, diffTextureId, true, true);
+  acquire2DTexture(specularTextureLoc, specTextureId, true, false);
+  acquireCubeMapTexture(skyboxWaterFaceLocations, skyboxTextureId);
 }
 
 void KernelScene::deinit(){
@@ -158,17 +187,13 @@ void KernelScene::deinit(){
   deleteVertexAtts(ArrayCount(deleteVertexAttributes), deleteVertexAttributes);
 
   uint32 deleteTextures[] = { cubeDiffTextureId, cubeSpecTextureId, skyboxTextureId };
-  glDeleteTextures(ArrayCount(deleteTextures), deleteTextures);
+  releaseTextures(ArrayCount(deleteTextures), deleteTextures);
 
   Framebuffer* framebuffers[] = { &preprocessFramebuffer, &postprocessFramebuffer };
   deleteFramebuffers(ArrayCount(framebuffers), framebuffers);
 
   delete nanoSuitModel;
 
-  glBindBuffer(GL_UNIFORM_BUFFER, 0); // unbind uniform buffers
-  uint32 deleteBuffers[] = { globalVSUniformBuffer, globalFSUniformBuffer };
-  glDeleteBuffers(ArrayCount(deleteBuffers), deleteBuffers);
-
   glDisable(GL_STENCIL_TEST);
 }
 
@@ -185,8 +210,6 @@ Framebuffer KernelScene::drawFrame(){
   glFrontFace(GL_CCW);
   glCullFace(GL_BACK);
 
-  glBindBuffer(GL_UNIFORM_BUFFER, globalVSUniformBuffer);
-
   glEnable(GL_STENCIL_TEST);
   glStencilOp(GL_KEEP, // Keep current stencil value when stencil test fails
               GL_KEEP, // Keep current stencil value when stencil test passes but depth fails
@@ -206,8 +229,7 @@ Framebuffer KernelScene::drawFrame(){
   glm::vec3 flashLightColor = flashLightOn ? glm::vec3(1.0f, 1.0f, 1.0f) : glm::vec3(0.0f);
 
   float32 t = getTime();
-  deltaTime = t - lastFrame;
-  lastFrame = t;
+  float32 deltaTime = getDeltaTime();
   float32 sineVal = sinf(t);
   float32 lightR = (sinf((t + 30.0f) / 3.0f) / 2.0f) + 0.5f;
   float32 lightG = (sinf((t + 60.0f) / 8.0f) / 2.0f) + 0.5f;
@@ -217,25 +239,17 @@ Framebuffer KernelScene::drawFrame(){
   glm::mat4 viewMat = camera.UpdateViewMatrix(deltaTime, cameraMovementSpeed);
 
   // update global uniforms
-  glBindBuffer(GL_UNIFORM_BUFFER, globalVSUniformBuffer);
-  glBindBufferRange(GL_UNIFORM_BUFFER,    // target
-                    globalVSBufferBindIndex,  // index of binding point
-                    globalVSUniformBuffer,  // buffer id
-                    0,            // starting offset into buffer object
-                    4 * 16);        // size: 4 vec3's, 16 bits alignments
-  glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(glm::mat4), glm::value_ptr(projectionMat));
-  glBufferSubData(GL_UNIFORM_BUFFER, globalVSBufferViewMatOffset, sizeof(glm::mat4), glm::value_ptr(viewMat));
-
-  glBindBuffer(GL_UNIFORM_BUFFER, globalFSUniformBuffer);
-  glBindBufferRange(GL_UNIFORM_BUFFER,    // target
-                    globalFSBufferBindIndex,  // index of binding point
-                    globalFSUniformBuffer,  // buffer id
-                    0,            // starting offset into buffer object
-                    4 * 16);          // size: 4 vec3's, 16 bits alignments
-  glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(glm::vec3), glm::value_ptr(directionalLightDir));
-  glBufferSubData(GL_UNIFORM_BUFFER, 16, sizeof(glm::vec3), glm::value_ptr(directionalLightColor * 0.1f)); // ambient
-  glBufferSubData(GL_UNIFORM_BUFFER, 32, sizeof(glm::vec3), glm::value_ptr(directionalLightColor * 0.3f)); // diffuse
-  glBufferSubData(GL_UNIFORM_BUFFER, 48, sizeof(glm::vec3), glm::value_ptr(directionalLightColor * 0.6f)); // specular
+  struct { glm::mat4 projection; glm::mat4 view; } globalVS = { projectionMat, viewMat }; // globalBlockVS (std140)
+  bindUniformBlock(globalVSBufferBindIndex, pushUniformBlock(&globalVS, sizeof(globalVS)));
+
+  // NOTE: std140 pads vec3s to 16 bytes
+  struct { glm::vec4 directionalLightDir, ambient, diffuse, specular; } globalFS = { // globalBlockFS (std140)
+          glm::vec4(directionalLightDir, 0.0f),
+          glm::vec4(directionalLightColor * 0.1f, 0.0f),
+          glm::vec4(directionalLightColor * 0.3f, 0.0f),
+          glm::vec4(directionalLightColor * 0.6f, 0.0f)
+  };
+  bindUniformBlock(globalFSBufferBindIndex, pushUniformBlock(&globalFS, sizeof(globalFS)));
 
   // oscillate with time
   const glm::vec3 lightPosition = glm::vec3(lightOrbitRadius * sinf(t * lightOrbitSpeed), sineVal, lightOrbitRadius * cosf(t * lightOrbitSpeed));
@@ -244,125 +258,116 @@ Framebuffer KernelScene::drawFrame(){
   lightModelMat = glm::translate(lightModelMat, lightPosition);
   lightModelMat = glm::scale(lightModelMat, glm::vec3(lightScale));
 
+  renderQueue.begin(camera.Position, projectionFar);
+
   // draw positional light
-  glBindVertexArray(lightVertexAtt.arrayObject);
   lightShader->use();
-  lightShader->setUniform("model", lightModelMat);
-  lightShader->setUniform("color", positionalLightColor);
-  glDrawElements(GL_TRIANGLES, // drawing mode
-                 cubePosNormTexNumElements * 3, // number of elements to draw (3 vertices per triangle * 2 triangles per face * 6 faces)
-                 GL_UNSIGNED_INT, // type of the indices
-                 0); // offset in the EBO
+  lightShader->setUniform(lightColorUniform, positionalLightColor);
+  RenderPacket lightPacket = {};
+  lightPacket.shader = lightShader;
+  lightPacket.vertexArray = lightVertexAtt.arrayObject;
+  lightPacket.flags = RenderPacketFlag_ModelMatrix;
+  lightPacket.modelUniform = lightModelUniform;
+  lightPacket.model = lightModelMat;
+  lightPacket.indexCount = cubePosNormTexNumElements * 3; // 3 vertices per triangle * 2 triangles per face * 6 faces
+  renderQueue.submit(RenderLayer_Opaque, lightPosition, lightPacket);
 
   // draw skybox
-  glBindVertexArray(skyboxVertexAtt.arrayObject);
   glm::mat4 viewMinusTranslation = glm::mat4(glm::mat3(viewMat));
-  glActiveTexture(GL_TEXTURE0 + skyboxTextureIndex);
-  glBindTexture(GL_TEXTURE_CUBE_MAP, skyboxTextureId);
   skyboxShader->use();
-  skyboxShader->setUniform("view", viewMinusTranslation);
-  glDrawElements(GL_TRIANGLES, // drawing mode
-                 36, // number of elements to draw (3 vertices per triangle * 2 triangles per face * 6 faces)
-                 GL_UNSIGNED_INT, // type of the indices
-                 0); // offset in the EBO
-
-  auto setDynamicLightUniforms = [&](ShaderProgram* shader)
+  skyboxShader->setUniform(skyboxViewUniform, viewMinusTranslation);
+  RenderPacket skyboxPacket = {};
+  skyboxPacket.shader = skyboxShader;
+  skyboxPacket.vertexArray = skyboxVertexAtt.arrayObject;
+  skyboxPacket.textureCount = 1;
+  skyboxPacket.textures[0] = { GL_TEXTURE_CUBE_MAP, skyboxTextureId, skyboxTextureIndex };
+  skyboxPacket.indexCount = 36; // 3 vertices per triangle * 2 triangles per face * 6 faces
+  renderQueue.submit(RenderLayer_Background, camera.Position, skyboxPacket);
+
+  auto setDynamicLightUniforms = [&](ShaderProgram* shader, const DynamicLightUniforms& uniforms)
   {
     // positional light (orbiting light)
-    shader->setUniform("positionalLight.position", lightPosition);
-    shader->setUniform("positionalLight.color.ambient", positionalLightColor * 0.05f);
-    shader->setUniform("positionalLight.color.diffuse", positionalLightColor * 0.3f);
-    shader->setUniform("positionalLight.color.specular", positionalLightColor * 1.0f);
+    shader->setUniform(uniforms.positionalLightPosition, lightPosition);
+    shader->setUniform(uniforms.positionalLightAmbient, positionalLightColor * 0.05f);
+    shader->setUniform(uniforms.positionalLightDiffuse, positionalLightColor * 0.3f);
+    shader->setUniform(uniforms.positionalLightSpecular, positionalLightColor * 1.0f);
 
     // flash light
-    shader->setUniform("spotLight.position", camera.Position);
-    shader->setUniform("spotLight.direction", camera.Front);
-    shader->setUniform("spotLight.color.ambient", flashLightColor * 0.05f);
-    shader->setUniform("spotLight.color.diffuse", flashLightColor * 0.3f);
-    shader->setUniform("spotLight.color.specular", flashLightColor * 0.5f);
+    shader->setUniform(uniforms.spotLightPosition, camera.Position);
+    shader->setUniform(uniforms.spotLightDirection, camera.Front);
+    shader->setUniform(uniforms.spotLightAmbient, flashLightColor * 0.05f);
+    shader->setUniform(uniforms.spotLightDiffuse, flashLightColor * 0.3f);
+    shader->setUniform(uniforms.spotLightSpecular, flashLightColor * 0.5f);
   };
 
   // draw cubes
-  glBindVertexArray(cubeVertexAtt.arrayObject);
   bool animSwitch = sin(8 * t) > 0; // switch between two images over time
-  glActiveTexture(GL_TEXTURE0 + nessCubeDiffuseTextureIndex);
-  glBindTexture(GL_TEXTURE_2D, cubeDiffTextureId);
-  glActiveTexture(GL_TEXTURE0 + nessCubeSpecularTextureIndex);
-  glBindTexture(GL_TEXTURE_2D, cubeSpecTextureId);
   cubeShader->use();
-  setDynamicLightUniforms(cubeShader);
-  cubeShader->setUniform("animSwitch", animSwitch);
-  cubeShader->setUniform("viewPos", camera.Position);
-  cubeShader->setUniform("view", viewMat);
-
-  glm::mat4 cubeModelMats[ArrayCount(cubePositions)];
-  for (uint32 i = 0; i < ArrayCount(cubeModelMats); i++)
+  setDynamicLightUniforms(cubeShader, cubeLightUniforms);
+  cubeShader->setUniform(cubeAnimSwitchUniform, animSwitch);
+  cubeShader->setUniform(cubeViewPosUniform, camera.Position);
+  cubeShader->setUniform(cubeViewUniform, viewMat);
+
+  RenderPacket cubePacket = {};
+  cubePacket.shader = cubeShader;
+  cubePacket.vertexArray = cubeVertexAtt.arrayObject;
+  cubePacket.flags = RenderPacketFlag_ModelMatrix | RenderPacketFlag_BackFacesFirst;
+  cubePacket.textureCount = 2;
+  cubePacket.textures[0] = { GL_TEXTURE_2D, cubeDiffTextureId, nessCubeDiffuseTextureIndex };
+  cubePacket.textures[1] = { GL_TEXTURE_2D, cubeSpecTextureId, nessCubeSpecularTextureIndex };
+  cubePacket.modelUniform = cubeModelUniform;
+  cubePacket.indexCount = cubePosNormTexNumElements * 3; // 3 vertices per triangle * 2 triangles per face * 6 faces
+  for (uint32 i = 0; i < ArrayCount(cubePositions); i++)
   {
     float32 angularSpeed = 7.3f * (i + 1);
 
     // orbit around the specified axis from the translated distance
-    cubeModelMats[i] = glm::rotate(glm::mat4(1.0f), t * glm::radians(angularSpeed), glm::vec3(50.0f - (i * 10), 100.0f, -50.0f + (i * 10)));
+    cubePacket.model = glm::rotate(glm::mat4(1.0f), t * glm::radians(angularSpeed), glm::vec3(50.0f - (i * 10), 100.0f, -50.0f + (i * 10)));
     // translate to position in world
-    cubeModelMats[i] = glm::translate(cubeModelMats[i], cubePositions[i]);
+    cubePacket.model = glm::translate(cubePacket.model, cubePositions[i]);
     // rotate with time
-    cubeModelMats[i] = glm::rotate(cubeModelMats[i], t * glm::radians(angularSpeed), glm::vec3(1.0f, 0.3f, 0.5f));
+    cubePacket.model = glm::rotate(cubePacket.model, t * glm::radians(angularSpeed), glm::vec3(1.0f, 0.3f, 0.5f));
     // scale object
-    cubeModelMats[i] = glm::scale(cubeModelMats[i], glm::vec3(cubeScales[i]));
-  }
+    cubePacket.model = glm::scale(cubePacket.model, glm::vec3(cubeScales[i]));
 
-  // TODO: Sort cube models by distance to camera position and draw back to front
-  for (uint32 i = 0; i < ArrayCount(cubeModelMats); i++)
-  {
-    cubeShader->setUniform("model", cubeModelMats[i]);
-    glCullFace(GL_FRONT);
-    glDrawElements(GL_TRIANGLES, // drawing mode
-                   cubePosNormTexNumElements *
-                   3, // number of elements to draw (3 vertices per triangle * 2 triangles per face * 6 faces)
-                   GL_UNSIGNED_INT, // type of the indices
-                   0); // offset in the EBO
-    glCullFace(GL_BACK);
-    glDrawElements(GL_TRIANGLES, // drawing mode
-                   cubePosNormTexNumElements *
-                   3, // number of elements to draw (3 vertices per triangle * 2 triangles per face * 6 faces)
-                   GL_UNSIGNED_INT, // type of the indices
-                   0); // offset in the EBO
+    // NOTE: the queue draws transparent packets back to front
+    renderQueue.submit(RenderLayer_Transparent, glm::vec3(cubePacket.model[3]), cubePacket);
   }
 
   // draw model
-  {
-    // NOTE: The reference is the value that will be written to the stencil buffer when glStencilOp uses GL_REPLACE
-    // NOTE: The mask gets ANDed with both the reference value and the stored value before the test is ran
-    // NOTE: Example - if we are using GL_EQUAL with a reference value of 1 and mask of 0xFF...
-    // NOTE: the test passes if ( ref & 0xFF ) == ( stencil & 0xFF ) and if it passes the value specified by glStencilOp
-    // NOTE:: is stored in the stencil buffer [in our case we use GL_KEEP and it is the reference value of 1 that is stored]
-    glStencilFunc(GL_ALWAYS, // Under what circumstances does the stencil function pass
-                  1, // reference value for stencil test
-                  0xFF); // mask that is ANDed with stencil value and reference value before the test compares them
-
-    // NOTE: Specify the bitmask that enables or disables the writing of individual bits in the stencil plane
-    // NOTE: 0xFF is all 1s, leaving the value unaffected. 0x00 is all 0s, zeroing out all values written to stencil buffer (disabling writes)
-    // NOTE: THIS IS NOT THE SAME AS THE MASK PASSED INTO glStencilFunc
-    glStencilMask(0xFF);
-
-    // Drawing the model
-    modelShader->use();
-    setDynamicLightUniforms(modelShader);
-    modelShader->setUniform("viewPos", camera.Position);
-    modelShader->setUniform("view", viewMat);
-    nanoSuitModel->Draw(*modelShader);
-
-    // Wall Hack Stencil For Model
-    // NOTE: the test passes if ( ref & 0xFF ) != ( stencil & 0xFF )
-    // NOTE: we want to disable depth testing, as the stencil will only be active when the model is behind something
-    glStencilFunc(GL_NOTEQUAL, 1, 0xFF);
-    glDisable(GL_DEPTH_TEST);
-    stencilShader->use();
-    stencilShader->setUniform("color", glm::vec3(0.5f, 0.0f, 0.0f));
-    stencilShader->setUniform("view", viewMat);
-    stencilShader->setUniform("model", nanoSuitModelMatrix);
-    nanoSuitModel->Draw(*stencilShader);
-    glEnable(GL_DEPTH_TEST);
-  }
+  modelShader->use();
+  setDynamicLightUniforms(modelShader, modelLightUniforms);
+  modelShader->setUniform(modelViewPosUniform, camera.Position);
+  modelShader->setUniform(modelViewUniform, viewMat);
+  RenderPacket modelPacket = {};
+  modelPacket.shader = modelShader;
+  modelPacket.flags = RenderPacketFlag_WriteStencil;
+  // NOTE: drawn after the cubes so they occlude the model's stencil and its wall hack shows through them
+  nanoSuitModel->submit(renderQueue, RenderLayer_Overlay, glm::vec3(nanoSuitModelMatrix[3]), modelPacket);
+
+  // NOTE: The reference is the value that will be written to the stencil buffer when glStencilOp uses GL_REPLACE
+  // NOTE: The mask gets ANDed with both the reference value and the stored value before the test is ran
+  // NOTE: Example - if we are using GL_EQUAL with a reference value of 1 and mask of 0xFF...
+  // NOTE: the test passes if ( ref & 0xFF ) == ( stencil & 0xFF ) and if it passes the value specified by glStencilOp
+  // NOTE:: is stored in the stencil buffer [in our case we use GL_KEEP and it is the reference value of 1 that is stored]
+  // NOTE: Only the model's packets write to the stencil buffer (RenderPacketFlag_WriteStencil)
+  glStencilFunc(GL_ALWAYS, // Under what circumstances does the stencil function pass
+                1, // reference value for stencil test
+                0xFF); // mask that is ANDed with stencil value and reference value before the test compares them
+
+  renderQueue.execute();
+
+  // Wall Hack Stencil For Model
+  // NOTE: the test passes if ( ref & 0xFF ) != ( stencil & 0xFF )
+  // NOTE: we want to disable depth testing, as the stencil will only be active when the model is behind something
+  glStencilFunc(GL_NOTEQUAL, 1, 0xFF);
+  glDisable(GL_DEPTH_TEST);
+  stencilShader->use();
+  stencilShader->setUniform(stencilColorUniform, glm::vec3(0.5f, 0.0f, 0.0f));
+  stencilShader->setUniform(stencilViewUniform, viewMat);
+  stencilShader->setUniform(stencilModelUniform, nanoSuitModelMatrix);
+  nanoSuitModel->Draw(*stencilShader);
+  glEnable(GL_DEPTH_TEST);
 
   // bind default frame buffer
   glBindFramebuffer(GL_FRAMEBUFFER, postprocessFramebuffer.id);
@@ -373,7 +378,7 @@ Framebuffer KernelScene::drawFrame(){
   glActiveTexture(GL_TEXTURE0 + colorAttachmentTextureIndex);
   glBindTexture(GL_TEXTURE_2D, preprocessFramebuffer.colorAttachment);
   framebufferShader->use();
-  framebufferShader->setUniform("kernel", kernels5x5[selectedKernelIndex], ArrayCount(kernels5x5[selectedKernelIndex]));
+  framebufferShader->setUniform(framebufferKernelUniform, kernels5x5[selectedKernelIndex], ArrayCount(kernels5x5[selectedKernelIndex]));
   glDrawElements(GL_TRIANGLES, // drawing mode
                  6, // number of elements to draw (3 vertices per triangle * 2 triangles per quad)
                  GL_UNSIGNED_INT, // type of the indices
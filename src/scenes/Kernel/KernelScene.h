@@ -8,6 +8,20 @@
 #include "../FirstPersonScene.h"
 #include "../../common/ObjectData.h"
 #include "../../ShaderProgram.h"
+#include "../../common/RenderQueue.h"
+
+struct DynamicLightUniforms
+{
+  UniformHandle positionalLightPosition;
+  UniformHandle positionalLightAmbient;
+  UniformHandle positionalLightDiffuse;
+  UniformHandle positionalLightSpecular;
+  UniformHandle spotLightPosition;
+  UniformHandle spotLightDirection;
+  UniformHandle spotLightAmbient;
+  UniformHandle spotLightDiffuse;
+  UniformHandle spotLightSpecular;
+};
 
 class KernelScene final : public FirstPersonScene
 {
@@ -28,6 +42,24 @@ private:
   ShaderProgram* framebufferShader = NULL;
   ShaderProgram* skyboxShader = NULL;
 
+  UniformHandle cubeModelUniform;
+  UniformHandle cubeAnimSwitchUniform;
+  UniformHandle cubeViewPosUniform;
+  UniformHandle cubeViewUniform;
+  DynamicLightUniforms cubeLightUniforms;
+  UniformHandle lightModelUniform;
+  UniformHandle lightColorUniform;
+  UniformHandle modelViewPosUniform;
+  UniformHandle modelViewUniform;
+  DynamicLightUniforms modelLightUniforms;
+  UniformHandle stencilColorUniform;
+  UniformHandle stencilViewUniform;
+  UniformHandle stencilModelUniform;
+  UniformHandle skyboxViewUniform;
+  UniformHandle framebufferKernelUniform;
+
+  RenderQueue renderQueue;
+
   VertexAtt lightVertexAtt;
   VertexAtt cubeVertexAtt;
   VertexAtt quadVertexAtt;
@@ -42,12 +74,8 @@ private:
   const float32 modelScale = 0.2f;
   glm::mat4 nanoSuitModelMatrix;
 
-  uint32 globalFSUniformBuffer;
   const uint32 globalFSBufferBindIndex = 0;
-
-  uint32 globalVSUniformBuffer;
   const uint32 globalVSBufferBindIndex = 1;
-  const uint32 globalVSBufferViewMatOffset = sizeof(glm::mat4);
 
   const float32 lightOrbitSpeed = 1.0f;
   const float32 lightOrbitRadius = 2.5f;
@@ -57,10 +85,7 @@ private:
   const glm::vec3 directionalLightColor = glm::vec3(1.0f);
 
   glm::mat4 projectionMat;
-
-  // frame rate
-  float32 deltaTime = 0.0f;  // Time between current frame and last frame
-  float32 lastFrame = 0.0f; // Time of last frame
+  const float32 projectionFar = 100.0f;
 
   bool flashLightOn = false;
 
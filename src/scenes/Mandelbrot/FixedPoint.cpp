@@ -0,0 +1,120 @@
+#include <cmath>
+
+#include "FixedPoint.h"
+
+file_access bool isNegative(const FixedPoint& value)
+{
+  return (value.limbs[FIXED_POINT_LIMBS - 1] & 0x80000000) != 0;
+}
+
+file_access FixedPoint negate(const FixedPoint& value)
+{
+  FixedPoint result;
+  uint64 carry = 1;
+  for(uint32 i = 0; i < FIXED_POINT_LIMBS; ++i)
+  {
+    uint64 sum = (uint64)(~value.limbs[i]) + carry;
+    result.limbs[i] = (uint32)sum;
+    carry = sum >> 32;
+  }
+  return result;
+}
+
+FixedPoint fixedPointFromFloat64(float64 value)
+{
+  FixedPoint result = {};
+  if(value == 0.0 || !std::isfinite(value)) { return result; }
+
+  bool negative = value < 0.0;
+  int32 exponent;
+  float64 fraction = frexp(negative ? -value : value, &exponent); // value = fraction * 2^exponent, fraction in [0.5, 1)
+  uint64 mantissa = (uint64)ldexp(fraction, 53);
+
+  // the mantissa's lowest bit sits at 2^(exponent - 53), the fixed-point's lowest bit at 2^-(32 * FIXED_POINT_FRACTION_LIMBS)
+  int32 shift = exponent - 53 + (32 * FIXED_POINT_FRACTION_LIMBS);
+  if(shift < 0)
+  {
+    if(shift <= -64) { return result; }
+    mantissa >>= -shift;
+    shift = 0;
+  }
+  uint32 limbIndex = shift / 32;
+  uint32 bitIndex = shift % 32;
+  uint64 low = mantissa << bitIndex;
+  uint64 high = bitIndex == 0 ? 0 : mantissa >> (64 - bitIndex);
+  uint32 pieces[4] = { (uint32)low, (uint32)(low >> 32), (uint32)high, (uint32)(high >> 32) };
+  for(uint32 i = 0; i < 4 && (limbIndex + i) < FIXED_POINT_LIMBS; ++i)
+  {
+    result.limbs[limbIndex + i] = pieces[i];
+  }
+
+  return negative ? negate(result) : result;
+}
+
+float64 fixedPointToFloat64(const FixedPoint& value)
+{
+  bool negative = isNegative(value);
+  FixedPoint magnitude = negative ? negate(value) : value;
+  float64 result = 0.0;
+  for(uint32 i = 0; i < FIXED_POINT_LIMBS; ++i)
+  {
+    result += ldexp((float64)magnitude.limbs[i], 32 * ((int32)i - FIXED_POINT_FRACTION_LIMBS));
+  }
+  return negative ? -result : result;
+}
+
+FixedPoint fixedPointAdd(const FixedPoint& a, const FixedPoint& b)
+{
+  FixedPoint result;
+  uint64 carry = 0;
+  for(uint32 i = 0; i < FIXED_POINT_LIMBS; ++i)
+  {
+    uint64 sum = (uint64)a.limbs[i] + b.limbs[i] + carry;
+    result.limbs[i] = (uint32)sum;
+    carry = sum >> 32;
+  }
+  return result;
+}
+
+FixedPoint fixedPointSub(const FixedPoint& a, const FixedPoint& b)
+{
+  return fixedPointAdd(a, negate(b));
+}
+
+FixedPoint fixedPointMul(const FixedPoint& a, const FixedPoint& b)
+{
+  bool negativeA = isNegative(a);
+  bool negativeB = isNegative(b);
+  FixedPoint magnitudeA = negativeA ? negate(a) : a;
+  FixedPoint magnitudeB = negativeB ? negate(b) : b;
+
+  // full width product of the magnitudes, then drop the extra fractional limbs
+  uint32 product[FIXED_POINT_LIMBS * 2] = {};
+  for(uint32 i = 0; i < FIXED_POINT_LIMBS; ++i)
+  {
+    uint64 carry = 0;
+    for(uint32 j = 0; j < FIXED_POINT_LIMBS; ++j)
+    {
+      uint64 term = ((uint64)magnitudeA.limbs[i] * magnitudeB.limbs[j]) + product[i + j] + carry;
+      product[i + j] = (uint32)term;
+      carry = term >> 32;
+    }
+    product[i + FIXED_POINT_LIMBS] = (uint32)carry;
+  }
+
+  FixedPoint result;
+  for(uint32 i = 0; i < FIXED_POINT_LIMBS; ++i)
+  {
+    result.limbs[i] = product[i + FIXED_POINT_FRACTION_LIMBS];
+  }
+  return (negativeA != negativeB) ? negate(result) : result;
+}
+
+bool fixedPointEquals(const FixedPoint& a, const FixedPoint& b)
+{
+  for(uint32 i = 0; i < FIXED_POINT_LIMBS; ++i)
+  {
+    if(a.limbs[i] != b.limbs[i]) { return false; }
+  }
+  return true;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "../../LearnOpenGLPlatform.h"
+
+// NOTE: Two's complement fixed-point number, limbs[0] is least significant and the top limb holds the signed integer part.
+// NOTE: 256 fractional bits (~77 decimal digits) keeps reference orbits exact well past 1e-50 scale zooms.
+#define FIXED_POINT_FRACTION_LIMBS 8
+#define FIXED_POINT_LIMBS (FIXED_POINT_FRACTION_LIMBS + 1)
+
+struct FixedPoint
+{
+  uint32 limbs[FIXED_POINT_LIMBS];
+};
+
+FixedPoint fixedPointFromFloat64(float64 value); // bits below 2^-256 are truncated
+float64 fixedPointToFloat64(const FixedPoint& value);
+FixedPoint fixedPointAdd(const FixedPoint& a, const FixedPoint& b);
+FixedPoint fixedPointSub(const FixedPoint& a, const FixedPoint& b);
+FixedPoint fixedPointMul(const FixedPoint& a, const FixedPoint& b); // integer part overflow wraps
+bool fixedPointEquals(const FixedPoint& a, const FixedPoint& b);
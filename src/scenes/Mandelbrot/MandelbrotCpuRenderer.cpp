@@ -0,0 +1,533 @@
+#include <cmath>
+#include <cstring>
+
+#include "MandelbrotCpuRenderer.h"
+
+#include <glad/glad.h>
+
+#include "../../common/FrameClock.h"
+
+// NOTE: The widest instruction set the compiler is allowed to use is picked at compile time (ex: /arch:AVX2)
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define MANDELBROT_SIMD_LANES 4
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MANDELBROT_SIMD_LANES 2
+#else
+#define MANDELBROT_SIMD_LANES 1
+#endif
+
+// Iteration counts for MANDELBROT_SIMD_LANES points, escaping once |z| >= 2 like MandelbrotFragmentShader
+file_access void escapeTimes(const float64* cReal, const float64* cImag, uint32 maxIterations, float32* iterationCounts)
+{
+#if MANDELBROT_SIMD_LANES == 4
+  const __m256d escapeRadiusSquared = _mm256_set1_pd(4.0);
+  const __m256d one = _mm256_set1_pd(1.0);
+  __m256d cr = _mm256_loadu_pd(cReal);
+  __m256d ci = _mm256_loadu_pd(cImag);
+  __m256d zr = _mm256_setzero_pd();
+  __m256d zi = _mm256_setzero_pd();
+  __m256d counts = _mm256_setzero_pd();
+  for(uint32 i = 0; i < maxIterations; ++i)
+  {
+    __m256d zrSquared = _mm256_mul_pd(zr, zr);
+    __m256d ziSquared = _mm256_mul_pd(zi, zi);
+    __m256d bounded = _mm256_cmp_pd(_mm256_add_pd(zrSquared, ziSquared), escapeRadiusSquared, _CMP_LT_OQ);
+    if(_mm256_movemask_pd(bounded) == 0) { break; }
+    counts = _mm256_add_pd(counts, _mm256_and_pd(bounded, one));
+    __m256d zrzi = _mm256_mul_pd(zr, zi);
+    zi = _mm256_add_pd(_mm256_add_pd(zrzi, zrzi), ci);
+    zr = _mm256_add_pd(_mm256_sub_pd(zrSquared, ziSquared), cr);
+  }
+  _mm_storeu_ps(iterationCounts, _mm256_cvtpd_ps(counts));
+#elif MANDELBROT_SIMD_LANES == 2
+  const __m128d escapeRadiusSquared = _mm_set1_pd(4.0);
+  const __m128d one = _mm_set1_pd(1.0);
+  __m128d cr = _mm_loadu_pd(cReal);
+  __m128d ci = _mm_loadu_pd(cImag);
+  __m128d zr = _mm_setzero_pd();
+  __m128d zi = _mm_setzero_pd();
+  __m128d counts = _mm_setzero_pd();
+  for(uint32 i = 0; i < maxIterations; ++i)
+  {
+    __m128d zrSquared = _mm_mul_pd(zr, zr);
+    __m128d ziSquared = _mm_mul_pd(zi, zi);
+    __m128d bounded = _mm_cmplt_pd(_mm_add_pd(zrSquared, ziSquared), escapeRadiusSquared);
+    if(_mm_movemask_pd(bounded) == 0) { break; }
+    counts = _mm_add_pd(counts, _mm_and_pd(bounded, one));
+    __m128d zrzi = _mm_mul_pd(zr, zi);
+    zi = _mm_add_pd(_mm_add_pd(zrzi, zrzi), ci);
+    zr = _mm_add_pd(_mm_sub_pd(zrSquared, ziSquared), cr);
+  }
+  _mm_storel_pi((__m64*)iterationCounts, _mm_cvtpd_ps(counts));
+#else
+  float64 zr = 0.0, zi = 0.0;
+  uint32 count = 0;
+  while(count < maxIterations && (zr * zr) + (zi * zi) < 4.0)
+  {
+    float64 zrTemp = (zr * zr) - (zi * zi) + cReal[0];
+    zi = (2.0 * zr * zi) + cImag[0];
+    zr = zrTemp;
+    count++;
+  }
+  iterationCounts[0] = (float32)count;
+#endif
+}
+
+// NOTE: Perturbation iterates the delta d from the reference orbit Z: d' = 2Zd + d^2 + dc. Whenever |Z + d| < |d| or
+// NOTE: the reference has escaped, the orbit is rebased onto the start of the reference (d = Z + d, restart at Z[0] = 0),
+// NOTE: which avoids the glitches of a single reference without needing secondary references.
+uint32 MandelbrotCpuRenderer::perturbedEscapeTime(float64 deltaCReal, float64 deltaCImag) const
+{
+  const uint32 referenceLast = (uint32)referenceReal.size() - 1;
+  const float64* Zr = referenceReal.data();
+  const float64* Zi = referenceImag.data();
+
+  // series approximation for the skipped iterations
+  float64 dc2r = (deltaCReal * deltaCReal) - (deltaCImag * deltaCImag);
+  float64 dc2i = 2.0 * deltaCReal * deltaCImag;
+  float64 dc3r = (dc2r * deltaCReal) - (dc2i * deltaCImag);
+  float64 dc3i = (dc2r * deltaCImag) + (dc2i * deltaCReal);
+  float64 dr = (seriesA[0] * deltaCReal - seriesA[1] * deltaCImag) + (seriesB[0] * dc2r - seriesB[1] * dc2i) + (seriesC[0] * dc3r - seriesC[1] * dc3i);
+  float64 di = (seriesA[0] * deltaCImag + seriesA[1] * deltaCReal) + (seriesB[0] * dc2i + seriesB[1] * dc2r) + (seriesC[0] * dc3i + seriesC[1] * dc3r);
+
+  uint32 n = seriesSkip;
+  uint32 count = seriesSkip;
+  while(count < level.maxIterations)
+  {
+    float64 zr = Zr[n] + dr;
+    float64 zi = Zi[n] + di;
+    float64 zMagnitudeSquared = (zr * zr) + (zi * zi);
+    if(zMagnitudeSquared >= 4.0) { break; }
+    count++;
+
+    if(zMagnitudeSquared < (dr * dr) + (di * di) || n == referenceLast)
+    {
+      dr = zr;
+      di = zi;
+      n = 0;
+    }
+
+    // d = (2Z + d) * d + dc
+    float64 twoZPlusDr = (2.0 * Zr[n]) + dr;
+    float64 twoZPlusDi = (2.0 * Zi[n]) + di;
+    float64 drTemp = (twoZPlusDr * dr) - (twoZPlusDi * di) + deltaCReal;
+    di = (twoZPlusDr * di) + (twoZPlusDi * dr) + deltaCImag;
+    dr = drTemp;
+    n++;
+  }
+  return count;
+}
+
+// NOTE: Runs on the main thread whenever the level changes, a few milliseconds for thousands of iterations.
+// NOTE: The reference sits on the level's anchor so panning never recomputes it.
+void MandelbrotCpuRenderer::computeReferenceOrbit()
+{
+  if(!referenceReal.empty() && referenceMaxIterations == level.maxIterations &&
+     fixedPointEquals(referenceCenterReal, level.anchorReal) && fixedPointEquals(referenceCenterImag, level.anchorImag))
+  {
+    return;
+  }
+  referenceCenterReal = level.anchorReal;
+  referenceCenterImag = level.anchorImag;
+  referenceMaxIterations = level.maxIterations;
+
+  referenceReal.clear();
+  referenceImag.clear();
+  FixedPoint zr = {};
+  FixedPoint zi = {};
+  for(uint32 i = 0; i <= level.maxIterations; ++i)
+  {
+    float64 zrDouble = fixedPointToFloat64(zr);
+    float64 ziDouble = fixedPointToFloat64(zi);
+    referenceReal.push_back(zrDouble);
+    referenceImag.push_back(ziDouble);
+    if((zrDouble * zrDouble) + (ziDouble * ziDouble) >= 4.0) { break; }
+
+    FixedPoint zrSquared = fixedPointMul(zr, zr);
+    FixedPoint ziSquared = fixedPointMul(zi, zi);
+    FixedPoint zrzi = fixedPointMul(zr, zi);
+    zi = fixedPointAdd(fixedPointAdd(zrzi, zrzi), level.anchorImag);
+    zr = fixedPointAdd(fixedPointSub(zrSquared, ziSquared), level.anchorReal);
+  }
+}
+
+// Finds how many iterations the cubic series can stand in for across a round's tiles. Terms are compared at the
+// largest dc and the series is trusted while each term stays well below the previous one.
+void MandelbrotCpuRenderer::computeSeriesApproximation(float64 maxDeltaC)
+{
+  float64 a[2] = { 0.0, 0.0 }, b[2] = { 0.0, 0.0 }, c[2] = { 0.0, 0.0 };
+  seriesSkip = 0;
+  seriesA[0] = seriesA[1] = seriesB[0] = seriesB[1] = seriesC[0] = seriesC[1] = 0.0;
+
+  // NOTE: the last reference entry may have escaped and skipping must leave room for at least one real iteration
+  uint32 skipLimit = (uint32)referenceReal.size() - 1;
+  for(uint32 n = 0; n + 1 < skipLimit; ++n)
+  {
+    // A' = 2ZA + 1, B' = 2ZB + A^2, C' = 2ZC + 2AB
+    float64 twoZr = 2.0 * referenceReal[n];
+    float64 twoZi = 2.0 * referenceImag[n];
+    float64 nextA[2] = { (twoZr * a[0]) - (twoZi * a[1]) + 1.0, (twoZr * a[1]) + (twoZi * a[0]) };
+    float64 nextB[2] = { (twoZr * b[0]) - (twoZi * b[1]) + (a[0] * a[0]) - (a[1] * a[1]),
+                         (twoZr * b[1]) + (twoZi * b[0]) + (2.0 * a[0] * a[1]) };
+    float64 nextC[2] = { (twoZr * c[0]) - (twoZi * c[1]) + 2.0 * ((a[0] * b[0]) - (a[1] * b[1])),
+                         (twoZr * c[1]) + (twoZi * c[0]) + 2.0 * ((a[0] * b[1]) + (a[1] * b[0])) };
+
+    float64 termA = sqrt((nextA[0] * nextA[0]) + (nextA[1] * nextA[1])) * maxDeltaC;
+    float64 termB = sqrt((nextB[0] * nextB[0]) + (nextB[1] * nextB[1])) * maxDeltaC * maxDeltaC;
+    float64 termC = sqrt((nextC[0] * nextC[0]) + (nextC[1] * nextC[1])) * maxDeltaC * maxDeltaC * maxDeltaC;
+    if(!std::isfinite(termC) || termB > termA * MANDELBROT_SERIES_TOLERANCE || termC > termB * MANDELBROT_SERIES_TOLERANCE) { break; }
+
+    a[0] = nextA[0]; a[1] = nextA[1];
+    b[0] = nextB[0]; b[1] = nextB[1];
+    c[0] = nextC[0]; c[1] = nextC[1];
+    seriesSkip = n + 1;
+  }
+
+  seriesA[0] = a[0]; seriesA[1] = a[1];
+  seriesB[0] = b[0]; seriesB[1] = b[1];
+  seriesC[0] = c[0]; seriesC[1] = c[1];
+}
+
+file_access int64 floorDivide(int64 numerator, int64 denominator)
+{
+  int64 quotient = numerator / denominator;
+  return (numerator % denominator != 0 && numerator < 0) ? quotient - 1 : quotient;
+}
+
+void MandelbrotCpuRenderer::init(Extent2D extent)
+{
+  glGenTextures(1, &textureId);
+  passCount = 0;
+  for(uint32 blockDimen = MANDELBROT_COARSEST_BLOCK_DIMEN; blockDimen > 0; blockDimen >>= 1) { passCount++; }
+  resize(extent);
+}
+
+void MandelbrotCpuRenderer::deinit()
+{
+  abandonRound();
+  glDeleteTextures(1, &textureId);
+  textureId = 0;
+  iterations.clear();
+  iterations.shrink_to_fit();
+
+  for(std::list<MandelbrotTile*>::iterator tile = recentTiles.begin(); tile != recentTiles.end(); ++tile) { delete *tile; }
+  recentTiles.clear();
+  tiles.clear();
+  levels.clear();
+  referenceReal.clear();
+  referenceImag.clear();
+  viewValid = false;
+  visibleTilesComplete = true;
+}
+
+void MandelbrotCpuRenderer::resize(Extent2D extent)
+{
+  abandonRound(); // NOTE: an invalid view re-derives the level state tile jobs read
+  this->extent = extent;
+  iterations.assign(extent.width * extent.height, 0.0f);
+  // NOTE: a screen straddles at most one more tile than it covers in each direction
+  uint32 visibleTileCount = ((extent.width / MANDELBROT_TILE_DIMEN) + 2) * ((extent.height / MANDELBROT_TILE_DIMEN) + 2);
+  maxCachedTiles = visibleTileCount * MANDELBROT_TILE_CACHE_SCREENS;
+  viewValid = false; // NOTE: the lattice origin depends on the extent
+
+  glBindTexture(GL_TEXTURE_2D, textureId);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, extent.width, extent.height, 0, GL_RED, GL_FLOAT, NULL);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
+
+void MandelbrotCpuRenderer::abandonRound()
+{
+  generation++;
+  waitForJobs(&roundJobs); // NOTE: abandoned tiles return at their next row and keep their completed passes
+  roundInFlight = false;
+  roundTiles.clear();
+}
+
+// Reuses a level with the same pixel size and iteration count if the view is within its lattice, otherwise starts
+// a new level anchored at the view's center
+void MandelbrotCpuRenderer::selectLevel(const MandelbrotView& view)
+{
+  for(uint32 i = 0; i < levels.size(); ++i)
+  {
+    MandelbrotLevel& candidate = levels[i];
+    if(candidate.pixelSize != view.pixelSize || candidate.maxIterations != view.maxIterations) { continue; }
+    float64 offsetReal = fixedPointToFloat64(fixedPointSub(view.centerReal, candidate.anchorReal)) / view.pixelSize;
+    float64 offsetImag = fixedPointToFloat64(fixedPointSub(view.centerImag, candidate.anchorImag)) / view.pixelSize;
+    if(fabs(offsetReal) < MANDELBROT_LEVEL_MAX_PIXEL_OFFSET && fabs(offsetImag) < MANDELBROT_LEVEL_MAX_PIXEL_OFFSET)
+    {
+      if(candidate.id != level.id)
+      {
+        abandonRound();
+        level = candidate;
+      }
+      return;
+    }
+  }
+
+  abandonRound();
+  if(levels.size() >= MANDELBROT_TILE_CACHE_MAX_LEVELS) { levels.erase(levels.begin()); } // NOTE: its tiles age out of the cache
+  level.id = nextLevelId++;
+  level.pixelSize = view.pixelSize;
+  level.maxIterations = view.maxIterations;
+  level.anchorReal = view.centerReal;
+  level.anchorImag = view.centerImag;
+  levels.push_back(level);
+}
+
+void MandelbrotCpuRenderer::render(const MandelbrotView& view)
+{
+  if(viewValid && fixedPointEquals(view.centerReal, this->view.centerReal) && fixedPointEquals(view.centerImag, this->view.centerImag) &&
+     view.pixelSize == this->view.pixelSize && view.maxIterations == this->view.maxIterations)
+  {
+    return;
+  }
+
+  uint32 previousLevelId = level.id;
+  selectLevel(view);
+  if(!viewValid || level.id != previousLevelId)
+  {
+    levelAnchorReal = fixedPointToFloat64(level.anchorReal);
+    levelAnchorImag = fixedPointToFloat64(level.anchorImag);
+    perturbation = level.pixelSize < MANDELBROT_PERTURBATION_PIXEL_SIZE;
+    if(perturbation) { computeReferenceOrbit(); }
+  }
+
+  // screen pixel x shows lattice pixel originX + x, see MandelbrotView for the screen's mapping
+  float64 centerX = fixedPointToFloat64(fixedPointSub(view.centerReal, level.anchorReal)) / level.pixelSize;
+  float64 centerY = fixedPointToFloat64(fixedPointSub(view.centerImag, level.anchorImag)) / level.pixelSize;
+  originX = (int64)floor(centerX - (extent.width * 0.5) + 0.5);
+  originY = (int64)floor(centerY - (extent.height * 0.5) + 0.5);
+
+  this->view = view;
+  viewValid = true;
+  viewChanged = true;
+  if(visibleTilesComplete)
+  {
+    renderStartNanoseconds = monotonicNanoseconds();
+    renderedPixels = 0;
+  }
+  visibleTilesComplete = false;
+}
+
+MandelbrotTile* MandelbrotCpuRenderer::findOrCreateTile(int64 tileX, int64 tileY)
+{
+  MandelbrotTileKey key = { level.id, tileX, tileY };
+  std::unordered_map<MandelbrotTileKey, MandelbrotTile*, MandelbrotTileKeyHash>::iterator search = tiles.find(key);
+  MandelbrotTile* tile;
+  if(search != tiles.end())
+  {
+    tile = search->second;
+    recentTiles.erase(tile->recentPosition);
+  } else
+  {
+    tile = new MandelbrotTile;
+    tile->key = key;
+    tile->completedPasses = 0;
+    tiles[key] = tile;
+  }
+  recentTiles.push_front(tile);
+  tile->recentPosition = recentTiles.begin();
+  return tile;
+}
+
+// NOTE: Only called between rounds, the visible tiles were just moved to the front
+void MandelbrotCpuRenderer::evictTiles()
+{
+  while(tiles.size() > maxCachedTiles)
+  {
+    MandelbrotTile* leastRecentlyUsed = recentTiles.back();
+    recentTiles.pop_back();
+    tiles.erase(leastRecentlyUsed->key);
+    delete leastRecentlyUsed;
+  }
+}
+
+void MandelbrotCpuRenderer::compositeVisibleTiles()
+{
+  int64 firstTileX = floorDivide(originX, MANDELBROT_TILE_DIMEN);
+  int64 firstTileY = floorDivide(originY, MANDELBROT_TILE_DIMEN);
+  int64 lastTileX = floorDivide(originX + extent.width - 1, MANDELBROT_TILE_DIMEN);
+  int64 lastTileY = floorDivide(originY + extent.height - 1, MANDELBROT_TILE_DIMEN);
+  for(int64 tileY = firstTileY; tileY <= lastTileY; ++tileY)
+  {
+    for(int64 tileX = firstTileX; tileX <= lastTileX; ++tileX)
+    {
+      MandelbrotTile* tile = findOrCreateTile(tileX, tileY);
+
+      // intersection of the tile with the screen, in screen pixels
+      int64 tileScreenX = (tileX * MANDELBROT_TILE_DIMEN) - originX;
+      int64 tileScreenY = (tileY * MANDELBROT_TILE_DIMEN) - originY;
+      int64 xBegin = tileScreenX > 0 ? tileScreenX : 0;
+      int64 yBegin = tileScreenY > 0 ? tileScreenY : 0;
+      int64 xEnd = (tileScreenX + MANDELBROT_TILE_DIMEN) < extent.width ? (tileScreenX + MANDELBROT_TILE_DIMEN) : extent.width;
+      int64 yEnd = (tileScreenY + MANDELBROT_TILE_DIMEN) < extent.height ? (tileScreenY + MANDELBROT_TILE_DIMEN) : extent.height;
+      for(int64 y = yBegin; y < yEnd; ++y)
+      {
+        float32* screenRow = iterations.data() + (y * extent.width);
+        const float32* tileRow = tile->iterations + ((y - tileScreenY) * MANDELBROT_TILE_DIMEN) - tileScreenX;
+        if(tile->completedPasses == 0)
+        {
+          for(int64 x = xBegin; x < xEnd; ++x) { screenRow[x] = 0.0f; }
+        } else
+        {
+          memcpy(screenRow + xBegin, tileRow + xBegin, (xEnd - xBegin) * sizeof(float32));
+        }
+      }
+    }
+  }
+
+  evictTiles();
+}
+
+// Queues the next pass of every visible tile that is at the coarsest incomplete pass, so that the whole screen
+// refines together. Returns false if every visible tile is complete.
+bool MandelbrotCpuRenderer::startRound()
+{
+  int64 firstTileX = floorDivide(originX, MANDELBROT_TILE_DIMEN);
+  int64 firstTileY = floorDivide(originY, MANDELBROT_TILE_DIMEN);
+  int64 lastTileX = floorDivide(originX + extent.width - 1, MANDELBROT_TILE_DIMEN);
+  int64 lastTileY = floorDivide(originY + extent.height - 1, MANDELBROT_TILE_DIMEN);
+
+  uint32 roundPass = passCount;
+  for(int64 tileY = firstTileY; tileY <= lastTileY; ++tileY)
+  {
+    for(int64 tileX = firstTileX; tileX <= lastTileX; ++tileX)
+    {
+      MandelbrotTile* tile = findOrCreateTile(tileX, tileY);
+      if(tile->completedPasses < roundPass) { roundPass = tile->completedPasses; }
+    }
+  }
+  if(roundPass == passCount) { return false; }
+
+  roundTiles.clear();
+  float64 maxDeltaX = 0.0, maxDeltaY = 0.0;
+  for(int64 tileY = firstTileY; tileY <= lastTileY; ++tileY)
+  {
+    for(int64 tileX = firstTileX; tileX <= lastTileX; ++tileX)
+    {
+      MandelbrotTile* tile = findOrCreateTile(tileX, tileY);
+      if(tile->completedPasses != roundPass) { continue; }
+      roundTiles.push_back(tile);
+      float64 farX = (float64)(tileX < 0 ? tileX * MANDELBROT_TILE_DIMEN : (tileX + 1) * MANDELBROT_TILE_DIMEN);
+      float64 farY = (float64)(tileY < 0 ? tileY * MANDELBROT_TILE_DIMEN : (tileY + 1) * MANDELBROT_TILE_DIMEN);
+      if(fabs(farX) > maxDeltaX) { maxDeltaX = fabs(farX); }
+      if(fabs(farY) > maxDeltaY) { maxDeltaY = fabs(farY); }
+    }
+  }
+
+  // NOTE: Safe to change between rounds, no tile jobs are reading it
+  if(perturbation) { computeSeriesApproximation(level.pixelSize * sqrt((maxDeltaX * maxDeltaX) + (maxDeltaY * maxDeltaY))); }
+
+  uint32 renderGeneration = generation;
+  for(uint32 i = 0; i < roundTiles.size(); ++i)
+  {
+    MandelbrotTile* tile = roundTiles[i];
+    addJob(&roundJobs, [this, tile, roundPass, renderGeneration] { renderTile(tile, roundPass, renderGeneration); });
+  }
+  roundInFlight = true;
+  return true;
+}
+
+bool MandelbrotCpuRenderer::update()
+{
+  // NOTE: Rounds are separated by a barrier here, tiles are only read or evicted while no jobs are writing them
+  if(!viewValid || (roundInFlight && roundJobs.remaining > 0)) { return false; }
+
+  bool textureChanged = false;
+  if(roundInFlight || viewChanged)
+  {
+    if(roundInFlight)
+    {
+      for(uint32 i = 0; i < roundTiles.size(); ++i)
+      {
+        if(roundTiles[i]->completedPasses == passCount) { renderedPixels += MANDELBROT_TILE_DIMEN * MANDELBROT_TILE_DIMEN; }
+      }
+    }
+    roundInFlight = false;
+    viewChanged = false;
+
+    compositeVisibleTiles();
+    glBindTexture(GL_TEXTURE_2D, textureId);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, extent.width, extent.height, GL_RED, GL_FLOAT, iterations.data());
+    textureMaxIterations = level.maxIterations;
+    textureChanged = true;
+  }
+
+  if(!visibleTilesComplete && !startRound())
+  {
+    visibleTilesComplete = true;
+    renderMilliseconds = (monotonicNanoseconds() - renderStartNanoseconds) / 1000000.0;
+  }
+  return textureChanged;
+}
+
+void MandelbrotCpuRenderer::renderTile(MandelbrotTile* tile, uint32 pass, uint32 renderGeneration)
+{
+  const uint32 blockDimen = MANDELBROT_COARSEST_BLOCK_DIMEN >> pass;
+  const uint32 previousBlockDimen = blockDimen * 2;
+  const int64 latticeX = tile->key.x * MANDELBROT_TILE_DIMEN;
+  const int64 latticeY = tile->key.y * MANDELBROT_TILE_DIMEN;
+
+  // NOTE: padded so the last SIMD group of a row can always be loaded
+  float64 cReal[MANDELBROT_TILE_DIMEN + MANDELBROT_SIMD_LANES];
+  float64 cImag[MANDELBROT_TILE_DIMEN + MANDELBROT_SIMD_LANES];
+  float32 counts[MANDELBROT_TILE_DIMEN + MANDELBROT_SIMD_LANES];
+  uint32 sampleX[MANDELBROT_TILE_DIMEN];
+
+  for(uint32 y = 0; y < MANDELBROT_TILE_DIMEN; y += blockDimen)
+  {
+    if(generation != renderGeneration) { return; }
+
+    // gather this row's samples, skipping the ones a coarser pass already computed
+    bool rowOnPreviousGrid = pass > 0 && (y % previousBlockDimen) == 0;
+    uint32 sampleCount = 0;
+    float64 deltaImag = ((latticeY + y) + 0.5) * level.pixelSize;
+    for(uint32 x = 0; x < MANDELBROT_TILE_DIMEN; x += blockDimen)
+    {
+      if(rowOnPreviousGrid && (x % previousBlockDimen) == 0) { continue; }
+      sampleX[sampleCount] = x;
+      cReal[sampleCount] = ((latticeX + x) + 0.5) * level.pixelSize;
+      cImag[sampleCount] = deltaImag;
+      sampleCount++;
+    }
+
+    if(perturbation)
+    {
+      for(uint32 i = 0; i < sampleCount; ++i) { counts[i] = (float32)perturbedEscapeTime(cReal[i], cImag[i]); }
+    } else
+    {
+      for(uint32 i = 0; i < sampleCount; ++i)
+      {
+        cReal[i] += levelAnchorReal;
+        cImag[i] += levelAnchorImag;
+      }
+      for(uint32 i = sampleCount; i < sampleCount + MANDELBROT_SIMD_LANES; ++i)
+      {
+        cReal[i] = cReal[0];
+        cImag[i] = cImag[0];
+      }
+
+      for(uint32 i = 0; i < sampleCount; i += MANDELBROT_SIMD_LANES)
+      {
+        escapeTimes(cReal + i, cImag + i, level.maxIterations, counts + i);
+      }
+    }
+
+    // fill each sample's block
+    for(uint32 i = 0; i < sampleCount; ++i)
+    {
+      for(uint32 blockY = y; blockY < y + blockDimen; ++blockY)
+      {
+        float32* row = tile->iterations + (blockY * MANDELBROT_TILE_DIMEN);
+        for(uint32 blockX = sampleX[i]; blockX < sampleX[i] + blockDimen; ++blockX) { row[blockX] = counts[i]; }
+      }
+    }
+  }
+
+  tile->completedPasses = pass + 1;
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <vector>
+#include <list>
+#include <atomic>
+#include <unordered_map>
+
+#include "../../LearnOpenGLPlatform.h"
+#include "../../common/WorkerPool.h"
+#include "FixedPoint.h"
+
+// NOTE: Renders escape time iteration counts in double precision on the worker pool. The image is refined
+// NOTE: progressively, every pass samples a finer grid and fills each sample's block so that a coarse preview shows
+// NOTE: up right away. Counts are uploaded to an R32F texture, colouring happens in MandelbrotIterationsFragmentShader.
+// NOTE: Counts are cached per tile of a zoom level's pixel lattice, panning only computes newly exposed tiles.
+#define MANDELBROT_TILE_DIMEN 64 // must be a multiple of MANDELBROT_COARSEST_BLOCK_DIMEN
+#define MANDELBROT_COARSEST_BLOCK_DIMEN 8 // passes at 8x8, 4x4, 2x2 and finally 1x1 pixel blocks
+#define MANDELBROT_TILE_CACHE_SCREENS 4 // tiles kept resident in screens worth of visible tiles, 16KB each
+#define MANDELBROT_TILE_CACHE_MAX_LEVELS 16
+#define MANDELBROT_LEVEL_MAX_PIXEL_OFFSET 1e9 // lattice coordinates must stay exact as doubles
+// NOTE: Below this pixel size doubles can no longer tell neighbouring pixels apart near the set (|c| ~ 2), so pixels are
+// NOTE: evaluated as double precision deltas from a fixed-point reference orbit at the level's anchor (perturbation)
+#define MANDELBROT_PERTURBATION_PIXEL_SIZE 1e-13
+#define MANDELBROT_SERIES_TOLERANCE 1e-3 // max ratio between consecutive series approximation terms
+
+struct MandelbrotView
+{
+  FixedPoint centerReal;
+  FixedPoint centerImag;
+  float64 pixelSize; // distance in the complex plane between neighbouring pixels
+  uint32 maxIterations;
+};
+
+// NOTE: A zoom level is a pixel lattice anchored in the complex plane, lattice pixel (i, j) is centered on
+// NOTE: anchor + (i + 0.5, j + 0.5) * pixelSize. Views are snapped to the nearest lattice pixel so tiles line up while panning.
+struct MandelbrotLevel
+{
+  uint32 id;
+  float64 pixelSize;
+  uint32 maxIterations;
+  FixedPoint anchorReal;
+  FixedPoint anchorImag;
+};
+
+struct MandelbrotTileKey
+{
+  uint32 level;
+  int64 x;
+  int64 y;
+
+  bool operator==(const MandelbrotTileKey& other) const { return level == other.level && x == other.x && y == other.y; }
+};
+
+struct MandelbrotTileKeyHash
+{
+  size_t operator()(const MandelbrotTileKey& key) const
+  {
+    uint64 hash = key.level;
+    hash = (hash * 0x9E3779B97F4A7C15ull) ^ (uint64)key.x;
+    hash = (hash * 0x9E3779B97F4A7C15ull) ^ (uint64)key.y;
+    return (size_t)hash;
+  }
+};
+
+struct MandelbrotTile
+{
+  MandelbrotTileKey key;
+  uint32 completedPasses; // written by the tile's job, only read on the main thread between rounds
+  std::list<MandelbrotTile*>::iterator recentPosition;
+  float32 iterations[MANDELBROT_TILE_DIMEN * MANDELBROT_TILE_DIMEN]; // row 0 is the bottom of the tile
+};
+
+class MandelbrotCpuRenderer
+{
+public:
+  void init(Extent2D extent);
+  void deinit();
+  void resize(Extent2D extent);
+  // Picks the zoom level for the view, in flight work is only abandoned if the level changes
+  void render(const MandelbrotView& view);
+  // Call every frame on the main thread, once the current round of tile jobs is done this uploads the visible
+  // tiles and starts the next refinement round. Returns true if the iteration texture changed.
+  bool update();
+  bool refining() const { return !visibleTilesComplete; }
+  uint32 iterationTexture() const { return textureId; }
+  // NOTE: the texture lags the view while a new level is refined, colour it with the iterations it was rendered with
+  uint32 iterationTextureMaxIterations() const { return textureMaxIterations; }
+  float64 lastRenderMilliseconds() const { return renderMilliseconds; }
+  float64 lastMegapixelsPerSecond() const { return renderMilliseconds > 0.0 ? renderedPixels / (renderMilliseconds * 1000.0) : 0.0; }
+  bool perturbing() const { return perturbation; }
+  uint32 referenceOrbitLength() const { return (uint32)referenceReal.size(); }
+  uint32 seriesSkippedIterations() const { return seriesSkip; }
+  uint32 cachedTileCount() const { return (uint32)tiles.size(); }
+
+private:
+  void selectLevel(const MandelbrotView& view);
+  MandelbrotTile* findOrCreateTile(int64 tileX, int64 tileY);
+  void evictTiles();
+  void compositeVisibleTiles();
+  bool startRound();
+  void renderTile(MandelbrotTile* tile, uint32 pass, uint32 renderGeneration);
+  void abandonRound();
+  void computeReferenceOrbit();
+  void computeSeriesApproximation(float64 maxDeltaC);
+  uint32 perturbedEscapeTime(float64 deltaCReal, float64 deltaCImag) const;
+
+  Extent2D extent = { 0, 0 };
+  uint32 textureId = 0;
+  uint32 textureMaxIterations = 1; // max iterations of the level last uploaded, never 0 as the shader divides by it
+  std::vector<float32> iterations; // row 0 is the bottom of the image, like the texture
+
+  // tile cache, most recently visible at the front
+  std::unordered_map<MandelbrotTileKey, MandelbrotTile*, MandelbrotTileKeyHash> tiles;
+  std::list<MandelbrotTile*> recentTiles;
+  std::vector<MandelbrotLevel> levels;
+  uint32 nextLevelId = 0;
+  uint32 maxCachedTiles = 0; // sized from the extent
+
+  // current view, snapped to the current level's lattice
+  // NOTE: tile jobs read the level (and the state derived from it), it only changes after abandonRound()
+  MandelbrotView view = {};
+  bool viewValid = false;
+  bool viewChanged = false;
+  MandelbrotLevel level = {};
+  float64 levelAnchorReal = 0.0; // anchor rounded to double
+  float64 levelAnchorImag = 0.0;
+  int64 originX = 0; // lattice coordinates of the bottom left pixel
+  int64 originY = 0;
+
+  uint32 passCount = 0;
+  bool roundInFlight = false;
+  bool visibleTilesComplete = true;
+  std::vector<MandelbrotTile*> roundTiles;
+  JobCounter roundJobs;
+  std::atomic<uint32> generation{0}; // bumped to abandon in flight tiles
+
+  // perturbation state, the reference orbit is stored rounded to double, Z[0] = 0
+  bool perturbation = false;
+  std::vector<float64> referenceReal;
+  std::vector<float64> referenceImag;
+  FixedPoint referenceCenterReal = {};
+  FixedPoint referenceCenterImag = {};
+  uint32 referenceMaxIterations = 0;
+  // delta after seriesSkip iterations is approximated by A*dc + B*dc^2 + C*dc^3
+  uint32 seriesSkip = 0;
+  float64 seriesA[2], seriesB[2], seriesC[2]; // {real, imag}
+
+  uint64 renderStartNanoseconds = 0;
+  uint64 renderedPixels = 0;
+  float64 renderMilliseconds = 0.0;
+};
@@ -0,0 +1,18 @@
+#version 330 core
+
+out vec4 FragColor;
+
+// iteration counts computed on the CPU, one texel per pixel
+uniform sampler2D iterations;
+uniform float maxIterations;
+uniform vec3 colorFavor;
+
+void main() {
+  float iterFraction = texelFetch(iterations, ivec2(gl_FragCoord.xy), 0).r / maxIterations;
+
+  vec3 color = vec3(1.0, 1.0, 1.0);
+  vec3 colorSub = (1.0 / colorFavor) * iterFraction;
+  color -= colorSub;
+
+  FragColor = vec4(color, 1.0);
+}
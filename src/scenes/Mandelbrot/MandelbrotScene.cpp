@@ -2,11 +2,15 @@
 // Created by Connor on 11/21/2019.
 //
 
+#include <cmath>
+#include <imgui/imgui.h>
+
 #include "MandelbrotScene.h"
 #include "../../common/FileLocations.h"
 #include "../../common/ObjectData.h"
 #include "../../common/Input.h"
 #include "../../common/Util.h"
+#include "../../common/FrameClock.h"
 
 MandelbrotScene::MandelbrotScene(GLFWwindow* window): Scene(), window(window) {}
 
@@ -19,27 +23,33 @@ void MandelbrotScene::init(Extent2D windowExtent)
 {
   Scene::init(windowExtent);
 
-  if(prevWindowExtent.width != 0) // Adjust the center offset in the event that the window size has changed since last init
-  {
-    float32 widthRatio = (float32)windowExtent.width / prevWindowExtent.width;
-    float32 heightRatio = (float32)windowExtent.height / prevWindowExtent.height;
-    centerOffset *= glm::vec2(widthRatio, heightRatio);
-  }
-
   drawFramebuffer = initializeFramebuffer(windowExtent, FramebufferCreate_NoDepthStencil);
 
-  prevWindowExtent = {windowExtent.width, windowExtent.height };
-
   mandelbrotShader = new ShaderProgram(UVCoordVertexShaderFileLoc, MandelbrotFragmentShaderFileLoc);
-  mandelbrotShader->use();
-  mandelbrotShader->setUniform("viewPortResolution", glm::vec2( windowExtent.width, windowExtent.height ));
+  iterationsShader = new ShaderProgram(UVCoordVertexShaderFileLoc, MandelbrotIterationsFragmentShaderFileLoc);
+
+  cpuRenderer.init(windowExtent);
 
   enableCursor(window, true);
 
   quadVertexAtt = initializeFramebufferQuadVertexAttBuffers();
 
-  lastFrame = getTime();
-  startTime = lastFrame;
+  ShaderProgram* shaders[] = { mandelbrotShader, iterationsShader };
+  ShaderProgram::finishLinks(shaders, ArrayCount(shaders));
+
+  mandelbrotShader->use();
+  mandelbrotShader->setUniform("viewPortResolution", glm::vec2( windowExtent.width, windowExtent.height ));
+  mandelbrotElapsedTimeUniform = mandelbrotShader->getUniformHandle("elapsedTime");
+  mandelbrotZoomUniform = mandelbrotShader->getUniformHandle("zoom");
+  mandelbrotCenterOffsetUniform = mandelbrotShader->getUniformHandle("centerOffset");
+  mandelbrotColorFavorUniform = mandelbrotShader->getUniformHandle("colorFavor");
+
+  iterationsShader->use();
+  iterationsShader->setUniform("iterations", 0);
+  iterationsMaxIterationsUniform = iterationsShader->getUniformHandle("maxIterations");
+  iterationsColorFavorUniform = iterationsShader->getUniformHandle("colorFavor");
+
+  startTime = getTime();
 }
 
 void MandelbrotScene::deinit()
@@ -50,28 +60,44 @@ void MandelbrotScene::deinit()
 
   mandelbrotShader->deleteShaderResources();
   delete mandelbrotShader;
+  iterationsShader->deleteShaderResources();
+  delete iterationsShader;
+
+  cpuRenderer.deinit();
 
   deleteVertexAtt(quadVertexAtt);
 }
 
 Framebuffer MandelbrotScene::drawFrame()
 {
-  local_access float32 previousZoom = zoom - 0.5f; // NOTE: values initially set to slight offset for the check below
-  local_access glm::vec2 previousOffset = glm::vec2{centerOffset.x, centerOffset.y};
+  local_access float64 previousZoom = zoom - 0.5; // NOTE: values initially set to slight offset for the check below
+  local_access FixedPoint previousCenterReal = centerReal;
+  local_access FixedPoint previousCenterImag = centerImag;
   local_access uint32 previousColorFavorIndex = currentColorFavorIndex;
   local_access Extent2D prevWindowExtent = windowExtent;
+  local_access MandelbrotBackend previousBackend = backend;
+
+  bool cpuIterationsChanged = false;
+  if(backend == MandelbrotBackend_Cpu)
+  {
+    cpuRenderer.render(cpuView());
+    cpuIterationsChanged = cpuRenderer.update();
+  }
 
   // we don't need to draw if we have not zoomed in since last frame
-  if(previousZoom == zoom && previousOffset == centerOffset
+  if(previousZoom == zoom && fixedPointEquals(previousCenterReal, centerReal) && fixedPointEquals(previousCenterImag, centerImag)
       && previousColorFavorIndex == currentColorFavorIndex
       && prevWindowExtent.height == windowExtent.height
-      && prevWindowExtent.width == windowExtent.width)
+      && prevWindowExtent.width == windowExtent.width
+      && previousBackend == backend && !cpuIterationsChanged)
   {
     return drawFramebuffer;
   }
   previousZoom = zoom;
-  previousOffset = centerOffset;
+  previousCenterReal = centerReal;
+  previousCenterImag = centerImag;
   previousColorFavorIndex = currentColorFavorIndex;
+  previousBackend = backend;
 
   glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
   glDisable(GL_DEPTH_TEST);
@@ -83,14 +109,23 @@ Framebuffer MandelbrotScene::drawFrame()
   glClear(GL_COLOR_BUFFER_BIT);
 
   float32 t = getTime() - startTime;
-  deltaTime = t - lastFrame;
-  lastFrame = t;
 
-  mandelbrotShader->use();
-  mandelbrotShader->setUniform("elapsedTime", t); // used with HexagonPlayground, NOT mandelbrot shader
-  mandelbrotShader->setUniform("zoom", zoom);
-  mandelbrotShader->setUniform("centerOffset", centerOffset);
-  mandelbrotShader->setUniform("colorFavor", colorFavors[currentColorFavorIndex]);
+  if(backend == MandelbrotBackend_Cpu)
+  {
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, cpuRenderer.iterationTexture());
+    iterationsShader->use();
+    iterationsShader->setUniform(iterationsMaxIterationsUniform, (float32)cpuRenderer.iterationTextureMaxIterations());
+    iterationsShader->setUniform(iterationsColorFavorUniform, colorFavors[currentColorFavorIndex]);
+  } else
+  {
+    mandelbrotShader->use();
+    mandelbrotShader->setUniform(mandelbrotElapsedTimeUniform, t); // used with HexagonPlayground, NOT mandelbrot shader
+    mandelbrotShader->setUniform(mandelbrotZoomUniform, (float32)zoom);
+    glm::vec2 centerOffset = glm::vec2(fixedPointToFloat64(centerReal) * windowExtent.height, fixedPointToFloat64(centerImag) * windowExtent.height);
+    mandelbrotShader->setUniform(mandelbrotCenterOffsetUniform, centerOffset);
+    mandelbrotShader->setUniform(mandelbrotColorFavorUniform, colorFavors[currentColorFavorIndex]);
+  }
   glDrawElements(GL_TRIANGLES, // drawing mode
                  6, // number of elements to draw (3 vertices per triangle * 2 triangles per quad)
                  GL_UNSIGNED_INT, // type of the indices
@@ -104,11 +139,12 @@ void MandelbrotScene::inputStatesUpdated() {
 
   if(isActive(MouseInput_Scroll)) {
     float32 yOffset = getMouseScrollY();
-    float zoomDelta = zoom * 0.03f * zoomSpeed;
+    float64 zoomDelta = zoom * 0.03 * zoomSpeed;
     if(yOffset < 0) {
       zoom -= zoomDelta;
     } else if(yOffset > 0) {
       zoom += zoomDelta;
+      if(zoom > MAX_ZOOM) { zoom = MAX_ZOOM; }
     }
   }
 
@@ -128,7 +164,9 @@ void MandelbrotScene::inputStatesUpdated() {
     MouseCoord mouseDelta = getMouseDelta();
     if(mouseDown) {
       // Note: mouseDelta.y is negative when mouse moves up due to upper left origin (0, 0)
-      centerOffset -= glm::vec2(mouseDelta.x / zoom, -mouseDelta.y / zoom);
+      float64 pixelSize = 1.0 / (windowExtent.height * zoom);
+      centerReal = fixedPointSub(centerReal, fixedPointFromFloat64(mouseDelta.x * pixelSize));
+      centerImag = fixedPointAdd(centerImag, fixedPointFromFloat64(mouseDelta.y * pixelSize));
     }
   }
 
@@ -138,6 +176,55 @@ void MandelbrotScene::inputStatesUpdated() {
   } else if (leftShiftState == INPUT_HOT_RELEASE) {
     zoomSpeed = ZOOM_SPEED_NORMAL;
   }
+
+  if(hotPress(KeyboardInput_R)) {
+    backend = (backend == MandelbrotBackend_Gpu) ? MandelbrotBackend_Cpu : MandelbrotBackend_Gpu;
+  }
+}
+
+// Iterations grow with the zoom so that boundary detail keeps resolving as the view narrows
+MandelbrotView MandelbrotScene::cpuView()
+{
+  float64 zoomDoublings = zoom > 0.25 ? log2(zoom / 0.25) : 0.0;
+  float64 maxIterations = CPU_MIN_ITERATIONS + (zoomDoublings * CPU_ITERATIONS_PER_ZOOM_DOUBLING);
+  if(maxIterations > CPU_MAX_ITERATIONS) { maxIterations = CPU_MAX_ITERATIONS; }
+
+  MandelbrotView view;
+  view.centerReal = centerReal;
+  view.centerImag = centerImag;
+  view.pixelSize = 1.0 / (windowExtent.height * zoom);
+  view.maxIterations = (uint32)maxIterations;
+  return view;
+}
+
+void MandelbrotScene::drawGui()
+{
+  Scene::drawGui();
+
+  ImGui::Begin("Mandelbrot");
+  ImGui::Text("Backend: %s (R to toggle)", backend == MandelbrotBackend_Cpu ? "CPU" : "GPU");
+  ImGui::Text("Zoom: %g", zoom);
+  if(backend == MandelbrotBackend_Cpu)
+  {
+    ImGui::Text("Max iterations: %u", cpuView().maxIterations);
+    ImGui::Text("Worker threads: %u", workerThreadCount() + 1);
+    ImGui::Text("Cached tiles: %u", cpuRenderer.cachedTileCount());
+    if(cpuRenderer.perturbing())
+    {
+      ImGui::Text("Perturbation: reference orbit %u, series skipped %u", cpuRenderer.referenceOrbitLength(), cpuRenderer.seriesSkippedIterations());
+    }
+    if(cpuRenderer.refining())
+    {
+      ImGui::Text("Refining...");
+    } else
+    {
+      ImGui::Text("Last render: %.2f ms (%.1f Mpix/s)", cpuRenderer.lastRenderMilliseconds(), cpuRenderer.lastMegapixelsPerSecond());
+    }
+  } else
+  {
+    ImGui::Text("Max iterations: %u", GPU_MAX_ITERATIONS);
+  }
+  ImGui::End();
 }
 
 void MandelbrotScene::framebufferSizeChangeRequest(Extent2D windowExtent)
@@ -150,9 +237,5 @@ void MandelbrotScene::framebufferSizeChangeRequest(Extent2D windowExtent)
   mandelbrotShader->use();
   mandelbrotShader->setUniform("viewPortResolution", glm::vec2(windowExtent.width, windowExtent.height));
 
-  // The center needs to be adjusted when the viewport size changes in order to maintain the same position
-  float32 widthRatio = (float32)windowExtent.width / prevWindowExtent.width;
-  float32 heightRatio = (float32)windowExtent.height / prevWindowExtent.height;
-  prevWindowExtent = windowExtent;
-  centerOffset *= glm::vec2(widthRatio, heightRatio);
+  cpuRenderer.resize(windowExtent);
 }
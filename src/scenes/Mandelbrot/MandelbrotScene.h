@@ -10,12 +10,24 @@
 #include "../FirstPersonScene.h"
 #include "../../common/ObjectData.h"
 #include "../../ShaderProgram.h"
+#include "MandelbrotCpuRenderer.h"
 
 #define ZOOM_SPEED_NORMAL 1.0f
 #define ZOOM_SPEED_FAST 3.0f
 #define MOUSE_ACTION_TIME_SECONDS 0.15f
+#define GPU_MAX_ITERATIONS 200 // matches MAX_ITERATIONS in MandelbrotFragmentShader
+#define CPU_MIN_ITERATIONS 200
+#define CPU_MAX_ITERATIONS 20000
+#define CPU_ITERATIONS_PER_ZOOM_DOUBLING 40
+#define MAX_ZOOM 1e65 // keeps pixel sizes well within FixedPoint's 256 fractional bits
 
-// TODO: Use fixed-point arithmatic to zoom further into the mandelbrot set, has very chunky pixels around 440,000 zoom
+enum MandelbrotBackend {
+  MandelbrotBackend_Gpu,
+  MandelbrotBackend_Cpu
+};
+
+// NOTE: The GPU backend runs out of float precision (chunky pixels) around 440,000 zoom, the CPU backend switches to
+// NOTE: perturbation from a fixed-point reference orbit and holds up to MAX_ZOOM
 class MandelbrotScene final : public Scene {
 public:
   MandelbrotScene(GLFWwindow* window);
@@ -23,27 +35,37 @@ public:
   Framebuffer drawFrame();
   void deinit();
   void inputStatesUpdated();
+  void drawGui();
   virtual void framebufferSizeChangeRequest(Extent2D windowExtent);
   const char* title();
 
 private:
 
-  Extent2D prevWindowExtent = { 0, 0 };
-
   Framebuffer drawFramebuffer;
 
   GLFWwindow* window = NULL;
 
   ShaderProgram* mandelbrotShader = NULL;
+  ShaderProgram* iterationsShader = NULL;
+
+  UniformHandle mandelbrotElapsedTimeUniform;
+  UniformHandle mandelbrotZoomUniform;
+  UniformHandle mandelbrotCenterOffsetUniform;
+  UniformHandle mandelbrotColorFavorUniform;
+  UniformHandle iterationsMaxIterationsUniform;
+  UniformHandle iterationsColorFavorUniform;
+
+  MandelbrotBackend backend = MandelbrotBackend_Gpu;
+  MandelbrotCpuRenderer cpuRenderer;
 
   float zoomSpeed = ZOOM_SPEED_NORMAL;
 
   float32 startTime = 0;
-  float32 deltaTime = 0;
-  float32 lastFrame = 0;
 
-  float32 zoom = 0.25f;
-  glm::vec2 centerOffset = glm::vec2(0.0f, 0.0f);
+  float64 zoom = 0.25;
+  // NOTE: center in the complex plane, the GPU backend gets it rounded to float
+  FixedPoint centerReal = {};
+  FixedPoint centerImag = {};
   bool mouseDown = false;
 
   VertexAtt quadVertexAtt = {};
@@ -53,4 +75,6 @@ private:
                               glm::vec3(0.5f, 1.0f, 0.5f) };
   int32 currentColorFavorIndex = 0;
   float32 mouseDownTime = 0.0f;
+
+  MandelbrotView cpuView();
 };
@@ -19,7 +19,8 @@ struct DirectionalLight{
 
 vec3 distColor(float numSteps);
 float distPosToScene(vec3 pos);
-vec4 distanceRayToScene(vec3 rayOrigin, vec3 rayDir);
+vec4 distanceRayToScene(vec3 rayOrigin, vec3 rayDir, float startDist);
+vec4 coneMarchTile();
 void estimateNormal(vec3 pos);
 vec4 calcDirectionalLightColor();
 vec4 calcLightColor(vec3 lightDir, LightColor lightColor);
@@ -53,6 +54,11 @@ uniform mat4 view;
 uniform vec3 cameraPos;
 uniform DirectionalLight directionalLight;
 uniform int numSamples;
+uniform vec2 jitter; // sub-pixel offset that varies per frame for temporal accumulation
+uniform bool conePrePass; // when true, each fragment cone marches a tile of the ray march instead
+uniform bool coneStartEnabled;
+uniform int coneTileSize;
+uniform sampler2D coneDistances; // vec2(start distance, steps taken) per tile, written by the cone pre-pass
 
 const float boxDimen = 20.0;
 const float halfBoxDimen = boxDimen / 2.0;
@@ -68,9 +74,19 @@ vec3 fragPos;
 
 void main()
 {
+  if(conePrePass) {
+    FragColor = coneMarchTile();
+    return;
+  }
+
+  vec2 coneResult = vec2(0.0, 0.0);
+  if(coneStartEnabled) {
+    coneResult = texelFetch(coneDistances, ivec2(gl_FragCoord.xy) / coneTileSize, 0).xy;
+  }
+
   // Move (0,0) from bottom left to center
   // Coordinate system goes from [-viewPortResolution / 2, viewPortResolution / 2]
-  vec2 pixelCoord = gl_FragCoord.xy-0.5*viewPortResolution.xy;
+  vec2 pixelCoord = gl_FragCoord.xy + jitter - 0.5*viewPortResolution.xy;
   float pixelWidth = 1.0 / viewPortResolution.y;
   // Scale y value to [-0.5, 0.5], scale x by same factor
   pixelCoord = pixelCoord * pixelWidth;
@@ -92,7 +108,7 @@ void main()
   vec4 averageDistanceResults = vec4(0.0, 0.0, 0.0, 0.0);
   for(int sampleIndex = 0; sampleIndex < numSamples; ++sampleIndex) {
     rayDirSamples[sampleIndex] = vec3(vec4(rayDirSamples[sampleIndex], 0.0) * view);
-    averageDistanceResults += distanceRayToScene(rayOrigin, rayDirSamples[sampleIndex]);
+    averageDistanceResults += distanceRayToScene(rayOrigin, rayDirSamples[sampleIndex], coneResult.x);
   }
   averageDistanceResults /= numSamples;
   vec3 worldPos = averageDistanceResults.xyz;
@@ -101,13 +117,15 @@ void main()
   estimateNormal(worldPos);
 
   if(numIterations < MAX_STEPS) { // hit
-    vec3 col = distColor(numIterations);
-    FragColor = vec4(gammaCorrectionToSRGB(col), 1.0);
+    // NOTE: steps taken by the cone are included so shading doesn't depend on where the ray started
+    vec3 col = distColor(min(numIterations + coneResult.y, float(MAX_STEPS)));
     vec4 clipPos = projection * view * vec4(worldPos, 1.0);
     float ndcDepth = clipPos.z / clipPos.w;
     float far = gl_DepthRange.far;
     float near = gl_DepthRange.near;
     gl_FragDepth = (far - near) * 0.5 * ndcDepth + (near + far) * 0.5;
+    // NOTE: depth is carried in alpha for MengerSpongeTemporalFragmentShader, which also writes it as gl_FragDepth
+    FragColor = vec4(gammaCorrectionToSRGB(col), gl_FragDepth);
   } else { // miss
 //    FragColor = vec4(missColor, 1.0);
     discard;
@@ -156,9 +174,10 @@ vec3 distColor(float numSteps) {
 
 // returns vec4(worldSpacePos, iterations)
 // NOTE: ray dir is assumed to be normalized
-vec4 distanceRayToScene(vec3 rayOrigin, vec3 rayDir) {
+// NOTE: startDist must be known to be free of the scene along the ray (ex: from coneMarchTile())
+vec4 distanceRayToScene(vec3 rayOrigin, vec3 rayDir, float startDist) {
 
-  float distTraveled = 0.0;
+  float distTraveled = startDist;
 
   for(int i = 0; i < MAX_STEPS; i++) {
     vec3 pos = rayOrigin + (distTraveled * rayDir);
@@ -171,6 +190,39 @@ vec4 distanceRayToScene(vec3 rayOrigin, vec3 rayDir) {
   return vec4(vec3(-1.0f), MAX_STEPS);
 }
 
+// Marches a single cone enclosing every ray shot for a coneTileSize x coneTileSize tile of pixels.
+// Each step, the sphere of radius posToScene around the cone's center is empty, and every ray of the tile is within
+// coneRadius of the center. The cone keeps widening as it advances, so a step s is only safe while
+// s + (distTraveled + s) * coneRadiusPerDist <= posToScene, giving s = (posToScene - coneRadius) / (1 + coneRadiusPerDist).
+// returns vec4(distance every ray in the tile can start at, steps taken, 0, 0)
+vec4 coneMarchTile() {
+  // NOTE: gl_FragCoord is at the center of the pre-pass pixel, which is the center of the tile in ray march pixels
+  vec2 tileCenterCoord = gl_FragCoord.xy * coneTileSize;
+  float pixelWidth = 1.0 / viewPortResolution.y;
+  vec2 pixelCoord = (tileCenterCoord - 0.5*viewPortResolution.xy) * pixelWidth;
+  vec3 rayDir = normalize(vec3(vec4(pixelCoord, -1.0, 0.0) * view));
+
+  // NOTE: tile's half diagonal padded by a pixel to cover both jitter and supersample offsets
+  // NOTE: the image plane is 1.0 away, so its distances bound the angle between rays
+  float coneRadiusPerDist = (0.5 * coneTileSize + 1.0) * sqrt(2.0) * pixelWidth;
+
+  float distTraveled = 0.0;
+  int i = 0;
+  for(; i < MAX_STEPS; i++) {
+    vec3 pos = rayOrigin + (distTraveled * rayDir);
+    float coneRadius = distTraveled * coneRadiusPerDist;
+    float safeDist = (distPosToScene(pos) - coneRadius) / (1.0 + coneRadiusPerDist);
+    if(safeDist < HIT_DIST) break; // cone touches the scene, rays must continue on their own
+    distTraveled += safeDist;
+    if(distTraveled > MISS_DIST) {
+      distTraveled = MISS_DIST;
+      break;
+    }
+  }
+
+  return vec4(distTraveled, i, 0.0, 0.0);
+}
+
 float distPosToScene(vec3 rayPos) {
   return sdMengerPrison(rayPos);
 }
@@ -2,16 +2,36 @@
 // Created by Connor on 11/21/2019.
 //
 
+#include <cmath>
 #include <imgui/imgui.h>
 #include "MengerSpongeScene.h"
 #include "../../common/FileLocations.h"
 #include "../../common/Util.h"
+#include "../../common/FrameClock.h"
 #include "../../common/Input.h"
+#include "../../common/TextureCache.h"
 
 const uint32 diff1TextureIndex = 0;
 const uint32 spec1TextureIndex = diff1TextureIndex + 1;
 const uint32 diff2TextureIndex = spec1TextureIndex + 1;
 const uint32 spec2TextureIndex = diff2TextureIndex + 1;
+const uint32 rayMarchTextureIndex = spec2TextureIndex + 1;
+const uint32 historyTextureIndex = rayMarchTextureIndex + 1;
+const uint32 coneTextureIndex = historyTextureIndex + 1;
+
+// Low discrepancy sequence in [0, 1), used for sub-pixel jitter
+file_access float32 halton(uint32 index, uint32 base)
+{
+  float32 result = 0.0f;
+  float32 fraction = 1.0f / base;
+  while(index > 0)
+  {
+    result += fraction * (index % base);
+    index /= base;
+    fraction /= base;
+  }
+  return result;
+}
 
 MengerSpongeScene::MengerSpongeScene(GLFWwindow* window): FirstPersonScene(), window(window)
 {
@@ -32,6 +52,7 @@ void MengerSpongeScene::init(Extent2D windowExtent)
   mengerSpongeShader = new ShaderProgram(UVCoordVertexShaderFileLoc, MengerSpongeFragmentShaderFileLoc);
   pixel2DShader = new ShaderProgram(pixel2DVertexShaderFileLoc, textureFragmentShaderFileLoc);
   cubeShader = new ShaderProgram(CubePosNormTexVertexShaderFileLoc, CubeTextureFragmentShaderFileLoc);
+  temporalShader = new ShaderProgram(UVCoordVertexShaderFileLoc, MengerSpongeTemporalFragmentShaderFileLoc);
 
   quadVertexAtt = initializeFramebufferQuadVertexAttBuffers();
   cubeVertexAtt = initializeCubePosNormTexVertexAttBuffers();
@@ -45,16 +66,24 @@ void MengerSpongeScene::init(Extent2D windowExtent)
           currentResolution.width,
           currentResolution.height
   };
+  initTemporalFramebuffers();
+  glGenQueries(RAY_MARCH_TIMER_LATENCY * 2, &rayMarchTimestampQueries[0][0]);
+  rayMarchTimerFrame = 0;
+  renderScale = 1.0f;
+  renderResolution = currentResolution;
 
   // NOTE: This is helps maintain same projection for both the ray marching and rasterization
   // If how we shoot rays change, this must change. If this changes, how we shoot rays must change.
   const float rayMarchFovVertical = glm::radians(53.14f);
-  projectionMat = glm::perspective(rayMarchFovVertical, (float32)currentResolution.width / (float32)currentResolution.height, 0.1f, 200.0f);
+  projectionMat = glm::perspective(rayMarchFovVertical, (float32)currentResolution.width / (float32)currentResolution.height, nearPlane, farPlane);
+
+  acquire2DTexture(scarabWingsTextureLoc, textureDiff1Id, true, true, &textureWidth, &textureHeight);
+  acquire2DTexture(scarabWingsSpecTextureLoc, textureSpec1Id, true, false);
+  acquire2DTexture(scarabTextureLoc, textureDiff2Id, true, true);
+  acquire2DTexture(scarabSpecTextureLoc, textureSpec2Id, true, false);
 
-  load2DTexture(scarabWingsTextureLoc, textureDiff1Id, true, true, &textureWidth, &textureHeight);
-  load2DTexture(scarabWingsSpecTextureLoc, textureSpec1Id, true, false);
-  load2DTexture(scarabTextureLoc, textureDiff2Id, true, true);
-  load2DTexture(scarabSpecTextureLoc, textureSpec2Id, true, false);
+  ShaderProgram* shaders[] = { mengerSpongeShader, pixel2DShader, cubeShader, temporalShader };
+  ShaderProgram::finishLinks(shaders, ArrayCount(shaders));
 
   mengerSpongeShader->use();
   mengerSpongeShader->setUniform("viewPortResolution", glm::vec2(currentResolution.width, currentResolution.height));
@@ -63,6 +92,17 @@ void MengerSpongeScene::init(Extent2D windowExtent)
   mengerSpongeShader->setUniform("directionalLight.color.specular", directionalLightSpec);
   mengerSpongeShader->setUniform("directionalLight.direction", directionalLightDir);
   mengerSpongeShader->setUniform("projection", projectionMat);
+  mengerSpongeShader->setUniform("coneTileSize", CONE_MARCH_TILE_SIZE);
+  mengerSpongeShader->setUniform("coneDistances", (int32)coneTextureIndex);
+  mengerSpongeViewPortResolutionUniform = mengerSpongeShader->getUniformHandle("viewPortResolution");
+  mengerSpongeJitterUniform = mengerSpongeShader->getUniformHandle("jitter");
+  mengerSpongeRayOriginUniform = mengerSpongeShader->getUniformHandle("rayOrigin");
+  mengerSpongeElapsedTimeUniform = mengerSpongeShader->getUniformHandle("elapsedTime");
+  mengerSpongeViewUniform = mengerSpongeShader->getUniformHandle("view");
+  mengerSpongeCameraPosUniform = mengerSpongeShader->getUniformHandle("cameraPos");
+  mengerSpongeNumSamplesUniform = mengerSpongeShader->getUniformHandle("numSamples");
+  mengerSpongeConeStartEnabledUniform = mengerSpongeShader->getUniformHandle("coneStartEnabled");
+  mengerSpongeConePrePassUniform = mengerSpongeShader->getUniformHandle("conePrePass");
 
   cubeShader->use();
   cubeShader->setUniform("projection", projectionMat);
@@ -73,6 +113,23 @@ void MengerSpongeScene::init(Extent2D windowExtent)
   cubeShader->setUniform("directionalLight.color.diffuse", directionalLightDiff);
   cubeShader->setUniform("directionalLight.color.specular", directionalLightSpec);
   cubeShader->setUniform("directionalLight.direction", directionalLightDir);
+  cubeDiffTextureUniform = cubeShader->getUniformHandle("material.diffTexture");
+  cubeSpecTextureUniform = cubeShader->getUniformHandle("material.specTexture");
+  cubeModelUniform = cubeShader->getUniformHandle("model");
+  cubeViewUniform = cubeShader->getUniformHandle("view");
+  cubeCameraPosUniform = cubeShader->getUniformHandle("cameraPos");
+
+  temporalShader->use();
+  temporalShader->setUniform("currentFrame", (int32)rayMarchTextureIndex);
+  temporalShader->setUniform("history", (int32)historyTextureIndex);
+  temporalShader->setUniform("near", nearPlane);
+  temporalShader->setUniform("far", farPlane);
+  temporalRenderResolutionUniform = temporalShader->getUniformHandle("renderResolution");
+  temporalOutputResolutionUniform = temporalShader->getUniformHandle("outputResolution");
+  temporalJitterUniform = temporalShader->getUniformHandle("jitter");
+  temporalInverseViewProjectionUniform = temporalShader->getUniformHandle("inverseViewProjection");
+  temporalPreviousViewProjectionUniform = temporalShader->getUniformHandle("previousViewProjection");
+  temporalHistoryWeightUniform = temporalShader->getUniformHandle("historyWeight");
 
 //  pixel2DShader->use();
 //  pixel2DShader->setUniform("windowDimens", glm::vec2(currentResolution.width, currentResolution.height));
@@ -81,8 +138,7 @@ void MengerSpongeScene::init(Extent2D windowExtent)
 
   timer.lengthInSeconds = 5;
 
-  lastFrame = getTime();
-  startTime = lastFrame;
+  startTime = getTime();
 }
 
 void MengerSpongeScene::deinit()
@@ -95,14 +151,76 @@ void MengerSpongeScene::deinit()
   delete mengerSpongeShader;
   delete pixel2DShader;
   delete cubeShader;
+  temporalShader->deleteShaderResources();
+  delete temporalShader;
 
   VertexAtt deleteVertexAttributes[] = { quadVertexAtt, cubeVertexAtt };
   deleteVertexAtts(ArrayCount(deleteVertexAttributes), deleteVertexAttributes);
 
   deleteFramebuffer(&dynamicResolutionFBO);
+  deleteTemporalFramebuffers();
+  glDeleteQueries(RAY_MARCH_TIMER_LATENCY * 2, &rayMarchTimestampQueries[0][0]);
 
   uint32 deleteTextures[] = { textureDiff1Id, textureSpec1Id, textureDiff2Id, textureSpec2Id };
-  glDeleteTextures(ArrayCount(deleteTextures), deleteTextures);
+  releaseTextures(ArrayCount(deleteTextures), deleteTextures);
+}
+
+void MengerSpongeScene::initTemporalFramebuffers()
+{
+  // NOTE: window space depth is carried in alpha and sits close to 1.0, where half floats are far too coarse
+  FramebufferCreationFlags flags = (FramebufferCreationFlags)(FramebufferCreate_NoDepthStencil | FramebufferCreate_color_RGBA32F);
+  rayMarchFBO = initializeFramebuffer(currentResolution, flags);
+  historyFBOs[0] = initializeFramebuffer(currentResolution, flags);
+  historyFBOs[1] = initializeFramebuffer(currentResolution, flags);
+  Extent2D coneExtent = {
+          (currentResolution.width + CONE_MARCH_TILE_SIZE - 1) / CONE_MARCH_TILE_SIZE,
+          (currentResolution.height + CONE_MARCH_TILE_SIZE - 1) / CONE_MARCH_TILE_SIZE
+  };
+  coneFBO = initializeFramebuffer(coneExtent, (FramebufferCreationFlags)(FramebufferCreate_NoDepthStencil | FramebufferCreate_color_RG32F));
+  historyValid = false;
+}
+
+void MengerSpongeScene::deleteTemporalFramebuffers()
+{
+  Framebuffer* temporalFramebuffers[] = { &rayMarchFBO, &historyFBOs[0], &historyFBOs[1], &coneFBO };
+  deleteFramebuffers(ArrayCount(temporalFramebuffers), temporalFramebuffers);
+}
+
+// Reads back the ray march time from RAY_MARCH_TIMER_LATENCY frames ago and nudges the render scale toward the budget.
+// Ray march cost is roughly proportional to pixel count, so the scale moves with the square root of the time ratio.
+void MengerSpongeScene::updateDynamicResolution()
+{
+  uint32 slot = rayMarchTimerFrame % RAY_MARCH_TIMER_LATENCY;
+  if(rayMarchTimerFrame >= RAY_MARCH_TIMER_LATENCY)
+  {
+    GLint available = 0;
+    glGetQueryObjectiv(rayMarchTimestampQueries[slot][1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if(available) // NOTE: never stall on the GPU, skip the measurement instead
+    {
+      GLuint64 beginNanoseconds, endNanoseconds;
+      glGetQueryObjectui64v(rayMarchTimestampQueries[slot][0], GL_QUERY_RESULT, &beginNanoseconds);
+      glGetQueryObjectui64v(rayMarchTimestampQueries[slot][1], GL_QUERY_RESULT, &endNanoseconds);
+      rayMarchMs = (endNanoseconds - beginNanoseconds) / 1000000.0f;
+
+      if(dynamicResolutionEnabled && rayMarchMs > 0.0f)
+      {
+        float32 estimatedScale = rayMarchTimerScales[slot] * sqrtf(rayMarchBudgetMs / rayMarchMs);
+        if(estimatedScale < DYNAMIC_RESOLUTION_MIN_SCALE) { estimatedScale = DYNAMIC_RESOLUTION_MIN_SCALE; }
+        if(estimatedScale > 1.0f) { estimatedScale = 1.0f; }
+        if(fabsf(estimatedScale - renderScale) > DYNAMIC_RESOLUTION_DEADBAND)
+        {
+          renderScale += (estimatedScale - renderScale) * DYNAMIC_RESOLUTION_ADJUST_RATE;
+        }
+      }
+    }
+  }
+  if(!dynamicResolutionEnabled) { renderScale = 1.0f; }
+
+  renderResolution.width = (uint32)(currentResolution.width * renderScale + 0.5f);
+  renderResolution.height = (uint32)(currentResolution.height * renderScale + 0.5f);
+  if(renderResolution.width < 1) { renderResolution.width = 1; }
+  if(renderResolution.height < 1) { renderResolution.height = 1; }
+  rayMarchTimerScales[slot] = renderScale;
 }
 
 Framebuffer MengerSpongeScene::drawFrame()
@@ -129,16 +247,15 @@ Framebuffer MengerSpongeScene::drawFrame()
   glViewport(0, 0, currentResolution.width, currentResolution.height);
 
   float32 t = getTime() - startTime;
-  deltaTime = t - lastFrame;
-  lastFrame = t;
+  float32 deltaTime = getDeltaTime();
 
   cubeShader->use();
   if(((uint32)(t / frameTime) % 2) == 0) {
-    cubeShader->setUniform("material.diffTexture", 0);
-    cubeShader->setUniform("material.specTexture", 1);
+    cubeShader->setUniform(cubeDiffTextureUniform, 0);
+    cubeShader->setUniform(cubeSpecTextureUniform, 1);
   } else {
-    cubeShader->setUniform("material.diffTexture", 2);
-    cubeShader->setUniform("material.specTexture", 3);
+    cubeShader->setUniform(cubeDiffTextureUniform, 2);
+    cubeShader->setUniform(cubeSpecTextureUniform, 3);
   }
 
   // Auto run forward
@@ -159,20 +276,102 @@ Framebuffer MengerSpongeScene::drawFrame()
     mengerSpongeShader->setUniform("directionalLight.color.specular", directionalLightSpec);
     mengerSpongeShader->setUniform("directionalLight.direction", directionalLightDir);
     mengerSpongeShader->setUniform("projection", projectionMat);
+    mengerSpongeShader->setUniform("coneTileSize", CONE_MARCH_TILE_SIZE);
+    mengerSpongeShader->setUniform("coneDistances", (int32)coneTextureIndex);
   }
 
+  updateDynamicResolution();
+  glm::vec2 jitter = glm::vec2(0.0f, 0.0f);
+  if(temporalAccumulationEnabled)
+  {
+    jitterIndex = (jitterIndex + 1) % TEMPORAL_JITTER_COUNT;
+    jitter = glm::vec2(halton(jitterIndex + 1, 2) - 0.5f, halton(jitterIndex + 1, 3) - 0.5f);
+  }
+
+  glDisable(GL_DEPTH_TEST);
+  glDisable(GL_BLEND);
+  uint32 timerSlot = rayMarchTimerFrame % RAY_MARCH_TIMER_LATENCY;
+  glQueryCounter(rayMarchTimestampQueries[timerSlot][0], GL_TIMESTAMP);
+
   mengerSpongeShader->use();
-  mengerSpongeShader->setUniform("rayOrigin", camera.Position);
-  mengerSpongeShader->setUniform("elapsedTime", t);
-  mengerSpongeShader->setUniform("view", cameraMat);
-  mengerSpongeShader->setUniform("cameraPos", camera.Position);
-  mengerSpongeShader->setUniform("numSamples", numSamples);
+  mengerSpongeShader->setUniform(mengerSpongeViewPortResolutionUniform, glm::vec2(renderResolution.width, renderResolution.height));
+  mengerSpongeShader->setUniform(mengerSpongeJitterUniform, jitter);
+  mengerSpongeShader->setUniform(mengerSpongeRayOriginUniform, camera.Position);
+  mengerSpongeShader->setUniform(mengerSpongeElapsedTimeUniform, t);
+  mengerSpongeShader->setUniform(mengerSpongeViewUniform, cameraMat);
+  mengerSpongeShader->setUniform(mengerSpongeCameraPosUniform, camera.Position);
+  mengerSpongeShader->setUniform(mengerSpongeNumSamplesUniform, numSamples);
+  mengerSpongeShader->setUniform(mengerSpongeConeStartEnabledUniform, coneMarchEnabled);
   glBindVertexArray(quadVertexAtt.arrayObject);
+
+  // cone march pre-pass, one fragment per tile of the render resolution
+  if(coneMarchEnabled)
+  {
+    glBindFramebuffer(GL_FRAMEBUFFER, coneFBO.id);
+    glViewport(0, 0,
+               (renderResolution.width + CONE_MARCH_TILE_SIZE - 1) / CONE_MARCH_TILE_SIZE,
+               (renderResolution.height + CONE_MARCH_TILE_SIZE - 1) / CONE_MARCH_TILE_SIZE);
+    mengerSpongeShader->setUniform(mengerSpongeConePrePassUniform, true);
+    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    mengerSpongeShader->setUniform(mengerSpongeConePrePassUniform, false);
+
+    // NOTE: bound only between the pre-pass and the ray march so the texture is never bound while being rendered to
+    glActiveTexture(GL_TEXTURE0 + coneTextureIndex);
+    glBindTexture(GL_TEXTURE_2D, coneFBO.colorAttachment);
+  }
+
+  // ray march at the render resolution, misses are discarded leaving the clear color with a depth of 1.0 in alpha
+  glBindFramebuffer(GL_FRAMEBUFFER, rayMarchFBO.id);
+  glViewport(0, 0, renderResolution.width, renderResolution.height);
+  glClear(GL_COLOR_BUFFER_BIT);
   glDrawElements(GL_TRIANGLES, // drawing mode
                  6, // number of elements to draw (3 vertices per triangle * 2 triangles per quad)
                  GL_UNSIGNED_INT, // type of the indices
                  0 /* offset in the EBO */);
 
+  if(coneMarchEnabled)
+  {
+    glActiveTexture(GL_TEXTURE0 + coneTextureIndex);
+    glBindTexture(GL_TEXTURE_2D, 0);
+  }
+
+  glQueryCounter(rayMarchTimestampQueries[timerSlot][1], GL_TIMESTAMP);
+  rayMarchTimerFrame++;
+
+  // upsample + accumulate into the output, writing depth for the cube and this frame's history alongside
+  uint32 writeHistoryIndex = (historyIndex + 1) % ArrayCount(historyFBOs);
+  glBindFramebuffer(GL_FRAMEBUFFER, dynamicResolutionFBO.id);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, historyFBOs[writeHistoryIndex].colorAttachment, 0);
+  GLenum drawBuffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+  glDrawBuffers(ArrayCount(drawBuffers), drawBuffers);
+  glViewport(0, 0, currentResolution.width, currentResolution.height);
+  glEnable(GL_DEPTH_TEST);
+  glDepthFunc(GL_ALWAYS);
+
+  glActiveTexture(GL_TEXTURE0 + rayMarchTextureIndex);
+  glBindTexture(GL_TEXTURE_2D, rayMarchFBO.colorAttachment);
+  glActiveTexture(GL_TEXTURE0 + historyTextureIndex);
+  glBindTexture(GL_TEXTURE_2D, historyFBOs[historyIndex].colorAttachment);
+
+  glm::mat4 viewProjection = projectionMat * cameraMat;
+  temporalShader->use();
+  temporalShader->setUniform(temporalRenderResolutionUniform, glm::vec2(renderResolution.width, renderResolution.height));
+  temporalShader->setUniform(temporalOutputResolutionUniform, glm::vec2(currentResolution.width, currentResolution.height));
+  temporalShader->setUniform(temporalJitterUniform, jitter);
+  temporalShader->setUniform(temporalInverseViewProjectionUniform, glm::inverse(viewProjection));
+  temporalShader->setUniform(temporalPreviousViewProjectionUniform, previousViewProjection);
+  temporalShader->setUniform(temporalHistoryWeightUniform, (temporalAccumulationEnabled && historyValid) ? TEMPORAL_HISTORY_WEIGHT : 0.0f);
+  glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+
+  // NOTE: history is only attached for this pass, resizing deletes the history textures
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, 0, 0);
+  glDrawBuffers(1, drawBuffers);
+  glDepthFunc(GL_LESS);
+  glEnable(GL_BLEND);
+  previousViewProjection = viewProjection;
+  historyIndex = writeHistoryIndex;
+  historyValid = true;
+
   // NOTE: Cube will be positioned at <0,0>
   glm::mat4 rotateMatrix = glm::rotate(glm::mat4(1.0f), t * glm::radians(20.0f), cubeRotAxis);
   glm::mat4 cubeModel = glm::scale(glm::mat4(1.0f), glm::vec3(cubeScale)); // scale is uniform
@@ -189,9 +388,9 @@ Framebuffer MengerSpongeScene::drawFrame()
   glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(cubeAttrIndices), cubeAttrIndices, GL_DYNAMIC_DRAW);
 
   cubeShader->use();
-  cubeShader->setUniform("model", cubeModel);
-  cubeShader->setUniform("view", cameraMat);
-  cubeShader->setUniform("cameraPos", camera.Position);
+  cubeShader->setUniform(cubeModelUniform, cubeModel);
+  cubeShader->setUniform(cubeViewUniform, cameraMat);
+  cubeShader->setUniform(cubeCameraPosUniform, camera.Position);
   glDrawElements(GL_TRIANGLES, // drawing mode
                  cubePosNormTexNumElements * 3, // number of elements to draw (3 vertices per triangle * 2 triangles per face * 6 faces)
                  GL_UNSIGNED_INT, // type of the indices
@@ -216,6 +415,12 @@ void MengerSpongeScene::drawGui()
     ImGui::PushItemWidth(ImGui::GetWindowWidth() * 0.50f);
     // Simplified Settings (expose floating-pointer border sizes as boolean representing 0.0f or 1.0f)
     if (ImGui::SliderInt("Supersamples", &numSamples, 1, 8)) {}
+    ImGui::Checkbox("Dynamic resolution", &dynamicResolutionEnabled);
+    ImGui::SliderFloat("Ray march budget (ms)", &rayMarchBudgetMs, 1.0f, 33.0f);
+    ImGui::Checkbox("Temporal accumulation", &temporalAccumulationEnabled);
+    ImGui::Checkbox("Cone march pre-pass", &coneMarchEnabled);
+    ImGui::Text("Ray march %ux%u (%.0f%% of %ux%u): %.2f ms", renderResolution.width, renderResolution.height, renderScale * 100.0f,
+                currentResolution.width, currentResolution.height, rayMarchMs);
     ImGui::PopItemWidth();
   }
 }
@@ -234,8 +439,8 @@ void MengerSpongeScene::inputStatesUpdated() {
     publicPseudoDrawFramebuffer.extent.width = currentResolution.width;
     publicPseudoDrawFramebuffer.extent.height = currentResolution.height;
 
-    mengerSpongeShader->use();
-    mengerSpongeShader->setUniform("viewPortResolution", glm::vec2(currentResolution.width, currentResolution.height));
+    deleteTemporalFramebuffers();
+    initTemporalFramebuffers();
 
     pixel2DShader->use();
     pixel2DShader->setUniform("windowDimens", glm::vec2(currentResolution.width, currentResolution.height));
@@ -253,8 +458,8 @@ void MengerSpongeScene::inputStatesUpdated() {
     publicPseudoDrawFramebuffer.extent.width = currentResolution.width;
     publicPseudoDrawFramebuffer.extent.height = currentResolution.height;
 
-    mengerSpongeShader->use();
-    mengerSpongeShader->setUniform("viewPortResolution", glm::vec2(currentResolution.width, currentResolution.height));
+    deleteTemporalFramebuffers();
+    initTemporalFramebuffers();
 
     pixel2DShader->use();
     pixel2DShader->setUniform("windowDimens", glm::vec2(currentResolution.width, currentResolution.height));
@@ -11,15 +11,21 @@
 #include "../FirstPersonScene.h"
 #include "../../common/ObjectData.h"
 #include "../../ShaderProgram.h"
-
-const Extent2D screenResolutions[] = {
-        {120, 68},
-        {240, 135},
-        {480, 270},
-        {960, 540},
-        {1920, 1080},
-        {3840, 2160}
-};
+#include "ScreenResolutions.h"
+
+// NOTE: The dynamic resolution controller scales the ray march resolution (relative to the chosen output resolution)
+// NOTE: to keep the ray march pass's GPU time within a budget. The temporal pass upsamples to the output resolution
+// NOTE: while accumulating jittered frames through reprojection, recovering most of the detail lost to the lower scale.
+#define DYNAMIC_RESOLUTION_MIN_SCALE 0.25f
+#define DYNAMIC_RESOLUTION_DEFAULT_BUDGET_MS 8.0f
+#define DYNAMIC_RESOLUTION_ADJUST_RATE 0.25f // fraction of the way to the estimated scale taken per measurement
+#define DYNAMIC_RESOLUTION_DEADBAND 0.02f // scale changes smaller than this are ignored to avoid constant flicker
+#define RAY_MARCH_TIMER_LATENCY 3 // frames before GPU timestamps are read back
+#define TEMPORAL_HISTORY_WEIGHT 0.9f
+#define TEMPORAL_JITTER_COUNT 8
+// NOTE: The cone pre-pass marches one cone per tile of ray march pixels to find how far all of the tile's rays
+// NOTE: can travel before any may hit, letting the full resolution pass skip the empty space in front of the sponge.
+#define CONE_MARCH_TILE_SIZE 8
 
 class MengerSpongeScene final : public FirstPersonScene {
 public:
@@ -33,17 +39,49 @@ public:
   const char* title();
 
 private:
+  void initTemporalFramebuffers();
+  void deleteTemporalFramebuffers();
+  void updateDynamicResolution();
 
   GLFWwindow* window = NULL;
 
   ShaderProgram* mengerSpongeShader = NULL;
   ShaderProgram* pixel2DShader = NULL;
   ShaderProgram* cubeShader = NULL;
+  ShaderProgram* temporalShader = NULL;
+
+  UniformHandle mengerSpongeViewPortResolutionUniform;
+  UniformHandle mengerSpongeJitterUniform;
+  UniformHandle mengerSpongeRayOriginUniform;
+  UniformHandle mengerSpongeElapsedTimeUniform;
+  UniformHandle mengerSpongeViewUniform;
+  UniformHandle mengerSpongeCameraPosUniform;
+  UniformHandle mengerSpongeNumSamplesUniform;
+  UniformHandle mengerSpongeConeStartEnabledUniform;
+  UniformHandle mengerSpongeConePrePassUniform;
+  UniformHandle cubeDiffTextureUniform;
+  UniformHandle cubeSpecTextureUniform;
+  UniformHandle cubeModelUniform;
+  UniformHandle cubeViewUniform;
+  UniformHandle cubeCameraPosUniform;
+  UniformHandle temporalRenderResolutionUniform;
+  UniformHandle temporalOutputResolutionUniform;
+  UniformHandle temporalJitterUniform;
+  UniformHandle temporalInverseViewProjectionUniform;
+  UniformHandle temporalPreviousViewProjectionUniform;
+  UniformHandle temporalHistoryWeightUniform;
 
   VertexAtt quadVertexAtt;
   VertexAtt cubeVertexAtt;
   Framebuffer dynamicResolutionFBO;
   Framebuffer publicPseudoDrawFramebuffer; // NOTE: this psuedo-framebuffer lets us hide the true size of our FBO to any caller
+  Framebuffer rayMarchFBO; // NOTE: output resolution, rgb color + depth in alpha, only renderResolution is drawn to
+  Framebuffer historyFBOs[2]; // NOTE: output resolution, rgb color + depth in alpha, written and read on alternating frames
+  Framebuffer coneFBO; // NOTE: one texel per CONE_MARCH_TILE_SIZE tile of rayMarchFBO, start distance + steps taken
+  uint32 historyIndex = 0; // history written last frame
+  bool historyValid = false;
+  glm::mat4 previousViewProjection;
+  uint32 jitterIndex = 0;
 
   uint32 textureDiff1Id;
   uint32 textureSpec1Id;
@@ -58,8 +96,6 @@ private:
   bool showDebugWindows = false;
 
   float32 startTime = 0;
-  float32 deltaTime = 0;
-  float32 lastFrame = 0;
   Timer timer;
 
   uint32 currentResolutionIndex = 0;
@@ -67,6 +103,19 @@ private:
 
   int32 numSamples = 1;
 
+  bool dynamicResolutionEnabled = true;
+  bool temporalAccumulationEnabled = true;
+  bool coneMarchEnabled = true;
+  float32 rayMarchBudgetMs = DYNAMIC_RESOLUTION_DEFAULT_BUDGET_MS;
+  float32 renderScale = 1.0f;
+  Extent2D renderResolution = currentResolution;
+  float32 rayMarchMs = 0.0f;
+  uint32 rayMarchTimestampQueries[RAY_MARCH_TIMER_LATENCY][2];
+  float32 rayMarchTimerScales[RAY_MARCH_TIMER_LATENCY]; // render scale each query slot was measured at
+  uint32 rayMarchTimerFrame = 0;
+
+  const float32 nearPlane = 0.1f;
+  const float32 farPlane = 200.0f;
   const float cubeScale = 10.0f;
   const float32 frameTime = 0.2f;
 
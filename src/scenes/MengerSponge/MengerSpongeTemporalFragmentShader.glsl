@@ -0,0 +1,77 @@
+#version 330 core
+
+// Upsamples the (possibly lower resolution) ray marched frame to the output resolution and accumulates it over time
+// by reprojecting last frame's result with the previous view projection matrix. Color and depth are written out for
+// the raster pass, the same values + depth in alpha are written to the history for the next frame.
+layout (location = 0) out vec4 FragColor;
+layout (location = 1) out vec4 History;
+
+uniform sampler2D currentFrame; // rgb color, a = window space depth
+uniform sampler2D history; // rgb color, a = window space depth
+uniform vec2 renderResolution; // region of currentFrame that was rendered
+uniform vec2 outputResolution; // size of currentFrame, history and the output
+uniform vec2 jitter; // sub-pixel offset the current frame was rendered with, in render pixels
+uniform mat4 inverseViewProjection;
+uniform mat4 previousViewProjection;
+uniform float historyWeight; // 0.0 ignores the history
+uniform float near;
+uniform float far;
+
+const float depthRejectionThreshold = 0.05; // relative difference in linear depth
+
+float linearDepth(float windowDepth) {
+  float ndcDepth = windowDepth * 2.0 - 1.0;
+  return (2.0 * near * far) / (far + near - ndcDepth * (far - near));
+}
+
+void main()
+{
+  vec2 uv = gl_FragCoord.xy / outputResolution;
+
+  // position of this pixel in the current frame's texels, undoing the jitter
+  vec2 currentTexelPos = uv * renderResolution - jitter;
+  ivec2 currentTexel = clamp(ivec2(currentTexelPos), ivec2(0), ivec2(renderResolution) - 1);
+  // NOTE: bilinear taps are kept half a texel inside the rendered region, texels beyond it are stale
+  vec2 currentSamplePos = clamp(currentTexelPos, vec2(0.5), renderResolution - 0.5);
+  vec3 currentColor = texture(currentFrame, currentSamplePos / outputResolution).rgb;
+  float currentDepth = texelFetch(currentFrame, currentTexel, 0).a; // NOTE: no filtering, depths don't blend across edges
+
+  vec3 color = currentColor;
+  if(historyWeight > 0.0) {
+    // reproject to where this surface was last frame
+    vec2 previousUV = uv;
+    float previousDepth = 1.0;
+    if(currentDepth < 1.0) {
+      vec4 worldPos = inverseViewProjection * vec4(vec3(uv, currentDepth) * 2.0 - 1.0, 1.0);
+      worldPos /= worldPos.w;
+      vec4 previousClip = previousViewProjection * worldPos;
+      previousUV = (previousClip.xy / previousClip.w) * 0.5 + 0.5;
+      previousDepth = (previousClip.z / previousClip.w) * 0.5 + 0.5;
+    }
+
+    vec2 previousSamplePos = clamp(previousUV * outputResolution, vec2(0.5), outputResolution - 0.5);
+    vec4 previous = texture(history, previousSamplePos / outputResolution);
+    bool onScreen = all(greaterThanEqual(previousUV, vec2(0.0))) && all(lessThanEqual(previousUV, vec2(1.0)));
+    bool sameSurface = (previousDepth >= 1.0) ? (previous.a >= 1.0) :
+                       (abs(linearDepth(previous.a) - linearDepth(previousDepth)) < depthRejectionThreshold * linearDepth(previousDepth));
+
+    if(onScreen && sameSurface) {
+      // clamp the history to the current neighborhood so animated geometry doesn't leave trails
+      vec3 neighborhoodMin = currentColor;
+      vec3 neighborhoodMax = currentColor;
+      for(int y = -1; y <= 1; ++y) {
+        for(int x = -1; x <= 1; ++x) {
+          ivec2 neighbor = clamp(currentTexel + ivec2(x, y), ivec2(0), ivec2(renderResolution) - 1);
+          vec3 neighborColor = texelFetch(currentFrame, neighbor, 0).rgb;
+          neighborhoodMin = min(neighborhoodMin, neighborColor);
+          neighborhoodMax = max(neighborhoodMax, neighborColor);
+        }
+      }
+      color = mix(currentColor, clamp(previous.rgb, neighborhoodMin, neighborhoodMax), historyWeight);
+    }
+  }
+
+  gl_FragDepth = currentDepth;
+  FragColor = vec4(color, 1.0);
+  History = vec4(color, currentDepth);
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "../../LearnOpenGLPlatform.h"
+
+// NOTE: Shared with tools/MengerRayMarcher, which renders the CPU reference images at each of these
+const Extent2D screenResolutions[] = {
+        {120, 68},
+        {240, 135},
+        {480, 270},
+        {960, 540},
+        {1920, 1080},
+        {3840, 2160}
+};
@@ -58,8 +58,10 @@ vec3 calcDirectionalLightColor() {
   vec3 ambient = directionalLightColor.ambient * diffColor;
 
   // diffuse light
-  vec3 normal = texture(material.normal, texCoords).rgb;
-  normal = normalize((normal * 2) - vec3(1.0, 1.0, 1.0));// normalize seems unnecessary
+  // NOTE: z is reconstructed so that two channel (BC5) normal maps work the same as RGB ones
+  vec3 normal;
+  normal.xy = (texture(material.normal, texCoords).rg * 2.0) - vec2(1.0, 1.0);
+  normal.z = sqrt(max(1.0 - dot(normal.xy, normal.xy), 0.0));
   float normalLightDirDot = dot(normal, fs_in.TangentLightDir);
   float diffStrength = max(normalLightDirDot, 0.0);
   vec3 diffuse = directionalLightColor.diffuse * diffStrength * diffColor;
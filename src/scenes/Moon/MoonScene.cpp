@@ -1,7 +1,10 @@
 #include "MoonScene.h"
 #include "../../common/FileLocations.h"
 #include "../../common/Util.h"
+#include "../../common/FrameClock.h"
 #include "../../common/ObjectData.h"
+#include "../../common/TextureCache.h"
+#include "../../common/UniformRing.h"
 
 #define SHADOW_MAP_WIDTH 2048
 #define SHADOW_MAP_HEIGHT 2048
@@ -42,23 +45,23 @@ void MoonScene::init(Extent2D windowExtent)
   floorVertexAtt = initializeQuadPosNormTexVertexAttBuffers();
   cubeVertexAtt = initializeCubePosNormTexVertexAttBuffers();
   
-  load2DTexture(dungeonStoneAlbedoTextureLoc, floorAlbedoTextureId, false, true);
-  load2DTexture(dungeonStoneNormalTextureLoc, floorNormalTextureId, false, false);
-  load2DTexture(dungeonStoneHeightTextureLoc, floorHeightTextureId, false, false);
+  acquire2DTextureAsync(dungeonStoneAlbedoTextureLoc, floorAlbedoTextureId, false, true);
+  acquire2DTextureAsync(dungeonStoneNormalTextureLoc, floorNormalTextureId, false, false);
+  acquire2DTextureAsync(dungeonStoneHeightTextureLoc, floorHeightTextureId, false, false);
   
-  load2DTexture(waterWornStoneAlbedoTextureLoc, cube1AlbedoTextureId, false, true);
-  load2DTexture(waterWornStoneNormalTextureLoc, cube1NormalTextureId, false, false);
-  load2DTexture(waterWornStoneHeightTextureLoc, cube1HeightTextureId, false, false);
+  acquire2DTextureAsync(waterWornStoneAlbedoTextureLoc, cube1AlbedoTextureId, false, true);
+  acquire2DTextureAsync(waterWornStoneNormalTextureLoc, cube1NormalTextureId, false, false);
+  acquire2DTextureAsync(waterWornStoneHeightTextureLoc, cube1HeightTextureId, false, false);
   
-  load2DTexture(copperRockAlbedoTextureLoc, cube2AlbedoTextureId, false, true);
-  load2DTexture(copperRockNormalTextureLoc, cube2NormalTextureId, false, false);
-  load2DTexture(copperRockHeightTextureLoc, cube2HeightTextureId, false, false);
+  acquire2DTextureAsync(copperRockAlbedoTextureLoc, cube2AlbedoTextureId, false, true);
+  acquire2DTextureAsync(copperRockNormalTextureLoc, cube2NormalTextureId, false, false);
+  acquire2DTextureAsync(copperRockHeightTextureLoc, cube2HeightTextureId, false, false);
   
-  load2DTexture(whiteSpruceAlbedoTextureLoc, cube3AlbedoTextureId, false, true);
-  load2DTexture(whiteSpruceNormalTextureLoc, cube3NormalTextureId, false, false);
-  load2DTexture(whiteSpruceHeightTextureLoc, cube3HeightTextureId, false, false);
+  acquire2DTextureAsync(whiteSpruceAlbedoTextureLoc, cube3AlbedoTextureId, false, true);
+  acquire2DTextureAsync(whiteSpruceNormalTextureLoc, cube3NormalTextureId, false, false);
+  acquire2DTextureAsync(whiteSpruceHeightTextureLoc, cube3HeightTextureId, false, false);
   
-  load2DTexture(moonTextureAlbedoLoc, lightTextureId, false, true);
+  acquire2DTextureAsync(moonTextureAlbedoLoc, lightTextureId, false, true);
 
   generateDepthMap();
   drawFramebuffer = initializeFramebuffer(windowExtent);
@@ -71,6 +74,9 @@ void MoonScene::init(Extent2D windowExtent)
   // Note: orthographic projection is used for directional lighting, as all light rays are parallel
   lightProjMat = glm::ortho(-projectionDimens, projectionDimens, -projectionDimens, projectionDimens, nearPlane, farPlane);
 
+  ShaderProgram* shaders[] = { directionalLightShader, quadTextureShader, depthMapShader };
+  ShaderProgram::finishLinks(shaders, ArrayCount(shaders));
+
   quadTextureShader->use();
   quadTextureShader->setUniform("projection", cameraProjMat);
   quadTextureShader->setUniform("tex", lightTextureIndex);
@@ -83,15 +89,8 @@ void MoonScene::init(Extent2D windowExtent)
   directionalLightShader->setUniform("directionalLightColor.specular", lightColor * 0.1f);
   directionalLightShader->setUniform("shadowMap", depthMap2DSamplerIndex);
 
-  {
-    glGenBuffers(1, &globalVSUniformBuffer);
-
-    glBindBuffer(GL_UNIFORM_BUFFER, globalVSUniformBuffer);
-    glBufferData(GL_UNIFORM_BUFFER, 2 * sizeof(glm::mat4), NULL, GL_STATIC_DRAW);
-
-    directionalLightShader->bindBlockIndex("globalBlockVS", globalVSBufferBindIndex);
-    quadTextureShader->bindBlockIndex("globalBlockVS", globalVSBufferBindIndex);
-  }
+  directionalLightShader->bindBlockIndex("globalBlockVS", globalVSBufferBindIndex);
+  quadTextureShader->bindBlockIndex("globalBlockVS", globalVSBufferBindIndex);
 
   // floor data
   floorModelMat = glm::mat4(1.0f);
@@ -116,15 +115,14 @@ void MoonScene::deinit()
   VertexAtt deleteVertexAttributes[] = { floorVertexAtt, cubeVertexAtt };
   deleteVertexAtts(ArrayCount(deleteVertexAttributes), deleteVertexAttributes);
 
-  uint32 deleteTextures[] = { floorAlbedoTextureId, floorNormalTextureId, floorHeightTextureId,
-                              cube1AlbedoTextureId, cube1NormalTextureId, cube1HeightTextureId,
-                              cube2AlbedoTextureId, cube2NormalTextureId, cube2HeightTextureId,
-                              cube3AlbedoTextureId, cube3NormalTextureId, cube3HeightTextureId,
-                              lightTextureId,
-                              depthMapFramebuffer.depthStencilAttachment };
-  glDeleteTextures(ArrayCount(deleteTextures), deleteTextures);
+  uint32 releaseTextureIds[] = { floorAlbedoTextureId, floorNormalTextureId, floorHeightTextureId,
+                                  cube1AlbedoTextureId, cube1NormalTextureId, cube1HeightTextureId,
+                                  cube2AlbedoTextureId, cube2NormalTextureId, cube2HeightTextureId,
+                                  cube3AlbedoTextureId, cube3NormalTextureId, cube3HeightTextureId,
+                                  lightTextureId };
+  releaseTextures(ArrayCount(releaseTextureIds), releaseTextureIds);
+  glDeleteTextures(1, &depthMapFramebuffer.depthStencilAttachment);
 
-  glDeleteBuffers(1, &globalVSUniformBuffer);
   glDeleteFramebuffers(1, &depthMapFramebuffer.id);
   deleteFramebuffer(&drawFramebuffer);
   depthMapFramebuffer = { 0, 0, 0, 0, 0 };
@@ -172,21 +170,13 @@ Framebuffer MoonScene::drawFrame()
   glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
 
   float32 t = getTime() - startTime;
-  deltaTime = t - lastFrame;
-  lastFrame = t;
+  float32 deltaTime = getDeltaTime();
 
   glm::mat4 viewMat = camera.UpdateViewMatrix(deltaTime, cameraMovementSpeed * 4.0f, false);
 
-  glBindBuffer(GL_UNIFORM_BUFFER, globalVSUniformBuffer);
   // update global view matrix uniform
-  glBindBufferRange(GL_UNIFORM_BUFFER,    // target
-                    globalVSBufferBindIndex,  // index of binding point
-                    globalVSUniformBuffer,  // buffer id
-                    0,            // starting offset into buffer object
-                    4 * 16);        // size: 4 vec3's, 16 bits alignments
-  glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(glm::mat4), glm::value_ptr(cameraProjMat));
-  glBufferSubData(GL_UNIFORM_BUFFER, globalVSBufferViewMatOffset, sizeof(glm::mat4), glm::value_ptr(viewMat));
-  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+  struct { glm::mat4 projection; glm::mat4 view; } globalVS = { cameraProjMat, viewMat }; // globalBlockVS (std140)
+  bindUniformBlock(globalVSBufferBindIndex, pushUniformBlock(&globalVS, sizeof(globalVS)));
 
   // light data
   glm::vec3 lightPosition = glm::vec3(cos(t/20) * lightRadius, lightHeightOffset + sin(t / 10) * lightHeightHalfVariance, sin(t / 20) * lightRadius);
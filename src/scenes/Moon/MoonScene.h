@@ -34,12 +34,8 @@ private:
   Framebuffer depthMapFramebuffer;
 
   float32 startTime = 0.0f;
-  float32 deltaTime = 0.0f;  // Time between current frame and last frame
-  float32 lastFrame = 0.0f; // Time of last frame
 
-  uint32 globalVSUniformBuffer;
   uint32 globalVSBufferBindIndex = 0;
-  uint32 globalVSBufferViewMatOffset = sizeof(glm::mat4);
 
   glm::mat4 cameraProjMat;
   glm::mat4 floorModelMat;
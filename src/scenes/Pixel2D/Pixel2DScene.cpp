@@ -6,6 +6,8 @@
 #include "../../common/FileLocations.h"
 #include "../../common/ObjectData.h"
 #include "../../common/Util.h"
+#include "../../common/FrameClock.h"
+#include "../../common/TextureCache.h"
 
 const uint32 textureIndex = 0;
 
@@ -26,7 +28,7 @@ void Pixel2DScene::init(Extent2D windowExtent)
 
   drawFramebuffer = initializeFramebuffer(windowExtent, FramebufferCreate_color_sRGB);
 
-  load2DTexture(flowerTextureLoc, textureId, true, true, &textureWidth, &textureHeight);
+  acquire2DTexture(flowerTextureLoc, textureId, true, true, &textureWidth, &textureHeight);
 
   uint32 widthOffset = (windowExtent.width / 2) - (textureWidth / 2);
   uint32 heightOffset = (windowExtent.height / 2) - (textureHeight / 2);
@@ -37,8 +39,7 @@ void Pixel2DScene::init(Extent2D windowExtent)
   pixel2DShader->setUniform("spriteDimens", glm::vec2(textureWidth, textureHeight));
   pixel2DShader->setUniform("tex", 0);
 
-  lastFrame = getTime();
-  startTime = lastFrame;
+  startTime = getTime();
 }
 
 void Pixel2DScene::deinit()
@@ -52,7 +53,7 @@ void Pixel2DScene::deinit()
 
   deleteFramebuffer(&drawFramebuffer);
 
-  glDeleteTextures(1, &textureId);
+  releaseTexture(textureId);
 
   glDisable(GL_FRAMEBUFFER_SRGB);
 }
@@ -74,8 +75,6 @@ Framebuffer Pixel2DScene::drawFrame()
   glViewport(0, 0, windowExtent.width, windowExtent.height);
 
   float32 t = getTime() - startTime;
-  deltaTime = t - lastFrame;
-  lastFrame = t;
 
   glBindFramebuffer(GL_FRAMEBUFFER, drawFramebuffer.id);
   glClear(GL_COLOR_BUFFER_BIT);
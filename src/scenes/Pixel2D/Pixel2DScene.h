@@ -28,6 +28,4 @@ private:
   uint32 textureWidth, textureHeight;
 
   float32 startTime = 0.0f;
-  float32 deltaTime = 0.0f;  // Time between current frame and last frame
-  float32 lastFrame = 0.0f; // Time of last frame
 };
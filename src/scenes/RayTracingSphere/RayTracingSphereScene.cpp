@@ -6,6 +6,7 @@
 #include "../../common/FileLocations.h"
 #include "../../common/ObjectData.h"
 #include "../../common/Util.h"
+#include "../../common/FrameClock.h"
 
 RayTracingSphereScene::RayTracingSphereScene() : FirstPersonScene()
 {
@@ -29,8 +30,7 @@ void RayTracingSphereScene::init(Extent2D windowExtent)
   rayTracingSphereShader->use();
   rayTracingSphereShader->setUniform("viewPortResolution", glm::vec2(windowExtent.width, windowExtent.height));
 
-  lastFrame = getTime();
-  startTime = lastFrame;
+  startTime = getTime();
 }
 
 void RayTracingSphereScene::deinit()
@@ -61,8 +61,7 @@ Framebuffer RayTracingSphereScene::drawFrame()
 //  }
 
   float32 t = getTime() - startTime;
-  deltaTime = t - lastFrame;
-  lastFrame = t;
+  float32 deltaTime = getDeltaTime();
 
   glm::mat4 cameraRotationMatrix = camera.UpdateViewMatrix(deltaTime, cameraMovementSpeed * 4.0f, false);
   rayTracingSphereShader->use();
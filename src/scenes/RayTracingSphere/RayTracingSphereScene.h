@@ -25,7 +25,5 @@ private:
 
   Framebuffer drawFramebuffer;
 
-  float32 deltaTime = 0;
-  float32 lastFrame = 0;
   float32 startTime = 0;
 };
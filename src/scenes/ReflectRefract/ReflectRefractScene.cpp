@@ -8,7 +8,9 @@
 
 #include "ReflectRefractScene.h"
 #include "../../common/Util.h"
+#include "../../common/FrameClock.h"
 #include "../../common/Input.h"
+#include "../../common/TextureCache.h"
 
 const float32 startDist = 2.5f;
 const float32 sqr2over2 = 0.70710678118f;
@@ -77,7 +79,7 @@ void ReflectRefractScene::init(Extent2D windowExtent)
 
   drawFramebuffer = initializeFramebuffer(windowExtent);
 
-  loadCubeMapTexture(yellowCloudFaceLocations, skyboxTextureId);
+  acquireCubeMapTexture(yellowCloudFaceLocations, skyboxTextureId);
 
   // load models
   nanoSuitModel = new Model(starmanModelLoc);
@@ -89,6 +91,31 @@ void ReflectRefractScene::init(Extent2D windowExtent)
   nanoSuitModelMat = glm::scale(glm::mat4(1.0f), glm::vec3(modelScale));  // it's a bit too big for our scene, so scale it down
   nanoSuitModelMat = glm::translate(nanoSuitModelMat, modelPosition); // translate it down so it's at the center of the scene
 
+  ShaderProgram* shaders[] = { explodingReflectionShader, exploding10InstanceReflectionShader, reflectionShader, reflection10InstanceShader, explodingRefractionShader, refractionShader, skyboxShader, normalVisualizationShader, normalVisualization10InstanceShader };
+  ShaderProgram::finishLinks(shaders, ArrayCount(shaders));
+
+  auto getUniforms = [](ShaderProgram* shader)
+  {
+    ReflectRefractUniforms uniforms;
+    uniforms.projection = shader->getUniformHandle("projection");
+    uniforms.view = shader->getUniformHandle("view");
+    uniforms.model = shader->getUniformHandle("model");
+    uniforms.models = shader->getUniformHandle("models");
+    uniforms.cameraPos = shader->getUniformHandle("cameraPos");
+    uniforms.time = shader->getUniformHandle("time");
+    uniforms.refractiveIndex = shader->getUniformHandle("refractiveIndex");
+    return uniforms;
+  };
+  explodingReflectionUniforms = getUniforms(explodingReflectionShader);
+  exploding10InstanceReflectionUniforms = getUniforms(exploding10InstanceReflectionShader);
+  reflectionUniforms = getUniforms(reflectionShader);
+  reflection10InstanceUniforms = getUniforms(reflection10InstanceShader);
+  explodingRefractionUniforms = getUniforms(explodingRefractionShader);
+  refractionUniforms = getUniforms(refractionShader);
+  skyboxUniforms = getUniforms(skyboxShader);
+  normalVisualizationUniforms = getUniforms(normalVisualizationShader);
+  normalVisualization10InstanceUniforms = getUniforms(normalVisualization10InstanceShader);
+
   explodingReflectionShader->use();
   explodingReflectionShader->setUniform("projection", projectionMat);
   explodingReflectionShader->setUniform("skybox", 0);
@@ -156,7 +183,7 @@ void ReflectRefractScene::deinit()
 
   deleteFramebuffer(&drawFramebuffer);
 
-  glDeleteTextures(1, &skyboxTextureId);
+  releaseTexture(skyboxTextureId);
 
   delete nanoSuitModel;
 }
@@ -186,38 +213,37 @@ Framebuffer ReflectRefractScene::drawFrame()
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
   float32 currTime = getTime() - initTime;
-  deltaTime = currTime - lastFrame;
-  lastFrame = currTime;
+  float32 deltaTime = getDeltaTime();
 
   glm::mat4 viewMat = camera.UpdateViewMatrix(deltaTime, cameraMovementSpeed);
   glm::mat4 projectionMat = glm::perspective(glm::radians(camera.Zoom), windowAspectRatio, 0.1f, 100.0f);
 
   // draw cube
   ShaderProgram* cubeShader = currMode == Exploding ? exploding10InstanceReflectionShader : reflection10InstanceShader;
+  const ReflectRefractUniforms& cubeUniforms = currMode == Exploding ? exploding10InstanceReflectionUniforms : reflection10InstanceUniforms;
 
   glBindVertexArray(cubeVertexAtt.arrayObject);
 
   cubeShader->use();
-  cubeShader->setUniform("projection", projectionMat);
-  cubeShader->setUniform("cameraPos", camera.Position);
-  cubeShader->setUniform("view", viewMat);
-  cubeShader->setUniform("time", currTime);
+  cubeShader->setUniform(cubeUniforms.projection, projectionMat);
+  cubeShader->setUniform(cubeUniforms.cameraPos, camera.Position);
+  cubeShader->setUniform(cubeUniforms.view, viewMat);
+  cubeShader->setUniform(cubeUniforms.time, currTime);
 
+  glm::mat4 cubeModelMats[ArrayCount(cubePositions)];
   for (int i = 0; i < ArrayCount(cubePositions); i++)
   {
-    glm::mat4 model = glm::rotate(glm::mat4(1.0f), currTime * glm::radians(angularSpeed), orbitAxis); // orbit with time
-    model = glm::translate(model, cubePositions[i]);
-    model = glm::rotate(model, currTime * glm::radians(angularSpeed), rotationAxis); // rotate with time
-
-    const std::string instanceModelName = "models[" + std::to_string(i) + "]";
-    cubeShader->setUniform(instanceModelName, model);
+    cubeModelMats[i] = glm::rotate(glm::mat4(1.0f), currTime * glm::radians(angularSpeed), orbitAxis); // orbit with time
+    cubeModelMats[i] = glm::translate(cubeModelMats[i], cubePositions[i]);
+    cubeModelMats[i] = glm::rotate(cubeModelMats[i], currTime * glm::radians(angularSpeed), rotationAxis); // rotate with time
+  }
+  cubeShader->setUniform(cubeUniforms.models, cubeModelMats, ArrayCount(cubeModelMats));
 
-    if (currMode == NormalVisualization) // draw cube normal visualizations
-    {
-      normalVisualization10InstanceShader->use();
-      normalVisualization10InstanceShader->setUniform(instanceModelName, model);
-      cubeShader->use();
-    }
+  if (currMode == NormalVisualization) // draw cube normal visualizations
+  {
+    normalVisualization10InstanceShader->use();
+    normalVisualization10InstanceShader->setUniform(normalVisualization10InstanceUniforms.models, cubeModelMats, ArrayCount(cubeModelMats));
+    cubeShader->use();
   }
   glDrawElementsInstanced(GL_TRIANGLES, // drawing mode
                           cubePosNormTexNumElements * 3, // number of elements to be rendered
@@ -228,8 +254,8 @@ Framebuffer ReflectRefractScene::drawFrame()
   if (currMode == NormalVisualization)
   {
     normalVisualization10InstanceShader->use();
-    normalVisualization10InstanceShader->setUniform("projection", projectionMat);
-    normalVisualization10InstanceShader->setUniform("view", viewMat);
+    normalVisualization10InstanceShader->setUniform(normalVisualization10InstanceUniforms.projection, projectionMat);
+    normalVisualization10InstanceShader->setUniform(normalVisualization10InstanceUniforms.view, viewMat);
     glDrawElementsInstanced(GL_TRIANGLES, // drawing mode
                             cubePosNormTexNumElements * 3, // number of elements to be rendered
                             GL_UNSIGNED_INT, // type of values in the indices
@@ -239,49 +265,54 @@ Framebuffer ReflectRefractScene::drawFrame()
 
   // draw model
   ShaderProgram* modelShader;
+  const ReflectRefractUniforms* modelUniforms;
   if (currMode == Exploding)
   {
     if (selectedReflactionIndex == reflectionIndex)
     {
       modelShader = explodingReflectionShader;
+      modelUniforms = &explodingReflectionUniforms;
     } else
     {
       modelShader = explodingRefractionShader;
+      modelUniforms = &explodingRefractionUniforms;
     }
   } else
   {
     if (selectedReflactionIndex == reflectionIndex)
     {
       modelShader = reflectionShader;
+      modelUniforms = &reflectionUniforms;
     } else
     {
       modelShader = refractionShader;
+      modelUniforms = &refractionUniforms;
     }
   }
 
   modelShader->use();
-  modelShader->setUniform("projection", projectionMat);
-  modelShader->setUniform("cameraPos", camera.Position);
-  modelShader->setUniform("view", viewMat);
-  modelShader->setUniform("refractiveIndex", refractionIndexValues[selectedReflactionIndex]);
-  modelShader->setUniform("model", nanoSuitModelMat);
-  modelShader->setUniform("time", currTime);
+  modelShader->setUniform(modelUniforms->projection, projectionMat);
+  modelShader->setUniform(modelUniforms->cameraPos, camera.Position);
+  modelShader->setUniform(modelUniforms->view, viewMat);
+  modelShader->setUniform(modelUniforms->refractiveIndex, refractionIndexValues[selectedReflactionIndex]);
+  modelShader->setUniform(modelUniforms->model, nanoSuitModelMat);
+  modelShader->setUniform(modelUniforms->time, currTime);
   nanoSuitModel->Draw(*modelShader);
 
   if (currMode == NormalVisualization)
   {
     normalVisualizationShader->use();
-    normalVisualizationShader->setUniform("projection", projectionMat);
-    normalVisualizationShader->setUniform("view", viewMat);
-    normalVisualizationShader->setUniform("model", nanoSuitModelMat);
+    normalVisualizationShader->setUniform(normalVisualizationUniforms.projection, projectionMat);
+    normalVisualizationShader->setUniform(normalVisualizationUniforms.view, viewMat);
+    normalVisualizationShader->setUniform(normalVisualizationUniforms.model, nanoSuitModelMat);
     nanoSuitModel->Draw(*normalVisualizationShader);
   }
 
   // draw skybox
   skyboxShader->use();
   glm::mat4 viewMinusTranslation = glm::mat4(glm::mat3(viewMat));
-  skyboxShader->setUniform("view", viewMinusTranslation);
-  skyboxShader->setUniform("projection", projectionMat);
+  skyboxShader->setUniform(skyboxUniforms.view, viewMinusTranslation);
+  skyboxShader->setUniform(skyboxUniforms.projection, projectionMat);
   glBindVertexArray(skyboxVertexAtt.arrayObject);
   glDrawElements(GL_TRIANGLES, // drawing mode
                  36, // number of elements to draw (3 vertices per triangle * 2 triangles per face * 6 faces)
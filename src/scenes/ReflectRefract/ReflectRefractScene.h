@@ -8,6 +8,18 @@
 #include "../../common/ObjectData.h"
 #include "../../ShaderProgram.h"
 
+// NOTE: per-frame uniforms, any of them may be inactive in a given program
+struct ReflectRefractUniforms
+{
+  UniformHandle projection;
+  UniformHandle view;
+  UniformHandle model;
+  UniformHandle models;
+  UniformHandle cameraPos;
+  UniformHandle time;
+  UniformHandle refractiveIndex;
+};
+
 class ReflectRefractScene final : public FirstPersonScene
 {
 public:
@@ -30,6 +42,16 @@ private:
   ShaderProgram* normalVisualizationShader;
   ShaderProgram* normalVisualization10InstanceShader;
 
+  ReflectRefractUniforms explodingReflectionUniforms;
+  ReflectRefractUniforms exploding10InstanceReflectionUniforms;
+  ReflectRefractUniforms reflectionUniforms;
+  ReflectRefractUniforms reflection10InstanceUniforms;
+  ReflectRefractUniforms explodingRefractionUniforms;
+  ReflectRefractUniforms refractionUniforms;
+  ReflectRefractUniforms skyboxUniforms;
+  ReflectRefractUniforms normalVisualizationUniforms;
+  ReflectRefractUniforms normalVisualization10InstanceUniforms;
+
   VertexAtt cubeVertexAtt;
   VertexAtt skyboxVertexAtt;
 
@@ -40,10 +62,7 @@ private:
 
   uint32 skyboxTextureId;
 
-  // frame rate
   float32 initTime = 0.0f;
-  float32 deltaTime = 0.0f;  // Time between current frame and last frame
-  float32 lastFrame = 0.0f; // Time of last frame
 
   const float32 angularSpeed = 7.3f;
   const glm::vec3 orbitAxis = glm::vec3(0.0f, 1.0f, 0.0f);
@@ -1,7 +1,11 @@
 #include "RoomScene.h"
 #include "../../common/FileLocations.h"
 #include "../../common/Util.h"
+#include "../../common/FrameClock.h"
 #include "../../common/ObjectData.h"
+#include "../../common/TextureCache.h"
+#include "../../common/UniformRing.h"
+#include "../../common/Profiler.h"
 
 const uint32 SHADOW_MAP_WIDTH = 2048;
 const uint32 SHADOW_MAP_HEIGHT = 2048;
@@ -33,8 +37,8 @@ void RoomScene::init(Extent2D windowExtent)
 
   drawFramebuffer = initializeFramebuffer(windowExtent, FramebufferCreate_color_sRGB);
 
-  load2DTexture(hardwoodTextureLoc, wallpaperTextureId, false, true);
-  load2DTexture(cementAlbedoTextureLoc, cubeTextureId, false, true);
+  acquire2DTexture(hardwoodTextureLoc, wallpaperTextureId, false, true);
+  acquire2DTexture(cementAlbedoTextureLoc, cubeTextureId, false, true);
   generateDepthCubeMap();
 
   float32 cameraAspectRatio = (float32)windowExtent.width / (float32)windowExtent.height;
@@ -47,6 +51,9 @@ void RoomScene::init(Extent2D windowExtent)
   const float32 lightFarPlane = 40.0f;
   lightProjMat = glm::perspective(glm::radians(90.0f), lightAspectRatio, lightNearPlane, lightFarPlane);
 
+  ShaderProgram* shaders[] = { positionalLightShader, singleColorShader, depthCubeMapShader };
+  ShaderProgram::finishLinks(shaders, ArrayCount(shaders));
+
   // set constant uniforms
   positionalLightShader->use();
   // set light attenuation
@@ -64,11 +71,6 @@ void RoomScene::init(Extent2D windowExtent)
   depthCubeMapShader->use();
   depthCubeMapShader->setUniform("lightFarPlane", lightFarPlane);
 
-  // initialize global uniform buffer with camera projection matrix
-  glGenBuffers(1, &globalVSUniformBuffer);
-  glBindBuffer(GL_UNIFORM_BUFFER, globalVSUniformBuffer);
-  glBufferData(GL_UNIFORM_BUFFER, 2 * sizeof(glm::mat4), NULL, GL_STATIC_DRAW);
-
   positionalLightShader->bindBlockIndex("globalBlockVS", globalVSBufferBindIndex);
   singleColorShader->bindBlockIndex("globalBlockVS", globalVSBufferBindIndex);
 
@@ -101,10 +103,9 @@ void RoomScene::deinit()
 
   deleteFramebuffer(&drawFramebuffer);
   
-  uint32 deleteTextures[] = { wallpaperTextureId, cubeTextureId, depthCubeMapId };
-  glDeleteTextures(ArrayCount(deleteTextures), deleteTextures);
-
-  glDeleteBuffers(1, &globalVSUniformBuffer);
+  uint32 releaseTextureIds[] = { wallpaperTextureId, cubeTextureId };
+  releaseTextures(ArrayCount(releaseTextureIds), releaseTextureIds);
+  glDeleteTextures(1, &depthCubeMapId);
 
   glDeleteFramebuffers(1, &depthMapFBO);
 
@@ -134,20 +135,13 @@ Framebuffer RoomScene::drawFrame()
   glBindTexture(GL_TEXTURE_CUBE_MAP, depthCubeMapId);
 
   float32 t = getTime();
-  deltaTime = t - lastFrame;
-  lastFrame = t;
+  float32 deltaTime = getDeltaTime();
 
   glm::mat4 viewMat = camera.UpdateViewMatrix(deltaTime, cameraMovementSpeed * 4.0f, false);
 
   // update global view matrix uniform
-  glBindBuffer(GL_UNIFORM_BUFFER, globalVSUniformBuffer);
-  glBindBufferRange(GL_UNIFORM_BUFFER,    // target
-                    globalVSBufferBindIndex,  // index of binding point
-                    globalVSUniformBuffer,  // buffer id
-                    0,            // starting offset into buffer object
-                    4 * 16);        // size: 4 vec3's, 16 bits alignments
-  glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(glm::mat4), glm::value_ptr(cameraProjMat));
-  glBufferSubData(GL_UNIFORM_BUFFER, globalVSBufferViewMatOffset, sizeof(glm::mat4), glm::value_ptr(viewMat));
+  struct { glm::mat4 projection; glm::mat4 view; } globalVS = { cameraProjMat, viewMat }; // globalBlockVS (std140)
+  bindUniformBlock(globalVSBufferBindIndex, pushUniformBlock(&globalVS, sizeof(globalVS)));
 
   // light data
   glm::vec3 lightPosition = glm::vec3(sin(t) * lightRadius, sin(1.5f * t) * lightAmplitude, cos(t) * lightRadius);
@@ -164,6 +158,7 @@ Framebuffer RoomScene::drawFrame()
           (lightProjMat * glm::lookAt(lightPosition, lightPosition + glm::vec3(0.0, 0.0, -1.0), glm::vec3(0.0, -1.0, 0.0))) // near
   };
 
+  uint32 shadowPassZone = profilerBeginZone("Shadow cube map");
   depthCubeMapShader->use();
   depthCubeMapShader->setUniform("cubeMapTransMats", shadowMapTransMats, 6);
   depthCubeMapShader->setUniform("lightPos", lightPosition);
@@ -200,7 +195,10 @@ Framebuffer RoomScene::drawFrame()
                  GL_UNSIGNED_INT, // type of the indices
                  0); // offset in the EBO
 
+  profilerEndZone(shadowPassZone);
+
   // bind default frame buffer
+  uint32 litPassZone = profilerBeginZone("Lit pass");
   glBindFramebuffer(GL_FRAMEBUFFER, drawFramebuffer.id);
   // render scene using the depth cube map for shadows
   glViewport(0, 0, windowExtent.width, windowExtent.height);
@@ -250,6 +248,7 @@ Framebuffer RoomScene::drawFrame()
                  cubePosNormTexNumElements * 3, // number of elements to draw * 3 vertices per triangle
                  GL_UNSIGNED_INT, // type of the indices
                  0); // offset in the EBO
+  profilerEndZone(litPassZone);
 
    glDisable(GL_FRAMEBUFFER_SRGB);
 
@@ -30,8 +30,6 @@ private:
 
   glm::mat4 cubeModelMat[3];
 
-  float32 deltaTime = 0.0f;  // Time between current frame and last frame
-  float32 lastFrame = 0.0f; // Time of last frame
 
   glm::vec3 lightColor = {0.8f, 0.8f, 0.8f};
   const float32 lightScale = 0.3f;
@@ -50,9 +48,7 @@ private:
   glm::mat4 lightProjMat;
   glm::mat4 roomModelMat;
 
-  uint32 globalVSUniformBuffer;
   uint32 globalVSBufferBindIndex = 0;
-  uint32 globalVSBufferViewMatOffset = sizeof(glm::mat4);
 
   const uint32 depthMap2DSamplerIndex = 2;
 
@@ -3,10 +3,21 @@
 #include <imgui/backends/imgui_impl_opengl3.h>
 #include <imgui/backends/imgui_impl_glfw.h>
 #include <fstream>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <cmath>
+#include <cstring>
 
 #include "../TextDebugShader.h"
 #include "../common/Input.h"
 #include "../common/glfwUtil.h"
+#include "../common/TextureStreamer.h"
+#include "../common/Profiler.h"
+#include "../common/GLState.h"
+#include "../common/UniformRing.h"
+#include "../common/FrameClock.h"
 
 #include "Kernel/KernelScene.h"
 #include "InfiniteCube/InfiniteCubeScene.h"
@@ -23,6 +34,8 @@
 #include "Multi/MultiScene.h"
 
 #define SAVE_FILE_RELATIVE_PATH "src/data/save.bin"
+#define BENCHMARK_QUERY_RING_SIZE 4 // GPU results are read this many frames late to avoid stalling on the query
+#define BENCHMARK_STREAMING_TIMEOUT_SECONDS 60
 
 file_access bool sceneManagerIsActive = true;
 
@@ -49,32 +62,47 @@ class EmptyScene : public Scene
   }
 };
 
+// NOTE: Every scene, in menu order. The multi scene is given the scenes before it, the list must not be moved or copied.
+struct SceneList
+{
+  EmptyScene emptyScene;
+  KernelScene kernelScene;
+  InfiniteCapsulesScene infiniteCapsulesScene;
+  InfiniteCubeScene infiniteCubeScene;
+  AsteroidBeltScene asteroidBeltScene;
+  MandelbrotScene mandelbrotScene;
+  RayTracingSphereScene rayTracingSphereScene;
+  MengerSpongeScene mengerSpongeScene;
+  MoonScene moonScene;
+  RoomScene roomScene;
+  ReflectRefractScene reflectRefractScene;
+  GUIScene guiScene;
+  Pixel2DScene pixel2DScene;
+  Scene* scenes[14];
+  MultiScene multiScene;
+
+  SceneList(GLFWwindow* window) : mandelbrotScene(window), mengerSpongeScene(window), guiScene(window),
+                                  scenes{ &mengerSpongeScene, &rayTracingSphereScene, &mandelbrotScene, &infiniteCubeScene,
+                                          &infiniteCapsulesScene, &roomScene, &guiScene, &moonScene, &asteroidBeltScene,
+                                          &reflectRefractScene, &kernelScene, &pixel2DScene, &emptyScene, &emptyScene },
+                                  multiScene(scenes, ArrayCount(scenes) - 3, 0)
+  {
+    scenes[ArrayCount(scenes) - 2] = &multiScene;
+  }
+  SceneList(const SceneList&) = delete;
+  SceneList& operator=(const SceneList&) = delete;
+};
+
 void runScenes(GLFWwindow* window) {
   Extent2D windowExtent = { VIEWPORT_INIT_WIDTH, VIEWPORT_INIT_HEIGHT };
 
   TextDebugShader textDebugShader = TextDebugShader(windowExtent);
 
-  EmptyScene emptyScene = EmptyScene();
-  KernelScene kernelScene = KernelScene();
-  InfiniteCapsulesScene infiniteCapsulesScene = InfiniteCapsulesScene();
-  InfiniteCubeScene infiniteCubeScene = InfiniteCubeScene();
-  AsteroidBeltScene asteroidBeltScene = AsteroidBeltScene();
-  MandelbrotScene mandelbrotScene = MandelbrotScene(window);
-  RayTracingSphereScene rayTracingSphereScene = RayTracingSphereScene();
-  MengerSpongeScene mengerSpongeScene = MengerSpongeScene(window);
-  MoonScene moonScene = MoonScene();
-  RoomScene roomScene = RoomScene();
-  ReflectRefractScene reflectRefractScene = ReflectRefractScene();
-  GUIScene guiScene = GUIScene(window);
-  Pixel2DScene pixel2DScene = Pixel2DScene();
-  Scene* scenes[] = { &mengerSpongeScene, &rayTracingSphereScene, &mandelbrotScene, &infiniteCubeScene,
-                      &infiniteCapsulesScene, &roomScene, &guiScene, &moonScene, &asteroidBeltScene,
-                      &reflectRefractScene, &kernelScene, &pixel2DScene, &emptyScene, &emptyScene };
-  MultiScene multiScene = MultiScene(scenes, ArrayCount(scenes) - 3, 0);
-  scenes[ArrayCount(scenes) - 2] = &multiScene;
+  SceneList sceneList(window);
+  Scene** scenes = sceneList.scenes;
   uint32 sceneIndex = 0;
   loadLastSceneIndex(&sceneIndex);
-  uint32 sceneCount = ArrayCount(scenes);
+  uint32 sceneCount = ArrayCount(sceneList.scenes);
   bool sceneCursorMode = false;
 
   auto handleInputForFrame = [&scenes, &sceneIndex, sceneCount, &window, &windowExtent, &textDebugShader, &sceneCursorMode]()
@@ -106,13 +134,14 @@ void runScenes(GLFWwindow* window) {
 
   initializeInput(window);
   subscribeWindowSizeCallback(windowSizeCallback);
+  startFrameClock();
   scenes[sceneIndex]->init(windowExtent);
   sceneCursorMode = isCursorEnabled(window);
   enableCursor(window, true);
-  float32 deltaTime = 1.0;
-  float32 lastFrame = getTime();
   while (glfwWindowShouldClose(window) == GL_FALSE)
   {
+    advanceFrameClock();
+
     if(windowSizeChange.consume()) {
       windowExtent = getWindowExtent();
       textDebugShader.updateWindowDimens(windowExtent);
@@ -121,13 +150,19 @@ void runScenes(GLFWwindow* window) {
 
     loadInputStateForFrame(window);
     handleInputForFrame();
+    updateTextureStreaming();
 
     // Start the Dear ImGui frame
     ImGui_ImplOpenGL3_NewFrame();
     ImGui_ImplGlfw_NewFrame();
     ImGui::NewFrame();
 
+    glStateBeginFrame();
+    uniformRingBeginFrame();
+    profilerBeginFrame();
+    uint32 sceneZone = profilerBeginZone(scenes[sceneIndex]->title());
     Framebuffer sceneFramebuffer = scenes[sceneIndex]->drawFrame();
+    profilerEndZone(sceneZone);
     glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
     glBindFramebuffer(GL_READ_FRAMEBUFFER, sceneFramebuffer.id);
     glBlitFramebuffer(0, 0, sceneFramebuffer.extent.width, sceneFramebuffer.extent.height, 0, 0, windowExtent.width, windowExtent.height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
@@ -140,11 +175,9 @@ void runScenes(GLFWwindow* window) {
 
     if(sceneManagerIsActive) {
       // debug text
-      uint32 numFrames = (uint32)(1 / deltaTime);
+      float32 wallDeltaTime = getWallDeltaTime();
+      uint32 numFrames = wallDeltaTime > 0.0f ? (uint32)(1 / wallDeltaTime) : 0;
       textDebugShader.renderText(std::to_string(numFrames) + " FPS", 25.0f, 25.0f, 2.0f, glm::vec3(1.0f, 0.0f, 0.0f));
-      float32 t = getTime();
-      deltaTime = t - lastFrame;
-      lastFrame = t;
 
       // ImGui
       // NOTE: below is a GREAT resource for ImGui
@@ -161,19 +194,44 @@ void runScenes(GLFWwindow* window) {
               enableCursor(window, false);
               sceneIndex = i;
               scenes[sceneIndex]->init(windowExtent);
+              profilerReset();
+            }
+          }
+          ImGui::EndMenu();
+        }
+        if (ImGui::BeginMenu("Frame Clock"))
+        {
+          const float32 targetFrameRates[] = { 0.0f, 30.0f, 60.0f, 120.0f, 144.0f };
+          for(uint32 i = 0; i < ArrayCount(targetFrameRates); ++i)
+          {
+            std::string label = targetFrameRates[i] == 0.0f ? "Uncapped" : std::to_string((uint32)targetFrameRates[i]) + " FPS";
+            if (ImGui::MenuItem(label.c_str(), NULL, getTargetFrameRate() == targetFrameRates[i])) {
+              setTargetFrameRate(targetFrameRates[i]);
             }
           }
+          ImGui::Separator();
+          bool fixedTimestep = getFixedTimestep() > 0.0f;
+          if (ImGui::MenuItem("Fixed 60Hz timestep", NULL, fixedTimestep)) {
+            setFixedTimestep(fixedTimestep ? 0.0f : 1.0f / 60.0f);
+          }
           ImGui::EndMenu();
         }
         ImGui::EndMainMenuBar();
       }
+
+      drawProfilerGui(scenes[sceneIndex]->title());
+      drawGLStateGui();
     } else { // if scene manager isn't active, draw GUI for scene
       scenes[sceneIndex]->drawGui();
     }
 
     // Rendering ImGui
+    uint32 guiZone = profilerBeginZone("ImGui");
     ImGui::Render();
     ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    profilerEndZone(guiZone);
+    profilerEndFrame();
+    uniformRingEndFrame();
 
     glfwSwapBuffers(window); // swaps double buffers (call after all render commands are completed)
     glfwPollEvents(); // checks for events (ex: keyboard/mouse input)
@@ -181,6 +239,9 @@ void runScenes(GLFWwindow* window) {
   scenes[sceneIndex]->deinit();
   deinitializeInput(window);
   saveLastSceneIndex(sceneIndex);
+  deinitTextureStreaming();
+  deinitUniformRing();
+  deinitProfiler();
 
   glfwTerminate(); // clean up gl resources
 }
@@ -220,4 +281,163 @@ void saveLastSceneIndex(uint32 sceneIndex)
   saveFile.open (SAVE_FILE_RELATIVE_PATH);
   saveFile << std::to_string(sceneIndex).c_str()  << "\n";
   saveFile.close();
+}
+
+struct FrameTimeStats
+{
+  float64 min;
+  float64 median;
+  float64 p99;
+};
+
+file_access FrameTimeStats calcFrameTimeStats(std::vector<float64> frameTimes)
+{
+  std::sort(frameTimes.begin(), frameTimes.end());
+  uint32 count = (uint32)frameTimes.size();
+  uint32 p99Index = (uint32)ceil(count * 0.99) - 1;
+  return { frameTimes[0], frameTimes[count / 2], frameTimes[p99Index] };
+}
+
+// NOTE: escapes quotes and backslashes (ex: Windows paths), control characters aren't expected
+file_access void writeJsonString(std::ostream& out, const char* string)
+{
+  out << '"';
+  for(const char* c = string; *c != '\0'; ++c)
+  {
+    if(*c == '"' || *c == '\\') { out << '\\'; }
+    out << *c;
+  }
+  out << '"';
+}
+
+file_access void writeFrameTimesJson(std::ostream& out, const char* name, const std::vector<float64>& frameTimes)
+{
+  FrameTimeStats stats = calcFrameTimeStats(frameTimes);
+  out << "  \"" << name << "\": {\n";
+  out << "    \"min\": " << stats.min << ",\n";
+  out << "    \"median\": " << stats.median << ",\n";
+  out << "    \"p99\": " << stats.p99 << ",\n";
+  out << "    \"frames\": [";
+  for(uint32 i = 0; i < frameTimes.size(); ++i)
+  {
+    out << (i == 0 ? "" : ", ") << frameTimes[i];
+  }
+  out << "]\n  }";
+}
+
+bool runSceneBenchmark(GLFWwindow* window, BenchmarkSettings settings)
+{
+  SceneList sceneList(window);
+  Scene** scenes = sceneList.scenes;
+
+  // scenes can be selected by title or by index
+  uint32 sceneCount = ArrayCount(sceneList.scenes);
+  Scene* scene = NULL;
+  for(uint32 i = 0; i < sceneCount; ++i)
+  {
+    if(strcmp(scenes[i]->title(), settings.scene) == 0) {
+      scene = scenes[i];
+      break;
+    }
+  }
+  if(scene == NULL)
+  {
+    char* indexEnd;
+    uint32 sceneIndex = strtoul(settings.scene, &indexEnd, 10);
+    if(*indexEnd == '\0' && sceneIndex < sceneCount) { scene = scenes[sceneIndex]; }
+  }
+  if(scene == NULL)
+  {
+    std::cout << "Benchmark scene not found: " << settings.scene << std::endl;
+    return false;
+  }
+
+  bool frameTimesInjected = settings.frameTimesFileLoc != NULL && injectFrameTimes(settings.frameTimesFileLoc);
+  if(!frameTimesInjected)
+  {
+    setFixedTimestep(settings.timestep);
+  }
+  startFrameClock();
+  scene->init(settings.extent);
+
+  // NOTE: Streamed textures must land before timing starts, otherwise early frames sample placeholders
+  std::chrono::steady_clock::time_point streamingStart = std::chrono::steady_clock::now();
+  while(!textureStreamingIdle())
+  {
+    updateTextureStreaming();
+    if(std::chrono::steady_clock::now() - streamingStart > std::chrono::seconds(BENCHMARK_STREAMING_TIMEOUT_SECONDS))
+    {
+      std::cout << "ERROR::BENCHMARK::Texture streaming timed out, some textures are still placeholders" << std::endl;
+      break;
+    }
+    std::this_thread::yield();
+  }
+
+  uint32 timeElapsedQueries[BENCHMARK_QUERY_RING_SIZE];
+  glGenQueries(BENCHMARK_QUERY_RING_SIZE, timeElapsedQueries);
+
+  std::vector<float64> cpuFrameTimesMs;
+  std::vector<float64> gpuFrameTimesMs;
+  cpuFrameTimesMs.reserve(settings.frameCount);
+  gpuFrameTimesMs.reserve(settings.frameCount);
+
+  const uint32 totalFrameCount = settings.warmupFrameCount + settings.frameCount;
+  auto collectGpuFrameTime = [&](uint32 frame)
+  {
+    GLuint64 elapsedNanoseconds;
+    glGetQueryObjectui64v(timeElapsedQueries[frame % BENCHMARK_QUERY_RING_SIZE], GL_QUERY_RESULT, &elapsedNanoseconds);
+    if(frame >= settings.warmupFrameCount) { gpuFrameTimesMs.push_back(elapsedNanoseconds / 1000000.0); }
+  };
+
+  for(uint32 frame = 0; frame < totalFrameCount; ++frame)
+  {
+    // the query about to be reused is BENCHMARK_QUERY_RING_SIZE frames old, its result should be ready
+    if(frame >= BENCHMARK_QUERY_RING_SIZE) { collectGpuFrameTime(frame - BENCHMARK_QUERY_RING_SIZE); }
+
+    glBeginQuery(GL_TIME_ELAPSED, timeElapsedQueries[frame % BENCHMARK_QUERY_RING_SIZE]);
+    std::chrono::steady_clock::time_point cpuStart = std::chrono::steady_clock::now();
+    uniformRingBeginFrame();
+    scene->drawFrame();
+    uniformRingEndFrame();
+    std::chrono::steady_clock::time_point cpuEnd = std::chrono::steady_clock::now();
+    glEndQuery(GL_TIME_ELAPSED);
+
+    if(frame >= settings.warmupFrameCount) {
+      cpuFrameTimesMs.push_back(std::chrono::duration<float64, std::milli>(cpuEnd - cpuStart).count());
+    }
+
+    advanceFrameClock();
+  }
+
+  uint32 firstUncollectedFrame = totalFrameCount > BENCHMARK_QUERY_RING_SIZE ? totalFrameCount - BENCHMARK_QUERY_RING_SIZE : 0;
+  for(uint32 frame = firstUncollectedFrame; frame < totalFrameCount; ++frame) { collectGpuFrameTime(frame); }
+
+  glDeleteQueries(BENCHMARK_QUERY_RING_SIZE, timeElapsedQueries);
+  scene->deinit();
+  deinitTextureStreaming();
+  deinitUniformRing();
+
+  std::ofstream outputFile;
+  if(settings.outputFileLoc != NULL) { outputFile.open(settings.outputFileLoc); }
+  std::ostream& out = settings.outputFileLoc != NULL ? outputFile : std::cout;
+  out << "{\n";
+  out << "  \"scene\": \"" << scene->title() << "\",\n";
+  out << "  \"width\": " << settings.extent.width << ",\n";
+  out << "  \"height\": " << settings.extent.height << ",\n";
+  if(frameTimesInjected)
+  {
+    out << "  \"frameTimes\": ";
+    writeJsonString(out, settings.frameTimesFileLoc);
+    out << ",\n";
+  } else
+  {
+    out << "  \"timestep\": " << settings.timestep << ",\n";
+  }
+  out << "  \"frameCount\": " << settings.frameCount << ",\n";
+  writeFrameTimesJson(out, "cpuFrameTimeMs", cpuFrameTimesMs);
+  out << ",\n";
+  writeFrameTimesJson(out, "gpuFrameTimeMs", gpuFrameTimesMs);
+  out << "\n}\n";
+
+  return true;
 }
\ No newline at end of file
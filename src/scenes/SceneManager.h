@@ -3,7 +3,22 @@
 #define GLFW_INCLUDE_NONE // ensure GLFW doesn't load OpenGL headers
 #include <GLFW/glfw3.h>
 
+#include "../LearnOpenGLPlatform.h"
+
 #define VIEWPORT_INIT_WIDTH 1920
 #define VIEWPORT_INIT_HEIGHT 1080
 
-void runScenes(GLFWwindow* window);
\ No newline at end of file
+struct BenchmarkSettings
+{
+  const char* scene; // scene title or index into the scene list
+  uint32 frameCount;
+  uint32 warmupFrameCount;
+  Extent2D extent;
+  float32 timestep; // seconds of simulated time per frame
+  const char* frameTimesFileLoc; // recorded frame times to replay instead of the fixed timestep, may be NULL
+  const char* outputFileLoc; // NULL writes results to stdout
+};
+
+void runScenes(GLFWwindow* window);
+// NOTE: window may be NULL when running with a headless context
+bool runSceneBenchmark(GLFWwindow* window, BenchmarkSettings settings);
\ No newline at end of file
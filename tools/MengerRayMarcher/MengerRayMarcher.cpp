@@ -0,0 +1,514 @@
+// CPU reference ray marcher for the Menger prison SDF in src/scenes/MengerSponge/MengerSpongeFragmentShader.glsl
+// usage: MengerRayMarcher [--samples n] [--time seconds] [--camera x y z yaw pitch] [--threads n] [--normals]
+//                         [--out directory] [--golden directory] [--tolerance n]
+// NOTE: Renders the ray marched part of MengerSpongeScene (not the raster cube) at every screenResolutions entry and
+// NOTE: reports throughput in Mrays/s. Images are written as binary PPMs. With --golden, images are compared against
+// NOTE: previously written ones and the exit code is non-zero if any channel differs by more than the tolerance.
+// NOTE: Rays are marched in 2x2 pixel SSE packets, 16x16 pixel tiles are spread over all cores with work stealing.
+
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <emmintrin.h>
+
+#include "../../src/LearnOpenGLPlatform.h"
+#include "../../src/scenes/MengerSponge/ScreenResolutions.h"
+
+// NOTE: Must match MengerSpongeFragmentShader.glsl
+#define MAX_STEPS 120
+#define MISS_DIST 200.0f
+#define HIT_DIST 0.01f
+#define BOX_DIMEN 20.0f
+#define HALF_BOX_DIMEN (BOX_DIMEN / 2.0f)
+#define NORMAL_EPSILON 0.0001f
+#define MAX_SAMPLES 8
+#define MISS_COLOR 0.1f // MengerSpongeScene's clear color, misses are discarded in the shader
+
+#define TILE_DIMEN 16
+#define PACKET_DIMEN 2 // 2x2 pixels per 4 wide packet
+#define DEFAULT_TOLERANCE 2
+
+typedef __m128 Lanes;
+
+struct Vec3
+{
+  float32 x, y, z;
+};
+
+struct Vec3Lanes
+{
+  Lanes x, y, z;
+};
+
+struct RenderSettings
+{
+  uint32 samples;
+  float32 time;
+  Vec3 cameraPos;
+  Vec3 cameraRight;
+  Vec3 cameraUp;
+  Vec3 cameraBack;
+  uint32 threadCount;
+  bool normals;
+};
+
+struct Image
+{
+  uint32 width;
+  uint32 height;
+  std::vector<uint8> pixels; // RGB, top row first like PPM
+};
+
+file_access inline Lanes lanes(float32 value) { return _mm_set1_ps(value); }
+file_access inline Lanes abs(Lanes value) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), value); }
+file_access inline Lanes select(Lanes mask, Lanes a, Lanes b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+
+file_access inline Lanes floorLanes(Lanes value)
+{
+  // NOTE: SSE2 has no floor, truncate and step down for negative values (positions are well within int range)
+  Lanes truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(value));
+  return _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, value), lanes(1.0f)));
+}
+
+// GLSL mod(), result has the sign of the divisor
+file_access inline Lanes mod(Lanes value, float32 divisor)
+{
+  return _mm_sub_ps(value, _mm_mul_ps(lanes(divisor), floorLanes(_mm_mul_ps(value, lanes(1.0f / divisor)))));
+}
+
+file_access inline Lanes length(Lanes x, Lanes y)
+{
+  return _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)));
+}
+
+file_access Lanes sdRect(Lanes x, Lanes y, float32 dimen)
+{
+  Lanes rayToCornerX = _mm_sub_ps(abs(x), lanes(dimen));
+  Lanes rayToCornerY = _mm_sub_ps(abs(y), lanes(dimen));
+  // maxDelta is the maximum negative value if the point exists inside of the box, otherwise 0.0
+  Lanes maxDelta = _mm_min_ps(_mm_max_ps(rayToCornerX, rayToCornerY), _mm_setzero_ps());
+  return _mm_add_ps(length(_mm_max_ps(rayToCornerX, _mm_setzero_ps()), _mm_max_ps(rayToCornerY, _mm_setzero_ps())), maxDelta);
+}
+
+file_access Lanes sdCross(const Vec3Lanes& rayPos, float32 dimen)
+{
+  Lanes da = sdRect(rayPos.x, rayPos.y, dimen);
+  Lanes db = sdRect(rayPos.x, rayPos.z, dimen);
+  Lanes dc = sdRect(rayPos.y, rayPos.z, dimen);
+  return _mm_min_ps(da, _mm_min_ps(db, dc));
+}
+
+file_access Lanes sdMengerPrison(Vec3Lanes rayPos, float32 time)
+{
+  // NOTE: sin is evaluated per lane, it is a small part of the cost and matches the shader closely
+  alignas(16) float32 sinInput[4];
+  _mm_store_ps(sinInput, _mm_add_ps(_mm_mul_ps(_mm_mul_ps(rayPos.y, lanes(6.28f)), lanes(0.125f)), lanes(time)));
+  for(uint32 i = 0; i < 4; ++i) { sinInput[i] = sinf(sinInput[i]) * 2.0f; }
+  Lanes sinTime = _mm_load_ps(sinInput);
+  rayPos.x = _mm_add_ps(rayPos.x, sinTime);
+  rayPos.z = _mm_add_ps(rayPos.z, sinTime);
+
+  Vec3Lanes prisonRay = {
+    _mm_sub_ps(mod(rayPos.x, BOX_DIMEN * 2.0f), lanes(BOX_DIMEN)),
+    _mm_sub_ps(mod(rayPos.y, BOX_DIMEN * 2.0f), lanes(BOX_DIMEN)),
+    _mm_sub_ps(mod(rayPos.z, BOX_DIMEN * 2.0f), lanes(BOX_DIMEN))
+  };
+  Lanes mengerPrisonDist = sdCross(prisonRay, HALF_BOX_DIMEN);
+
+  float32 scale = 1.0f;
+  for(uint32 i = 0; i < 3; ++i)
+  {
+    float32 boxedWorldDimen = BOX_DIMEN / scale;
+    Lanes halfBoxed = lanes(boxedWorldDimen * 0.5f);
+    Lanes rayScale = lanes(scale * 3.0f);
+    Vec3Lanes ray = {
+      _mm_mul_ps(_mm_sub_ps(mod(_mm_add_ps(rayPos.x, halfBoxed), boxedWorldDimen), halfBoxed), rayScale),
+      _mm_mul_ps(_mm_sub_ps(mod(_mm_add_ps(rayPos.y, halfBoxed), boxedWorldDimen), halfBoxed), rayScale),
+      _mm_mul_ps(_mm_sub_ps(mod(_mm_add_ps(rayPos.z, halfBoxed), boxedWorldDimen), halfBoxed), rayScale)
+    };
+    Lanes crossesDist = sdCross(ray, HALF_BOX_DIMEN);
+    scale *= 3.0f;
+    crossesDist = _mm_mul_ps(crossesDist, lanes(1.0f / scale));
+    mengerPrisonDist = _mm_max_ps(mengerPrisonDist, _mm_sub_ps(_mm_setzero_ps(), crossesDist));
+  }
+
+  return _mm_mul_ps(mengerPrisonDist, lanes(0.57f));
+}
+
+// Marches four rays in lockstep, returns the hit position (-1 on a miss) and step count (MAX_STEPS on a miss)
+// NOTE: ray dirs are assumed to be normalized
+file_access void distanceRayToScene(const Vec3& rayOrigin, const Vec3Lanes& rayDir, float32 time, Vec3Lanes* hitPos, Lanes* steps)
+{
+  Lanes distTraveled = _mm_setzero_ps();
+  Lanes active = _mm_cmpeq_ps(distTraveled, distTraveled);
+  *hitPos = { lanes(-1.0f), lanes(-1.0f), lanes(-1.0f) };
+  *steps = lanes((float32)MAX_STEPS);
+
+  for(uint32 i = 0; i < MAX_STEPS; ++i)
+  {
+    Vec3Lanes pos = {
+      _mm_add_ps(lanes(rayOrigin.x), _mm_mul_ps(distTraveled, rayDir.x)),
+      _mm_add_ps(lanes(rayOrigin.y), _mm_mul_ps(distTraveled, rayDir.y)),
+      _mm_add_ps(lanes(rayOrigin.z), _mm_mul_ps(distTraveled, rayDir.z))
+    };
+    Lanes posToScene = sdMengerPrison(pos, time);
+    distTraveled = select(active, _mm_add_ps(distTraveled, posToScene), distTraveled);
+
+    // absolute value for posToScene incase the ray makes its way inside an object
+    Lanes hit = _mm_and_ps(active, _mm_cmplt_ps(abs(posToScene), lanes(HIT_DIST)));
+    hitPos->x = select(hit, pos.x, hitPos->x);
+    hitPos->y = select(hit, pos.y, hitPos->y);
+    hitPos->z = select(hit, pos.z, hitPos->z);
+    *steps = select(hit, lanes((float32)i), *steps);
+    active = _mm_andnot_ps(hit, active);
+    active = _mm_andnot_ps(_mm_cmpgt_ps(distTraveled, lanes(MISS_DIST)), active);
+    if(_mm_movemask_ps(active) == 0) { break; }
+  }
+}
+
+file_access Vec3Lanes estimateNormal(const Vec3Lanes& pos, float32 time)
+{
+  Lanes epsilon = lanes(NORMAL_EPSILON);
+  Vec3Lanes normal = {
+    _mm_sub_ps(sdMengerPrison({ _mm_add_ps(pos.x, epsilon), pos.y, pos.z }, time), sdMengerPrison({ _mm_sub_ps(pos.x, epsilon), pos.y, pos.z }, time)),
+    _mm_sub_ps(sdMengerPrison({ pos.x, _mm_add_ps(pos.y, epsilon), pos.z }, time), sdMengerPrison({ pos.x, _mm_sub_ps(pos.y, epsilon), pos.z }, time)),
+    _mm_sub_ps(sdMengerPrison({ pos.x, pos.y, _mm_add_ps(pos.z, epsilon) }, time), sdMengerPrison({ pos.x, pos.y, _mm_sub_ps(pos.z, epsilon) }, time))
+  };
+  Lanes inverseLength = _mm_div_ps(lanes(1.0f), _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(normal.x, normal.x), _mm_mul_ps(normal.y, normal.y)), _mm_mul_ps(normal.z, normal.z))));
+  return { _mm_mul_ps(normal.x, inverseLength), _mm_mul_ps(normal.y, inverseLength), _mm_mul_ps(normal.z, inverseLength) };
+}
+
+file_access float32 gammaCorrectionToSRGB(float32 color)
+{
+  // This formula was pulled from Real-Time Rendering 4th Edition pg 162
+  return color < 0.0031308f ? (12.92f * color) : ((1.055f * powf(color, 1.0f / 2.4f)) - 0.055f);
+}
+
+file_access uint8 unorm8(float32 value)
+{
+  value = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+  return (uint8)(value * 255.0f + 0.5f);
+}
+
+// NOTE: Mirrors the checkerboard sample pattern in MengerSpongeFragmentShader's main()
+file_access const float32 samplePattern[MAX_SAMPLES][2] = {
+  { -1.0f, 1.0f }, { 1.0f, -1.0f }, { -1.0f, -3.0f }, { 3.0f, 1.0f },
+  { -3.0f, -1.0f }, { 1.0f, 3.0f }, { -3.0f, 3.0f }, { 3.0f, -3.0f }
+};
+
+file_access void renderTile(const RenderSettings& settings, uint32 tileIndex, Image* image, Image* normalImage)
+{
+  const uint32 tilesWide = (image->width + TILE_DIMEN - 1) / TILE_DIMEN;
+  const uint32 tileX = (tileIndex % tilesWide) * TILE_DIMEN;
+  const uint32 tileY = (tileIndex / tilesWide) * TILE_DIMEN;
+  const float32 pixelWidth = 1.0f / image->height;
+  const float32 samplePixelOffsetStep = pixelWidth / 8.0f;
+
+  for(uint32 packetY = tileY; packetY < tileY + TILE_DIMEN && packetY < image->height; packetY += PACKET_DIMEN)
+  {
+    for(uint32 packetX = tileX; packetX < tileX + TILE_DIMEN && packetX < image->width; packetX += PACKET_DIMEN)
+    {
+      // lanes are (x, y), (x + 1, y), (x, y + 1), (x + 1, y + 1) with y going up like gl_FragCoord
+      Lanes fragX = _mm_add_ps(lanes((float32)packetX), _mm_setr_ps(0.5f, 1.5f, 0.5f, 1.5f));
+      Lanes fragY = _mm_add_ps(lanes((float32)packetY), _mm_setr_ps(0.5f, 0.5f, 1.5f, 1.5f));
+      Lanes pixelCoordX = _mm_mul_ps(_mm_sub_ps(fragX, lanes(0.5f * image->width)), lanes(pixelWidth));
+      Lanes pixelCoordY = _mm_mul_ps(_mm_sub_ps(fragY, lanes(0.5f * image->height)), lanes(pixelWidth));
+
+      Vec3Lanes averagePos = { _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps() };
+      Lanes averageSteps = _mm_setzero_ps();
+      for(uint32 sampleIndex = 0; sampleIndex < settings.samples; ++sampleIndex)
+      {
+        Lanes dirX = _mm_add_ps(pixelCoordX, lanes(samplePattern[sampleIndex][0] * samplePixelOffsetStep));
+        Lanes dirY = _mm_add_ps(pixelCoordY, lanes(samplePattern[sampleIndex][1] * samplePixelOffsetStep));
+        Lanes dirZ = lanes(-1.0f);
+        Lanes inverseLength = _mm_div_ps(lanes(1.0f), _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dirX, dirX), _mm_mul_ps(dirY, dirY)), _mm_mul_ps(dirZ, dirZ))));
+        dirX = _mm_mul_ps(dirX, inverseLength);
+        dirY = _mm_mul_ps(dirY, inverseLength);
+        dirZ = _mm_mul_ps(dirZ, inverseLength);
+
+        // camera space to world space, equivalent to vec4(rayDir, 0.0) * view in the shader
+        Vec3Lanes rayDir = {
+          _mm_add_ps(_mm_add_ps(_mm_mul_ps(dirX, lanes(settings.cameraRight.x)), _mm_mul_ps(dirY, lanes(settings.cameraUp.x))), _mm_mul_ps(dirZ, lanes(settings.cameraBack.x))),
+          _mm_add_ps(_mm_add_ps(_mm_mul_ps(dirX, lanes(settings.cameraRight.y)), _mm_mul_ps(dirY, lanes(settings.cameraUp.y))), _mm_mul_ps(dirZ, lanes(settings.cameraBack.y))),
+          _mm_add_ps(_mm_add_ps(_mm_mul_ps(dirX, lanes(settings.cameraRight.z)), _mm_mul_ps(dirY, lanes(settings.cameraUp.z))), _mm_mul_ps(dirZ, lanes(settings.cameraBack.z)))
+        };
+
+        Vec3Lanes hitPos;
+        Lanes steps;
+        distanceRayToScene(settings.cameraPos, rayDir, settings.time, &hitPos, &steps);
+        averagePos.x = _mm_add_ps(averagePos.x, hitPos.x);
+        averagePos.y = _mm_add_ps(averagePos.y, hitPos.y);
+        averagePos.z = _mm_add_ps(averagePos.z, hitPos.z);
+        averageSteps = _mm_add_ps(averageSteps, steps);
+      }
+      Lanes inverseSamples = lanes(1.0f / settings.samples);
+      averagePos.x = _mm_mul_ps(averagePos.x, inverseSamples);
+      averagePos.y = _mm_mul_ps(averagePos.y, inverseSamples);
+      averagePos.z = _mm_mul_ps(averagePos.z, inverseSamples);
+      averageSteps = _mm_mul_ps(averageSteps, inverseSamples);
+
+      alignas(16) float32 stepResults[4];
+      alignas(16) float32 normalResults[3][4];
+      _mm_store_ps(stepResults, averageSteps);
+      if(normalImage)
+      {
+        Vec3Lanes normal = estimateNormal(averagePos, settings.time);
+        _mm_store_ps(normalResults[0], normal.x);
+        _mm_store_ps(normalResults[1], normal.y);
+        _mm_store_ps(normalResults[2], normal.z);
+      }
+
+      for(uint32 lane = 0; lane < 4; ++lane)
+      {
+        uint32 x = packetX + (lane & 1);
+        uint32 y = packetY + (lane >> 1);
+        if(x >= image->width || y >= image->height) { continue; }
+
+        bool hit = stepResults[lane] < MAX_STEPS;
+        uint8 value = unorm8(hit ? gammaCorrectionToSRGB(1.0f - (stepResults[lane] / MAX_STEPS)) : MISS_COLOR);
+        uint8* pixel = &image->pixels[(((image->height - 1 - y) * image->width) + x) * 3];
+        pixel[0] = pixel[1] = pixel[2] = value;
+
+        if(normalImage)
+        {
+          uint8* normalPixel = &normalImage->pixels[(((image->height - 1 - y) * image->width) + x) * 3];
+          for(uint32 channel = 0; channel < 3; ++channel)
+          {
+            normalPixel[channel] = hit ? unorm8((normalResults[channel][lane] * 0.5f) + 0.5f) : 0;
+          }
+        }
+      }
+    }
+  }
+}
+
+// NOTE: Each worker owns a contiguous range of tiles packed as (end << 32 | begin). The owner takes tiles from the
+// NOTE: front, idle workers steal the back half of another worker's range. Both sides use CAS on the same word.
+struct alignas(64) TileRange
+{
+  std::atomic<uint64> range;
+};
+
+file_access inline uint64 packRange(uint32 begin, uint32 end) { return ((uint64)end << 32) | begin; }
+
+file_access bool popTile(TileRange* tileRange, uint32* tile)
+{
+  uint64 range = tileRange->range.load();
+  while(true)
+  {
+    uint32 begin = (uint32)range;
+    uint32 end = (uint32)(range >> 32);
+    if(begin >= end) { return false; }
+    if(tileRange->range.compare_exchange_weak(range, packRange(begin + 1, end)))
+    {
+      *tile = begin;
+      return true;
+    }
+  }
+}
+
+file_access bool stealTiles(TileRange* victim, TileRange* thief)
+{
+  uint64 range = victim->range.load();
+  while(true)
+  {
+    uint32 begin = (uint32)range;
+    uint32 end = (uint32)(range >> 32);
+    if(begin >= end) { return false; }
+    uint32 stolenBegin = end - ((end - begin + 1) / 2);
+    if(victim->range.compare_exchange_weak(range, packRange(begin, stolenBegin)))
+    {
+      thief->range.store(packRange(stolenBegin, end));
+      return true;
+    }
+  }
+}
+
+file_access void renderImage(const RenderSettings& settings, Image* image, Image* normalImage)
+{
+  const uint32 tileCount = ((image->width + TILE_DIMEN - 1) / TILE_DIMEN) * ((image->height + TILE_DIMEN - 1) / TILE_DIMEN);
+  std::vector<TileRange> tileRanges(settings.threadCount);
+  for(uint32 i = 0; i < settings.threadCount; ++i)
+  {
+    tileRanges[i].range.store(packRange((uint32)(((uint64)tileCount * i) / settings.threadCount),
+                                        (uint32)(((uint64)tileCount * (i + 1)) / settings.threadCount)));
+  }
+
+  auto worker = [&](uint32 workerIndex) {
+    TileRange* ownRange = &tileRanges[workerIndex];
+    while(true)
+    {
+      uint32 tile;
+      while(popTile(ownRange, &tile)) { renderTile(settings, tile, image, normalImage); }
+
+      // NOTE: once every range is seen empty there is nothing left to steal, tiles in transit belong to their thief
+      bool stole = false;
+      for(uint32 i = 1; i < settings.threadCount && !stole; ++i)
+      {
+        stole = stealTiles(&tileRanges[(workerIndex + i) % settings.threadCount], ownRange);
+      }
+      if(!stole) { return; }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for(uint32 i = 1; i < settings.threadCount; ++i) { threads.emplace_back(worker, i); }
+  worker(0);
+  for(uint32 i = 0; i < threads.size(); ++i) { threads[i].join(); }
+}
+
+file_access bool writePPM(const std::string& fileName, const Image& image)
+{
+  std::ofstream file(fileName, std::ios::binary);
+  if(!file) { return false; }
+  file << "P6\n" << image.width << " " << image.height << "\n255\n";
+  file.write((const char*)image.pixels.data(), image.pixels.size());
+  return (bool)file;
+}
+
+file_access bool readPPM(const std::string& fileName, Image* image)
+{
+  std::ifstream file(fileName, std::ios::binary);
+  std::string magic;
+  uint32 maxValue;
+  if(!(file >> magic >> image->width >> image->height >> maxValue) || magic != "P6" || maxValue != 255) { return false; }
+  file.get(); // single whitespace before the pixel data
+  image->pixels.resize(image->width * image->height * 3);
+  file.read((char*)image->pixels.data(), image->pixels.size());
+  return (bool)file;
+}
+
+// Returns the number of channels that differ by more than the tolerance
+file_access uint64 compareImages(const Image& image, const Image& golden, uint32 tolerance, uint32* maxDifference)
+{
+  *maxDifference = 0;
+  if(image.width != golden.width || image.height != golden.height) { return image.pixels.size(); }
+  uint64 failures = 0;
+  for(uint64 i = 0; i < image.pixels.size(); ++i)
+  {
+    uint32 difference = (uint32)std::abs((int32)image.pixels[i] - (int32)golden.pixels[i]);
+    if(difference > *maxDifference) { *maxDifference = difference; }
+    if(difference > tolerance) { failures++; }
+  }
+  return failures;
+}
+
+// NOTE: Same basis as Camera::updateCameraVectors() in src/Camera.cpp
+file_access void setCamera(RenderSettings* settings, Vec3 position, float32 yawDegrees, float32 pitchDegrees)
+{
+  float32 yaw = yawDegrees * (3.14159265f / 180.0f);
+  float32 pitch = pitchDegrees * (3.14159265f / 180.0f);
+  Vec3 front = { cosf(yaw) * cosf(pitch), sinf(pitch), sinf(yaw) * cosf(pitch) };
+  // right = normalize(cross(front, worldUp)), up = cross(right, front)
+  float32 rightLength = sqrtf((front.z * front.z) + (front.x * front.x));
+  Vec3 right = { -front.z / rightLength, 0.0f, front.x / rightLength };
+  Vec3 up = { (right.y * front.z) - (right.z * front.y), (right.z * front.x) - (right.x * front.z), (right.x * front.y) - (right.y * front.x) };
+  settings->cameraPos = position;
+  settings->cameraRight = right;
+  settings->cameraUp = up;
+  settings->cameraBack = { -front.x, -front.y, -front.z };
+}
+
+int main(int argc, char* argv[])
+{
+  RenderSettings settings = {};
+  settings.samples = 1;
+  settings.time = 0.0f;
+  settings.threadCount = std::thread::hardware_concurrency() > 0 ? std::thread::hardware_concurrency() : 1;
+  setCamera(&settings, { 0.0f, 1.0f, 30.0f }, -90.0f, 0.0f); // MengerSpongeScene's starting camera
+  std::string outDirectory = ".";
+  std::string goldenDirectory;
+  uint32 tolerance = DEFAULT_TOLERANCE;
+
+  for(int i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+    if(arg == "--samples" && i + 1 < argc)
+    {
+      settings.samples = (uint32)atoi(argv[++i]);
+      if(settings.samples < 1 || settings.samples > MAX_SAMPLES)
+      {
+        std::cout << "ERROR::MENGER_RAY_MARCHER::SAMPLES_MUST_BE_1_TO_" << MAX_SAMPLES << std::endl;
+        return 1;
+      }
+    } else if(arg == "--time" && i + 1 < argc)
+    {
+      settings.time = (float32)atof(argv[++i]);
+    } else if(arg == "--camera" && i + 5 < argc)
+    {
+      Vec3 position = { (float32)atof(argv[i + 1]), (float32)atof(argv[i + 2]), (float32)atof(argv[i + 3]) };
+      setCamera(&settings, position, (float32)atof(argv[i + 4]), (float32)atof(argv[i + 5]));
+      i += 5;
+    } else if(arg == "--threads" && i + 1 < argc)
+    {
+      settings.threadCount = (uint32)atoi(argv[++i]);
+      if(settings.threadCount < 1) { settings.threadCount = 1; }
+    } else if(arg == "--normals")
+    {
+      settings.normals = true;
+    } else if(arg == "--out" && i + 1 < argc)
+    {
+      outDirectory = argv[++i];
+    } else if(arg == "--golden" && i + 1 < argc)
+    {
+      goldenDirectory = argv[++i];
+    } else if(arg == "--tolerance" && i + 1 < argc)
+    {
+      tolerance = (uint32)atoi(argv[++i]);
+    } else
+    {
+      std::cout << "usage: MengerRayMarcher [--samples n] [--time seconds] [--camera x y z yaw pitch] [--threads n] [--normals]" << std::endl;
+      std::cout << "                        [--out directory] [--golden directory] [--tolerance n]" << std::endl;
+      return 1;
+    }
+  }
+
+  std::cout << "Menger prison CPU ray marcher: " << settings.threadCount << " threads, " << settings.samples << " sample(s) per pixel" << std::endl;
+
+  bool goldenFailed = false;
+  for(uint32 resolutionIndex = 0; resolutionIndex < ArrayCount(screenResolutions); ++resolutionIndex)
+  {
+    Extent2D resolution = screenResolutions[resolutionIndex];
+    Image image = { resolution.width, resolution.height, std::vector<uint8>(resolution.width * resolution.height * 3) };
+    Image normalImage = image;
+
+    auto start = std::chrono::steady_clock::now();
+    renderImage(settings, &image, settings.normals ? &normalImage : NULL);
+    float64 seconds = std::chrono::duration<float64>(std::chrono::steady_clock::now() - start).count();
+    float64 rays = (float64)resolution.width * resolution.height * settings.samples;
+
+    std::string name = "menger_" + std::to_string(resolution.width) + "x" + std::to_string(resolution.height);
+    std::cout << name << ": " << (seconds * 1000.0) << " ms, " << (rays / seconds / 1000000.0) << " Mrays/s";
+
+    if(goldenDirectory.empty())
+    {
+      if(!writePPM(outDirectory + "/" + name + ".ppm", image) ||
+         (settings.normals && !writePPM(outDirectory + "/" + name + "_normals.ppm", normalImage)))
+      {
+        std::cout << std::endl << "ERROR::MENGER_RAY_MARCHER::FAILED_TO_WRITE_IMAGE: " << outDirectory << "/" << name << std::endl;
+        return 1;
+      }
+      std::cout << std::endl;
+    } else
+    {
+      Image golden;
+      if(!readPPM(goldenDirectory + "/" + name + ".ppm", &golden))
+      {
+        std::cout << std::endl << "ERROR::MENGER_RAY_MARCHER::FAILED_TO_READ_GOLDEN_IMAGE: " << goldenDirectory << "/" << name << ".ppm" << std::endl;
+        return 1;
+      }
+      uint32 maxDifference;
+      uint64 failures = compareImages(image, golden, tolerance, &maxDifference);
+      std::cout << ", golden " << (failures == 0 ? "match" : "MISMATCH") << " (max difference " << maxDifference << ", " << failures << " channels over tolerance)" << std::endl;
+      goldenFailed = goldenFailed || failures > 0;
+    }
+  }
+
+  return goldenFailed ? 2 : 0;
+}
@@ -0,0 +1,99 @@
+// Checks that Mesh::Draw stays free of heap allocations (see the NOTE on Mesh::Draw)
+// usage: MeshDrawAllocations (run from the repo root, the shaders are loaded from src/)
+// NOTE: Replaces the global operator new with a counting one, draws a textured mesh MESH_DRAW_COUNT times in an
+// NOTE: invisible window and exits non-zero if any allocation happened while drawing.
+
+#define GLFW_INCLUDE_NONE // ensure GLFW doesn't load OpenGL headers
+
+#include <cstdlib>
+#include <new>
+#include <vector>
+#include <iostream>
+#include <GLFW/glfw3.h>
+#include <glad/glad.h>
+
+#include "../../src/Mesh.h"
+#include "../../src/common/FileLocations.h"
+#include "../../src/common/glExtensions.h"
+
+#define MESH_DRAW_COUNT 10000
+
+file_access bool countingAllocations = false;
+file_access uint64 allocationCount = 0;
+
+void* operator new(size_t size)
+{
+  if(countingAllocations) { allocationCount++; }
+  void* memory = malloc(size > 0 ? size : 1);
+  if(memory == NULL) { throw std::bad_alloc(); }
+  return memory;
+}
+
+void operator delete(void* memory) noexcept { free(memory); }
+void operator delete(void* memory, size_t) noexcept { free(memory); }
+
+int main()
+{
+  if(glfwInit() == GLFW_FALSE)
+  {
+    std::cout << "Failed to load GLFW" << std::endl;
+    return -1;
+  }
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+  glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+  glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+  GLFWwindow* window = glfwCreateWindow(64, 64, "MeshDrawAllocations", NULL, NULL);
+  if(window == NULL)
+  {
+    std::cout << "Failed to create GLFW window" << std::endl;
+    glfwTerminate();
+    return -1;
+  }
+  glfwMakeContextCurrent(window);
+  if(!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+  {
+    std::cout << "Failed to initialize GLAD" << std::endl;
+    glfwTerminate();
+    return -1;
+  }
+  loadGLExtensions((GLADloadproc)glfwGetProcAddress);
+
+  int32 drawResult;
+  {
+    ShaderProgram shader(posNormTexVertexShaderFileLoc, dirPosSpotLightModelFragmentShaderFileLoc);
+    shader.use();
+
+    // NOTE: the textures are never sampled from, only bound, so they are left without storage
+    uint32 textureIds[3];
+    glGenTextures(ArrayCount(textureIds), textureIds);
+    std::vector<Texture> textures = {
+            { textureIds[0], "diffTexture", "diffuse1" },
+            { textureIds[1], "diffTexture", "diffuse2" },
+            { textureIds[2], "specTexture", "specular1" }
+    };
+    std::vector<Vertex> vertices = {
+            { glm::vec3(-0.5f, -0.5f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec2(0.0f, 0.0f) },
+            { glm::vec3(0.5f, -0.5f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec2(1.0f, 0.0f) },
+            { glm::vec3(0.0f, 0.5f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec2(0.5f, 1.0f) }
+    };
+    std::vector<uint32> indices = { 0, 1, 2 };
+    Mesh mesh(vertices, indices, textures);
+
+    countingAllocations = true;
+    for(uint32 i = 0; i < MESH_DRAW_COUNT; ++i)
+    {
+      mesh.Draw(shader);
+    }
+    countingAllocations = false;
+    glFinish();
+
+    std::cout << MESH_DRAW_COUNT << " Mesh::Draw calls made " << allocationCount << " allocations" << std::endl;
+    drawResult = allocationCount == 0 ? 0 : -1;
+
+    glDeleteTextures(ArrayCount(textureIds), textureIds);
+  }
+
+  glfwTerminate();
+  return drawResult;
+}
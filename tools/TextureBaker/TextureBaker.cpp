@@ -0,0 +1,589 @@
+// Offline texture baker, converts source images into .btex files (see src/common/BakedTexture.h)
+// usage: TextureBaker [--bc7] [--uncompressed] [--flip] [image or directory]...
+// NOTE: Run from the repository root. With no inputs, every image in src/data and src/data/PBR is baked in both
+// NOTE: vertical orientations, since scenes load some of them flipped.
+
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <filesystem>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb/stb_image.h>
+
+#include "../../src/LearnOpenGLPlatform.h"
+#include "../../src/common/BakedTexture.h"
+
+#define BLOCK_DIMEN 4
+#define BLOCK_PIXEL_COUNT (BLOCK_DIMEN * BLOCK_DIMEN)
+#define POWER_ITERATION_COUNT 8
+
+enum TextureKind {
+  TextureKind_Color, // sRGB, mips are filtered in linear space
+  TextureKind_Normal, // tangent space normal map, mips are renormalized
+  TextureKind_Height, // parallax height, kept uncompressed since block artifacts show up as steps
+  TextureKind_Data, // specular, roughness, etc.
+};
+
+struct BakeSettings
+{
+  bool useBC7;
+  bool uncompressed;
+};
+
+struct BakeImage
+{
+  uint32 width;
+  uint32 height;
+  std::vector<float32> pixels; // RGBA
+};
+
+file_access float32 clamp01(float32 value)
+{
+  return value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+}
+
+file_access float32 srgbToLinear(float32 value)
+{
+  return value <= 0.04045f ? value / 12.92f : powf((value + 0.055f) / 1.055f, 2.4f);
+}
+
+file_access float32 linearToSrgb(float32 value)
+{
+  return value <= 0.0031308f ? value * 12.92f : (1.055f * powf(value, 1.0f / 2.4f)) - 0.055f;
+}
+
+file_access TextureKind textureKind(const std::string& imgLocation)
+{
+  std::string fileName = std::filesystem::path(imgLocation).filename().string();
+  if(fileName.find("normal") != std::string::npos) { return TextureKind_Normal; }
+  if(fileName.find("height") != std::string::npos) { return TextureKind_Height; }
+  if(fileName.find("spec") != std::string::npos || fileName.find("rough") != std::string::npos ||
+     fileName.find("metal") != std::string::npos || fileName.find("_ao") != std::string::npos)
+  {
+    return TextureKind_Data;
+  }
+  return TextureKind_Color;
+}
+
+file_access void downsample(const BakeImage& source, TextureKind kind, BakeImage* result)
+{
+  result->width = source.width > 1 ? source.width / 2 : 1;
+  result->height = source.height > 1 ? source.height / 2 : 1;
+  result->pixels.resize(result->width * result->height * 4);
+
+  for(uint32 y = 0; y < result->height; ++y)
+  {
+    for(uint32 x = 0; x < result->width; ++x)
+    {
+      uint32 sourceX0 = x * 2, sourceY0 = y * 2;
+      uint32 sourceX1 = sourceX0 + 1 < source.width ? sourceX0 + 1 : sourceX0;
+      uint32 sourceY1 = sourceY0 + 1 < source.height ? sourceY0 + 1 : sourceY0;
+      const float32* samples[4] = {
+              &source.pixels[(sourceY0 * source.width + sourceX0) * 4],
+              &source.pixels[(sourceY0 * source.width + sourceX1) * 4],
+              &source.pixels[(sourceY1 * source.width + sourceX0) * 4],
+              &source.pixels[(sourceY1 * source.width + sourceX1) * 4],
+      };
+
+      float32* pixel = &result->pixels[(y * result->width + x) * 4];
+      for(uint32 channel = 0; channel < 4; ++channel)
+      {
+        pixel[channel] = (samples[0][channel] + samples[1][channel] + samples[2][channel] + samples[3][channel]) * 0.25f;
+      }
+
+      if(kind == TextureKind_Normal)
+      {
+        float32 normal[3] = { pixel[0] * 2.0f - 1.0f, pixel[1] * 2.0f - 1.0f, pixel[2] * 2.0f - 1.0f };
+        float32 length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        if(length > 0.0f)
+        {
+          for(uint32 channel = 0; channel < 3; ++channel) { pixel[channel] = (normal[channel] / length) * 0.5f + 0.5f; }
+        }
+      }
+    }
+  }
+}
+
+file_access void quantize(const BakeImage& image, TextureKind kind, std::vector<uint8>* result)
+{
+  result->resize(image.width * image.height * 4);
+  for(uint32 i = 0; i < image.pixels.size(); ++i)
+  {
+    float32 value = image.pixels[i];
+    if(kind == TextureKind_Color && (i % 4) != 3) { value = linearToSrgb(value); }
+    (*result)[i] = (uint8)(clamp01(value) * 255.0f + 0.5f);
+  }
+}
+
+// ===== Block compression =====
+// NOTE: Endpoints are fit along the principal axis of each block's colors. This is a lot faster than an exhaustive
+// NOTE: search and is plenty for the textures in this repo.
+
+file_access void fetchBlock(const uint8* rgba, uint32 width, uint32 height, uint32 blockX, uint32 blockY, uint8 block[BLOCK_PIXEL_COUNT][4])
+{
+  for(uint32 y = 0; y < BLOCK_DIMEN; ++y)
+  {
+    for(uint32 x = 0; x < BLOCK_DIMEN; ++x)
+    {
+      // clamp to the edge for images that aren't a multiple of the block size
+      uint32 pixelX = blockX * BLOCK_DIMEN + x;
+      uint32 pixelY = blockY * BLOCK_DIMEN + y;
+      if(pixelX >= width) { pixelX = width - 1; }
+      if(pixelY >= height) { pixelY = height - 1; }
+      memcpy(block[y * BLOCK_DIMEN + x], rgba + ((pixelY * width + pixelX) * 4), 4);
+    }
+  }
+}
+
+file_access void fitEndpoints(const uint8 block[BLOCK_PIXEL_COUNT][4], uint32 channelCount, float32 low[4], float32 high[4])
+{
+  float32 mean[4] = {};
+  float32 minimum[4] = { 255.0f, 255.0f, 255.0f, 255.0f };
+  float32 maximum[4] = {};
+  for(uint32 i = 0; i < BLOCK_PIXEL_COUNT; ++i)
+  {
+    for(uint32 c = 0; c < channelCount; ++c)
+    {
+      float32 value = block[i][c];
+      mean[c] += value / BLOCK_PIXEL_COUNT;
+      if(value < minimum[c]) { minimum[c] = value; }
+      if(value > maximum[c]) { maximum[c] = value; }
+    }
+  }
+
+  float32 covariance[4][4] = {};
+  for(uint32 i = 0; i < BLOCK_PIXEL_COUNT; ++i)
+  {
+    for(uint32 row = 0; row < channelCount; ++row)
+    {
+      for(uint32 column = 0; column < channelCount; ++column)
+      {
+        covariance[row][column] += (block[i][row] - mean[row]) * (block[i][column] - mean[column]);
+      }
+    }
+  }
+
+  float32 axis[4] = {};
+  for(uint32 c = 0; c < channelCount; ++c) { axis[c] = maximum[c] - minimum[c]; }
+  for(uint32 iteration = 0; iteration < POWER_ITERATION_COUNT; ++iteration)
+  {
+    float32 nextAxis[4] = {};
+    float32 lengthSquared = 0.0f;
+    for(uint32 row = 0; row < channelCount; ++row)
+    {
+      for(uint32 column = 0; column < channelCount; ++column) { nextAxis[row] += covariance[row][column] * axis[column]; }
+      lengthSquared += nextAxis[row] * nextAxis[row];
+    }
+    if(lengthSquared < 1e-6f) { break; }
+    float32 inverseLength = 1.0f / sqrtf(lengthSquared);
+    for(uint32 c = 0; c < channelCount; ++c) { axis[c] = nextAxis[c] * inverseLength; }
+  }
+
+  float32 axisLengthSquared = 0.0f;
+  for(uint32 c = 0; c < channelCount; ++c) { axisLengthSquared += axis[c] * axis[c]; }
+  if(axisLengthSquared < 1e-6f)
+  {
+    // every pixel in the block is the same color
+    for(uint32 c = 0; c < channelCount; ++c) { low[c] = high[c] = mean[c]; }
+    return;
+  }
+  float32 inverseAxisLength = 1.0f / sqrtf(axisLengthSquared);
+  for(uint32 c = 0; c < channelCount; ++c) { axis[c] *= inverseAxisLength; }
+
+  float32 minProjection = 0.0f, maxProjection = 0.0f;
+  for(uint32 i = 0; i < BLOCK_PIXEL_COUNT; ++i)
+  {
+    float32 projection = 0.0f;
+    for(uint32 c = 0; c < channelCount; ++c) { projection += (block[i][c] - mean[c]) * axis[c]; }
+    if(projection < minProjection) { minProjection = projection; }
+    if(projection > maxProjection) { maxProjection = projection; }
+  }
+
+  for(uint32 c = 0; c < channelCount; ++c)
+  {
+    low[c] = clamp01((mean[c] + axis[c] * minProjection) / 255.0f) * 255.0f;
+    high[c] = clamp01((mean[c] + axis[c] * maxProjection) / 255.0f) * 255.0f;
+  }
+}
+
+file_access uint32 nearestPaletteIndex(const uint8 pixel[4], const float32 palette[][4], uint32 paletteCount, uint32 channelCount)
+{
+  uint32 nearestIndex = 0;
+  float32 nearestDistance = 1e30f;
+  for(uint32 i = 0; i < paletteCount; ++i)
+  {
+    float32 distance = 0.0f;
+    for(uint32 c = 0; c < channelCount; ++c)
+    {
+      float32 delta = pixel[c] - palette[i][c];
+      distance += delta * delta;
+    }
+    if(distance < nearestDistance)
+    {
+      nearestDistance = distance;
+      nearestIndex = i;
+    }
+  }
+  return nearestIndex;
+}
+
+file_access uint16 packRGB565(const float32 color[4])
+{
+  uint16 r = (uint16)(color[0] * (31.0f / 255.0f) + 0.5f);
+  uint16 g = (uint16)(color[1] * (63.0f / 255.0f) + 0.5f);
+  uint16 b = (uint16)(color[2] * (31.0f / 255.0f) + 0.5f);
+  return (r << 11) | (g << 5) | b;
+}
+
+file_access void unpackRGB565(uint16 packed, float32 color[4])
+{
+  uint32 r = (packed >> 11) & 31, g = (packed >> 5) & 63, b = packed & 31;
+  color[0] = (float32)((r << 3) | (r >> 2));
+  color[1] = (float32)((g << 2) | (g >> 4));
+  color[2] = (float32)((b << 3) | (b >> 2));
+  color[3] = 255.0f;
+}
+
+// NOTE: Always uses the four color mode (color0 > color1), which is also the only mode the color half of BC3 has
+file_access void encodeBC1Block(const uint8 block[BLOCK_PIXEL_COUNT][4], uint8* output)
+{
+  float32 low[4], high[4];
+  fitEndpoints(block, 3, low, high);
+  uint16 color0 = packRGB565(high);
+  uint16 color1 = packRGB565(low);
+  if(color0 < color1) { uint16 swap = color0; color0 = color1; color1 = swap; }
+
+  uint32 indices = 0;
+  if(color0 != color1)
+  {
+    float32 palette[4][4];
+    unpackRGB565(color0, palette[0]);
+    unpackRGB565(color1, palette[1]);
+    for(uint32 c = 0; c < 3; ++c)
+    {
+      palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+      palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+    }
+    for(uint32 i = 0; i < BLOCK_PIXEL_COUNT; ++i) { indices |= nearestPaletteIndex(block[i], palette, 4, 3) << (i * 2); }
+  }
+
+  output[0] = color0 & 0xFF;
+  output[1] = color0 >> 8;
+  output[2] = color1 & 0xFF;
+  output[3] = color1 >> 8;
+  memcpy(output + 4, &indices, sizeof(indices)); // NOTE: assumes little endian
+}
+
+// Single channel block, the alpha half of BC3 and each half of BC5
+file_access void encodeBC4Block(const uint8 block[BLOCK_PIXEL_COUNT][4], uint32 channel, uint8* output)
+{
+  uint8 minimum = 255, maximum = 0;
+  for(uint32 i = 0; i < BLOCK_PIXEL_COUNT; ++i)
+  {
+    if(block[i][channel] < minimum) { minimum = block[i][channel]; }
+    if(block[i][channel] > maximum) { maximum = block[i][channel]; }
+  }
+
+  uint64 indices = 0;
+  if(maximum != minimum)
+  {
+    // NOTE: endpoint0 > endpoint1 selects the eight value mode
+    float32 palette[8][4] = {};
+    palette[0][0] = maximum;
+    palette[1][0] = minimum;
+    for(uint32 i = 2; i < 8; ++i) { palette[i][0] = ((8 - i) * (float32)maximum + (i - 1) * (float32)minimum) / 7.0f; }
+    for(uint32 i = 0; i < BLOCK_PIXEL_COUNT; ++i)
+    {
+      uint8 value[4] = { block[i][channel] };
+      indices |= (uint64)nearestPaletteIndex(value, palette, 8, 1) << (i * 3);
+    }
+  }
+
+  output[0] = maximum;
+  output[1] = minimum;
+  for(uint32 i = 0; i < 6; ++i) { output[2 + i] = (uint8)(indices >> (i * 8)); }
+}
+
+struct BlockBitWriter
+{
+  uint8* output;
+  uint32 bitPosition;
+
+  void write(uint32 value, uint32 bitCount)
+  {
+    for(uint32 i = 0; i < bitCount; ++i, ++bitPosition)
+    {
+      if((value >> i) & 1) { output[bitPosition / 8] |= 1 << (bitPosition % 8); }
+    }
+  }
+};
+
+// NOTE: BC7 mode 6 only: one subset, 7 bit RGBA endpoints + a unique p-bit each, 4 bit indices
+file_access void encodeBC7Block(const uint8 block[BLOCK_PIXEL_COUNT][4], uint8* output)
+{
+  const uint32 weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+  float32 endpoints[2][4];
+  fitEndpoints(block, 4, endpoints[0], endpoints[1]);
+
+  uint32 quantized[2][4];
+  uint32 pBits[2];
+  for(uint32 e = 0; e < 2; ++e)
+  {
+    // pick the p-bit that lands closest to the fit endpoint
+    float32 bestError = 1e30f;
+    for(uint32 p = 0; p < 2; ++p)
+    {
+      uint32 candidate[4];
+      float32 error = 0.0f;
+      for(uint32 c = 0; c < 4; ++c)
+      {
+        float32 value = (endpoints[e][c] - p) * 0.5f + 0.5f;
+        candidate[c] = value < 0.0f ? 0 : (value > 127.0f ? 127 : (uint32)value);
+        float32 delta = endpoints[e][c] - (float32)((candidate[c] << 1) | p);
+        error += delta * delta;
+      }
+      if(error < bestError)
+      {
+        bestError = error;
+        pBits[e] = p;
+        memcpy(quantized[e], candidate, sizeof(candidate));
+      }
+    }
+  }
+
+  float32 palette[16][4];
+  for(uint32 i = 0; i < 16; ++i)
+  {
+    for(uint32 c = 0; c < 4; ++c)
+    {
+      uint32 endpoint0 = (quantized[0][c] << 1) | pBits[0];
+      uint32 endpoint1 = (quantized[1][c] << 1) | pBits[1];
+      palette[i][c] = (float32)((((64 - weights[i]) * endpoint0) + (weights[i] * endpoint1) + 32) >> 6);
+    }
+  }
+
+  uint32 indices[BLOCK_PIXEL_COUNT];
+  for(uint32 i = 0; i < BLOCK_PIXEL_COUNT; ++i) { indices[i] = nearestPaletteIndex(block[i], palette, 16, 4); }
+
+  // NOTE: The anchor (first) index drops its high bit, swap the endpoints if it would be set
+  if(indices[0] & 8)
+  {
+    for(uint32 c = 0; c < 4; ++c) { uint32 swap = quantized[0][c]; quantized[0][c] = quantized[1][c]; quantized[1][c] = swap; }
+    uint32 swap = pBits[0]; pBits[0] = pBits[1]; pBits[1] = swap;
+    for(uint32 i = 0; i < BLOCK_PIXEL_COUNT; ++i) { indices[i] = 15 - indices[i]; }
+  }
+
+  memset(output, 0, 16);
+  BlockBitWriter writer = { output, 0 };
+  writer.write(1 << 6, 7); // mode 6
+  for(uint32 c = 0; c < 4; ++c)
+  {
+    writer.write(quantized[0][c], 7);
+    writer.write(quantized[1][c], 7);
+  }
+  writer.write(pBits[0], 1);
+  writer.write(pBits[1], 1);
+  writer.write(indices[0], 3);
+  for(uint32 i = 1; i < BLOCK_PIXEL_COUNT; ++i) { writer.write(indices[i], 4); }
+}
+
+file_access uint32 blockByteSize(BakedTextureFormat format)
+{
+  return format == BakedTextureFormat_BC1 ? 8 : 16;
+}
+
+file_access void encodeMip(const std::vector<uint8>& rgba, uint32 width, uint32 height, BakedTextureFormat format, std::vector<uint8>* output)
+{
+  if(!bakedTextureFormatCompressed(format))
+  {
+    uint32 channelCount = format == BakedTextureFormat_R8 ? 1 : (format == BakedTextureFormat_RGB8 ? 3 : 4);
+    for(uint32 i = 0; i < width * height; ++i) { output->insert(output->end(), &rgba[i * 4], &rgba[i * 4] + channelCount); }
+    return;
+  }
+
+  uint32 blocksWide = (width + BLOCK_DIMEN - 1) / BLOCK_DIMEN;
+  uint32 blocksHigh = (height + BLOCK_DIMEN - 1) / BLOCK_DIMEN;
+  uint32 blockSize = blockByteSize(format);
+  size_t mipStart = output->size();
+  output->resize(mipStart + (blocksWide * blocksHigh * blockSize));
+
+  uint8 block[BLOCK_PIXEL_COUNT][4];
+  for(uint32 blockY = 0; blockY < blocksHigh; ++blockY)
+  {
+    for(uint32 blockX = 0; blockX < blocksWide; ++blockX)
+    {
+      fetchBlock(rgba.data(), width, height, blockX, blockY, block);
+      uint8* blockOutput = output->data() + mipStart + ((blockY * blocksWide + blockX) * blockSize);
+      switch(format)
+      {
+        case BakedTextureFormat_BC1:
+          encodeBC1Block(block, blockOutput);
+          break;
+        case BakedTextureFormat_BC3:
+          encodeBC4Block(block, 3, blockOutput);
+          encodeBC1Block(block, blockOutput + 8);
+          break;
+        case BakedTextureFormat_BC5:
+          encodeBC4Block(block, 0, blockOutput);
+          encodeBC4Block(block, 1, blockOutput + 8);
+          break;
+        case BakedTextureFormat_BC7:
+          encodeBC7Block(block, blockOutput);
+          break;
+        default:
+          InvalidCodePath;
+      }
+    }
+  }
+}
+
+file_access BakedTextureFormat chooseFormat(TextureKind kind, bool hasAlpha, const BakeSettings& settings)
+{
+  switch(kind)
+  {
+    case TextureKind_Height:
+      return BakedTextureFormat_R8;
+    case TextureKind_Normal:
+      return settings.uncompressed ? BakedTextureFormat_RGB8 : BakedTextureFormat_BC5;
+    default:
+      if(settings.uncompressed) { return hasAlpha ? BakedTextureFormat_RGBA8 : BakedTextureFormat_RGB8; }
+      if(settings.useBC7) { return BakedTextureFormat_BC7; }
+      return hasAlpha ? BakedTextureFormat_BC3 : BakedTextureFormat_BC1;
+  }
+}
+
+file_access const char* formatName(BakedTextureFormat format)
+{
+  const char* names[] = { "R8", "RGB8", "RGBA8", "BC1", "BC3", "BC5", "BC7" };
+  return names[format];
+}
+
+file_access bool bakeTexture(const std::string& imgLocation, bool flipImageVert, const BakeSettings& settings)
+{
+  int width, height, numChannels;
+  stbi_set_flip_vertically_on_load(flipImageVert);
+  uint8* data = stbi_load(imgLocation.c_str(), &width, &height, &numChannels, 4 /*desired channels*/);
+  if(data == NULL)
+  {
+    std::cout << "ERROR::TEXTURE_BAKER::FAILED_TO_LOAD " << imgLocation << std::endl;
+    return false;
+  }
+
+  TextureKind kind = textureKind(imgLocation);
+  bool hasAlpha = false;
+  BakeImage mipImage;
+  mipImage.width = width;
+  mipImage.height = height;
+  mipImage.pixels.resize(width * height * 4);
+  for(uint32 i = 0; i < mipImage.pixels.size(); ++i)
+  {
+    float32 value = data[i] / 255.0f;
+    bool alphaChannel = (i % 4) == 3;
+    if(alphaChannel && data[i] != 255) { hasAlpha = true; }
+    mipImage.pixels[i] = (kind == TextureKind_Color && !alphaChannel) ? srgbToLinear(value) : value;
+  }
+  stbi_image_free(data);
+
+  BakedTextureFormat format = chooseFormat(kind, hasAlpha, settings);
+  BakedTextureHeader header = {};
+  header.identifier = BAKED_TEXTURE_IDENTIFIER;
+  header.version = BAKED_TEXTURE_VERSION;
+  header.format = format;
+  header.flags = (flipImageVert ? BakedTexture_FlippedVertically : 0) | (kind == TextureKind_Normal ? BakedTexture_NormalMap : 0);
+
+  std::vector<uint8> mipData;
+  std::vector<uint8> quantized;
+  while(header.mipCount < BAKED_TEXTURE_MAX_MIP_COUNT)
+  {
+    BakedTextureMip& mip = header.mips[header.mipCount++];
+    mip.width = mipImage.width;
+    mip.height = mipImage.height;
+    mip.offset = (uint32)mipData.size();
+    quantize(mipImage, kind, &quantized);
+    encodeMip(quantized, mipImage.width, mipImage.height, format, &mipData);
+    mip.size = (uint32)mipData.size() - mip.offset;
+
+    if(mipImage.width == 1 && mipImage.height == 1) { break; }
+    BakeImage nextMipImage;
+    downsample(mipImage, kind, &nextMipImage);
+    mipImage = std::move(nextMipImage);
+  }
+  header.dataSize = (uint32)mipData.size();
+
+  std::string bakedLocation = bakedTextureLocation(imgLocation.c_str(), flipImageVert);
+  std::ofstream bakedFile(bakedLocation, std::ios::binary | std::ios::trunc);
+  if(!bakedFile.is_open())
+  {
+    std::cout << "ERROR::TEXTURE_BAKER::FAILED_TO_WRITE " << bakedLocation << std::endl;
+    return false;
+  }
+  bakedFile.write((const char*)&header, sizeof(header));
+  bakedFile.write((const char*)mipData.data(), mipData.size());
+
+  std::cout << bakedLocation << " (" << formatName(format) << ", " << header.mipCount << " mips, "
+            << (header.dataSize / 1024) << " KB)" << std::endl;
+  return true;
+}
+
+file_access bool isSourceImage(const std::filesystem::path& path)
+{
+  std::string extension = path.extension().string();
+  return extension == ".png" || extension == ".jpg" || extension == ".jpeg";
+}
+
+int main(int argc, char** argv)
+{
+  BakeSettings settings = {};
+  bool flipImageVert = false;
+  std::vector<std::string> inputs;
+  for(int i = 1; i < argc; ++i)
+  {
+    if(strcmp(argv[i], "--bc7") == 0) { settings.useBC7 = true; }
+    else if(strcmp(argv[i], "--uncompressed") == 0) { settings.uncompressed = true; }
+    else if(strcmp(argv[i], "--flip") == 0) { flipImageVert = true; }
+    else if(strncmp(argv[i], "--", 2) == 0)
+    {
+      std::cout << "usage: TextureBaker [--bc7] [--uncompressed] [--flip] [image or directory]..." << std::endl;
+      return 1;
+    }
+    else { inputs.push_back(argv[i]); }
+  }
+
+  bool bothOrientations = inputs.empty();
+  if(inputs.empty())
+  {
+    inputs.push_back("src/data");
+    inputs.push_back("src/data/PBR");
+  }
+
+  std::vector<std::string> imgLocations;
+  for(const std::string& input : inputs)
+  {
+    if(std::filesystem::is_directory(input))
+    {
+      for(const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(input))
+      {
+        if(entry.is_regular_file() && isSourceImage(entry.path())) { imgLocations.push_back(entry.path().generic_string()); }
+      }
+    } else
+    {
+      imgLocations.push_back(input);
+    }
+  }
+
+  uint32 failureCount = 0;
+  for(const std::string& imgLocation : imgLocations)
+  {
+    if(!bakeTexture(imgLocation, flipImageVert, settings)) { failureCount++; }
+    if(bothOrientations && !bakeTexture(imgLocation, !flipImageVert, settings)) { failureCount++; }
+  }
+
+  std::cout << "Baked " << (imgLocations.size() * (bothOrientations ? 2 : 1)) - failureCount << " textures, "
+            << failureCount << " failed" << std::endl;
+  return failureCount == 0 ? 0 : 1;
+}